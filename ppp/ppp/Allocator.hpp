@@ -0,0 +1,381 @@
+/*
+ *  Allocator.hpp
+ *  Allocators used for the backing storage of ppp containers
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_ALLOCATOR_HPP_
+#define PPP_PPP_ALLOCATOR_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ppp {
+
+// One cache line, which is also the width of an AVX-512 register
+constexpr std::size_t BUFFER_ALIGNMENT{64};
+
+template <class T, std::size_t Alignment = BUFFER_ALIGNMENT>
+class AlignedAllocator {
+ public:
+    static_assert(Alignment >= alignof(T), "Alignment too small for type");
+    static_assert((Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two");
+
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    constexpr AlignedAllocator() noexcept = default;
+
+    template <class U>
+    constexpr AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {
+    }
+
+    [[nodiscard]] T *allocate(std::size_t count) {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T *>(
+            ::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T *pointer, std::size_t) noexcept {
+        ::operator delete(pointer, std::align_val_t{Alignment});
+    }
+
+    template <class U>
+    constexpr bool operator==(
+        const AlignedAllocator<U, Alignment> &) const noexcept {
+        return true;
+    }
+};  // class AlignedAllocator
+
+namespace detail {
+
+inline std::pmr::memory_resource *&CurrentResourceSlot() noexcept {
+    thread_local std::pmr::memory_resource *resource{
+        std::pmr::new_delete_resource()};
+    return resource;
+}
+
+}  // namespace detail
+
+/**
+ * @brief The memory resource new Matrix and Column buffers on this thread
+ *        are drawn from; the aligned global heap unless a ScopedResource
+ *        says otherwise
+ */
+inline std::pmr::memory_resource *CurrentResource() noexcept {
+    return detail::CurrentResourceSlot();
+}
+
+/*
+ * Installs a memory resource as this thread's CurrentResource() for its
+ * lifetime. Buffers remember the resource they came from, so they can be
+ * moved out of the scope, but the resource has to outlive them.
+ */
+class ScopedResource {
+ public:
+    explicit ScopedResource(std::pmr::memory_resource *resource) noexcept
+        : previous_{std::exchange(detail::CurrentResourceSlot(), resource)} {}
+
+    ScopedResource(const ScopedResource &) = delete;
+    ScopedResource &operator=(const ScopedResource &) = delete;
+
+    ~ScopedResource() { detail::CurrentResourceSlot() = previous_; }
+
+ private:
+    std::pmr::memory_resource *previous_;
+};  // class ScopedResource
+
+/*
+ * Allocator over a std::pmr::memory_resource that always asks for
+ * BUFFER_ALIGNMENT. Default construction picks up CurrentResource(), and
+ * so does a copied container, while moves keep the source's resource so
+ * they stay O(1).
+ */
+template <class T>
+class ResourceAllocator {
+ public:
+    static constexpr std::size_t ALIGNMENT{
+        std::max(BUFFER_ALIGNMENT, alignof(T))};
+
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ResourceAllocator() noexcept : resource_{CurrentResource()} {}
+
+    explicit ResourceAllocator(std::pmr::memory_resource *resource) noexcept
+        : resource_{resource} {}
+
+    template <class U>
+    ResourceAllocator(const ResourceAllocator<U> &other) noexcept
+        : resource_{other.Resource()} {}
+
+    [[nodiscard]] T *allocate(std::size_t count) {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T *>(
+            resource_->allocate(count * sizeof(T), ALIGNMENT));
+    }
+
+    void deallocate(T *pointer, std::size_t count) noexcept {
+        resource_->deallocate(pointer, count * sizeof(T), ALIGNMENT);
+    }
+
+    ResourceAllocator select_on_container_copy_construction() const noexcept {
+        return {};
+    }
+
+    std::pmr::memory_resource *Resource() const noexcept { return resource_; }
+
+    template <class U>
+    bool operator==(const ResourceAllocator<U> &other) const noexcept {
+        return resource_ == other.Resource() ||
+               resource_->is_equal(*other.Resource());
+    }
+
+ private:
+    std::pmr::memory_resource *resource_;
+};  // class ResourceAllocator
+
+// Blocks of 64 B << class are pooled; anything larger goes upstream
+constexpr std::size_t POOL_CLASSES{20};
+
+/*
+ * Thread-safe pool of cache-line aligned blocks in power-of-two size
+ * classes. Freed blocks are kept on per-class free lists and handed back
+ * out, so a loop producing same-shaped temporaries stops calling malloc
+ * after its first iteration. Memory goes back upstream on Release() or
+ * destruction.
+ */
+class PoolResource : public std::pmr::memory_resource {
+ public:
+    explicit PoolResource(
+        std::pmr::memory_resource *upstream =
+            std::pmr::new_delete_resource()) noexcept
+        : upstream_{upstream}, free_{} {}
+
+    PoolResource(const PoolResource &) = delete;
+    PoolResource &operator=(const PoolResource &) = delete;
+
+    ~PoolResource() override { Release(); }
+
+    // Returns every cached block to upstream
+    void Release() noexcept {
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (std::size_t size_class{0}; size_class < POOL_CLASSES;
+             size_class++) {
+            while (free_[size_class] != nullptr) {
+                FreeBlock *block{free_[size_class]};
+                free_[size_class] = block->next;
+                upstream_->deallocate(block, BlockSize(size_class),
+                                      BUFFER_ALIGNMENT);
+            }
+        }
+    }
+
+ private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    static constexpr std::size_t BlockSize(std::size_t size_class) noexcept {
+        return BUFFER_ALIGNMENT << size_class;
+    }
+
+    static constexpr std::size_t SizeClass(std::size_t bytes) noexcept {
+        return bytes <= BUFFER_ALIGNMENT
+                   ? 0
+                   : std::bit_width((bytes - 1) / BUFFER_ALIGNMENT);
+    }
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        const std::size_t size_class{SizeClass(bytes)};
+        if (size_class >= POOL_CLASSES || alignment > BUFFER_ALIGNMENT) {
+            return upstream_->allocate(bytes, alignment);
+        }
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (FreeBlock *block{free_[size_class]}; block != nullptr) {
+                free_[size_class] = block->next;
+                return block;
+            }
+        }
+        return upstream_->allocate(BlockSize(size_class), BUFFER_ALIGNMENT);
+    }
+
+    void do_deallocate(void *pointer, std::size_t bytes,
+                       std::size_t alignment) override {
+        const std::size_t size_class{SizeClass(bytes)};
+        if (size_class >= POOL_CLASSES || alignment > BUFFER_ALIGNMENT) {
+            upstream_->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        std::lock_guard<std::mutex> lock{mutex_};
+        free_[size_class] = ::new (pointer) FreeBlock{free_[size_class]};
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource *upstream_;
+    std::mutex mutex_;
+    FreeBlock *free_[POOL_CLASSES];
+};  // class PoolResource
+
+// First block an ArenaResource takes from upstream
+constexpr std::size_t ARENA_BLOCK{1 << 20};
+
+/*
+ * Bump allocator for short-lived temporaries, not thread-safe. Freeing the
+ * most recent allocation pops it, and once nothing is live the arena
+ * rewinds to its first block, so expression temporaries recycle the same
+ * few cache-hot blocks. Blocks are only returned upstream by Release() or
+ * destruction.
+ */
+class ArenaResource : public std::pmr::memory_resource {
+ public:
+    explicit ArenaResource(
+        std::size_t block_size = ARENA_BLOCK,
+        std::pmr::memory_resource *upstream =
+            std::pmr::new_delete_resource()) noexcept
+        : upstream_{upstream},
+          block_size_{std::max(block_size, BUFFER_ALIGNMENT)} {}
+
+    ArenaResource(const ArenaResource &) = delete;
+    ArenaResource &operator=(const ArenaResource &) = delete;
+
+    ~ArenaResource() override { Release(); }
+
+    // Bytes handed out since the last rewind
+    std::size_t Used() const noexcept {
+        std::size_t used{offset_};
+        for (std::size_t block{0}; block < current_; block++) {
+            used += blocks_[block].size;
+        }
+        return used;
+    }
+
+    // Frees every allocation at once; nothing may still be using them
+    void Reset() noexcept {
+        current_ = 0;
+        offset_ = 0;
+        live_ = 0;
+    }
+
+    void Release() noexcept {
+        for (const Block &block : blocks_) {
+            upstream_->deallocate(block.data, block.size, BUFFER_ALIGNMENT);
+        }
+        blocks_.clear();
+        Reset();
+    }
+
+ private:
+    struct Block {
+        std::byte *data;
+        std::size_t size;
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (alignment > BUFFER_ALIGNMENT) {
+            throw std::bad_alloc();
+        }
+        bytes = std::max<std::size_t>(bytes, 1);
+        while (current_ < blocks_.size()) {
+            const Block &block{blocks_[current_]};
+            const std::size_t start{(offset_ + alignment - 1) &
+                                    ~(alignment - 1)};
+            if (start + bytes <= block.size) {
+                offset_ = start + bytes;
+                live_++;
+                return block.data + start;
+            }
+            current_++;
+            offset_ = 0;
+        }
+
+        const std::size_t size{std::max(
+            bytes, blocks_.empty() ? block_size_ : blocks_.back().size * 2)};
+        blocks_.push_back({static_cast<std::byte *>(
+                               upstream_->allocate(size, BUFFER_ALIGNMENT)),
+                           size});
+        current_ = blocks_.size() - 1;
+        offset_ = bytes;
+        live_++;
+        return blocks_.back().data;
+    }
+
+    void do_deallocate(void *pointer, std::size_t bytes,
+                       std::size_t) override {
+        if (live_ == 0 || --live_ == 0) {
+            current_ = 0;
+            offset_ = 0;
+        } else if (current_ < blocks_.size() &&
+                   static_cast<std::byte *>(pointer) +
+                           std::max<std::size_t>(bytes, 1) ==
+                       blocks_[current_].data + offset_) {
+            offset_ = static_cast<std::size_t>(
+                static_cast<std::byte *>(pointer) - blocks_[current_].data);
+        }
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource *upstream_;
+    std::size_t block_size_;
+    std::vector<Block> blocks_{};
+    std::size_t current_{0};
+    std::size_t offset_{0};
+    std::size_t live_{0};
+};  // class ArenaResource
+
+// Process-wide pool, for buffers that are shared between threads
+inline PoolResource &SharedPool() noexcept {
+    static PoolResource pool{};
+    return pool;
+}
+
+// This thread's arena, for temporaries that never leave it
+inline ArenaResource &ThreadArena() noexcept {
+    thread_local ArenaResource arena{};
+    return arena;
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_ALLOCATOR_HPP_
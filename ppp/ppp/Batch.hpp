@@ -0,0 +1,472 @@
+/*
+ *  Batch.hpp
+ *  Many small fixed-size matrices stored structure-of-arrays
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_BATCH_HPP_
+#define PPP_PPP_BATCH_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Column.hpp"
+#include "FixedMatrix.hpp"
+#include "Matrix.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+namespace detail {
+
+// Matrices handled per task, a multiple of every BatchWidth
+constexpr std::size_t BATCH_CHUNK{4096};
+
+// Matrices per LaneBlock: one cache line, which is also the plane padding
+template <class T>
+consteval std::size_t BatchWidth() noexcept {
+    return std::max<std::size_t>(1, BUFFER_ALIGNMENT / sizeof(T));
+}
+
+/*
+ * The same entry of Width consecutive matrices. Every operator is a short
+ * unit-stride loop, so once inlined into a PPP_TARGET clone each one
+ * becomes a few full-width SIMD instructions and a closed form written
+ * for scalars runs on a whole block of matrices at once.
+ */
+template <class T, std::size_t Width>
+struct LaneBlock {
+    T lanes[Width];
+
+    PPP_ALWAYS_INLINE static constexpr LaneBlock Broadcast(T value) noexcept {
+        LaneBlock block;
+        for (std::size_t lane{0}; lane < Width; lane++) {
+            block.lanes[lane] = value;
+        }
+        return block;
+    }
+
+    PPP_ALWAYS_INLINE static constexpr LaneBlock Load(
+        const T *source) noexcept {
+        LaneBlock block;
+        for (std::size_t lane{0}; lane < Width; lane++) {
+            block.lanes[lane] = source[lane];
+        }
+        return block;
+    }
+
+    PPP_ALWAYS_INLINE constexpr void Store(T *destination) const noexcept {
+        for (std::size_t lane{0}; lane < Width; lane++) {
+            destination[lane] = lanes[lane];
+        }
+    }
+
+#define PPP_LANE_BLOCK_OPERATOR(op)                                        \
+    PPP_ALWAYS_INLINE friend constexpr LaneBlock operator op(              \
+        const LaneBlock &left, const LaneBlock &right) noexcept {          \
+        LaneBlock block;                                                   \
+        for (std::size_t lane{0}; lane < Width; lane++) {                  \
+            block.lanes[lane] = left.lanes[lane] op right.lanes[lane];     \
+        }                                                                  \
+        return block;                                                      \
+    }                                                                      \
+    PPP_ALWAYS_INLINE constexpr LaneBlock &operator op##=(                 \
+        const LaneBlock &right) noexcept {                                 \
+        for (std::size_t lane{0}; lane < Width; lane++) {                  \
+            lanes[lane] = lanes[lane] op right.lanes[lane];                \
+        }                                                                  \
+        return *this;                                                      \
+    }
+
+    PPP_LANE_BLOCK_OPERATOR(+)
+    PPP_LANE_BLOCK_OPERATOR(-)
+    PPP_LANE_BLOCK_OPERATOR(*)
+    PPP_LANE_BLOCK_OPERATOR(/)
+#undef PPP_LANE_BLOCK_OPERATOR
+};  // struct LaneBlock
+
+// value in every lane of V, for both scalars and LaneBlocks
+template <class V, class T>
+PPP_ALWAYS_INLINE constexpr V Splat(T value) noexcept {
+    if constexpr (requires { V::Broadcast(value); }) {
+        return V::Broadcast(value);
+    } else {
+        return static_cast<V>(value);
+    }
+}
+
+template <class Body>
+void BatchBlocks(std::size_t first, std::size_t last, std::size_t width,
+                 const Body &body) {
+    for (std::size_t lane{first}; lane < last; lane += width) {
+        body(lane);
+    }
+}
+
+#ifdef PPP_SIMD_X86
+template <class Body>
+PPP_TARGET_AVX2 void BatchBlocksAvx2(std::size_t first, std::size_t last,
+                                     std::size_t width, const Body &body) {
+    for (std::size_t lane{first}; lane < last; lane += width) {
+        body(lane);
+    }
+}
+
+template <class Body>
+PPP_TARGET_AVX512 void BatchBlocksAvx512(std::size_t first, std::size_t last,
+                                         std::size_t width, const Body &body) {
+    for (std::size_t lane{first}; lane < last; lane += width) {
+        body(lane);
+    }
+}
+#endif  // PPP_SIMD_X86
+
+/**
+ * @brief Runs body(lane) for every lane in [0, count) that is a multiple of
+ *        width, split across threads in BATCH_CHUNK pieces and compiled for
+ *        the widest ISA available
+ *
+ * Bodies have to be PPP_ALWAYS_INLINE so that they, and the LaneBlock
+ * operators inside them, are inlined into the ISA clone.
+ */
+template <class Body>
+void ForEachBlock(std::size_t count, std::size_t width, const Body &body) {
+    const std::size_t chunks{(count + BATCH_CHUNK - 1) / BATCH_CHUNK};
+    const std::size_t threads{count < PARALLEL_THRESHOLD ? 1
+                                                         : GetThreadCount()};
+    ParallelFor(chunks, threads, [&body, count, width](std::size_t chunk) {
+        const std::size_t first{chunk * BATCH_CHUNK};
+        const std::size_t last{std::min(count, first + BATCH_CHUNK)};
+#ifdef PPP_SIMD_X86
+        if (HasAvx512()) {
+            BatchBlocksAvx512(first, last, width, body);
+            return;
+        } else if (HasAvx2()) {
+            BatchBlocksAvx2(first, last, width, body);
+            return;
+        }
+#endif  // PPP_SIMD_X86
+        BatchBlocks(first, last, width, body);
+    });
+}
+
+/**
+ * @brief Adjugate (transposed cofactors) and determinant of an n x n
+ *        row-major matrix, n <= 4, in closed form
+ *
+ * Straight-line code with no pivoting branches, so it runs unchanged on
+ * LaneBlock entries and every matrix of a block takes the same path.
+ */
+template <class V, std::size_t N>
+PPP_ALWAYS_INLINE constexpr V Adjugate(const V (&a)[N * N],
+                                       V (&adjugate)[N * N]) noexcept {
+    if constexpr (N == 1) {
+        adjugate[0] = Splat<V>(1);
+        return a[0];
+    } else if constexpr (N == 2) {
+        adjugate[0] = a[3];
+        adjugate[1] = V{} - a[1];
+        adjugate[2] = V{} - a[2];
+        adjugate[3] = a[0];
+        return (a[0] * a[3]) - (a[1] * a[2]);
+    } else if constexpr (N == 3) {
+        adjugate[0] = (a[4] * a[8]) - (a[5] * a[7]);
+        adjugate[1] = (a[2] * a[7]) - (a[1] * a[8]);
+        adjugate[2] = (a[1] * a[5]) - (a[2] * a[4]);
+        adjugate[3] = (a[5] * a[6]) - (a[3] * a[8]);
+        adjugate[4] = (a[0] * a[8]) - (a[2] * a[6]);
+        adjugate[5] = (a[2] * a[3]) - (a[0] * a[5]);
+        adjugate[6] = (a[3] * a[7]) - (a[4] * a[6]);
+        adjugate[7] = (a[1] * a[6]) - (a[0] * a[7]);
+        adjugate[8] = (a[0] * a[4]) - (a[1] * a[3]);
+        return (a[0] * adjugate[0]) + (a[1] * adjugate[3]) +
+               (a[2] * adjugate[6]);
+    } else {
+        static_assert(N == 4, "Closed forms stop at 4 x 4");
+        // 2 x 2 minors of the top (s) and bottom (c) row pairs
+        const V s0{(a[0] * a[5]) - (a[4] * a[1])};
+        const V s1{(a[0] * a[6]) - (a[4] * a[2])};
+        const V s2{(a[0] * a[7]) - (a[4] * a[3])};
+        const V s3{(a[1] * a[6]) - (a[5] * a[2])};
+        const V s4{(a[1] * a[7]) - (a[5] * a[3])};
+        const V s5{(a[2] * a[7]) - (a[6] * a[3])};
+        const V c0{(a[8] * a[13]) - (a[12] * a[9])};
+        const V c1{(a[8] * a[14]) - (a[12] * a[10])};
+        const V c2{(a[8] * a[15]) - (a[12] * a[11])};
+        const V c3{(a[9] * a[14]) - (a[13] * a[10])};
+        const V c4{(a[9] * a[15]) - (a[13] * a[11])};
+        const V c5{(a[10] * a[15]) - (a[14] * a[11])};
+
+        adjugate[0] = (a[5] * c5) - (a[6] * c4) + (a[7] * c3);
+        adjugate[1] = (a[2] * c4) - (a[1] * c5) - (a[3] * c3);
+        adjugate[2] = (a[13] * s5) - (a[14] * s4) + (a[15] * s3);
+        adjugate[3] = (a[10] * s4) - (a[9] * s5) - (a[11] * s3);
+        adjugate[4] = (a[6] * c2) - (a[4] * c5) - (a[7] * c1);
+        adjugate[5] = (a[0] * c5) - (a[2] * c2) + (a[3] * c1);
+        adjugate[6] = (a[14] * s2) - (a[12] * s5) - (a[15] * s1);
+        adjugate[7] = (a[8] * s5) - (a[10] * s2) + (a[11] * s1);
+        adjugate[8] = (a[4] * c4) - (a[5] * c2) + (a[7] * c0);
+        adjugate[9] = (a[1] * c2) - (a[0] * c4) - (a[3] * c0);
+        adjugate[10] = (a[12] * s4) - (a[13] * s2) + (a[15] * s0);
+        adjugate[11] = (a[9] * s2) - (a[8] * s4) - (a[11] * s0);
+        adjugate[12] = (a[5] * c1) - (a[4] * c3) - (a[6] * c0);
+        adjugate[13] = (a[0] * c3) - (a[1] * c1) + (a[2] * c0);
+        adjugate[14] = (a[13] * s1) - (a[12] * s3) - (a[14] * s0);
+        adjugate[15] = (a[8] * s3) - (a[9] * s1) + (a[10] * s0);
+        return (s0 * c5) - (s1 * c4) + (s2 * c3) + (s3 * c2) - (s4 * c1) +
+               (s5 * c0);
+    }
+}
+
+}  // namespace detail
+
+/*
+ * Count matrices of Rows x Columns, stored structure-of-arrays: entry (r, c)
+ * of every matrix sits in one contiguous plane, so entry (r, c) of a block
+ * of consecutive matrices fills whole SIMD registers and each batched
+ * operation is the scalar formula applied to those registers. Planes are
+ * padded to a multiple of BUFFER_ALIGNMENT so that every one starts on a
+ * cache line and the last block never reads past its plane.
+ */
+template <BasicEntry T, std::size_t Rows, std::size_t Columns>
+    requires(Rows > 0 && Columns > 0)
+class MatrixBatch {
+ public:
+    using Buffer = std::vector<T, ResourceAllocator<T>>;
+
+    [[nodiscard("You Must Check Success")]]
+    static std::optional<MatrixBatch<T, Rows, Columns>> New(
+        std::size_t count) noexcept {
+        return MatrixBatch<T, Rows, Columns>{count};
+    }
+
+    constexpr std::size_t Size() const noexcept { return count_; }
+
+    // Distance between planes, count rounded up to a whole cache line
+    constexpr std::size_t Stride() const noexcept { return stride_; }
+
+    const T *Plane(std::size_t row, std::size_t column) const noexcept {
+        return data_.data() + (((row * Columns) + column) * stride_);
+    }
+
+    T *Plane(std::size_t row, std::size_t column) noexcept {
+        return data_.data() + (((row * Columns) + column) * stride_);
+    }
+
+    std::optional<FixedMatrix<T, Rows, Columns>> Get(
+        std::size_t index) const noexcept {
+        if (index >= count_) {
+            return std::nullopt;
+        } else {
+            FixedMatrix<T, Rows, Columns> matrix{};
+            for (std::size_t entry{0}; entry < Rows * Columns; entry++) {
+                matrix.Data()[entry] = data_[(entry * stride_) + index];
+            }
+            return matrix;
+        }
+    }
+
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t> Set(
+        std::size_t index,
+        const FixedMatrix<T, Rows, Columns> &matrix) noexcept {
+        if (index >= count_) {
+            return std::nullopt;
+        } else {
+            for (std::size_t entry{0}; entry < Rows * Columns; entry++) {
+                data_[(entry * stride_) + index] = matrix.Data()[entry];
+            }
+            return 0;
+        }
+    }
+
+    // Determinant of every matrix, in order
+    Column<T> Det() const noexcept
+        requires(Rows == Columns && Rows <= 4)
+    {
+        // Sized to the padded planes so the last block can store whole
+        typename Column<T>::Buffer determinants(stride_);
+        T *output{determinants.data()};
+        const T *input{data_.data()};
+        const std::size_t stride{stride_};
+        detail::ForEachBlock(stride, WIDTH, [=](std::size_t lane)
+                                                PPP_ALWAYS_INLINE {
+            Lanes a[Rows * Columns];
+            Lanes adjugate[Rows * Columns];
+            for (std::size_t entry{0}; entry < Rows * Columns; entry++) {
+                a[entry] = Lanes::Load(input + (entry * stride) + lane);
+            }
+            detail::Adjugate<Lanes, Rows>(a, adjugate).Store(output + lane);
+        });
+        determinants.resize(count_);
+        return Column<T>{std::move(determinants), "det"};
+    }
+
+    /**
+     * @brief Inverse of every matrix, by adjugate over determinant
+     *
+     * No pivoting, so every lane runs the same instructions. A singular
+     * matrix leaves non-finite entries in its slot; check Det() first when
+     * that can happen.
+     */
+    MatrixBatch<T, Rows, Columns> Inverse() const noexcept
+        requires(Rows == Columns && Rows <= 4 && !std::is_integral_v<T>)
+    {
+        MatrixBatch<T, Rows, Columns> result{count_};
+        T *output{result.data_.data()};
+        const T *input{data_.data()};
+        const std::size_t stride{stride_};
+        detail::ForEachBlock(stride, WIDTH, [=](std::size_t lane)
+                                                PPP_ALWAYS_INLINE {
+            Lanes a[Rows * Columns];
+            Lanes adjugate[Rows * Columns];
+            for (std::size_t entry{0}; entry < Rows * Columns; entry++) {
+                a[entry] = Lanes::Load(input + (entry * stride) + lane);
+            }
+            const Lanes scale{Lanes::Broadcast(T(1)) /
+                              detail::Adjugate<Lanes, Rows>(a, adjugate)};
+            for (std::size_t entry{0}; entry < Rows * Columns; entry++) {
+                (adjugate[entry] * scale)
+                    .Store(output + (entry * stride) + lane);
+            }
+        });
+        return result;
+    }
+
+    /**
+     * @brief Solves A_i * X_i = B_i for every matrix in the batch, with the
+     *        same closed forms as Inverse()
+     *
+     * @return std::nullopt if rhs holds a different number of matrices
+     */
+    template <std::size_t K>
+    std::optional<MatrixBatch<T, Rows, K>> Solve(
+        const MatrixBatch<T, Rows, K> &rhs) const noexcept
+        requires(Rows == Columns && Rows <= 4 && !std::is_integral_v<T>)
+    {
+        if (rhs.Size() != count_) {
+            return std::nullopt;
+        }
+
+        std::optional<MatrixBatch<T, Rows, K>> result{
+            MatrixBatch<T, Rows, K>::New(count_)};
+        T *output{result.value().Plane(0, 0)};
+        const T *input{data_.data()};
+        const T *b{rhs.Plane(0, 0)};
+        const std::size_t stride{stride_};
+        detail::ForEachBlock(stride, WIDTH, [=](std::size_t lane)
+                                                PPP_ALWAYS_INLINE {
+            Lanes a[Rows * Columns];
+            Lanes adjugate[Rows * Columns];
+            for (std::size_t entry{0}; entry < Rows * Columns; entry++) {
+                a[entry] = Lanes::Load(input + (entry * stride) + lane);
+            }
+            const Lanes scale{Lanes::Broadcast(T(1)) /
+                              detail::Adjugate<Lanes, Rows>(a, adjugate)};
+            for (std::size_t row{0}; row < Rows; row++) {
+                for (std::size_t column{0}; column < K; column++) {
+                    Lanes sum{Lanes::Broadcast(T(0))};
+                    for (std::size_t inner{0}; inner < Rows; inner++) {
+                        sum += adjugate[(row * Rows) + inner] *
+                               Lanes::Load(b + (((inner * K) + column) *
+                                                stride) +
+                                           lane);
+                    }
+                    (sum * scale)
+                        .Store(output + (((row * K) + column) * stride) +
+                               lane);
+                }
+            }
+        });
+        return result;
+    }
+
+ private:
+    explicit MatrixBatch(std::size_t count) noexcept
+        : count_{count},
+          stride_{RoundUp(count)},
+          data_(Rows * Columns * RoundUp(count), T(0)) {}
+
+    static constexpr std::size_t WIDTH{detail::BatchWidth<T>()};
+    using Lanes = detail::LaneBlock<T, WIDTH>;
+
+    static constexpr std::size_t RoundUp(std::size_t count) noexcept {
+        return ((count + WIDTH - 1) / WIDTH) * WIDTH;
+    }
+
+    std::size_t count_;
+    std::size_t stride_;
+    Buffer data_;
+};  // class MatrixBatch
+
+/**
+ * @brief Multiplies the matrices of two batches pairwise
+ *
+ * @return std::nullopt if the batches hold different numbers of matrices
+ */
+template <BasicEntry T, std::size_t Rows, std::size_t Inner,
+          std::size_t Columns>
+inline std::optional<MatrixBatch<T, Rows, Columns>> Multiply(
+    const MatrixBatch<T, Rows, Inner> &lhs,
+    const MatrixBatch<T, Inner, Columns> &rhs) noexcept {
+    if (lhs.Size() != rhs.Size()) {
+        return std::nullopt;
+    }
+
+    std::optional<MatrixBatch<T, Rows, Columns>> product{
+        MatrixBatch<T, Rows, Columns>::New(lhs.Size())};
+    using Lanes = detail::LaneBlock<T, detail::BatchWidth<T>()>;
+    T *output{product.value().Plane(0, 0)};
+    const T *a{lhs.Plane(0, 0)};
+    const T *b{rhs.Plane(0, 0)};
+    const std::size_t stride{lhs.Stride()};
+    detail::ForEachBlock(stride, detail::BatchWidth<T>(),
+                         [=](std::size_t lane) PPP_ALWAYS_INLINE {
+        for (std::size_t row{0}; row < Rows; row++) {
+            for (std::size_t column{0}; column < Columns; column++) {
+                Lanes sum{Lanes::Broadcast(T(0))};
+                for (std::size_t inner{0}; inner < Inner; inner++) {
+                    sum += Lanes::Load(a + (((row * Inner) + inner) * stride) +
+                                       lane) *
+                           Lanes::Load(b +
+                                       (((inner * Columns) + column) * stride) +
+                                       lane);
+                }
+                sum.Store(output + (((row * Columns) + column) * stride) +
+                          lane);
+            }
+        }
+    });
+    return product;
+}
+
+template <BasicEntry T, std::size_t Rows, std::size_t Inner,
+          std::size_t Columns>
+inline std::optional<MatrixBatch<T, Rows, Columns>> operator*(
+    const MatrixBatch<T, Rows, Inner> &lhs,
+    const MatrixBatch<T, Inner, Columns> &rhs) noexcept {
+    return Multiply(lhs, rhs);
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_BATCH_HPP_
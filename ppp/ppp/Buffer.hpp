@@ -0,0 +1,203 @@
+/*
+ *  Buffer.hpp
+ *  Reference-counted, copy-on-write element storage
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_BUFFER_HPP_
+#define PPP_PPP_BUFFER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#include "Allocator.hpp"
+
+namespace ppp {
+
+/*
+ * Fixed-size array of T whose copies share one allocation. The reference
+ * count lives in a cache line just ahead of the elements, so a buffer is a
+ * single allocation from CurrentResource() and the elements stay
+ * BUFFER_ALIGNMENT aligned.
+ *
+ * Copying is O(1). Every non-const accessor first makes the buffer unique,
+ * copying the elements if anything else still refers to them, so writes
+ * are never seen through another copy. Pointers handed out earlier are not
+ * tracked: take them after copying, not before. Clone() always copies, for
+ * owners that only share when asked to.
+ *
+ * Detach() is not thread safe. Call a non-const accessor once and hand the
+ * pointer to parallel workers rather than calling it from each of them.
+ */
+template <class T>
+class SharedBuffer {
+ public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    SharedBuffer() noexcept : header_{nullptr}, data_{nullptr} {}
+
+    SharedBuffer(std::size_t count, const T &value)
+        : header_{Allocate(count)}, data_{Elements(header_)} {
+        if (header_ != nullptr) {
+            std::uninitialized_fill_n(data_, count, value);
+        }
+    }
+
+    SharedBuffer(const SharedBuffer &other) noexcept
+        : header_{other.header_}, data_{other.data_} {
+        if (header_ != nullptr) {
+            header_->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedBuffer(SharedBuffer &&other) noexcept
+        : header_{std::exchange(other.header_, nullptr)},
+          data_{std::exchange(other.data_, nullptr)} {}
+
+    SharedBuffer &operator=(SharedBuffer other) noexcept {
+        std::swap(header_, other.header_);
+        std::swap(data_, other.data_);
+        return *this;
+    }
+
+    ~SharedBuffer() { Release(); }
+
+    // A buffer with its own copy of the elements, never shared
+    SharedBuffer Clone() const {
+        SharedBuffer clone{};
+        if (header_ != nullptr) {
+            clone.header_ = Allocate(header_->size);
+            clone.data_ = Elements(clone.header_);
+            std::uninitialized_copy_n(data_, header_->size, clone.data_);
+        }
+        return clone;
+    }
+
+    std::size_t size() const noexcept {
+        return header_ == nullptr ? 0 : header_->size;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    // Number of buffers, this one included, sharing the elements
+    std::size_t References() const noexcept {
+        return header_ == nullptr
+                   ? 1
+                   : header_->references.load(std::memory_order_acquire);
+    }
+
+    const T *data() const noexcept { return data_; }
+    T *data() {
+        Detach();
+        return data_;
+    }
+
+    const T &operator[](std::size_t index) const noexcept {
+        return data_[index];
+    }
+    T &operator[](std::size_t index) {
+        Detach();
+        return data_[index];
+    }
+
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size(); }
+    const_iterator cbegin() const noexcept { return data_; }
+    const_iterator cend() const noexcept { return data_ + size(); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
+
+    // Gives this buffer its own copy of the elements if they are shared
+    void Detach() {
+        if (header_ != nullptr &&
+            header_->references.load(std::memory_order_acquire) > 1) {
+            Header *unique{Allocate(header_->size)};
+            std::uninitialized_copy_n(data_, header_->size, Elements(unique));
+            Release();
+            header_ = unique;
+            data_ = Elements(unique);
+        }
+    }
+
+ private:
+    struct Header {
+        std::atomic<std::size_t> references;
+        std::size_t size;
+        std::pmr::memory_resource *resource;
+    };
+
+    static constexpr std::size_t ALIGNMENT{
+        std::max(BUFFER_ALIGNMENT, alignof(T))};
+    static constexpr std::size_t HEADER_BYTES{
+        ((sizeof(Header) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT};
+
+    static constexpr std::size_t Bytes(std::size_t count) noexcept {
+        return HEADER_BYTES + (count * sizeof(T));
+    }
+
+    static T *Elements(Header *header) noexcept {
+        return header == nullptr
+                   ? nullptr
+                   : reinterpret_cast<T *>(
+                         reinterpret_cast<std::byte *>(header) +
+                         HEADER_BYTES);
+    }
+
+    // Uninitialized room for count elements, or nullptr when count is 0
+    static Header *Allocate(std::size_t count) {
+        if (count == 0) {
+            return nullptr;
+        } else if (count >
+                   (std::numeric_limits<std::size_t>::max() - HEADER_BYTES) /
+                       sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        std::pmr::memory_resource *resource{CurrentResource()};
+        return ::new (resource->allocate(Bytes(count), ALIGNMENT))
+            Header{1, count, resource};
+    }
+
+    void Release() noexcept {
+        if (header_ != nullptr &&
+            header_->references.fetch_sub(1, std::memory_order_acq_rel) ==
+                1) {
+            const std::size_t count{header_->size};
+            std::pmr::memory_resource *resource{header_->resource};
+            std::destroy_n(data_, count);
+            header_->~Header();
+            resource->deallocate(header_, Bytes(count), ALIGNMENT);
+        }
+        header_ = nullptr;
+        data_ = nullptr;
+    }
+
+    Header *header_;
+    T *data_;
+};  // class SharedBuffer
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_BUFFER_HPP_
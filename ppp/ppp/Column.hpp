@@ -38,6 +38,10 @@
 #include <utility>
 #include <vector>
 
+#include "Allocator.hpp"
+#include "Math.hpp"
+#include "ThreadPool.hpp"
+
 namespace ppp {
 
 enum class ErrorCode : std::uint8_t {
@@ -71,14 +75,17 @@ concept Number = SimpleComplexNumber<T> || SimpleNumber<T>;
 template <BasicEntry T>
 class Column {
  public:
+    // Drawn from CurrentResource() when created; see Allocator.hpp
+    using Buffer = std::vector<T, ResourceAllocator<T>>;
+
     constexpr Column(const std::vector<T> &data, const std::string_view key)
-        : data_{data}, key_{key} {}
+        : data_(data.cbegin(), data.cend()), key_{key} {}
 
-    constexpr Column(const std::vector<T> &&data, const std::string_view key)
-        : data_{data}, key_{key} {}
+    constexpr Column(Buffer &&data, const std::string_view key)
+        : data_{std::move(data)}, key_{key} {}
 
-    constexpr explicit Column(const Column<T> &&moved)
-        : data_{moved.data_}, key_{moved.key_} {}
+    constexpr explicit Column(Column<T> &&moved) noexcept
+        : data_{std::move(moved.data_)}, key_{std::move(moved.key_)} {}
 
     constexpr inline T Sum() const {
         return std::reduce(std::execution::par_unseq, data_.begin(),
@@ -87,6 +94,9 @@ class Column {
 
     constexpr std::size_t Size() const { return data_.size(); }
 
+    constexpr const T *Data() const noexcept { return data_.data(); }
+    constexpr T *Data() noexcept { return data_.data(); }
+
     constexpr T LNorm(std::optional<std::size_t> norm) const {
         if (!norm.has_value()) {
             // L-Infinity - max element magnitude
@@ -122,13 +132,9 @@ class Column {
         if (rhs.Size() != this->Size()) {
             return std::nullopt;
         } else {
-            auto it = std::ranges::views::zip(this->data_, rhs.data_);
-            std::atomic<T> sum{};
-            std::for_each(std::execution::par_unseq, it.begin(), it.end(),
-                          [&sum](const std::pair<T, T> &x) {
-                              sum += x.first * x.second;
-                          });
-            return sum;
+            return std::transform_reduce(std::execution::par_unseq,
+                                         data_.cbegin(), data_.cend(),
+                                         rhs.data_.cbegin(), T(0));
         }
     }
 
@@ -137,7 +143,7 @@ class Column {
         if (rhs.data_.size() != 3 || this->data_.size() != 3) {
             return std::nullopt;
         } else {
-            std::vector<T> cross{
+            Buffer cross{
                 (data_[1] * rhs.data_[2]) - (data_[2] * rhs.data_[1]),
                 (data_[2] * rhs.data_[0]) - (data_[0] * rhs.data_[2]),
                 (data_[0] * rhs.data_[1]) - (data_[1] * rhs.data_[0]),
@@ -163,6 +169,111 @@ class Column {
         }
     }
 
+    // The compound operators update the column in place and keep its key
+    constexpr std::optional<std::uint8_t> operator+=(const Column<T> &rhs) {
+        if (rhs.data_.size() != data_.size()) {
+            return std::nullopt;
+        } else {
+            std::transform(std::execution::par_unseq, data_.cbegin(),
+                           data_.cend(), rhs.data_.cbegin(), data_.begin(),
+                           std::plus<T>());
+            return 0;
+        }
+    }
+
+    constexpr std::optional<std::uint8_t> operator-=(const Column<T> &rhs) {
+        if (rhs.data_.size() != data_.size()) {
+            return std::nullopt;
+        } else {
+            std::transform(std::execution::par_unseq, data_.cbegin(),
+                           data_.cend(), rhs.data_.cbegin(), data_.begin(),
+                           std::minus<T>());
+            return 0;
+        }
+    }
+
+    constexpr Column<T> &operator*=(const T &rhs) {
+        std::transform(std::execution::par_unseq, data_.cbegin(), data_.cend(),
+                       data_.begin(),
+                       [&rhs](const T &entry) { return entry * rhs; });
+        return *this;
+    }
+
+    constexpr Column<T> &operator/=(const T &rhs) {
+        std::transform(std::execution::par_unseq, data_.cbegin(), data_.cend(),
+                       data_.begin(),
+                       [&rhs](const T &entry) { return entry / rhs; });
+        return *this;
+    }
+
+    /* ********************************************************************** */
+    /*                            Element-wise Math                           */
+    /* ********************************************************************** */
+
+    // Each result is keyed after this column, e.g. "exp(key)". MathPrecision
+    // lists how far the Fast kernels can be off.
+
+    Column<T> Exp(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return Column<T>{MathOver(detail::MathOp::Exp, nullptr, 0, precision),
+                         "exp(" + key_ + ")"};
+    }
+
+    Column<T> Log(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return Column<T>{MathOver(detail::MathOp::Log, nullptr, 0, precision),
+                         "log(" + key_ + ")"};
+    }
+
+    Column<T> Sqrt(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return Column<T>{MathOver(detail::MathOp::Sqrt, nullptr, 0, precision),
+                         "sqrt(" + key_ + ")"};
+    }
+
+    Column<T> Tanh(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return Column<T>{MathOver(detail::MathOp::Tanh, nullptr, 0, precision),
+                         "tanh(" + key_ + ")"};
+    }
+
+    Column<T> Sigmoid(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return Column<T>{
+            MathOver(detail::MathOp::Sigmoid, nullptr, 0, precision),
+            "sigmoid(" + key_ + ")"};
+    }
+
+    Column<T> Pow(const T &exponent,
+                  MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return Column<T>{
+            MathOver(detail::MathOp::Pow, &exponent, 0, precision),
+            "pow(" + key_ + ")"};
+    }
+
+    // std::nullopt unless exponents is as long as this column
+    std::optional<Column<T>> Pow(
+        const Column<T> &exponents,
+        MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        if (exponents.data_.size() != data_.size()) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(
+                MathOver(detail::MathOp::Pow, exponents.data_.data(), 1,
+                         precision),
+                "pow(" + key_ + ", " + exponents.key_ + ")");
+        }
+    }
+
     /* ********************************************************************** */
     /*                                Friends                                 */
     /* ********************************************************************** */
@@ -179,6 +290,22 @@ class Column {
     constexpr friend inline std::optional<Column<V>> operator-(
         const Column<V> &lhs, const Column<V> &rhs);
 
+    template <BasicEntry V>
+    constexpr friend inline std::optional<Column<V>> operator+(
+        Column<V> &&lhs, const Column<V> &rhs);
+
+    template <BasicEntry V>
+    constexpr friend inline std::optional<Column<V>> operator+(
+        const Column<V> &lhs, Column<V> &&rhs);
+
+    template <BasicEntry V>
+    constexpr friend inline std::optional<Column<V>> operator-(
+        Column<V> &&lhs, const Column<V> &rhs);
+
+    template <BasicEntry V>
+    constexpr friend inline std::optional<Column<V>> operator-(
+        const Column<V> &lhs, Column<V> &&rhs);
+
     template <BasicEntry V>
     constexpr friend inline std::optional<V> operator*(const Column<V> &lhs,
                                                        const Column<V> &rhs);
@@ -191,12 +318,25 @@ class Column {
     constexpr friend inline Column<V> operator*(const Column<V> &lhs,
                                                 const V &rhs);
 
+    template <Number V>
+    constexpr friend inline Column<V> operator*(const V &lhs,
+                                                Column<V> &&rhs);
+
     template <BasicEntry V>
     constexpr friend inline bool operator==(const Column<V> &lhs,
                                             const Column<V> &rhs);
 
  private:
-    std::vector<T> data_;
+    Buffer MathOver(detail::MathOp op, const T *exponents,
+                    std::size_t exponent_step, MathPrecision precision) const {
+        Buffer result(data_.size());
+        detail::ElementwiseMath(op, data_.data(), exponents, exponent_step,
+                                result.data(), data_.size(), GetThreadCount(),
+                                precision);
+        return result;
+    }
+
+    Buffer data_;
     std::string key_;
 };
 
@@ -217,7 +357,7 @@ constexpr inline std::optional<Column<V>> operator+(const Column<V> &lhs,
     if (lhs.data_.size() != rhs.data_.size()) {
         return std::nullopt;
     } else {
-        std::vector<V> sum(lhs.data_.size());
+        typename Column<V>::Buffer sum(lhs.data_.size());
         std::transform(std::execution::par_unseq, lhs.data_.cbegin(),
                        lhs.data_.cend(), rhs.data_.cbegin(), sum.begin(),
                        std::plus<V>());
@@ -233,7 +373,7 @@ constexpr inline std::optional<Column<V>> operator-(const Column<V> &lhs,
     if (lhs.data_.size() != rhs.data_.size()) {
         return std::nullopt;
     } else {
-        std::vector<V> diff(lhs.data_.size());
+        typename Column<V>::Buffer diff(lhs.data_.size());
         std::transform(std::execution::par_unseq, lhs.data_.cbegin(),
                        lhs.data_.cend(), rhs.data_.cbegin(), diff.begin(),
                        std::minus<V>());
@@ -243,6 +383,70 @@ constexpr inline std::optional<Column<V>> operator-(const Column<V> &lhs,
     }
 }
 
+// Overloads taking a temporary reuse its buffer for the result
+
+template <BasicEntry V>
+constexpr inline std::optional<Column<V>> operator+(Column<V> &&lhs,
+                                                    const Column<V> &rhs) {
+    if (!(lhs += rhs).has_value()) {
+        return std::nullopt;
+    } else {
+        lhs.key_ += " + " + rhs.key_;
+        return std::make_optional<Column<V>>(std::move(lhs));
+    }
+}
+
+template <BasicEntry V>
+constexpr inline std::optional<Column<V>> operator+(const Column<V> &lhs,
+                                                    Column<V> &&rhs) {
+    if (lhs.data_.size() != rhs.data_.size()) {
+        return std::nullopt;
+    } else {
+        std::transform(std::execution::par_unseq, lhs.data_.cbegin(),
+                       lhs.data_.cend(), rhs.data_.cbegin(), rhs.data_.begin(),
+                       std::plus<V>());
+        rhs.key_ = lhs.key_ + " + " + rhs.key_;
+        return std::make_optional<Column<V>>(std::move(rhs));
+    }
+}
+
+template <BasicEntry V>
+constexpr inline std::optional<Column<V>> operator+(Column<V> &&lhs,
+                                                    Column<V> &&rhs) {
+    return std::move(lhs) + rhs;
+}
+
+template <BasicEntry V>
+constexpr inline std::optional<Column<V>> operator-(Column<V> &&lhs,
+                                                    const Column<V> &rhs) {
+    if (!(lhs -= rhs).has_value()) {
+        return std::nullopt;
+    } else {
+        lhs.key_ += " - " + rhs.key_;
+        return std::make_optional<Column<V>>(std::move(lhs));
+    }
+}
+
+template <BasicEntry V>
+constexpr inline std::optional<Column<V>> operator-(const Column<V> &lhs,
+                                                    Column<V> &&rhs) {
+    if (lhs.data_.size() != rhs.data_.size()) {
+        return std::nullopt;
+    } else {
+        std::transform(std::execution::par_unseq, lhs.data_.cbegin(),
+                       lhs.data_.cend(), rhs.data_.cbegin(), rhs.data_.begin(),
+                       std::minus<V>());
+        rhs.key_ = lhs.key_ + " - " + rhs.key_;
+        return std::make_optional<Column<V>>(std::move(rhs));
+    }
+}
+
+template <BasicEntry V>
+constexpr inline std::optional<Column<V>> operator-(Column<V> &&lhs,
+                                                    Column<V> &&rhs) {
+    return std::move(lhs) - rhs;
+}
+
 template <BasicEntry V>
 constexpr inline bool operator==(const Column<V> &lhs, const Column<V> &rhs) {
     return lhs.data_ == rhs.data_;
@@ -256,7 +460,7 @@ constexpr inline std::optional<V> operator*(const Column<V> &lhs,
 
 template <Number V>
 constexpr inline Column<V> operator*(const V &lhs, const Column<V> &rhs) {
-    std::vector<V> data(rhs.data_.size());
+    typename Column<V>::Buffer data(rhs.data_.size());
 
     std::transform(std::execution::par_unseq, rhs.data_.cbegin(),
                    rhs.data_.cend(), data.begin(),
@@ -270,6 +474,18 @@ constexpr inline Column<V> operator*(const Column<V> &lhs, const V &rhs) {
     return rhs * lhs;
 }
 
+template <Number V>
+constexpr inline Column<V> operator*(const V &lhs, Column<V> &&rhs) {
+    rhs *= lhs;
+    rhs.key_ += " * " + std::to_string(lhs);
+    return Column<V>(std::move(rhs));
+}
+
+template <Number V>
+constexpr inline Column<V> operator*(Column<V> &&lhs, const V &rhs) {
+    return rhs * std::move(lhs);
+}
+
 }  // namespace ppp
 
 #endif  // PPP_PPP_COLUMN_HPP_
@@ -0,0 +1,424 @@
+/*
+ *  Convolution.hpp
+ *  Direct and im2col kernels for two dimensional convolution on ppp::Matrix
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_CONVOLUTION_HPP_
+#define PPP_PPP_CONVOLUTION_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Gemm.hpp"
+#include "Reduce.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Tuning.hpp"
+
+namespace ppp {
+
+/*
+ * Which outputs a two dimensional filter produces along each side:
+ *
+ *     Valid  only where the kernel lies inside the matrix
+ *     Same   ceil(size / stride) outputs, the matrix padded with zeros as
+ *            evenly as possible (the odd entry of padding after it)
+ *     Full   everywhere the kernel overlaps the matrix
+ */
+enum class Padding : std::uint8_t {
+    Valid,
+    Same,
+    Full,
+};
+
+namespace detail {
+
+// Strided kernels with at most this many taps run the direct path until the
+// crossover is tuned. At stride 1 the direct path won at every size tried,
+// up to 129x129 taps, so im2col is only considered for strided filters.
+constexpr std::size_t DIRECT_CONVOLUTION_TAPS{64 * 64};
+
+// Widest kernel row the direct path unrolls at compile time
+constexpr std::size_t UNROLLED_KERNEL_WIDTH{8};
+
+// Entries of scratch one task aims to work in
+constexpr std::size_t CONVOLUTION_BLOCK{1 << 16};
+
+// Output columns per im2col tile
+constexpr std::size_t CONVOLUTION_STRIP{256};
+
+template <class T>
+using ConvolutionBuffer = std::vector<T, AlignedAllocator<T>>;
+
+struct FilterExtent {
+    std::size_t outputs;
+    // Zero entries before the first one of the matrix
+    std::size_t before;
+};
+
+struct FilterShape {
+    FilterExtent rows;
+    FilterExtent columns;
+};
+
+inline std::optional<FilterExtent> FilterExtentFor(
+    std::size_t size, std::size_t kernel, Padding padding,
+    std::size_t stride) noexcept {
+    if (padding == Padding::Valid) {
+        if (size < kernel) {
+            return std::nullopt;
+        }
+        return FilterExtent{((size - kernel) / stride) + 1, 0};
+    } else if (padding == Padding::Same) {
+        const std::size_t outputs{(size + stride - 1) / stride};
+        const std::size_t reach{((outputs - 1) * stride) + kernel};
+        return FilterExtent{outputs, reach > size ? (reach - size) / 2 : 0};
+    } else {
+        return FilterExtent{((size + kernel - 2) / stride) + 1, kernel - 1};
+    }
+}
+
+/**
+ * @return std::nullopt if either operand is empty, stride is 0, or a Valid
+ *         kernel is larger than the matrix
+ */
+inline std::optional<FilterShape> FilterShapeFor(
+    std::size_t height, std::size_t width, std::size_t kernel_height,
+    std::size_t kernel_width, Padding padding, std::size_t stride) noexcept {
+    if (height == 0 || width == 0 || kernel_height == 0 ||
+        kernel_width == 0 || stride == 0) {
+        return std::nullopt;
+    }
+    const std::optional<FilterExtent> rows{
+        FilterExtentFor(height, kernel_height, padding, stride)};
+    const std::optional<FilterExtent> columns{
+        FilterExtentFor(width, kernel_width, padding, stride)};
+    if (!rows.has_value() || !columns.has_value()) {
+        return std::nullopt;
+    }
+    return FilterShape{rows.value(), columns.value()};
+}
+
+/**
+ * @brief Copies the rows x columns window of source whose corner sits at
+ *        (row, column), which may lie outside it, reading zeros there
+ */
+template <class T>
+void PaddedWindow(StridedMatrix<const T> source, std::size_t height,
+                  std::size_t width, std::ptrdiff_t row, std::ptrdiff_t column,
+                  std::size_t rows, std::size_t columns, T *window) noexcept {
+    const auto clamp = [](std::ptrdiff_t value, std::size_t limit) {
+        return static_cast<std::size_t>(
+            std::clamp<std::ptrdiff_t>(value, 0,
+                                       static_cast<std::ptrdiff_t>(limit)));
+    };
+    // Window columns [first, last) fall inside the matrix
+    const std::size_t first{clamp(-column, columns)};
+    const std::size_t last{
+        clamp(static_cast<std::ptrdiff_t>(width) - column, columns)};
+    for (std::size_t r{0}; r < rows; r++) {
+        T *destination{window + (r * columns)};
+        const std::ptrdiff_t source_row{row + static_cast<std::ptrdiff_t>(r)};
+        if (source_row < 0 ||
+            source_row >= static_cast<std::ptrdiff_t>(height) ||
+            first >= last) {
+            std::fill(destination, destination + columns, T(0));
+            continue;
+        }
+        std::fill(destination, destination + first, T(0));
+        const T *line{&source(static_cast<std::size_t>(source_row),
+                              static_cast<std::size_t>(column) + first)};
+        for (std::size_t c{first}; c < last; c++) {
+            destination[c] = line[(c - first) * source.column_stride];
+        }
+        std::fill(destination + last, destination + columns, T(0));
+    }
+}
+
+// output[j] += sum over v of weights[v] * source[j * stride + v]
+template <std::size_t Width, class T>
+PPP_ALWAYS_INLINE inline void CorrelateLine(const T *source, const T *weights,
+                                            std::size_t stride,
+                                            std::size_t count,
+                                            T *output) noexcept {
+    if (stride == 1) {
+        for (std::size_t j{0}; j < count; j++) {
+            T sum{output[j]};
+            PPP_UNROLL(16)
+            for (std::size_t v{0}; v < Width; v++) {
+                sum += weights[v] * source[j + v];
+            }
+            output[j] = sum;
+        }
+    } else {
+        for (std::size_t j{0}; j < count; j++) {
+            T sum{output[j]};
+            PPP_UNROLL(16)
+            for (std::size_t v{0}; v < Width; v++) {
+                sum += weights[v] * source[(j * stride) + v];
+            }
+            output[j] = sum;
+        }
+    }
+}
+
+// CorrelateLine for a width known at run time, UNROLLED_KERNEL_WIDTH taps
+// at a time and then the rest
+template <class T, std::size_t Width = UNROLLED_KERNEL_WIDTH>
+PPP_ALWAYS_INLINE inline void CorrelateLines(const T *source,
+                                             const T *weights,
+                                             std::size_t width,
+                                             std::size_t stride,
+                                             std::size_t count,
+                                             T *output) noexcept {
+    if constexpr (Width == UNROLLED_KERNEL_WIDTH) {
+        for (; width > Width; width -= Width) {
+            CorrelateLine<Width>(source, weights, stride, count, output);
+            source += Width;
+            weights += Width;
+        }
+    }
+    if constexpr (Width > 0) {
+        if (width == Width) {
+            CorrelateLine<Width>(source, weights, stride, count, output);
+        } else {
+            CorrelateLines<T, Width - 1>(source, weights, width, stride,
+                                         count, output);
+        }
+    }
+}
+
+/*
+ * The direct path keeps each output row in L1 and adds one kernel row to it
+ * at a time. Each pass takes a run of taps whose count is fixed at compile
+ * time, so the taps unroll into registers and the loop over outputs
+ * vectorizes.
+ */
+template <class T>
+void CorrelateDirect(const T *window, std::size_t window_width,
+                     const T *kernel, std::size_t kernel_height,
+                     std::size_t kernel_width, std::size_t stride,
+                     std::size_t rows, std::size_t columns, T *output) {
+    RunWidest([&]() PPP_ALWAYS_INLINE {
+        for (std::size_t i{0}; i < rows; i++) {
+            T *line{output + (i * columns)};
+            std::fill(line, line + columns, T(0));
+            for (std::size_t u{0}; u < kernel_height; u++) {
+                CorrelateLines(window + (((i * stride) + u) * window_width),
+                               kernel + (u * kernel_width), kernel_width,
+                               stride, columns, line);
+            }
+        }
+    });
+}
+
+/*
+ * The im2col path unrolls each input row into its kernel width patches,
+ * column (r, j) of the patch matrix holding input(r, j * stride + v) for v
+ * in [0, kernel_width). One GEMM with the kernel then correlates every
+ * input row with every kernel row at once,
+ *
+ *     Y(u, (r, j)) = sum over v of kernel(u, v) * input(r, j * stride + v),
+ *
+ * and output(i, j) = sum over u of Y(u, (i * stride + u, j)). Patches only
+ * repeat along the width, so the unrolled matrix is kernel_width rather
+ * than kernel_height * kernel_width times the input, and the GEMM stays a
+ * matrix product even for a single kernel.
+ */
+template <class T>
+void CorrelateIm2col(const T *window, std::size_t window_width,
+                     std::size_t window_rows, const T *kernel,
+                     std::size_t kernel_height, std::size_t kernel_width,
+                     std::size_t stride, std::size_t rows,
+                     std::size_t columns, T *output,
+                     std::size_t output_stride, ConvolutionBuffer<T> &patches,
+                     ConvolutionBuffer<T> &products) {
+    const std::size_t lines{window_rows * columns};
+    patches.resize(kernel_width * lines);
+    products.resize(kernel_height * lines);
+    RunWidest([&]() PPP_ALWAYS_INLINE {
+        for (std::size_t v{0}; v < kernel_width; v++) {
+            for (std::size_t r{0}; r < window_rows; r++) {
+                const T *source{window + (r * window_width) + v};
+                T *destination{patches.data() + (v * lines) + (r * columns)};
+                for (std::size_t j{0}; j < columns; j++) {
+                    destination[j] = source[j * stride];
+                }
+            }
+        }
+    });
+    Gemm<T>(kernel_height, lines, kernel_width, T(1),
+            {kernel, kernel_width, 1}, {patches.data(), lines, 1}, T(0),
+            {products.data(), lines, 1});
+    RunWidest([&]() PPP_ALWAYS_INLINE {
+        for (std::size_t i{0}; i < rows; i++) {
+            T *line{output + (i * output_stride)};
+            std::fill(line, line + columns, T(0));
+            for (std::size_t u{0}; u < kernel_height; u++) {
+                const T *source{products.data() + (u * lines) +
+                                (((i * stride) + u) * columns)};
+                for (std::size_t j{0}; j < columns; j++) {
+                    line[j] += source[j];
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Cross-correlation of a height x width source with a row-major
+ *        kernel, written row-major to output, blocks of output rows spread
+ *        over up to threads threads
+ *
+ * Kernels of at most direct_taps taps run the direct path and larger ones
+ * the im2col path.
+ */
+template <class T>
+void Correlate2D(StridedMatrix<const T> source, std::size_t height,
+                 std::size_t width, const T *kernel, std::size_t kernel_height,
+                 std::size_t kernel_width, const FilterShape &shape,
+                 std::size_t stride, T *output, std::size_t threads,
+                 std::size_t direct_taps) {
+    const std::size_t output_rows{shape.rows.outputs};
+    const std::size_t output_columns{shape.columns.outputs};
+    const bool direct{kernel_height * kernel_width <= direct_taps};
+
+    // Each block rereads kernel_height - 1 rows of the one before it, so
+    // blocks are kept several kernels tall
+    const std::size_t tile_columns{
+        direct ? output_columns : std::min(output_columns, CONVOLUTION_STRIP)};
+    const std::size_t row_cost{
+        std::max<std::size_t>(1, tile_columns * stride *
+                                     (direct ? 1 : kernel_height +
+                                                       kernel_width))};
+    std::size_t block_rows{std::max(CONVOLUTION_BLOCK / row_cost,
+                                    4 * kernel_height)};
+    block_rows = std::min(block_rows,
+                          std::max<std::size_t>(
+                              1, (output_rows + threads - 1) / threads));
+    const std::size_t blocks{(output_rows + block_rows - 1) / block_rows};
+
+    ParallelFor(blocks, std::min(threads, blocks), [&](std::size_t block) {
+        const std::size_t first{block * block_rows};
+        const std::size_t rows{std::min(block_rows, output_rows - first)};
+        const std::size_t window_rows{((rows - 1) * stride) + kernel_height};
+        const std::ptrdiff_t top{
+            static_cast<std::ptrdiff_t>(first * stride) -
+            static_cast<std::ptrdiff_t>(shape.rows.before)};
+        ConvolutionBuffer<T> window{};
+        if (direct) {
+            const std::size_t window_width{
+                ((output_columns - 1) * stride) + kernel_width};
+            window.resize(window_rows * window_width);
+            PaddedWindow(source, height, width, top,
+                         -static_cast<std::ptrdiff_t>(shape.columns.before),
+                         window_rows, window_width, window.data());
+            CorrelateDirect(window.data(), window_width, kernel,
+                            kernel_height, kernel_width, stride, rows,
+                            output_columns, output + (first * output_columns));
+            return;
+        }
+        ConvolutionBuffer<T> patches{};
+        ConvolutionBuffer<T> products{};
+        for (std::size_t column{0}; column < output_columns;
+             column += CONVOLUTION_STRIP) {
+            const std::size_t columns{
+                std::min(CONVOLUTION_STRIP, output_columns - column)};
+            const std::size_t window_width{((columns - 1) * stride) +
+                                           kernel_width};
+            window.resize(window_rows * window_width);
+            PaddedWindow(source, height, width, top,
+                         static_cast<std::ptrdiff_t>(column * stride) -
+                             static_cast<std::ptrdiff_t>(shape.columns.before),
+                         window_rows, window_width, window.data());
+            CorrelateIm2col(window.data(), window_width, window_rows, kernel,
+                            kernel_height, kernel_width, stride, rows, columns,
+                            output + (first * output_columns) + column,
+                            output_columns, patches, products);
+        }
+    });
+}
+
+/*
+ * The crossover is the tap count of the largest square stride 2 kernel, timed
+ * over a float image, past which im2col beat the direct path by at least
+ * 10% at every candidate. Kernels smaller than the first candidate are never
+ * timed and stay direct; if the direct path wins at the last candidate it is
+ * kept for every size.
+ */
+inline TunedValues TuneConvolution() {
+    constexpr std::size_t size{256};
+    constexpr std::size_t stride{2};
+    constexpr std::array<std::size_t, 7> edges{3, 5, 9, 17, 33, 65, 97};
+    std::vector<float, AlignedAllocator<float>> image(size * size);
+    std::vector<float, AlignedAllocator<float>> output(size * size);
+    for (std::size_t entry{0}; entry < image.size(); entry++) {
+        image[entry] = static_cast<float>(entry % 17);
+    }
+    std::size_t taps{std::numeric_limits<std::size_t>::max()};
+    std::size_t previous{(edges[0] - 1) * (edges[0] - 1)};
+    for (const std::size_t edge : edges) {
+        const std::vector<float> kernel(edge * edge, 1.0f);
+        const FilterShape shape{
+            FilterShapeFor(size, size, edge, edge, Padding::Same, stride)
+                .value()};
+        const auto run = [&](std::size_t direct_taps) {
+            Correlate2D<float>({image.data(), size, 1}, size, size,
+                               kernel.data(), edge, edge, shape, stride,
+                               output.data(), 1, direct_taps);
+        };
+        // Warm both paths up first; im2col grows the GEMM workspaces
+        run(std::numeric_limits<std::size_t>::max());
+        run(0);
+        const double direct{
+            BestTime([&] { run(std::numeric_limits<std::size_t>::max()); })};
+        const double im2col{BestTime([&] { run(0); })};
+        if (im2col > 0.9 * direct) {
+            // A near tie, or a later direct win, keeps the direct path
+            taps = std::numeric_limits<std::size_t>::max();
+        } else if (taps == std::numeric_limits<std::size_t>::max()) {
+            taps = previous;
+        }
+        previous = edge * edge;
+    }
+    return {taps, 0, 0};
+}
+
+// Tuned crossover, else DIRECT_CONVOLUTION_TAPS
+inline std::size_t DirectConvolutionTaps() {
+    return TunedValuesOr(TunedKernel::Convolution,
+                         {DIRECT_CONVOLUTION_TAPS, 0, 0},
+                         &TuneConvolution)[0];
+}
+
+// Crossover for a filter with this stride; unit strides always run direct
+inline std::size_t DirectConvolutionTaps(std::size_t stride) {
+    return stride == 1 ? std::numeric_limits<std::size_t>::max()
+                       : DirectConvolutionTaps();
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_CONVOLUTION_HPP_
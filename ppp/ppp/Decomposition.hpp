@@ -0,0 +1,499 @@
+/*
+ *  Decomposition.hpp
+ *  Blocked matrix factorization kernels used by ppp::Matrix
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_DECOMPOSITION_HPP_
+#define PPP_PPP_DECOMPOSITION_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+#include "Triangular.hpp"
+
+namespace ppp {
+namespace detail {
+
+// Columns factored per panel. Wide enough that the trailing update runs
+// near GEMM speed, narrow enough that the panel stays in L2.
+constexpr std::size_t LU_BLOCK{128};
+
+// Narrowest panel split by LuRecursive before falling back to LuPanel
+constexpr std::size_t LU_LEAF{16};
+
+// Columns per block for Cholesky and per block reflector for QR
+constexpr std::size_t CHOLESKY_BLOCK{128};
+constexpr std::size_t QR_BLOCK{64};
+
+// Jacobi SVD sweeps before giving up on convergence, which quadratic
+// convergence makes far more than enough
+constexpr std::size_t JACOBI_SWEEPS{60};
+
+template <class T>
+void SwapRows(std::size_t width, StridedMatrix<T> a, std::size_t first,
+              std::size_t second) noexcept {
+    if (a.column_stride == 1) {
+        std::swap_ranges(&a(first, 0), &a(first, 0) + width, &a(second, 0));
+    } else {
+        for (std::size_t column{0}; column < width; column++) {
+            std::swap(a(first, column), a(second, column));
+        }
+    }
+}
+
+/**
+ * @brief Unblocked LU with partial pivoting of the columns [begin, end) of an
+ *        n x n matrix, swapping whole rows as it goes
+ *
+ * @return false if any pivot in the panel was exactly zero
+ */
+template <class T>
+bool LuPanel(std::size_t n, std::size_t begin, std::size_t end,
+             StridedMatrix<T> a, std::size_t *pivots) noexcept {
+    bool nonsingular{true};
+    for (std::size_t j{begin}; j < end; j++) {
+        std::size_t pivot{j};
+        auto largest{std::abs(a(j, j))};
+        for (std::size_t row{j + 1}; row < n; row++) {
+            const auto magnitude{std::abs(a(row, j))};
+            if (magnitude > largest) {
+                largest = magnitude;
+                pivot = row;
+            }
+        }
+
+        pivots[j] = pivot;
+        if (pivot != j) {
+            SwapRows(n, a, j, pivot);
+        }
+
+        const T diagonal{a(j, j)};
+        if (diagonal == T(0)) {
+            nonsingular = false;
+            continue;
+        }
+
+        for (std::size_t row{j + 1}; row < n; row++) {
+            const T multiplier{a(row, j) / diagonal};
+            a(row, j) = multiplier;
+            for (std::size_t column{j + 1}; column < end; column++) {
+                a(row, column) -= multiplier * a(j, column);
+            }
+        }
+    }
+    return nonsingular;
+}
+
+/**
+ * @brief Recursive panel factorization: factors the left half, updates the
+ *        right half with a triangular solve and a GEMM, then factors it
+ *
+ * Moves most of the panel's work out of the rank-1 updates in LuPanel and
+ * into GEMM, which matters because the panel is tall and strided.
+ */
+template <class T>
+bool LuRecursive(std::size_t n, std::size_t begin, std::size_t end,
+                 StridedMatrix<T> a, std::size_t *pivots,
+                 std::size_t threads) noexcept {
+    if (end - begin <= LU_LEAF) {
+        return LuPanel(n, begin, end, a, pivots);
+    }
+
+    const std::size_t middle{begin + ((end - begin) / 2)};
+    bool nonsingular{LuRecursive(n, begin, middle, a, pivots, threads)};
+    Trsm<T>(middle - begin, end - middle, Triangle::Lower, Diagonal::Unit,
+            {&a(begin, begin), a.row_stride, a.column_stride},
+            {&a(begin, middle), a.row_stride, a.column_stride}, 1);
+    ParallelGemm<T>(n - middle, end - middle, middle - begin, T(-1),
+                    {&a(middle, begin), a.row_stride, a.column_stride},
+                    {&a(begin, middle), a.row_stride, a.column_stride}, T(1),
+                    {&a(middle, middle), a.row_stride, a.column_stride},
+                    threads);
+    return LuRecursive(n, middle, end, a, pivots, threads) && nonsingular;
+}
+
+/**
+ * @brief Right looking blocked LU with partial pivoting, in place
+ *
+ * On return a holds L below the diagonal (unit diagonal implied) and U on and
+ * above it, and row i was swapped with row pivots[i] at step i (LAPACK
+ * getrf convention). Each step factors an LU_BLOCK wide panel, applies L11^-1
+ * to the block row to its right, then updates the trailing matrix with one
+ * parallel GEMM: A22 -= L21 * U12.
+ *
+ * @return false if the matrix is singular; the factorization is still
+ *         completed so the determinant can be read off as zero
+ */
+template <class T>
+bool LuFactor(std::size_t n, StridedMatrix<T> a, std::size_t *pivots,
+              std::size_t threads) noexcept {
+    bool nonsingular{true};
+    for (std::size_t begin{0}; begin < n; begin += LU_BLOCK) {
+        const std::size_t end{std::min(n, begin + LU_BLOCK)};
+        nonsingular = LuRecursive(n, begin, end, a, pivots, threads) &&
+                      nonsingular;
+        if (end == n) {
+            break;
+        }
+
+        const std::size_t trailing{n - end};
+        Trsm<T>(end - begin, trailing, Triangle::Lower, Diagonal::Unit,
+                {&a(begin, begin), a.row_stride, a.column_stride},
+                {&a(begin, end), a.row_stride, a.column_stride}, threads);
+        ParallelGemm<T>(trailing, trailing, end - begin, T(-1),
+                        {&a(end, begin), a.row_stride, a.column_stride},
+                        {&a(begin, end), a.row_stride, a.column_stride}, T(1),
+                        {&a(end, end), a.row_stride, a.column_stride},
+                        threads);
+    }
+    return nonsingular;
+}
+
+/**
+ * @brief Blocked right looking Cholesky factorization A = L * L^T, in place
+ *
+ * Only the lower triangle of a is read. On return it holds L; the strict
+ * upper triangle is scratch. Each step factors a CHOLESKY_BLOCK wide diagonal
+ * block, solves for the block column below it and updates the lower half of
+ * the trailing matrix one block column at a time with GEMM.
+ *
+ * @return false if the matrix is not positive definite
+ */
+template <class T>
+bool CholeskyFactor(std::size_t n, StridedMatrix<T> a,
+                    std::size_t threads) noexcept {
+    for (std::size_t begin{0}; begin < n; begin += CHOLESKY_BLOCK) {
+        const std::size_t end{std::min(n, begin + CHOLESKY_BLOCK)};
+
+        // Left looking inside the block, so the sums run along rows
+        for (std::size_t j{begin}; j < end; j++) {
+            T diagonal{a(j, j)};
+            for (std::size_t p{begin}; p < j; p++) {
+                diagonal -= a(j, p) * a(j, p);
+            }
+            if (!(diagonal > T(0))) {
+                return false;
+            }
+            diagonal = std::sqrt(diagonal);
+            a(j, j) = diagonal;
+
+            for (std::size_t row{j + 1}; row < end; row++) {
+                T sum{a(row, j)};
+                for (std::size_t p{begin}; p < j; p++) {
+                    sum -= a(row, p) * a(j, p);
+                }
+                a(row, j) = sum / diagonal;
+            }
+        }
+
+        if (end == n) {
+            break;
+        }
+
+        // L21 * L11^T = A21, solved as L11 * L21^T = A21^T in place
+        const StridedMatrix<T> panel{&a(end, begin), a.row_stride,
+                                     a.column_stride};
+        Trsm<T>(end - begin, n - end, Triangle::Lower, Diagonal::NonUnit,
+                {&a(begin, begin), a.row_stride, a.column_stride},
+                {panel.data, panel.column_stride, panel.row_stride}, threads);
+
+        // A22 -= L21 * L21^T, lower block trapezoid only
+        for (std::size_t column{end}; column < n; column += CHOLESKY_BLOCK) {
+            const std::size_t last{std::min(n, column + CHOLESKY_BLOCK)};
+            ParallelGemm<T>(n - column, last - column, end - begin, T(-1),
+                            {&a(column, begin), a.row_stride, a.column_stride},
+                            {&a(column, begin), a.column_stride, a.row_stride},
+                            T(1),
+                            {&a(column, column), a.row_stride, a.column_stride},
+                            threads);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Unblocked Householder QR of the columns [begin, end) of an m x n
+ *        matrix, applied only within those columns
+ *
+ * Reflector j is H = I - tau[j] * v * v^T, with v[j] = 1 implied and the rest
+ * of v stored below the diagonal (LAPACK geqr2 convention).
+ */
+template <class T>
+void HouseholderPanel(std::size_t m, std::size_t begin, std::size_t end,
+                      StridedMatrix<T> a, T *tau) noexcept {
+    T work[QR_BLOCK];
+    for (std::size_t j{begin}; j < end && j < m; j++) {
+        const T alpha{a(j, j)};
+        T sigma{0};
+        for (std::size_t row{j + 1}; row < m; row++) {
+            sigma += a(row, j) * a(row, j);
+        }
+        if (sigma == T(0)) {
+            tau[j] = T(0);
+            continue;
+        }
+
+        const T norm{std::sqrt((alpha * alpha) + sigma)};
+        const T beta{alpha > T(0) ? -norm : norm};
+        tau[j] = (beta - alpha) / beta;
+        const T scale{T(1) / (alpha - beta)};
+        for (std::size_t row{j + 1}; row < m; row++) {
+            a(row, j) *= scale;
+        }
+        a(j, j) = beta;
+
+        // work = tau * v^T * A[j:m, j+1:end], then A -= v * work
+        const std::size_t width{end - j - 1};
+        for (std::size_t column{0}; column < width; column++) {
+            work[column] = a(j, j + 1 + column);
+        }
+        for (std::size_t row{j + 1}; row < m; row++) {
+            const T v{a(row, j)};
+            for (std::size_t column{0}; column < width; column++) {
+                work[column] += v * a(row, j + 1 + column);
+            }
+        }
+        for (std::size_t column{0}; column < width; column++) {
+            work[column] *= tau[j];
+            a(j, j + 1 + column) -= work[column];
+        }
+        for (std::size_t row{j + 1}; row < m; row++) {
+            const T v{a(row, j)};
+            for (std::size_t column{0}; column < width; column++) {
+                a(row, j + 1 + column) -= v * work[column];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Block reflector for reflectors [begin, begin + count) of a compact
+ *        QR: Q_block = I - V * T * V^T (LAPACK larft, forward columnwise)
+ *
+ * V is written out densely as a (m - begin) x count row-major matrix with its
+ * implied unit diagonal and zero upper triangle, and T as count x count.
+ */
+template <class T>
+void BuildBlockReflector(std::size_t m, std::size_t begin, std::size_t count,
+                         StridedMatrix<const T> qr, const T *tau, T *v,
+                         T *t) noexcept {
+    const std::size_t rows{m - begin};
+    for (std::size_t row{0}; row < rows; row++) {
+        for (std::size_t column{0}; column < count; column++) {
+            v[(row * count) + column] =
+                row < column    ? T(0)
+                : row == column ? T(1)
+                                : qr(begin + row, begin + column);
+        }
+    }
+
+    std::fill(t, t + (count * count), T(0));
+    T projection[QR_BLOCK];
+    for (std::size_t i{0}; i < count; i++) {
+        // projection = V[:, 0:i]^T * v_i, which is zero above row i
+        std::fill(projection, projection + i, T(0));
+        for (std::size_t row{i}; row < rows; row++) {
+            const T vi{v[(row * count) + i]};
+            for (std::size_t column{0}; column < i; column++) {
+                projection[column] += v[(row * count) + column] * vi;
+            }
+        }
+        for (std::size_t row{0}; row < i; row++) {
+            T sum{0};
+            for (std::size_t inner{row}; inner < i; inner++) {
+                sum += t[(row * count) + inner] * projection[inner];
+            }
+            t[(row * count) + i] = -tau[begin + i] * sum;
+        }
+        t[(i * count) + i] = tau[begin + i];
+    }
+}
+
+/**
+ * @brief c = Q_block^T * c = (I - V * T^T * V^T) * c, or c = Q_block * c =
+ *        (I - V * T * V^T) * c when not transposed, for the rows - begin by
+ *        columns matrix c, with two GEMMs against V
+ */
+template <class T>
+void ApplyBlockReflector(std::size_t rows, std::size_t count, const T *v,
+                         const T *t, bool transposed, std::size_t columns,
+                         StridedMatrix<T> c, std::size_t threads) noexcept {
+    std::vector<T, AlignedAllocator<T>> work(count * columns);
+    std::vector<T, AlignedAllocator<T>> scaled(count * columns);
+    ParallelGemm<T>(count, columns, rows, T(1), {v, 1, count},
+                    {c.data, c.row_stride, c.column_stride}, T(0),
+                    {work.data(), columns, 1}, threads);
+    Gemm<T>(count, columns, count, T(1),
+            transposed ? StridedMatrix<const T>{t, 1, count}
+                       : StridedMatrix<const T>{t, count, 1},
+            {work.data(), columns, 1}, T(0), {scaled.data(), columns, 1});
+    ParallelGemm<T>(rows, columns, count, T(-1), {v, count, 1},
+                    {scaled.data(), columns, 1}, T(1), c, threads);
+}
+
+/**
+ * @brief Blocked Householder QR of an m x n matrix (m >= n), in place
+ *
+ * On return R is on and above the diagonal and the reflectors are below it,
+ * with their scalars in tau[0, n). Each QR_BLOCK wide panel is factored
+ * unblocked and then applied to the rest of the matrix as one block
+ * reflector, so the bulk of the work is GEMM.
+ */
+template <class T>
+void QrFactor(std::size_t m, std::size_t n, StridedMatrix<T> a, T *tau,
+              std::size_t threads) noexcept {
+    std::vector<T, AlignedAllocator<T>> v(m * QR_BLOCK);
+    std::vector<T, AlignedAllocator<T>> t(QR_BLOCK * QR_BLOCK);
+    for (std::size_t begin{0}; begin < n; begin += QR_BLOCK) {
+        const std::size_t end{std::min(n, begin + QR_BLOCK)};
+        HouseholderPanel(m, begin, end, a, tau);
+        if (end == n) {
+            break;
+        }
+
+        BuildBlockReflector<T>(m, begin, end - begin,
+                               {a.data, a.row_stride, a.column_stride}, tau,
+                               v.data(), t.data());
+        ApplyBlockReflector<T>(
+            m - begin, end - begin, v.data(), t.data(), true, n - end,
+            {&a(begin, end), a.row_stride, a.column_stride}, threads);
+    }
+}
+
+/**
+ * @brief c = Q^T * c for the m x columns matrix c, where Q comes from
+ *        QrFactor of an m x n matrix
+ */
+template <class T>
+void QrApplyTransposed(std::size_t m, std::size_t n, StridedMatrix<const T> qr,
+                       const T *tau, std::size_t columns, StridedMatrix<T> c,
+                       std::size_t threads) noexcept {
+    std::vector<T, AlignedAllocator<T>> v(m * QR_BLOCK);
+    std::vector<T, AlignedAllocator<T>> t(QR_BLOCK * QR_BLOCK);
+    for (std::size_t begin{0}; begin < n; begin += QR_BLOCK) {
+        const std::size_t end{std::min(n, begin + QR_BLOCK)};
+        BuildBlockReflector<T>(m, begin, end - begin, qr, tau, v.data(),
+                               t.data());
+        ApplyBlockReflector<T>(
+            m - begin, end - begin, v.data(), t.data(), true, columns,
+            {&c(begin, 0), c.row_stride, c.column_stride}, threads);
+    }
+}
+
+/**
+ * @brief Forms the m x n orthonormal Q of QrFactor explicitly, by applying
+ *        the block reflectors last to first to the leading columns of I
+ *
+ * Block b only mixes rows and columns from its first reflector on, since
+ * the columns before it are still unit vectors there (LAPACK orgqr).
+ */
+template <class T>
+void QrFormQ(std::size_t m, std::size_t n, StridedMatrix<const T> qr,
+             const T *tau, StridedMatrix<T> q, std::size_t threads) noexcept {
+    for (std::size_t row{0}; row < m; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            q(row, column) = row == column ? T(1) : T(0);
+        }
+    }
+    std::vector<T, AlignedAllocator<T>> v(m * QR_BLOCK);
+    std::vector<T, AlignedAllocator<T>> t(QR_BLOCK * QR_BLOCK);
+    for (std::size_t block{(n + QR_BLOCK - 1) / QR_BLOCK}; block > 0;
+         block--) {
+        const std::size_t begin{(block - 1) * QR_BLOCK};
+        const std::size_t end{std::min(n, begin + QR_BLOCK)};
+        BuildBlockReflector<T>(m, begin, end - begin, qr, tau, v.data(),
+                               t.data());
+        ApplyBlockReflector<T>(
+            m - begin, end - begin, v.data(), t.data(), false, n - begin,
+            {&q(begin, begin), q.row_stride, q.column_stride}, threads);
+    }
+}
+
+/**
+ * @brief One-sided (Hestenes) Jacobi SVD of a rows x columns matrix a with
+ *        rows >= columns, stored column by column, in place
+ *
+ * Pairs of columns of a are rotated until all are orthogonal, with the
+ * rotations accumulated in the columns x columns matrix v (also column by
+ * column), so that on return a = U * diag(sigma) and the input was
+ * U * diag(sigma) * V^T. Singular values come out unsorted.
+ */
+template <class T>
+void JacobiSvd(std::size_t rows, std::size_t columns, T *a, T *v) noexcept {
+    for (std::size_t i{0}; i < columns * columns; i++) {
+        v[i] = (i % (columns + 1) == 0) ? T(1) : T(0);
+    }
+    const T tolerance{std::numeric_limits<T>::epsilon() *
+                      std::sqrt(T(rows))};
+    for (std::size_t sweep{0}; sweep < JACOBI_SWEEPS; sweep++) {
+        bool rotated{false};
+        for (std::size_t p{0}; p + 1 < columns; p++) {
+            for (std::size_t q{p + 1}; q < columns; q++) {
+                T *x{a + (p * rows)};
+                T *y{a + (q * rows)};
+                T alpha{0};
+                T beta{0};
+                T gamma{0};
+                for (std::size_t row{0}; row < rows; row++) {
+                    alpha += x[row] * x[row];
+                    beta += y[row] * y[row];
+                    gamma += x[row] * y[row];
+                }
+                if (std::abs(gamma) <= tolerance * std::sqrt(alpha * beta)) {
+                    continue;
+                }
+                rotated = true;
+
+                // The rotation that zeroes gamma, taking the smaller angle
+                const T zeta{(beta - alpha) / (T(2) * gamma)};
+                const T tangent{
+                    (zeta >= T(0) ? T(1) : T(-1)) /
+                    (std::abs(zeta) + std::sqrt(T(1) + (zeta * zeta)))};
+                const T cosine{T(1) / std::sqrt(T(1) + (tangent * tangent))};
+                const T sine{cosine * tangent};
+                for (std::size_t row{0}; row < rows; row++) {
+                    const T first{x[row]};
+                    x[row] = (cosine * first) - (sine * y[row]);
+                    y[row] = (sine * first) + (cosine * y[row]);
+                }
+                T *vx{v + (p * columns)};
+                T *vy{v + (q * columns)};
+                for (std::size_t row{0}; row < columns; row++) {
+                    const T first{vx[row]};
+                    vx[row] = (cosine * first) - (sine * vy[row]);
+                    vy[row] = (sine * first) + (cosine * vy[row]);
+                }
+            }
+        }
+        if (!rotated) {
+            break;
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_DECOMPOSITION_HPP_
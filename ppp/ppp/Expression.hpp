@@ -0,0 +1,399 @@
+/*
+ *  Expression.hpp
+ *  Lazily evaluated element-wise arithmetic on ppp::Matrix
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_EXPRESSION_HPP_
+#define PPP_PPP_EXPRESSION_HPP_
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Column.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+/*
+ * ppp::Lazy(a) + b - c * 2.0 builds a tree of lightweight nodes instead of
+ * three intermediate matrices. Nothing is computed until Evaluate(), which
+ * allocates the result once and fills it in a single (parallel) sweep.
+ *
+ * Nodes refer to their matrices by pointer, so every operand has to outlive
+ * the expression. Shapes broadcast like the eager operators: a row, column
+ * or 1x1 operand is stretched over the other side. Any other mismatch in
+ * the tree makes Evaluate() return std::nullopt.
+ */
+
+template <class E>
+concept MatrixExpression = requires(const E &expression, std::size_t index,
+                                    Layout layout) {
+    typename E::value_type;
+    { expression.Valid() } -> std::same_as<bool>;
+    { expression.Height() } -> std::same_as<std::size_t>;
+    { expression.Width() } -> std::same_as<std::size_t>;
+    { expression.PreferredLayout() } -> std::same_as<Layout>;
+    { expression.Uniform(layout) } -> std::same_as<bool>;
+    expression.Linear(index);
+    expression(index, index);
+};
+
+template <MatrixExpression E>
+std::optional<Matrix<typename E::value_type>> Evaluate(const E &expression);
+
+template <class Derived>
+class ExpressionBase {
+ public:
+    auto Evaluate() const {
+        return ppp::Evaluate(static_cast<const Derived &>(*this));
+    }
+};
+
+template <BasicEntry T>
+class MatrixTerminal : public ExpressionBase<MatrixTerminal<T>> {
+ public:
+    using value_type = T;
+
+    explicit MatrixTerminal(const Matrix<T> &matrix) noexcept
+        : data_{matrix.Data()},
+          height_{matrix.Height()},
+          width_{matrix.Width()},
+          layout_{matrix.GetLayout()},
+          row_stride_{matrix.RowStride()},
+          column_stride_{matrix.ColumnStride()},
+          packed_{true} {}
+
+    // A view is only swept linearly when it happens to be a packed buffer
+    explicit MatrixTerminal(MatrixView<const T> view) noexcept
+        : data_{view.Data()},
+          height_{view.Height()},
+          width_{view.Width()},
+          layout_{view.ColumnStride() == 1 ? Layout::RowMajor
+                                           : Layout::ColumnMajor},
+          row_stride_{view.RowStride()},
+          column_stride_{view.ColumnStride()},
+          packed_{layout_ == Layout::RowMajor
+                      ? height_ <= 1 || row_stride_ == width_
+                      : (height_ <= 1 || row_stride_ == 1) &&
+                            (width_ <= 1 || column_stride_ == height_)} {}
+
+    constexpr bool Valid() const noexcept { return true; }
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr Layout PreferredLayout() const noexcept { return layout_; }
+    constexpr bool Uniform(Layout layout) const noexcept {
+        return packed_ && layout == layout_;
+    }
+
+    constexpr T Linear(std::size_t index) const noexcept {
+        return data_[index];
+    }
+    constexpr T operator()(std::size_t row,
+                           std::size_t column) const noexcept {
+        return data_[(row * row_stride_) + (column * column_stride_)];
+    }
+
+ private:
+    const T *data_;
+    std::size_t height_;
+    std::size_t width_;
+    Layout layout_;
+    std::size_t row_stride_;
+    std::size_t column_stride_;
+    bool packed_;
+};  // class MatrixTerminal
+
+template <MatrixExpression L, MatrixExpression R, class Op>
+class BinaryExpression : public ExpressionBase<BinaryExpression<L, R, Op>> {
+ public:
+    using value_type = typename L::value_type;
+    static_assert(std::same_as<value_type, typename R::value_type>,
+                  "Both sides of an expression must hold the same type");
+
+    // A side with one row or column has its index masked to 0, which
+    // stretches it over the other side like the eager operators do
+    BinaryExpression(const L &lhs, const R &rhs, Op op) noexcept
+        : lhs_{lhs},
+          rhs_{rhs},
+          op_{op},
+          height_{std::max(lhs.Height(), rhs.Height())},
+          width_{std::max(lhs.Width(), rhs.Width())},
+          lhs_rows_{Mask(lhs.Height())},
+          lhs_columns_{Mask(lhs.Width())},
+          rhs_rows_{Mask(rhs.Height())},
+          rhs_columns_{Mask(rhs.Width())} {}
+
+    constexpr bool Valid() const noexcept {
+        const auto compatible{[](std::size_t left, std::size_t right) {
+            return left == right || left == 1 || right == 1;
+        }};
+        return lhs_.Valid() && rhs_.Valid() &&
+               (Matching() ||
+                (lhs_.Height() != 0 && rhs_.Height() != 0 &&
+                 compatible(lhs_.Height(), rhs_.Height()) &&
+                 compatible(lhs_.Width(), rhs_.Width())));
+    }
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr Layout PreferredLayout() const noexcept {
+        return lhs_.PreferredLayout();
+    }
+    constexpr bool Uniform(Layout layout) const noexcept {
+        return Matching() && lhs_.Uniform(layout) && rhs_.Uniform(layout);
+    }
+
+    constexpr value_type Linear(std::size_t index) const noexcept {
+        return op_(lhs_.Linear(index), rhs_.Linear(index));
+    }
+    constexpr value_type operator()(std::size_t row,
+                                    std::size_t column) const noexcept {
+        return op_(lhs_(row & lhs_rows_, column & lhs_columns_),
+                   rhs_(row & rhs_rows_, column & rhs_columns_));
+    }
+
+ private:
+    static constexpr std::size_t Mask(std::size_t extent) noexcept {
+        return extent == 1 ? 0 : ~std::size_t{0};
+    }
+
+    constexpr bool Matching() const noexcept {
+        return lhs_.Height() == rhs_.Height() && lhs_.Width() == rhs_.Width();
+    }
+
+    L lhs_;
+    R rhs_;
+    Op op_;
+    std::size_t height_;
+    std::size_t width_;
+    std::size_t lhs_rows_;
+    std::size_t lhs_columns_;
+    std::size_t rhs_rows_;
+    std::size_t rhs_columns_;
+};  // class BinaryExpression
+
+template <MatrixExpression E, class Op>
+class UnaryExpression : public ExpressionBase<UnaryExpression<E, Op>> {
+ public:
+    using value_type = typename E::value_type;
+
+    UnaryExpression(const E &inner, Op op) noexcept : inner_{inner}, op_{op} {}
+
+    constexpr bool Valid() const noexcept { return inner_.Valid(); }
+    constexpr std::size_t Height() const noexcept { return inner_.Height(); }
+    constexpr std::size_t Width() const noexcept { return inner_.Width(); }
+    constexpr Layout PreferredLayout() const noexcept {
+        return inner_.PreferredLayout();
+    }
+    constexpr bool Uniform(Layout layout) const noexcept {
+        return inner_.Uniform(layout);
+    }
+
+    constexpr value_type Linear(std::size_t index) const noexcept {
+        return op_(inner_.Linear(index));
+    }
+    constexpr value_type operator()(std::size_t row,
+                                    std::size_t column) const noexcept {
+        return op_(inner_(row, column));
+    }
+
+ private:
+    E inner_;
+    Op op_;
+};  // class UnaryExpression
+
+template <BasicEntry T>
+inline MatrixTerminal<T> Lazy(const Matrix<T> &matrix) noexcept {
+    return MatrixTerminal<T>{matrix};
+}
+
+template <class T>
+inline MatrixTerminal<std::remove_const_t<T>> Lazy(
+    MatrixView<T> view) noexcept {
+    return MatrixTerminal<std::remove_const_t<T>>{
+        MatrixView<const std::remove_const_t<T>>{view}};
+}
+
+namespace detail {
+
+template <class T>
+struct IsMatrix : std::false_type {};
+
+template <BasicEntry T>
+struct IsMatrix<Matrix<T>> : std::true_type {};
+
+template <class T>
+concept ExpressionOperand =
+    MatrixExpression<T> || IsMatrix<T>::value || IsMatrixView<T>::value;
+
+template <class T>
+constexpr auto AsExpression(const T &operand) noexcept {
+    if constexpr (MatrixExpression<T>) {
+        return operand;
+    } else {
+        return Lazy(operand);
+    }
+}
+
+// Only kicks in when at least one side is already lazy, so Matrix + Matrix
+// keeps its eager, optional returning overload
+template <class L, class R>
+concept LazyOperands = ExpressionOperand<L> && ExpressionOperand<R> &&
+                       (MatrixExpression<L> || MatrixExpression<R>);
+
+}  // namespace detail
+
+template <class L, class R>
+    requires detail::LazyOperands<L, R>
+inline auto operator+(const L &lhs, const R &rhs) noexcept {
+    auto left{detail::AsExpression(lhs)};
+    auto right{detail::AsExpression(rhs)};
+    using T = typename decltype(left)::value_type;
+    return BinaryExpression{left, right,
+                            [](const T &a, const T &b) { return a + b; }};
+}
+
+template <class L, class R>
+    requires detail::LazyOperands<L, R>
+inline auto operator-(const L &lhs, const R &rhs) noexcept {
+    auto left{detail::AsExpression(lhs)};
+    auto right{detail::AsExpression(rhs)};
+    using T = typename decltype(left)::value_type;
+    return BinaryExpression{left, right,
+                            [](const T &a, const T &b) { return a - b; }};
+}
+
+template <MatrixExpression E>
+inline auto operator-(const E &expression) noexcept {
+    using T = typename E::value_type;
+    return UnaryExpression{expression, [](const T &a) { return T(0) - a; }};
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator+(const E &expression, U scalar) noexcept {
+    using T = typename E::value_type;
+    const T value{static_cast<T>(scalar)};
+    return UnaryExpression{expression,
+                           [value](const T &a) { return a + value; }};
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator+(U scalar, const E &expression) noexcept {
+    return expression + scalar;
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator-(const E &expression, U scalar) noexcept {
+    using T = typename E::value_type;
+    const T value{static_cast<T>(scalar)};
+    return UnaryExpression{expression,
+                           [value](const T &a) { return a - value; }};
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator-(U scalar, const E &expression) noexcept {
+    using T = typename E::value_type;
+    const T value{static_cast<T>(scalar)};
+    return UnaryExpression{expression,
+                           [value](const T &a) { return value - a; }};
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator*(const E &expression, U scalar) noexcept {
+    using T = typename E::value_type;
+    const T value{static_cast<T>(scalar)};
+    return UnaryExpression{expression,
+                           [value](const T &a) { return a * value; }};
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator*(U scalar, const E &expression) noexcept {
+    return expression * scalar;
+}
+
+template <MatrixExpression E, SimpleNumber U>
+inline auto operator/(const E &expression, U scalar) noexcept {
+    using T = typename E::value_type;
+    const T value{static_cast<T>(scalar)};
+    return UnaryExpression{expression,
+                           [value](const T &a) { return a / value; }};
+}
+
+/**
+ * @brief Materializes an expression into a freshly allocated Matrix
+ *
+ * @return std::nullopt if any two operands in the tree cannot be broadcast
+ */
+template <MatrixExpression E>
+std::optional<Matrix<typename E::value_type>> Evaluate(const E &expression) {
+    using T = typename E::value_type;
+
+    if (!expression.Valid()) {
+        return std::nullopt;
+    } else if (expression.Height() == 0) {
+        return Matrix<T>::New();
+    }
+
+    const Layout layout{expression.PreferredLayout()};
+    std::optional<Matrix<T>> result{
+        Matrix<T>::New(expression.Height(), expression.Width(), layout)};
+    if (!result.has_value()) {
+        return std::nullopt;
+    }
+
+    Matrix<T> &output{result.value()};
+    T *destination{output.Data()};
+    const std::size_t size{output.Size()};
+
+    if (expression.Uniform(layout)) {
+        // Every operand is laid out like the result: one fused linear sweep
+        constexpr std::size_t chunk{1 << 14};
+        const std::size_t chunks{(size + chunk - 1) / chunk};
+        const std::size_t threads{size < PARALLEL_THRESHOLD ? 1
+                                                            : GetThreadCount()};
+        ParallelFor(chunks, threads, [&](std::size_t index) {
+            const std::size_t begin{index * chunk};
+            const std::size_t end{std::min(size, begin + chunk)};
+            for (std::size_t i{begin}; i < end; i++) {
+                destination[i] = expression.Linear(i);
+            }
+        });
+    } else {
+        const std::size_t row_stride{output.RowStride()};
+        const std::size_t column_stride{output.ColumnStride()};
+        const std::size_t threads{size < PARALLEL_THRESHOLD ? 1
+                                                            : GetThreadCount()};
+        ParallelFor(expression.Height(), threads, [&](std::size_t row) {
+            for (std::size_t column{0}; column < expression.Width();
+                 column++) {
+                destination[(row * row_stride) + (column * column_stride)] =
+                    expression(row, column);
+            }
+        });
+    }
+
+    return result;
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_EXPRESSION_HPP_
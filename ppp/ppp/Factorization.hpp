@@ -0,0 +1,349 @@
+/*
+ *  Factorization.hpp
+ *  Reusable LU, Cholesky and QR factorizations of ppp::Matrix
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_FACTORIZATION_HPP_
+#define PPP_PPP_FACTORIZATION_HPP_
+
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Column.hpp"
+#include "Decomposition.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+#include "Triangular.hpp"
+
+namespace ppp {
+
+/*
+ * Each factorization is computed once by New() and can then Solve() any
+ * number of right hand sides. Solve() takes a whole matrix of right hand
+ * sides at once; the triangular solves are blocked so that most of the work
+ * is GEMM, which makes one call with k columns much cheaper than k calls.
+ */
+
+namespace detail {
+
+// Copies any strided matrix into a freshly allocated row-major one, with the
+// rows optionally gathered through a permutation
+template <BasicEntry T>
+Matrix<T> RowMajorCopy(const Matrix<T> &source, std::size_t rows,
+                       const std::vector<std::size_t> *permutation) noexcept {
+    Matrix<T> copy{Matrix<T>::New(rows, source.Width()).value()};
+    const T *from{source.Data()};
+    T *to{copy.Data()};
+    for (std::size_t row{0}; row < rows; row++) {
+        const std::size_t source_row{
+            permutation == nullptr ? row : (*permutation)[row]};
+        for (std::size_t column{0}; column < source.Width(); column++) {
+            to[(row * source.Width()) + column] =
+                from[(source_row * source.RowStride()) +
+                     (column * source.ColumnStride())];
+        }
+    }
+    return copy;
+}
+
+template <BasicEntry T>
+StridedMatrix<T> Strided(Matrix<T> &matrix) noexcept {
+    return {matrix.Data(), matrix.RowStride(), matrix.ColumnStride()};
+}
+
+template <BasicEntry T>
+StridedMatrix<const T> Strided(const Matrix<T> &matrix) noexcept {
+    return {matrix.Data(), matrix.RowStride(), matrix.ColumnStride()};
+}
+
+}  // namespace detail
+
+/**
+ * @brief P * A = L * U with partial pivoting, for square A
+ */
+template <BasicEntry T>
+    requires(!std::is_integral_v<T>)
+class LUFactorization {
+ public:
+    static std::optional<LUFactorization<T>> New(
+        const Matrix<T> &matrix) noexcept {
+        return FactoryHelper(matrix.FactorLU());
+    }
+
+    // Factors the matrix in its own buffer
+    static std::optional<LUFactorization<T>> New(Matrix<T> &&matrix) noexcept {
+        return FactoryHelper(std::move(matrix).FactorLU());
+    }
+
+    constexpr std::size_t Size() const noexcept { return lu_.Height(); }
+    constexpr bool Singular() const noexcept { return singular_; }
+
+    // L strictly below the diagonal (unit diagonal implied), U on and above
+    const Matrix<T> &Factors() const noexcept { return lu_; }
+
+    // Row i of P * A is row Permutation()[i] of A
+    const std::vector<std::size_t> &Permutation() const noexcept {
+        return permutation_;
+    }
+
+    T Det() const noexcept {
+        T det{1};
+        for (std::size_t row{0}; row < Size(); row++) {
+            det *= lu_.Data()[(row * lu_.RowStride()) +
+                              (row * lu_.ColumnStride())];
+        }
+        return odd_permutation_ ? -det : det;
+    }
+
+    /**
+     * @brief Solves A * X = rhs for every column of rhs
+     *
+     * @return std::nullopt if rhs has the wrong height or A is singular
+     */
+    std::optional<Matrix<T>> Solve(const Matrix<T> &rhs) const noexcept {
+        if (singular_ || rhs.Height() != Size()) {
+            return std::nullopt;
+        }
+
+        Matrix<T> solution{
+            detail::RowMajorCopy(rhs, rhs.Height(), &permutation_)};
+        const std::size_t threads{GetThreadCount()};
+        detail::Trsm<T>(Size(), solution.Width(), Triangle::Lower,
+                        Diagonal::Unit, detail::Strided(lu_),
+                        detail::Strided(solution), threads);
+        detail::Trsm<T>(Size(), solution.Width(), Triangle::Upper,
+                        Diagonal::NonUnit, detail::Strided(lu_),
+                        detail::Strided(solution), threads);
+        return std::make_optional<Matrix<T>>(std::move(solution));
+    }
+
+ private:
+    LUFactorization(Matrix<T> &&lu,
+                    std::vector<std::size_t> &&permutation) noexcept
+        : lu_{std::move(lu)},
+          permutation_{std::move(permutation)},
+          singular_{false},
+          odd_permutation_{false} {
+        for (std::size_t row{0}; row < Size(); row++) {
+            singular_ = singular_ || lu_.At(row, row).value() == T(0);
+        }
+
+        // Parity of the permutation from its cycle decomposition
+        std::vector<bool> visited(permutation_.size(), false);
+        for (std::size_t start{0}; start < permutation_.size(); start++) {
+            std::size_t length{0};
+            for (std::size_t row{start}; !visited[row];
+                 row = permutation_[row]) {
+                visited[row] = true;
+                length++;
+            }
+            if (length != 0 && length % 2 == 0) {
+                odd_permutation_ = !odd_permutation_;
+            }
+        }
+    }
+
+    static std::optional<LUFactorization<T>> FactoryHelper(
+        std::optional<std::pair<Matrix<T>, std::vector<std::size_t>>>
+            &&factors) noexcept {
+        if (!factors.has_value()) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<LUFactorization<T>>(LUFactorization<T>{
+                std::move(factors.value().first),
+                std::move(factors.value().second)});
+        }
+    }
+
+    Matrix<T> lu_;
+    std::vector<std::size_t> permutation_;
+    bool singular_;
+    bool odd_permutation_;
+};  // class LUFactorization
+
+/**
+ * @brief A = L * L^T, for symmetric positive definite A
+ *
+ * Only the lower triangle of A is read.
+ */
+template <BasicEntry T>
+    requires std::floating_point<T>
+class CholeskyFactorization {
+ public:
+    static std::optional<CholeskyFactorization<T>> New(
+        const Matrix<T> &matrix) noexcept {
+        if (matrix.Height() != matrix.Width()) {
+            return std::nullopt;
+        } else {
+            return FactoryHelper(
+                detail::RowMajorCopy(matrix, matrix.Height(), nullptr));
+        }
+    }
+
+    static std::optional<CholeskyFactorization<T>> New(
+        Matrix<T> &&matrix) noexcept {
+        if (matrix.Height() != matrix.Width()) {
+            return std::nullopt;
+        } else {
+            return FactoryHelper(std::move(matrix));
+        }
+    }
+
+    constexpr std::size_t Size() const noexcept { return lower_.Height(); }
+
+    // L, with zeros above the diagonal
+    const Matrix<T> &Factors() const noexcept { return lower_; }
+
+    /**
+     * @brief Solves A * X = rhs for every column of rhs
+     *
+     * @return std::nullopt if rhs has the wrong height
+     */
+    std::optional<Matrix<T>> Solve(const Matrix<T> &rhs) const noexcept {
+        if (rhs.Height() != Size()) {
+            return std::nullopt;
+        }
+
+        Matrix<T> solution{
+            detail::RowMajorCopy(rhs, rhs.Height(), nullptr)};
+        const detail::StridedMatrix<const T> lower{detail::Strided(lower_)};
+        const std::size_t threads{GetThreadCount()};
+        detail::Trsm<T>(Size(), solution.Width(), Triangle::Lower,
+                        Diagonal::NonUnit, lower, detail::Strided(solution),
+                        threads);
+        // L^T is L with its strides swapped
+        detail::Trsm<T>(Size(), solution.Width(), Triangle::Upper,
+                        Diagonal::NonUnit,
+                        {lower.data, lower.column_stride, lower.row_stride},
+                        detail::Strided(solution), threads);
+        return std::make_optional<Matrix<T>>(std::move(solution));
+    }
+
+ private:
+    explicit CholeskyFactorization(Matrix<T> &&lower) noexcept
+        : lower_{std::move(lower)} {}
+
+    static std::optional<CholeskyFactorization<T>> FactoryHelper(
+        Matrix<T> &&matrix) noexcept {
+        const std::size_t n{matrix.Height()};
+        detail::StridedMatrix<T> lower{detail::Strided(matrix)};
+        if (!detail::CholeskyFactor<T>(n, lower, GetThreadCount())) {
+            return std::nullopt;
+        }
+        for (std::size_t row{0}; row < n; row++) {
+            for (std::size_t column{row + 1}; column < n; column++) {
+                lower(row, column) = T(0);
+            }
+        }
+        return std::make_optional<CholeskyFactorization<T>>(
+            CholeskyFactorization<T>{std::move(matrix)});
+    }
+
+    Matrix<T> lower_;
+};  // class CholeskyFactorization
+
+/**
+ * @brief A = Q * R by Householder reflections, for m x n A with m >= n
+ *
+ * Solve() returns the least squares solution when A is tall.
+ */
+template <BasicEntry T>
+    requires std::floating_point<T>
+class QRFactorization {
+ public:
+    static std::optional<QRFactorization<T>> New(
+        const Matrix<T> &matrix) noexcept {
+        if (matrix.Height() < matrix.Width()) {
+            return std::nullopt;
+        } else {
+            return FactoryHelper(
+                detail::RowMajorCopy(matrix, matrix.Height(), nullptr));
+        }
+    }
+
+    static std::optional<QRFactorization<T>> New(
+        Matrix<T> &&matrix) noexcept {
+        if (matrix.Height() < matrix.Width()) {
+            return std::nullopt;
+        } else {
+            return FactoryHelper(std::move(matrix));
+        }
+    }
+
+    constexpr std::size_t Height() const noexcept { return qr_.Height(); }
+    constexpr std::size_t Width() const noexcept { return qr_.Width(); }
+
+    // R on and above the diagonal, the Householder vectors below it
+    const Matrix<T> &Factors() const noexcept { return qr_; }
+    const std::vector<T> &Tau() const noexcept { return tau_; }
+
+    /**
+     * @brief Minimizes ||A * X - rhs|| for every column of rhs, which is the
+     *        exact solution when A is square
+     *
+     * @return std::nullopt if rhs has the wrong height or A is rank deficient
+     */
+    std::optional<Matrix<T>> Solve(const Matrix<T> &rhs) const noexcept {
+        if (rhs.Height() != Height()) {
+            return std::nullopt;
+        }
+        for (std::size_t row{0}; row < Width(); row++) {
+            if (qr_.At(row, row).value() == T(0)) {
+                return std::nullopt;
+            }
+        }
+
+        Matrix<T> projected{detail::RowMajorCopy(rhs, rhs.Height(), nullptr)};
+        const std::size_t threads{GetThreadCount()};
+        detail::QrApplyTransposed<T>(Height(), Width(), detail::Strided(qr_),
+                                     tau_.data(), projected.Width(),
+                                     detail::Strided(projected), threads);
+
+        Matrix<T> solution{
+            detail::RowMajorCopy(projected, Width(), nullptr)};
+        detail::Trsm<T>(Width(), solution.Width(), Triangle::Upper,
+                        Diagonal::NonUnit, detail::Strided(qr_),
+                        detail::Strided(solution), threads);
+        return std::make_optional<Matrix<T>>(std::move(solution));
+    }
+
+ private:
+    QRFactorization(Matrix<T> &&qr, std::vector<T> &&tau) noexcept
+        : qr_{std::move(qr)}, tau_{std::move(tau)} {}
+
+    static std::optional<QRFactorization<T>> FactoryHelper(
+        Matrix<T> &&matrix) noexcept {
+        std::vector<T> tau(matrix.Width(), T(0));
+        detail::QrFactor<T>(matrix.Height(), matrix.Width(),
+                            detail::Strided(matrix), tau.data(),
+                            GetThreadCount());
+        return std::make_optional<QRFactorization<T>>(
+            QRFactorization<T>{std::move(matrix), std::move(tau)});
+    }
+
+    Matrix<T> qr_;
+    std::vector<T> tau_;
+};  // class QRFactorization
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_FACTORIZATION_HPP_
@@ -0,0 +1,393 @@
+/*
+ *  FixedMatrix.hpp
+ *  Matrices with compile-time extents and inline storage
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_FIXED_MATRIX_HPP_
+#define PPP_PPP_FIXED_MATRIX_HPP_
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Column.hpp"
+#include "Matrix.hpp"
+#include "View.hpp"
+
+namespace ppp {
+
+namespace detail {
+
+// Loops over at most this many entries are unrolled outright
+constexpr std::size_t FIXED_UNROLL_LIMIT{64};
+
+// Calls body(0), ..., body(N - 1), unrolled when N is small
+template <std::size_t N, class Body>
+constexpr void Unroll(const Body &body) {
+    if constexpr (N <= FIXED_UNROLL_LIMIT) {
+        [&body]<std::size_t... I>(std::index_sequence<I...>) {
+            (body(I), ...);
+        }(std::make_index_sequence<N>{});
+    } else {
+        for (std::size_t i{0}; i < N; i++) {
+            body(i);
+        }
+    }
+}
+
+}  // namespace detail
+
+/*
+ * A Rows x Columns matrix stored row-major in a std::array: no heap, no
+ * thread pool, and every operation is constexpr. Shapes are part of the
+ * type, so mismatches fail to compile instead of returning std::nullopt.
+ * View() exposes the storage to every kernel that takes a MatrixView, and
+ * New()/ToMatrix() convert to and from the dynamic Matrix.
+ */
+template <BasicEntry T, std::size_t Rows, std::size_t Columns>
+    requires(Rows > 0 && Columns > 0)
+class FixedMatrix {
+ public:
+    static constexpr std::size_t ROWS{Rows};
+    static constexpr std::size_t COLUMNS{Columns};
+
+    constexpr FixedMatrix() noexcept : data_{} {}
+
+    constexpr explicit FixedMatrix(const T &value) noexcept : data_{} {
+        data_.fill(value);
+    }
+
+    // FixedMatrix<double, 2, 2>{{{1, 2}, {3, 4}}}; missing entries are zero
+    constexpr FixedMatrix(const T (&rows)[Rows][Columns]) noexcept : data_{} {
+        detail::Unroll<Rows * Columns>([this, &rows](std::size_t i) {
+            data_[i] = rows[i / Columns][i % Columns];
+        });
+    }
+
+    static constexpr FixedMatrix<T, Rows, Columns> Identity() noexcept
+        requires(Rows == Columns)
+    {
+        FixedMatrix<T, Rows, Columns> identity{};
+        detail::Unroll<Rows>(
+            [&identity](std::size_t i) { identity(i, i) = T(1); });
+        return identity;
+    }
+
+    // Copies a dynamic matrix or view, if it has exactly this shape
+    static std::optional<FixedMatrix<T, Rows, Columns>> New(
+        MatrixView<const T> view) noexcept {
+        if (view.Height() != Rows || view.Width() != Columns) {
+            return std::nullopt;
+        } else {
+            FixedMatrix<T, Rows, Columns> result{};
+            detail::Unroll<Rows * Columns>([&result, &view](std::size_t i) {
+                result.data_[i] = view(i / Columns, i % Columns);
+            });
+            return result;
+        }
+    }
+
+    static std::optional<FixedMatrix<T, Rows, Columns>> New(
+        const Matrix<T> &matrix) noexcept {
+        return New(matrix.View());
+    }
+
+    Matrix<T> ToMatrix() const noexcept {
+        Matrix<T> matrix{Matrix<T>::New(Rows, Columns).value()};
+        std::copy(data_.cbegin(), data_.cend(), matrix.Data());
+        return matrix;
+    }
+
+    static constexpr std::size_t Height() noexcept { return Rows; }
+    static constexpr std::size_t Width() noexcept { return Columns; }
+    static constexpr std::size_t Size() noexcept { return Rows * Columns; }
+
+    constexpr const T *Data() const noexcept { return data_.data(); }
+    constexpr T *Data() noexcept { return data_.data(); }
+
+    constexpr MatrixView<const T> View() const noexcept {
+        return {data_.data(), Rows, Columns, Columns, 1};
+    }
+
+    constexpr MatrixView<T> View() noexcept {
+        return {data_.data(), Rows, Columns, Columns, 1};
+    }
+
+    // Unchecked access
+    constexpr const T &operator()(std::size_t row,
+                                  std::size_t column) const noexcept {
+        return data_[(row * Columns) + column];
+    }
+
+    constexpr T &operator()(std::size_t row, std::size_t column) noexcept {
+        return data_[(row * Columns) + column];
+    }
+
+    constexpr std::optional<T> At(std::size_t row,
+                                  std::size_t column) const noexcept {
+        if (row >= Rows || column >= Columns) {
+            return std::nullopt;
+        } else {
+            return (*this)(row, column);
+        }
+    }
+
+    constexpr FixedMatrix<T, Columns, Rows> Transpose() const noexcept {
+        FixedMatrix<T, Columns, Rows> result{};
+        detail::Unroll<Rows * Columns>([this, &result](std::size_t i) {
+            result(i % Columns, i / Columns) = data_[i];
+        });
+        return result;
+    }
+
+    /**
+     * @brief Determinant by elimination; exact (fraction free Bareiss) for
+     *        integral entries and partially pivoted otherwise
+     */
+    constexpr T Det() const noexcept
+        requires(Rows == Columns)
+    {
+        FixedMatrix<T, Rows, Columns> work{*this};
+        T det{1};
+        T previous{1};
+        for (std::size_t step{0}; step < Rows; step++) {
+            std::size_t pivot{step};
+            if constexpr (std::is_integral_v<T>) {
+                while (pivot < Rows && work(pivot, step) == T(0)) {
+                    pivot++;
+                }
+            } else {
+                for (std::size_t row{step + 1}; row < Rows; row++) {
+                    if (Magnitude(work(row, step)) >
+                        Magnitude(work(pivot, step))) {
+                        pivot = row;
+                    }
+                }
+            }
+            if (pivot == Rows || work(pivot, step) == T(0)) {
+                return T(0);
+            } else if (pivot != step) {
+                work.SwapRows(pivot, step);
+                det = T(0) - det;
+            }
+
+            for (std::size_t row{step + 1}; row < Rows; row++) {
+                if constexpr (std::is_integral_v<T>) {
+                    for (std::size_t column{step + 1}; column < Columns;
+                         column++) {
+                        work(row, column) =
+                            ((work(row, column) * work(step, step)) -
+                             (work(row, step) * work(step, column))) /
+                            previous;
+                    }
+                } else {
+                    const T factor{work(row, step) / work(step, step)};
+                    for (std::size_t column{step + 1}; column < Columns;
+                         column++) {
+                        work(row, column) -= factor * work(step, column);
+                    }
+                }
+            }
+
+            if constexpr (std::is_integral_v<T>) {
+                previous = work(step, step);
+            } else {
+                det *= work(step, step);
+            }
+        }
+
+        if constexpr (std::is_integral_v<T>) {
+            return det * work(Rows - 1, Rows - 1);
+        } else {
+            return det;
+        }
+    }
+
+    /**
+     * @brief Gauss-Jordan inverse with partial pivoting
+     *
+     * @return std::nullopt if the matrix is singular
+     */
+    constexpr std::optional<FixedMatrix<T, Rows, Columns>> Inverse()
+        const noexcept
+        requires(Rows == Columns && !std::is_integral_v<T>)
+    {
+        FixedMatrix<T, Rows, Columns> work{*this};
+        FixedMatrix<T, Rows, Columns> inverse{Identity()};
+        for (std::size_t step{0}; step < Rows; step++) {
+            std::size_t pivot{step};
+            for (std::size_t row{step + 1}; row < Rows; row++) {
+                if (Magnitude(work(row, step)) > Magnitude(work(pivot, step))) {
+                    pivot = row;
+                }
+            }
+            if (work(pivot, step) == T(0)) {
+                return std::nullopt;
+            } else if (pivot != step) {
+                work.SwapRows(pivot, step);
+                inverse.SwapRows(pivot, step);
+            }
+
+            const T scale{T(1) / work(step, step)};
+            for (std::size_t column{0}; column < Columns; column++) {
+                work(step, column) *= scale;
+                inverse(step, column) *= scale;
+            }
+            for (std::size_t row{0}; row < Rows; row++) {
+                if (row != step && work(row, step) != T(0)) {
+                    const T factor{work(row, step)};
+                    for (std::size_t column{0}; column < Columns; column++) {
+                        work(row, column) -= factor * work(step, column);
+                        inverse(row, column) -= factor * inverse(step, column);
+                    }
+                }
+            }
+        }
+        return inverse;
+    }
+
+    /* ********************************************************************** */
+    /*                          Compound Assignment                           */
+    /* ********************************************************************** */
+
+    constexpr FixedMatrix<T, Rows, Columns> &operator+=(
+        const FixedMatrix<T, Rows, Columns> &rhs) noexcept {
+        detail::Unroll<Rows * Columns>(
+            [this, &rhs](std::size_t i) { data_[i] += rhs.data_[i]; });
+        return *this;
+    }
+
+    constexpr FixedMatrix<T, Rows, Columns> &operator-=(
+        const FixedMatrix<T, Rows, Columns> &rhs) noexcept {
+        detail::Unroll<Rows * Columns>(
+            [this, &rhs](std::size_t i) { data_[i] -= rhs.data_[i]; });
+        return *this;
+    }
+
+    template <SimpleNumber U>
+    constexpr FixedMatrix<T, Rows, Columns> &operator*=(U rhs) noexcept {
+        const T scalar{static_cast<T>(rhs)};
+        detail::Unroll<Rows * Columns>(
+            [this, &scalar](std::size_t i) { data_[i] *= scalar; });
+        return *this;
+    }
+
+    template <SimpleNumber U>
+    constexpr FixedMatrix<T, Rows, Columns> &operator/=(U rhs) noexcept {
+        const T scalar{static_cast<T>(rhs)};
+        detail::Unroll<Rows * Columns>(
+            [this, &scalar](std::size_t i) { data_[i] /= scalar; });
+        return *this;
+    }
+
+    /* ********************************************************************** */
+    /*                               Operators                                */
+    /* ********************************************************************** */
+
+    friend constexpr FixedMatrix<T, Rows, Columns> operator+(
+        const FixedMatrix<T, Rows, Columns> &lhs,
+        const FixedMatrix<T, Rows, Columns> &rhs) noexcept {
+        FixedMatrix<T, Rows, Columns> result{};
+        detail::Unroll<Rows * Columns>([&](std::size_t i) {
+            result.data_[i] = lhs.data_[i] + rhs.data_[i];
+        });
+        return result;
+    }
+
+    friend constexpr FixedMatrix<T, Rows, Columns> operator-(
+        const FixedMatrix<T, Rows, Columns> &lhs,
+        const FixedMatrix<T, Rows, Columns> &rhs) noexcept {
+        FixedMatrix<T, Rows, Columns> result{};
+        detail::Unroll<Rows * Columns>([&](std::size_t i) {
+            result.data_[i] = lhs.data_[i] - rhs.data_[i];
+        });
+        return result;
+    }
+
+    template <SimpleNumber U>
+    friend constexpr FixedMatrix<T, Rows, Columns> operator*(
+        FixedMatrix<T, Rows, Columns> lhs, U rhs) noexcept {
+        return lhs *= rhs;
+    }
+
+    template <SimpleNumber U>
+    friend constexpr FixedMatrix<T, Rows, Columns> operator*(
+        U lhs, FixedMatrix<T, Rows, Columns> rhs) noexcept {
+        return rhs *= lhs;
+    }
+
+    template <SimpleNumber U>
+    friend constexpr FixedMatrix<T, Rows, Columns> operator/(
+        FixedMatrix<T, Rows, Columns> lhs, U rhs) noexcept {
+        return lhs /= rhs;
+    }
+
+    // Entries compare exactly, so results stay usable in static_assert
+    friend constexpr bool operator==(
+        const FixedMatrix<T, Rows, Columns> &lhs,
+        const FixedMatrix<T, Rows, Columns> &rhs) noexcept {
+        return lhs.data_ == rhs.data_;
+    }
+
+ private:
+    constexpr void SwapRows(std::size_t first, std::size_t second) noexcept {
+        for (std::size_t column{0}; column < Columns; column++) {
+            std::swap((*this)(first, column), (*this)(second, column));
+        }
+    }
+
+    // std::abs is not constexpr until C++23 library support catches up
+    static constexpr auto Magnitude(const T &value) noexcept {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return value < T(0) ? T(0) - value : value;
+        } else {
+            return std::norm(value);
+        }
+    }
+
+    std::array<T, Rows * Columns> data_;
+};  // class FixedMatrix
+
+/**
+ * @brief Matrix product; the inner dimensions have to agree at compile time
+ */
+template <BasicEntry T, std::size_t Rows, std::size_t Inner,
+          std::size_t Columns>
+constexpr FixedMatrix<T, Rows, Columns> operator*(
+    const FixedMatrix<T, Rows, Inner> &lhs,
+    const FixedMatrix<T, Inner, Columns> &rhs) noexcept {
+    FixedMatrix<T, Rows, Columns> result{};
+    detail::Unroll<Rows * Columns>([&](std::size_t i) {
+        const std::size_t row{i / Columns};
+        const std::size_t column{i % Columns};
+        T sum{0};
+        detail::Unroll<Inner>([&](std::size_t k) {
+            sum += lhs(row, k) * rhs(k, column);
+        });
+        result(row, column) = sum;
+    });
+    return result;
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_FIXED_MATRIX_HPP_
@@ -0,0 +1,592 @@
+/*
+ *  Gemm.hpp
+ *  Cache blocked general matrix multiply kernels used by ppp::Matrix
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_GEMM_HPP_
+#define PPP_PPP_GEMM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Tuning.hpp"
+
+namespace ppp {
+namespace detail {
+
+/*
+ * The multiply follows the usual Goto/BLIS structure:
+ *
+ *   for each nc wide column panel of C            (B panel lives in L3)
+ *     for each kc deep slice of the shared dimension
+ *       pack B[kc x nc] into nr wide micro panels
+ *       for each mc tall row panel of C           (A block lives in L2)
+ *         pack A[mc x kc] into mr tall micro panels
+ *         for each nr x mr micro tile: run the register blocked kernel
+ *
+ * Every operand is addressed through a row stride and a column stride, so
+ * row-major, column-major and transposed operands are all handled by packing.
+ */
+
+template <class T>
+struct StridedMatrix {
+    T *data;
+    std::size_t row_stride;
+    std::size_t column_stride;
+
+    constexpr T &operator()(std::size_t row,
+                            std::size_t column) const noexcept {
+        return data[(row * row_stride) + (column * column_stride)];
+    }
+};
+
+template <class T>
+struct GemmBlocking {
+    std::size_t mc;
+    std::size_t kc;
+    std::size_t nc;
+};
+
+// Largest mr x nr tile produced by any of the micro kernels below
+constexpr std::size_t MAX_MICRO_TILE{12 * 32};
+
+template <class T>
+struct GemmKernel {
+    std::size_t mr;
+    std::size_t nr;
+    // ab[mr x nr] (row-major) = sum over kc of packed_a[p] * packed_b[p]
+    void (*compute)(std::size_t kc, const T *packed_a, const T *packed_b,
+                    T *ab) noexcept;
+};
+
+template <class T, std::size_t MR, std::size_t NR>
+void ScalarMicroKernel(std::size_t kc, const T *packed_a, const T *packed_b,
+                       T *ab) noexcept {
+    T accumulator[MR * NR]{};
+    for (std::size_t p{0}; p < kc; p++) {
+        for (std::size_t i{0}; i < MR; i++) {
+            const T a{packed_a[i]};
+            for (std::size_t j{0}; j < NR; j++) {
+                accumulator[(i * NR) + j] += a * packed_b[j];
+            }
+        }
+        packed_a += MR;
+        packed_b += NR;
+    }
+    std::copy(accumulator, accumulator + (MR * NR), ab);
+}
+
+#ifdef PPP_SIMD_X86
+// 6x16 floats: 12 ymm accumulators keep both FMA ports busy
+PPP_TARGET_AVX2 inline void MicroKernelAvx2(std::size_t kc,
+                                            const float *packed_a,
+                                            const float *packed_b,
+                                            float *ab) noexcept {
+    __m256 c[6][2];
+    PPP_UNROLL(6)
+    for (std::size_t i = 0; i < 6; i++) {
+        c[i][0] = _mm256_setzero_ps();
+        c[i][1] = _mm256_setzero_ps();
+    }
+    for (std::size_t p{0}; p < kc; p++) {
+        const __m256 b0{_mm256_load_ps(packed_b)};
+        const __m256 b1{_mm256_load_ps(packed_b + 8)};
+        PPP_UNROLL(6)
+        for (std::size_t i = 0; i < 6; i++) {
+            const __m256 a{_mm256_broadcast_ss(packed_a + i)};
+            c[i][0] = _mm256_fmadd_ps(a, b0, c[i][0]);
+            c[i][1] = _mm256_fmadd_ps(a, b1, c[i][1]);
+        }
+        packed_a += 6;
+        packed_b += 16;
+    }
+    PPP_UNROLL(6)
+    for (std::size_t i = 0; i < 6; i++) {
+        _mm256_storeu_ps(ab + (i * 16), c[i][0]);
+        _mm256_storeu_ps(ab + (i * 16) + 8, c[i][1]);
+    }
+}
+
+// 6x8 doubles
+PPP_TARGET_AVX2 inline void MicroKernelAvx2(std::size_t kc,
+                                            const double *packed_a,
+                                            const double *packed_b,
+                                            double *ab) noexcept {
+    __m256d c[6][2];
+    PPP_UNROLL(6)
+    for (std::size_t i = 0; i < 6; i++) {
+        c[i][0] = _mm256_setzero_pd();
+        c[i][1] = _mm256_setzero_pd();
+    }
+    for (std::size_t p{0}; p < kc; p++) {
+        const __m256d b0{_mm256_load_pd(packed_b)};
+        const __m256d b1{_mm256_load_pd(packed_b + 4)};
+        PPP_UNROLL(6)
+        for (std::size_t i = 0; i < 6; i++) {
+            const __m256d a{_mm256_broadcast_sd(packed_a + i)};
+            c[i][0] = _mm256_fmadd_pd(a, b0, c[i][0]);
+            c[i][1] = _mm256_fmadd_pd(a, b1, c[i][1]);
+        }
+        packed_a += 6;
+        packed_b += 8;
+    }
+    PPP_UNROLL(6)
+    for (std::size_t i = 0; i < 6; i++) {
+        _mm256_storeu_pd(ab + (i * 8), c[i][0]);
+        _mm256_storeu_pd(ab + (i * 8) + 4, c[i][1]);
+    }
+}
+
+// 12x32 floats: 24 of the 32 zmm registers hold C
+PPP_TARGET_AVX512 inline void MicroKernelAvx512(std::size_t kc,
+                                                const float *packed_a,
+                                                const float *packed_b,
+                                                float *ab) noexcept {
+    __m512 c[12][2];
+    PPP_UNROLL(12)
+    for (std::size_t i = 0; i < 12; i++) {
+        c[i][0] = _mm512_setzero_ps();
+        c[i][1] = _mm512_setzero_ps();
+    }
+    for (std::size_t p{0}; p < kc; p++) {
+        const __m512 b0{_mm512_load_ps(packed_b)};
+        const __m512 b1{_mm512_load_ps(packed_b + 16)};
+        PPP_UNROLL(12)
+        for (std::size_t i = 0; i < 12; i++) {
+            const __m512 a{_mm512_set1_ps(packed_a[i])};
+            c[i][0] = _mm512_fmadd_ps(a, b0, c[i][0]);
+            c[i][1] = _mm512_fmadd_ps(a, b1, c[i][1]);
+        }
+        packed_a += 12;
+        packed_b += 32;
+    }
+    PPP_UNROLL(12)
+    for (std::size_t i = 0; i < 12; i++) {
+        _mm512_storeu_ps(ab + (i * 32), c[i][0]);
+        _mm512_storeu_ps(ab + (i * 32) + 16, c[i][1]);
+    }
+}
+
+// 12x16 doubles
+PPP_TARGET_AVX512 inline void MicroKernelAvx512(std::size_t kc,
+                                                const double *packed_a,
+                                                const double *packed_b,
+                                                double *ab) noexcept {
+    __m512d c[12][2];
+    PPP_UNROLL(12)
+    for (std::size_t i = 0; i < 12; i++) {
+        c[i][0] = _mm512_setzero_pd();
+        c[i][1] = _mm512_setzero_pd();
+    }
+    for (std::size_t p{0}; p < kc; p++) {
+        const __m512d b0{_mm512_load_pd(packed_b)};
+        const __m512d b1{_mm512_load_pd(packed_b + 8)};
+        PPP_UNROLL(12)
+        for (std::size_t i = 0; i < 12; i++) {
+            const __m512d a{_mm512_set1_pd(packed_a[i])};
+            c[i][0] = _mm512_fmadd_pd(a, b0, c[i][0]);
+            c[i][1] = _mm512_fmadd_pd(a, b1, c[i][1]);
+        }
+        packed_a += 12;
+        packed_b += 16;
+    }
+    PPP_UNROLL(12)
+    for (std::size_t i = 0; i < 12; i++) {
+        _mm512_storeu_pd(ab + (i * 16), c[i][0]);
+        _mm512_storeu_pd(ab + (i * 16) + 8, c[i][1]);
+    }
+}
+#endif  // PPP_SIMD_X86
+
+template <class T>
+const GemmKernel<T> &SelectGemmKernel() noexcept {
+    static const GemmKernel<T> kernel{[]() -> GemmKernel<T> {
+#ifdef PPP_SIMD_X86
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            constexpr std::size_t lanes{64 / sizeof(T)};
+            if (HasAvx512()) {
+                return {12, 2 * lanes, &MicroKernelAvx512};
+            } else if (HasAvx2()) {
+                return {6, lanes, &MicroKernelAvx2};
+            }
+        }
+#endif
+        return {4, 4, &ScalarMicroKernel<T, 4, 4>};
+    }()};
+    return kernel;
+}
+
+// An A block of about l2_bytes and a B panel of a few megabytes, rounded to
+// whole micro panels
+template <class T>
+GemmBlocking<T> GemmBlockingFor(const GemmKernel<T> &kernel, std::size_t kc,
+                                std::size_t l2_bytes) noexcept {
+    const std::size_t mc{std::max<std::size_t>(
+        kernel.mr, (l2_bytes / (kc * sizeof(T))) / kernel.mr * kernel.mr)};
+    const std::size_t nc{std::max<std::size_t>(
+        kernel.nr,
+        ((4 * 1024 * 1024) / (kc * sizeof(T))) / kernel.nr * kernel.nr)};
+    return {mc, kc, nc};
+}
+
+// Sized so a B micro panel fills most of a 48K L1, an A block a fraction of
+// a 1M L2 and a B panel a couple of megabytes of L3
+template <class T>
+GemmBlocking<T> DefaultGemmBlocking(const GemmKernel<T> &kernel) noexcept {
+    return GemmBlockingFor(
+        kernel,
+        std::clamp<std::size_t>((32 * 1024) / (kernel.nr * sizeof(T)), 64,
+                                512),
+        192 * 1024);
+}
+
+template <class T>
+T *GemmWorkspace(std::size_t slot, std::size_t size) noexcept {
+    static thread_local std::vector<T, AlignedAllocator<T>> workspaces[2];
+    std::vector<T, AlignedAllocator<T>> &workspace{workspaces[slot]};
+    if (workspace.size() < size) {
+        workspace.resize(size);
+    }
+    return workspace.data();
+}
+
+// Packs rows [0, rows) of a[rows x depth] into mr tall panels, zero padded
+template <class T>
+void PackA(std::size_t rows, std::size_t depth, StridedMatrix<const T> a,
+           std::size_t mr, T *packed) noexcept {
+    for (std::size_t panel{0}; panel < rows; panel += mr) {
+        const std::size_t height{std::min(mr, rows - panel)};
+        if (a.column_stride == 1) {
+            for (std::size_t i{0}; i < height; i++) {
+                const T *source{&a(panel + i, 0)};
+                for (std::size_t p{0}; p < depth; p++) {
+                    packed[(p * mr) + i] = source[p];
+                }
+            }
+        } else {
+            for (std::size_t p{0}; p < depth; p++) {
+                for (std::size_t i{0}; i < height; i++) {
+                    packed[(p * mr) + i] = a(panel + i, p);
+                }
+            }
+        }
+        if (height < mr) {
+            for (std::size_t p{0}; p < depth; p++) {
+                std::fill(packed + (p * mr) + height, packed + ((p + 1) * mr),
+                          T(0));
+            }
+        }
+        packed += mr * depth;
+    }
+}
+
+// Packs columns [0, columns) of b[depth x columns] into nr wide panels
+template <class T>
+void PackB(std::size_t depth, std::size_t columns, StridedMatrix<const T> b,
+           std::size_t nr, T *packed) noexcept {
+    for (std::size_t panel{0}; panel < columns; panel += nr) {
+        const std::size_t width{std::min(nr, columns - panel)};
+        if (b.column_stride == 1) {
+            for (std::size_t p{0}; p < depth; p++) {
+                const T *source{&b(p, panel)};
+                std::copy(source, source + width, packed + (p * nr));
+                std::fill(packed + (p * nr) + width, packed + ((p + 1) * nr),
+                          T(0));
+            }
+        } else {
+            for (std::size_t j{0}; j < width; j++) {
+                for (std::size_t p{0}; p < depth; p++) {
+                    packed[(p * nr) + j] = b(p, panel + j);
+                }
+            }
+            for (std::size_t p{0}; p < depth; p++) {
+                std::fill(packed + (p * nr) + width, packed + ((p + 1) * nr),
+                          T(0));
+            }
+        }
+        packed += nr * depth;
+    }
+}
+
+template <class T>
+void ScaleMatrix(std::size_t rows, std::size_t columns, T beta,
+                 StridedMatrix<T> c) noexcept {
+    for (std::size_t i{0}; i < rows; i++) {
+        for (std::size_t j{0}; j < columns; j++) {
+            c(i, j) = (beta == T(0)) ? T(0) : beta * c(i, j);
+        }
+    }
+}
+
+// Straightforward i-p-j loop for products too small to amortize packing
+template <class T>
+void SmallGemm(std::size_t m, std::size_t n, std::size_t k, T alpha,
+               StridedMatrix<const T> a, StridedMatrix<const T> b, T beta,
+               StridedMatrix<T> c) noexcept {
+    ScaleMatrix(m, n, beta, c);
+    for (std::size_t i{0}; i < m; i++) {
+        for (std::size_t p{0}; p < k; p++) {
+            const T scaled{alpha * a(i, p)};
+            for (std::size_t j{0}; j < n; j++) {
+                c(i, j) += scaled * b(p, j);
+            }
+        }
+    }
+}
+
+// c[rows x columns] = alpha * ab + beta * c, never reading c when beta is 0
+template <class T>
+void UpdateTile(std::size_t rows, std::size_t columns, T alpha, const T *ab,
+                std::size_t ab_stride, T beta, StridedMatrix<T> c) noexcept {
+    if (c.column_stride != 1) {
+        for (std::size_t i{0}; i < rows; i++) {
+            for (std::size_t j{0}; j < columns; j++) {
+                T &entry{c(i, j)};
+                entry = (beta == T(0))
+                            ? alpha * ab[(i * ab_stride) + j]
+                            : (alpha * ab[(i * ab_stride) + j]) + (beta * entry);
+            }
+        }
+    } else if (beta == T(0)) {
+        for (std::size_t i{0}; i < rows; i++) {
+            T *destination{&c(i, 0)};
+            const T *source{ab + (i * ab_stride)};
+            for (std::size_t j{0}; j < columns; j++) {
+                destination[j] = alpha * source[j];
+            }
+        }
+    } else if (alpha == T(1) && beta == T(1)) {
+        for (std::size_t i{0}; i < rows; i++) {
+            T *destination{&c(i, 0)};
+            const T *source{ab + (i * ab_stride)};
+            for (std::size_t j{0}; j < columns; j++) {
+                destination[j] += source[j];
+            }
+        }
+    } else {
+        for (std::size_t i{0}; i < rows; i++) {
+            T *destination{&c(i, 0)};
+            const T *source{ab + (i * ab_stride)};
+            for (std::size_t j{0}; j < columns; j++) {
+                destination[j] = (alpha * source[j]) + (beta * destination[j]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes the [row_begin, row_end) x [column_begin, column_end) tile
+ *        of C = alpha * A * B + beta * C, where A is m x k and B is k x n
+ */
+template <class T>
+void GemmTile(std::size_t row_begin, std::size_t row_end,
+              std::size_t column_begin, std::size_t column_end, std::size_t k,
+              T alpha, StridedMatrix<const T> a, StridedMatrix<const T> b,
+              T beta, StridedMatrix<T> c, const GemmKernel<T> &kernel,
+              const GemmBlocking<T> &blocking) noexcept {
+    const std::size_t mr{kernel.mr};
+    const std::size_t nr{kernel.nr};
+    const std::size_t mc{std::max(mr, blocking.mc / mr * mr)};
+    const std::size_t kc{std::max<std::size_t>(1, blocking.kc)};
+    const std::size_t nc{std::max(nr, blocking.nc / nr * nr)};
+
+    T *packed_a{GemmWorkspace<T>(0, mc * kc)};
+    T *packed_b{GemmWorkspace<T>(1, nc * kc)};
+    alignas(BUFFER_ALIGNMENT) T ab[MAX_MICRO_TILE];
+
+    for (std::size_t jc{column_begin}; jc < column_end; jc += nc) {
+        const std::size_t nc_current{std::min(nc, column_end - jc)};
+
+        for (std::size_t pc{0}; pc < k; pc += kc) {
+            const std::size_t kc_current{std::min(kc, k - pc)};
+            const T beta_current{pc == 0 ? beta : T(1)};
+
+            PackB(kc_current, nc_current,
+                  StridedMatrix<const T>{&b(pc, jc), b.row_stride,
+                                         b.column_stride},
+                  nr, packed_b);
+
+            for (std::size_t ic{row_begin}; ic < row_end; ic += mc) {
+                const std::size_t mc_current{std::min(mc, row_end - ic)};
+
+                PackA(mc_current, kc_current,
+                      StridedMatrix<const T>{&a(ic, pc), a.row_stride,
+                                             a.column_stride},
+                      mr, packed_a);
+
+                for (std::size_t jr{0}; jr < nc_current; jr += nr) {
+                    const std::size_t width{std::min(nr, nc_current - jr)};
+                    const T *panel_b{packed_b + (jr * kc_current)};
+
+                    for (std::size_t ir{0}; ir < mc_current; ir += mr) {
+                        const std::size_t height{std::min(mr, mc_current - ir)};
+                        kernel.compute(kc_current,
+                                       packed_a + (ir * kc_current), panel_b,
+                                       ab);
+
+                        UpdateTile(height, width, alpha, ab, nr,
+                                   beta_current,
+                                   StridedMatrix<T>{&c(ic + ir, jc + jr),
+                                                    c.row_stride,
+                                                    c.column_stride});
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Times one product of square operands for each candidate kc and an
+ *        A block of an eighth, a quarter or half of L2
+ */
+template <class T>
+TunedValues TuneGemmBlocking() {
+    const GemmKernel<T> &kernel{SelectGemmKernel<T>()};
+    const std::size_t l2{GetCpuCaches().l2 != 0 ? GetCpuCaches().l2
+                                                : 1024 * 1024};
+    std::vector<GemmBlocking<T>> candidates{DefaultGemmBlocking(kernel)};
+    for (const std::size_t kc : {128, 256, 384, 512}) {
+        for (const std::size_t share : {8, 4, 2}) {
+            candidates.push_back(GemmBlockingFor(kernel, kc, l2 / share));
+        }
+    }
+
+    constexpr std::size_t size{384};
+    std::vector<T, AlignedAllocator<T>> a(size * size);
+    std::vector<T, AlignedAllocator<T>> b(size * size);
+    std::vector<T, AlignedAllocator<T>> c(size * size);
+    for (std::size_t entry{0}; entry < a.size(); entry++) {
+        a[entry] = T(entry % 7) / T(8);
+        b[entry] = T(entry % 5) / T(4);
+    }
+    const GemmBlocking<T> fastest{FastestCandidate<GemmBlocking<T>>(
+        candidates, [&](const GemmBlocking<T> &blocking) {
+            GemmTile<T>(0, size, 0, size, size, T(1), {a.data(), size, 1},
+                        {b.data(), size, 1}, T(0), {c.data(), size, 1},
+                        kernel, blocking);
+        })};
+    return {fastest.mc, fastest.kc, fastest.nc};
+}
+
+// Tuned float and double blocking, else the default for the micro kernel.
+// Cached sizes whose packed blocks would not fit in 64M are ignored.
+template <class T>
+GemmBlocking<T> GetGemmBlocking() {
+    static const GemmBlocking<T> fallback{
+        DefaultGemmBlocking(SelectGemmKernel<T>())};
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        const auto [mc, kc, nc] = TunedValuesOr(
+            std::is_same_v<T, float> ? TunedKernel::GemmFloat
+                                     : TunedKernel::GemmDouble,
+            {fallback.mc, fallback.kc, fallback.nc}, &TuneGemmBlocking<T>);
+        constexpr std::size_t limit{(64 * 1024 * 1024) / sizeof(T)};
+        if (kc == 0 || mc > limit / kc || nc > limit / kc) {
+            return fallback;
+        }
+        return {mc, kc, nc};
+    } else {
+        return fallback;
+    }
+}
+
+/**
+ * @brief C = alpha * A * B + beta * C for an m x k A and a k x n B
+ *
+ * When beta is zero C is never read, so it may hold uninitialized values.
+ */
+template <class T>
+void Gemm(std::size_t m, std::size_t n, std::size_t k, T alpha,
+          StridedMatrix<const T> a, StridedMatrix<const T> b, T beta,
+          StridedMatrix<T> c) noexcept {
+    if (m == 0 || n == 0) {
+        return;
+    } else if (k == 0 || alpha == T(0)) {
+        ScaleMatrix(m, n, beta, c);
+    } else if (m * n * k <= 16 * 16 * 16) {
+        SmallGemm(m, n, k, alpha, a, b, beta, c);
+    } else {
+        GemmTile(0, m, 0, n, k, alpha, a, b, beta, c, SelectGemmKernel<T>(),
+                 GetGemmBlocking<T>());
+    }
+}
+
+constexpr std::size_t RoundUp(std::size_t value,
+                              std::size_t multiple) noexcept {
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+/**
+ * @brief Gemm split into independent tiles of C, which are scheduled on the
+ *        shared work stealing pool
+ *
+ * Tiles start at one mc x nc cache block and are halved along their longer
+ * side until there are a few per thread, so tall-skinny, short-wide and
+ * square products all expose enough parallelism.
+ */
+template <class T>
+void ParallelGemm(std::size_t m, std::size_t n, std::size_t k, T alpha,
+                  StridedMatrix<const T> a, StridedMatrix<const T> b, T beta,
+                  StridedMatrix<T> c, std::size_t threads) noexcept {
+    if (threads <= 1 || k == 0 || alpha == T(0) ||
+        m * n * k <= 64 * 64 * 64) {
+        Gemm(m, n, k, alpha, a, b, beta, c);
+        return;
+    }
+
+    const GemmKernel<T> &kernel{SelectGemmKernel<T>()};
+    const GemmBlocking<T> blocking{GetGemmBlocking<T>()};
+    const std::size_t mr{kernel.mr};
+    const std::size_t nr{kernel.nr};
+
+    std::size_t tile_m{RoundUp(std::min(m, blocking.mc), mr)};
+    std::size_t tile_n{RoundUp(std::min(n, blocking.nc), nr)};
+    const std::size_t wanted_tiles{4 * threads};
+    while (((m + tile_m - 1) / tile_m) * ((n + tile_n - 1) / tile_n) <
+           wanted_tiles) {
+        const bool split_rows{tile_m > mr && (tile_m >= tile_n || tile_n <= nr)};
+        if (split_rows) {
+            tile_m = RoundUp(tile_m / 2, mr);
+        } else if (tile_n > nr) {
+            tile_n = RoundUp(tile_n / 2, nr);
+        } else {
+            break;
+        }
+    }
+
+    const std::size_t row_tiles{(m + tile_m - 1) / tile_m};
+    const std::size_t column_tiles{(n + tile_n - 1) / tile_n};
+    ParallelFor(row_tiles * column_tiles, threads, [&](std::size_t tile) {
+        const std::size_t row_begin{(tile / column_tiles) * tile_m};
+        const std::size_t column_begin{(tile % column_tiles) * tile_n};
+        GemmTile(row_begin, std::min(m, row_begin + tile_m), column_begin,
+                 std::min(n, column_begin + tile_n), k, alpha, a, b, beta, c,
+                 kernel, blocking);
+    });
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_GEMM_HPP_
@@ -0,0 +1,776 @@
+/*
+ *  Mapped.hpp
+ *  Out-of-core matrices backed by a memory-mapped file
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_MAPPED_HPP_
+#define PPP_PPP_MAPPED_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Column.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+#include "Numa.hpp"
+#include "Reduce.hpp"
+#include "ThreadPool.hpp"
+#include "View.hpp"
+
+namespace ppp {
+
+template <class T>
+concept MappedEntry =
+    (std::integral<T> || std::floating_point<T>) && !std::same_as<T, bool>;
+
+enum class MapMode : std::uint8_t {
+    ReadOnly,
+    // Writable, but changes stay private to this mapping and never reach
+    // the file
+    CopyOnWrite,
+    // Writable, and changes are written back to the file
+    ReadWrite,
+};
+
+// Bytes of each operand a tiled sweep works on at once, unless changed with
+// SetMappedTileBytes(); the tiles ahead are prefetched and the ones behind
+// dropped, so resident memory stays a few tiles no matter how large the file
+constexpr std::size_t MAPPED_TILE_BYTES{1 << 26};
+
+// Entries start a page into the file so the mapping keeps them aligned
+constexpr std::size_t MAPPED_DATA_OFFSET{4096};
+
+namespace detail {
+
+inline std::atomic<std::size_t> &MappedTileSetting() noexcept {
+    static std::atomic<std::size_t> bytes{MAPPED_TILE_BYTES};
+    return bytes;
+}
+
+}  // namespace detail
+
+// Sets the tile size of the out-of-core sweeps; 0 restores the default
+inline void SetMappedTileBytes(std::size_t bytes) noexcept {
+    detail::MappedTileSetting().store(bytes == 0 ? MAPPED_TILE_BYTES : bytes);
+}
+
+inline std::size_t GetMappedTileBytes() noexcept {
+    return detail::MappedTileSetting().load();
+}
+
+namespace detail {
+
+constexpr char MAPPED_MAGIC[8]{'P', 'P', 'P', 'M', 'A', 'T', 'R', 'X'};
+constexpr std::uint32_t MAPPED_VERSION{1};
+
+/*
+ * File layout: this header, zero padding up to data_offset, then the
+ * entries in row-major order. Integers are in host byte order.
+ */
+struct MappedHeader {
+    char magic[8];
+    std::uint32_t version;
+    // Kind in the high bits (1 float, 2 signed, 3 unsigned), size in bytes
+    // in the low eight
+    std::uint32_t dtype;
+    std::uint64_t rows;
+    std::uint64_t columns;
+    std::uint64_t data_offset;
+};
+
+template <MappedEntry T>
+consteval std::uint32_t MappedDtype() noexcept {
+    const std::uint32_t kind{std::floating_point<T>  ? 1U
+                             : std::is_signed_v<T> ? 2U
+                                                   : 3U};
+    return (kind << 8) | static_cast<std::uint32_t>(sizeof(T));
+}
+
+// One operand of a tiled sweep: its first row and the bytes per row
+struct MappedRows {
+    const std::byte *data;
+    std::size_t row_bytes;
+    // Whether its finished tiles may be dropped from this process; never
+    // for copy-on-write maps, where that would discard the changes
+    bool releasable;
+};
+
+inline void Advise(const std::byte *begin, std::size_t bytes, bool inward,
+                   [[maybe_unused]] int advice) noexcept {
+#if defined(__linux__)
+    const std::size_t page{PageSize()};
+    const auto first{reinterpret_cast<std::uintptr_t>(begin)};
+    const std::uintptr_t start{inward ? ((first + page - 1) / page) * page
+                                      : (first / page) * page};
+    const std::uintptr_t end{inward ? ((first + bytes) / page) * page
+                                    : ((first + bytes + page - 1) / page) *
+                                          page};
+    if (bytes != 0 && end > start) {
+        madvise(reinterpret_cast<void *>(start), end - start, advice);
+    }
+#else
+    (void)begin;
+    (void)bytes;
+    (void)inward;
+#endif
+}
+
+/**
+ * @brief Runs body(first, last) over [0, rows) in tiles of about
+ *        GetMappedTileBytes() of the widest operand
+ *
+ * Each operand is advised sequential up front, the next tile is requested
+ * before the current one runs, and releasable tiles are dropped from this
+ * process once done; the page cache keeps them for as long as it likes.
+ */
+template <class Body>
+void ForEachRowTile(std::size_t rows, const std::vector<MappedRows> &operands,
+                    const Body &body) {
+#if defined(__linux__)
+    constexpr int sequential{MADV_SEQUENTIAL};
+    constexpr int will_need{MADV_WILLNEED};
+    constexpr int dont_need{MADV_DONTNEED};
+#else
+    constexpr int sequential{0};
+    constexpr int will_need{0};
+    constexpr int dont_need{0};
+#endif
+    std::size_t widest{1};
+    for (const MappedRows &operand : operands) {
+        widest = std::max(widest, operand.row_bytes);
+        Advise(operand.data, rows * operand.row_bytes, false, sequential);
+    }
+    const std::size_t tile{
+        std::max<std::size_t>(1, GetMappedTileBytes() / widest)};
+
+    for (std::size_t first{0}; first < rows; first += tile) {
+        const std::size_t last{std::min(rows, first + tile)};
+        const std::size_t ahead{std::min(rows, last + tile)};
+        for (const MappedRows &operand : operands) {
+            Advise(operand.data + (last * operand.row_bytes),
+                   (ahead - last) * operand.row_bytes, false, will_need);
+        }
+        body(first, last);
+        for (const MappedRows &operand : operands) {
+            if (operand.releasable) {
+                Advise(operand.data + (first * operand.row_bytes),
+                       (last - first) * operand.row_bytes, true, dont_need);
+            }
+        }
+    }
+}
+
+// Entries each task of an element-wise tile covers
+constexpr std::size_t MAPPED_CHUNK{1 << 14};
+
+template <class Op>
+void ParallelChunks(std::size_t size, const Op &op) {
+    const std::size_t chunks{(size + MAPPED_CHUNK - 1) / MAPPED_CHUNK};
+    ParallelFor(chunks, GetThreadCount(), [&](std::size_t chunk) {
+        const std::size_t begin{chunk * MAPPED_CHUNK};
+        op(begin, std::min(size, begin + MAPPED_CHUNK));
+    });
+}
+
+}  // namespace detail
+
+/*
+ * A dense row-major matrix whose entries live in a file mapped with mmap
+ * instead of in memory, for matrices larger than RAM. The file carries its
+ * own shape and element type (see detail::MappedHeader), and Open() refuses
+ * a file written for another type.
+ *
+ * The reductions, element-wise operators and products below walk the file
+ * in row tiles with madvise hints, so the only memory they lean on is the
+ * page cache. View() exposes the entries to every MatrixView operand
+ * without a copy, but those kernels are not tiled.
+ *
+ * Only available on Linux; elsewhere Open() and Create() return
+ * std::nullopt.
+ */
+template <MappedEntry T>
+class MappedMatrix {
+ public:
+    MappedMatrix(const MappedMatrix &) = delete;
+    MappedMatrix &operator=(const MappedMatrix &) = delete;
+
+    MappedMatrix(MappedMatrix &&moved) noexcept
+        : base_{std::exchange(moved.base_, nullptr)},
+          length_{std::exchange(moved.length_, 0)},
+          height_{moved.height_},
+          width_{moved.width_},
+          mode_{moved.mode_},
+          data_{std::exchange(moved.data_, nullptr)} {}
+
+    MappedMatrix &operator=(MappedMatrix &&moved) noexcept {
+        if (this != &moved) {
+            Unmap();
+            base_ = std::exchange(moved.base_, nullptr);
+            length_ = std::exchange(moved.length_, 0);
+            height_ = moved.height_;
+            width_ = moved.width_;
+            mode_ = moved.mode_;
+            data_ = std::exchange(moved.data_, nullptr);
+        }
+        return *this;
+    }
+
+    ~MappedMatrix() { Unmap(); }
+
+    /**
+     * @brief Maps an existing matrix file
+     *
+     * @return std::nullopt if the file cannot be opened or mapped, is not a
+     *         matrix file, holds another element type or is shorter than its
+     *         header says
+     */
+    static std::optional<MappedMatrix<T>> Open(
+        const std::filesystem::path &path, MapMode mode = MapMode::ReadOnly) {
+#if defined(__linux__)
+        const int descriptor{::open(
+            path.c_str(), mode == MapMode::ReadWrite ? O_RDWR : O_RDONLY)};
+        if (descriptor < 0) {
+            return std::nullopt;
+        }
+        detail::MappedHeader header{};
+        struct stat status{};
+        const bool valid{
+            ::fstat(descriptor, &status) == 0 &&
+            ::pread(descriptor, &header, sizeof(header), 0) ==
+                static_cast<ssize_t>(sizeof(header)) &&
+            ValidHeader(header, static_cast<std::size_t>(status.st_size))};
+        std::optional<MappedMatrix<T>> mapped{};
+        if (valid) {
+            mapped = Map(descriptor,
+                         header.data_offset + (header.rows * header.columns *
+                                               sizeof(T)),
+                         header, mode);
+        }
+        ::close(descriptor);
+        return mapped;
+#else
+        (void)path;
+        (void)mode;
+        return std::nullopt;
+#endif
+    }
+
+    /**
+     * @brief Creates (or truncates) a zero-filled rows x columns matrix file
+     *        and maps it MapMode::ReadWrite
+     *
+     * The file starts sparse, so creating it costs no disk until it is
+     * written.
+     */
+    static std::optional<MappedMatrix<T>> Create(
+        const std::filesystem::path &path, std::size_t rows,
+        std::size_t columns) {
+#if defined(__linux__)
+        if (columns != 0 &&
+            rows > (std::numeric_limits<std::size_t>::max() -
+                    MAPPED_DATA_OFFSET) /
+                       sizeof(T) / columns) {
+            return std::nullopt;
+        }
+        const int descriptor{
+            ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+        if (descriptor < 0) {
+            return std::nullopt;
+        }
+        detail::MappedHeader header{};
+        std::memcpy(header.magic, detail::MAPPED_MAGIC, sizeof(header.magic));
+        header.version = detail::MAPPED_VERSION;
+        header.dtype = detail::MappedDtype<T>();
+        header.rows = rows;
+        header.columns = columns;
+        header.data_offset = MAPPED_DATA_OFFSET;
+        const std::size_t length{MAPPED_DATA_OFFSET +
+                                 (rows * columns * sizeof(T))};
+        std::optional<MappedMatrix<T>> mapped{};
+        if (::pwrite(descriptor, &header, sizeof(header), 0) ==
+                static_cast<ssize_t>(sizeof(header)) &&
+            ::ftruncate(descriptor, static_cast<off_t>(length)) == 0) {
+            mapped = Map(descriptor, length, header, MapMode::ReadWrite);
+        }
+        ::close(descriptor);
+        return mapped;
+#else
+        (void)path;
+        (void)rows;
+        (void)columns;
+        return std::nullopt;
+#endif
+    }
+
+    // Writes matrix, in any layout, to a new file at path
+    static std::optional<MappedMatrix<T>> Save(
+        const std::filesystem::path &path, const Matrix<T> &matrix) {
+        std::optional<MappedMatrix<T>> mapped{
+            Create(path, matrix.Height(), matrix.Width())};
+        if (mapped.has_value()) {
+            const MatrixView<const T> view{matrix.View()};
+            T *entries{mapped->data_};
+            const std::size_t width{matrix.Width()};
+            ParallelFor(matrix.Height(), GetThreadCount(),
+                        [&](std::size_t row) {
+                            for (std::size_t column{0}; column < width;
+                                 column++) {
+                                entries[(row * width) + column] =
+                                    view(row, column);
+                            }
+                        });
+        }
+        return mapped;
+    }
+
+    std::size_t Height() const noexcept { return height_; }
+    std::size_t Width() const noexcept { return width_; }
+    std::size_t Size() const noexcept { return height_ * width_; }
+    MapMode Mode() const noexcept { return mode_; }
+    const T *Data() const noexcept { return data_; }
+
+    MatrixView<const T> View() const noexcept {
+        return {data_, height_, width_, width_, 1};
+    }
+
+    std::optional<T> At(std::size_t row, std::size_t column) const noexcept {
+        if (row >= height_ || column >= width_) {
+            return std::nullopt;
+        } else {
+            return data_[(row * width_) + column];
+        }
+    }
+
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t> Set(
+        std::size_t row, std::size_t column, const T &value) noexcept {
+        if (row >= height_ || column >= width_ ||
+            mode_ == MapMode::ReadOnly) {
+            return std::nullopt;
+        } else {
+            data_[(row * width_) + column] = value;
+            return 0;
+        }
+    }
+
+    // Copies the whole matrix into memory
+    Matrix<T> ToMatrix() const {
+        Matrix<T> matrix{Matrix<T>::New(height_, width_).value()};
+        T *destination{matrix.Data()};
+        ForEachTile({}, [&](std::size_t first, std::size_t last) {
+            std::copy(data_ + (first * width_), data_ + (last * width_),
+                      destination + (first * width_));
+        });
+        return matrix;
+    }
+
+    /**
+     * @brief Writes a MapMode::ReadWrite mapping back to its file and waits
+     *        for the disk
+     *
+     * @return std::nullopt for other modes or if the write fails
+     */
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    Flush() noexcept {
+#if defined(__linux__)
+        if (mode_ == MapMode::ReadWrite &&
+            ::msync(base_, length_, MS_SYNC) == 0) {
+            return 0;
+        }
+#endif
+        return std::nullopt;
+    }
+
+    /* ********************************************************************** */
+    /*                               Reductions                               */
+    /* ********************************************************************** */
+
+    Column<T> Sum(Axis axis) const { return Column<T>{SumOver(axis), "sum"}; }
+
+    // std::nullopt when there is nothing to average
+    std::optional<Column<T>> Mean(Axis axis) const {
+        const std::size_t count{ReducedCount(axis)};
+        if (count == 0) {
+            return std::nullopt;
+        }
+        std::vector<T> means{SumOver(axis)};
+        for (T &mean : means) {
+            mean /= static_cast<T>(count);
+        }
+        return std::make_optional<Column<T>>(means, "mean");
+    }
+
+    // Smallest entry; std::nullopt when there is nothing to compare
+    std::optional<Column<T>> Min(Axis axis) const {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(ExtremumOver<false>(axis),
+                                                 "min");
+        }
+    }
+
+    std::optional<Column<T>> Max(Axis axis) const {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(ExtremumOver<true>(axis),
+                                                 "max");
+        }
+    }
+
+    /* ********************************************************************** */
+    /*                          Compound Assignment                           */
+    /* ********************************************************************** */
+
+    // Fail on a read-only map or a shape mismatch
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    operator+=(const MappedMatrix<T> &rhs) {
+        return UpdateWith(rhs, [](T &entry, const T &other) PPP_ALWAYS_INLINE {
+            entry += other;
+        });
+    }
+
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    operator-=(const MappedMatrix<T> &rhs) {
+        return UpdateWith(rhs, [](T &entry, const T &other) PPP_ALWAYS_INLINE {
+            entry -= other;
+        });
+    }
+
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    operator*=(const T &scalar) {
+        if (mode_ == MapMode::ReadOnly) {
+            return std::nullopt;
+        }
+        ForEachTile({}, [&](std::size_t first, std::size_t last) {
+            T *entries{data_ + (first * width_)};
+            detail::ParallelChunks((last - first) * width_,
+                                   [&](std::size_t begin, std::size_t end) {
+                                       for (std::size_t i{begin}; i < end;
+                                            i++) {
+                                           entries[i] *= scalar;
+                                       }
+                                   });
+        });
+        return 0;
+    }
+
+    template <MappedEntry V, class Op>
+    friend std::optional<MappedMatrix<V>> MappedElementWise(
+        const MappedMatrix<V> &lhs, const MappedMatrix<V> &rhs,
+        const std::filesystem::path &path, const Op &op);
+
+    template <MappedEntry V>
+    friend std::optional<MappedMatrix<V>> Multiply(
+        const MappedMatrix<V> &lhs, MatrixView<const V> rhs,
+        const std::filesystem::path &path);
+
+ private:
+    MappedMatrix(std::byte *base, std::size_t length, std::size_t height,
+                 std::size_t width, MapMode mode, std::size_t offset) noexcept
+        : base_{base},
+          length_{length},
+          height_{height},
+          width_{width},
+          mode_{mode},
+          data_{reinterpret_cast<T *>(base + offset)} {}
+
+    static bool ValidHeader(const detail::MappedHeader &header,
+                            std::size_t file_size) noexcept {
+        if (std::memcmp(header.magic, detail::MAPPED_MAGIC,
+                        sizeof(header.magic)) != 0 ||
+            header.version != detail::MAPPED_VERSION ||
+            header.dtype != detail::MappedDtype<T>() ||
+            header.data_offset < sizeof(header) ||
+            header.data_offset % alignof(T) != 0 ||
+            header.data_offset > file_size) {
+            return false;
+        }
+        const std::size_t available{(file_size - header.data_offset) /
+                                    sizeof(T)};
+        return header.columns == 0 ||
+               (header.rows <= available / header.columns);
+    }
+
+#if defined(__linux__)
+    static std::optional<MappedMatrix<T>> Map(
+        int descriptor, std::size_t length,
+        const detail::MappedHeader &header, MapMode mode) {
+        const int protection{mode == MapMode::ReadOnly
+                                 ? PROT_READ
+                                 : PROT_READ | PROT_WRITE};
+        const int flags{mode == MapMode::CopyOnWrite ? MAP_PRIVATE
+                                                     : MAP_SHARED};
+        void *base{::mmap(nullptr, length, protection, flags, descriptor, 0)};
+        if (base == MAP_FAILED) {
+            return std::nullopt;
+        }
+        return MappedMatrix<T>{static_cast<std::byte *>(base),
+                               length,
+                               header.rows,
+                               header.columns,
+                               mode,
+                               header.data_offset};
+    }
+#endif
+
+    void Unmap() noexcept {
+#if defined(__linux__)
+        if (base_ != nullptr) {
+            ::munmap(base_, length_);
+        }
+#endif
+        base_ = nullptr;
+        data_ = nullptr;
+    }
+
+    detail::MappedRows Rows() const noexcept {
+        return {reinterpret_cast<const std::byte *>(data_),
+                width_ * sizeof(T), mode_ != MapMode::CopyOnWrite};
+    }
+
+    // ForEachRowTile over this matrix and others, all height_ rows tall
+    template <class Body>
+    void ForEachTile(std::initializer_list<detail::MappedRows> others,
+                     const Body &body) const {
+        std::vector<detail::MappedRows> operands{Rows()};
+        operands.insert(operands.end(), others.begin(), others.end());
+        detail::ForEachRowTile(height_, operands, body);
+    }
+
+    template <class Op>
+    std::optional<std::uint8_t> UpdateWith(const MappedMatrix<T> &rhs,
+                                           const Op &op) {
+        if (mode_ == MapMode::ReadOnly || rhs.height_ != height_ ||
+            rhs.width_ != width_) {
+            return std::nullopt;
+        }
+        ForEachTile({rhs.Rows()}, [&](std::size_t first, std::size_t last) {
+            T *entries{data_ + (first * width_)};
+            const T *others{rhs.data_ + (first * width_)};
+            detail::ParallelChunks((last - first) * width_,
+                                   [&](std::size_t begin, std::size_t end) {
+                                       for (std::size_t i{begin}; i < end;
+                                            i++) {
+                                           op(entries[i], others[i]);
+                                       }
+                                   });
+        });
+        return 0;
+    }
+
+    std::size_t ReducedCount(Axis axis) const noexcept {
+        return axis == Axis::Row      ? width_
+               : axis == Axis::Column ? height_
+                                      : Size();
+    }
+
+    std::vector<T> SumOver(Axis axis) const {
+        const auto entry{[](const T &value, std::size_t) PPP_ALWAYS_INLINE {
+            return value;
+        }};
+        const std::size_t threads{GetThreadCount()};
+        std::vector<T> sums(axis == Axis::Row      ? height_
+                            : axis == Axis::Column ? width_
+                                                   : 1,
+                            T(0));
+        ForEachTile({}, [&](std::size_t first, std::size_t last) {
+            const T *tile{data_ + (first * width_)};
+            const std::size_t rows{last - first};
+            if (axis == Axis::Row) {
+                const std::vector<T> partial{
+                    detail::SumAlong(tile, rows, width_, width_, threads,
+                                     entry)};
+                std::copy(partial.begin(), partial.end(),
+                          sums.begin() + first);
+            } else if (axis == Axis::Column) {
+                const std::vector<T> partial{
+                    detail::SumAcross(tile, rows, width_, width_, threads,
+                                      entry, detail::ReduceChunk())};
+                for (std::size_t column{0}; column < width_; column++) {
+                    sums[column] += partial[column];
+                }
+            } else {
+                sums[0] += detail::SumAlong(tile, 1, rows * width_, 0,
+                                            threads, entry)[0];
+            }
+        });
+        return sums;
+    }
+
+    // Extremum of each result's entries; later tiles only win when strictly
+    // better, as in the in-memory reductions
+    template <bool Greatest>
+    std::vector<T> ExtremumOver(Axis axis) const {
+        const std::size_t threads{GetThreadCount()};
+        std::vector<T> best{};
+        ForEachTile({}, [&](std::size_t first, std::size_t last) {
+            const T *tile{data_ + (first * width_)};
+            const std::size_t rows{last - first};
+            if (axis == Axis::Row) {
+                for (const auto &[value, index] :
+                     detail::ExtremumAlong<Greatest>(tile, rows, width_,
+                                                     width_, threads)) {
+                    best.push_back(value);
+                }
+                return;
+            }
+            const std::vector<T> partial{
+                axis == Axis::Column
+                    ? detail::ExtremumAcross<Greatest>(tile, rows, width_,
+                                                       width_, threads,
+                                                       detail::ReduceChunk())
+                          .first
+                    : std::vector<T>{detail::ExtremumAlong<Greatest>(
+                          tile, 1, rows * width_, 0, threads)[0]
+                                         .first}};
+            if (best.empty()) {
+                best = partial;
+                return;
+            }
+            for (std::size_t i{0}; i < best.size(); i++) {
+                if (detail::Better<Greatest>(partial[i], best[i])) {
+                    best[i] = partial[i];
+                }
+            }
+        });
+        return best;
+    }
+
+    std::byte *base_;
+    std::size_t length_;
+    std::size_t height_;
+    std::size_t width_;
+    MapMode mode_;
+    T *data_;
+};  // class MappedMatrix
+
+/**
+ * @brief op(lhs entry, rhs entry) for every entry, written tile by tile to a
+ *        new matrix file at path
+ */
+template <MappedEntry V, class Op>
+std::optional<MappedMatrix<V>> MappedElementWise(
+    const MappedMatrix<V> &lhs, const MappedMatrix<V> &rhs,
+    const std::filesystem::path &path, const Op &op) {
+    if (lhs.Height() != rhs.Height() || lhs.Width() != rhs.Width()) {
+        return std::nullopt;
+    }
+    std::optional<MappedMatrix<V>> result{
+        MappedMatrix<V>::Create(path, lhs.Height(), lhs.Width())};
+    if (!result.has_value()) {
+        return std::nullopt;
+    }
+    const std::size_t width{lhs.Width()};
+    V *destination{result->data_};
+    detail::ForEachRowTile(
+        lhs.Height(), {lhs.Rows(), rhs.Rows(), result->Rows()},
+        [&](std::size_t first, std::size_t last) {
+            const std::size_t offset{first * width};
+            detail::ParallelChunks(
+                (last - first) * width,
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i{offset + begin}; i < offset + end;
+                         i++) {
+                        destination[i] = op(lhs.data_[i], rhs.data_[i]);
+                    }
+                });
+        });
+    return result;
+}
+
+// lhs + rhs into a new matrix file at path
+template <MappedEntry V>
+std::optional<MappedMatrix<V>> Add(const MappedMatrix<V> &lhs,
+                                   const MappedMatrix<V> &rhs,
+                                   const std::filesystem::path &path) {
+    return MappedElementWise(lhs, rhs, path,
+                             [](const V &left, const V &right)
+                                 PPP_ALWAYS_INLINE { return left + right; });
+}
+
+template <MappedEntry V>
+std::optional<MappedMatrix<V>> Subtract(const MappedMatrix<V> &lhs,
+                                        const MappedMatrix<V> &rhs,
+                                        const std::filesystem::path &path) {
+    return MappedElementWise(lhs, rhs, path,
+                             [](const V &left, const V &right)
+                                 PPP_ALWAYS_INLINE { return left - right; });
+}
+
+/**
+ * @brief lhs * rhs into a new matrix file at path
+ *
+ * lhs is streamed in row panels of about GetMappedTileBytes(), each multiplied
+ * by all of rhs with one parallel GEMM into the matching rows of the result,
+ * so only rhs has to be resident throughout.
+ */
+template <MappedEntry V>
+std::optional<MappedMatrix<V>> Multiply(const MappedMatrix<V> &lhs,
+                                        MatrixView<const V> rhs,
+                                        const std::filesystem::path &path) {
+    if (lhs.Width() != rhs.Height()) {
+        return std::nullopt;
+    }
+    std::optional<MappedMatrix<V>> result{
+        MappedMatrix<V>::Create(path, lhs.Height(), rhs.Width())};
+    if (!result.has_value() || lhs.Width() == 0 || rhs.Width() == 0) {
+        return result;
+    }
+    const std::size_t depth{lhs.Width()};
+    const std::size_t width{rhs.Width()};
+    V *destination{result->data_};
+    detail::ForEachRowTile(
+        lhs.Height(), {lhs.Rows(), result->Rows()},
+        [&](std::size_t first, std::size_t last) {
+            detail::ParallelGemm<V>(
+                last - first, width, depth, V(1),
+                {lhs.data_ + (first * depth), depth, 1}, rhs.Strided(), V(0),
+                {destination + (first * width), width, 1}, GetThreadCount());
+        });
+    return result;
+}
+
+template <MappedEntry V>
+std::optional<MappedMatrix<V>> Multiply(const MappedMatrix<V> &lhs,
+                                        const MappedMatrix<V> &rhs,
+                                        const std::filesystem::path &path) {
+    return Multiply(lhs, rhs.View(), path);
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_MAPPED_HPP_
@@ -0,0 +1,562 @@
+/*
+ *  Math.hpp
+ *  Vectorized element-wise exp, log, sqrt, tanh, sigmoid and pow
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_MATH_HPP_
+#define PPP_PPP_MATH_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "Reduce.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+/*
+ * How the element-wise math functions are evaluated. Fast runs polynomial
+ * kernels vectorized for AVX2 or AVX-512 on float and double, with these
+ * worst errors against the exact result over the normal range:
+ *
+ *              float     double
+ *     Exp      1 ULP     1 ULP
+ *     Log      1.5 ULP   1.5 ULP
+ *     Sqrt     0.5 ULP   0.5 ULP   (correctly rounded)
+ *     Tanh     3 ULP     3 ULP
+ *     Sigmoid  3 ULP     3 ULP
+ *     Pow      1 ULP     1.5 ULP   (double: up to 10 ULP once |y log(x)|
+ *                                   passes 100, near overflow)
+ *
+ * Subnormal results are rounded twice and may be off by one more unit.
+ * Special values (NaN, infinities, zeros, negative bases) follow the C
+ * library. Exact calls the C library for every entry, as does Fast for
+ * complex entries or on CPUs without AVX2.
+ */
+enum class MathPrecision : std::uint8_t {
+    Fast,
+    Exact,
+};
+
+template <class T>
+concept Transcendental =
+    std::floating_point<T> ||
+    (std::same_as<T, std::complex<typename T::value_type>> &&
+     std::floating_point<typename T::value_type>);
+
+namespace detail {
+
+// Entries per parallel task
+constexpr std::size_t MATH_BLOCK{1 << 12};
+
+// Float Pow operands widened to double at a time
+constexpr std::size_t POW_CHUNK{256};
+
+enum class MathOp : std::uint8_t {
+    Exp,
+    Log,
+    Sqrt,
+    Tanh,
+    Sigmoid,
+    Pow,
+};
+
+template <class T>
+concept VectorMath = std::same_as<T, float> || std::same_as<T, double>;
+
+template <class T>
+struct MathTraits;
+
+template <>
+struct MathTraits<float> {
+    using Bits = std::int32_t;
+    static constexpr int MANTISSA{23};
+    static constexpr Bits BIAS{127};
+    // Adding this rounds anything below 2^22 in magnitude to an integer
+    static constexpr float ROUND{0x1.8p23f};
+    static constexpr float LOG2E{0x1.715476p0f};
+    // ln(2) split so that k * LN2_HI is exact for every exponent k
+    static constexpr float LN2_HI{0x1.62e4p-1f};
+    static constexpr float LN2_LO{0x1.7f7d1cp-20f};
+    // exp overflows above EXP_MAX and rounds to zero below EXP_MIN
+    static constexpr float EXP_MAX{0x1.62e42ep6f};
+    static constexpr float EXP_MIN{-0x1.9fe368p6f};
+    // tanh rounds to +-1 beyond this
+    static constexpr float TANH_LIMIT{9.1f};
+    // 1/k!, highest order first, for exp on [-ln(2)/2, ln(2)/2]
+    static constexpr float EXP[]{
+        1.0f / 5040, 1.0f / 720, 1.0f / 120, 1.0f / 24,
+        1.0f / 6,    1.0f / 2,   1.0f,       1.0f,
+    };
+    // 2 / (2k + 1), highest order first, for log1p(f) = 2 atanh(f / (2 + f))
+    static constexpr float LOG[]{
+        2.0f / 11, 2.0f / 9, 2.0f / 7, 2.0f / 5, 2.0f / 3,
+    };
+    // Pow evaluates float operands in double, about 2^-32 accurate
+    static constexpr double WIDE_EXP[]{
+        1.0 / 40320, 1.0 / 5040, 1.0 / 720, 1.0 / 120, 1.0 / 24,
+        1.0 / 6,     1.0 / 2,    1.0,       1.0,
+    };
+    static constexpr double WIDE_LOG[]{
+        2.0 / 13, 2.0 / 11, 2.0 / 9, 2.0 / 7, 2.0 / 5, 2.0 / 3,
+    };
+};
+
+template <>
+struct MathTraits<double> {
+    using Bits = std::int64_t;
+    static constexpr int MANTISSA{52};
+    static constexpr Bits BIAS{1023};
+    static constexpr double ROUND{0x1.8p52};
+    static constexpr double LOG2E{0x1.71547652b82fep0};
+    static constexpr double LN2_HI{0x1.62e42fee00000p-1};
+    static constexpr double LN2_LO{0x1.a39ef35793c76p-33};
+    static constexpr double EXP_MAX{0x1.62e42fefa39efp9};
+    static constexpr double EXP_MIN{-0x1.74910d52d3052p9};
+    static constexpr double TANH_LIMIT{19.1};
+    static constexpr double EXP[]{
+        1.0 / 6227020800, 1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800,
+        1.0 / 362880,     1.0 / 40320,     1.0 / 5040,     1.0 / 720,
+        1.0 / 120,        1.0 / 24,        1.0 / 6,        1.0 / 2,
+        1.0,              1.0,
+    };
+    // Minimax replacement for the atanh series (from fdlibm's e_log.c)
+    static constexpr double LOG[]{
+        1.479819860511658591e-01, 1.531383769920937332e-01,
+        1.818357216161805012e-01, 2.222219843214978396e-01,
+        2.857142874366239149e-01, 3.999999999940941908e-01,
+        6.666666666666735130e-01,
+    };
+};
+
+template <VectorMath T, std::size_t N>
+PPP_ALWAYS_INLINE constexpr T Horner(T x,
+                                     const T (&coefficients)[N]) noexcept {
+    T result{coefficients[0]};
+    PPP_UNROLL(16)
+    for (std::size_t i{1}; i < N; i++) {
+        result = (result * x) + coefficients[i];
+    }
+    return result;
+}
+
+// 2^k for k in [1 - BIAS, BIAS]
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T Pow2(typename MathTraits<T>::Bits k) noexcept {
+    using Traits = MathTraits<T>;
+    return std::bit_cast<T>((k + Traits::BIAS) << Traits::MANTISSA);
+}
+
+// x = k ln(2) + r with |r| <= ln(2) / 2, for |x| below EXP_MAX
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T ReduceExp(T x,
+                                     typename MathTraits<T>::Bits &k) noexcept {
+    using Traits = MathTraits<T>;
+    const T shifted{(x * Traits::LOG2E) + Traits::ROUND};
+    const T n{shifted - Traits::ROUND};
+    k = std::bit_cast<typename Traits::Bits>(shifted) -
+        std::bit_cast<typename Traits::Bits>(Traits::ROUND);
+    return (x - (n * Traits::LN2_HI)) - (n * Traits::LN2_LO);
+}
+
+// exp(x + low) for a small correction low, taking exp on the reduced
+// argument from series
+template <VectorMath T, std::size_t N>
+PPP_ALWAYS_INLINE inline T ExpSeries(T x, T low,
+                                     const T (&series)[N]) noexcept {
+    using Traits = MathTraits<T>;
+    using Bits = typename Traits::Bits;
+    Bits k{};
+    const T r{ReduceExp(std::clamp(x, Traits::EXP_MIN, Traits::EXP_MAX), k) +
+              low};
+    // 2^k is applied in two halves so subnormal results scale correctly
+    const Bits half{k >> 1};
+    const T result{Horner(r, series) * Pow2<T>(half) * Pow2<T>(k - half)};
+    return x > Traits::EXP_MAX   ? std::numeric_limits<T>::infinity()
+           : x < Traits::EXP_MIN ? T{0}
+                                 : result;
+}
+
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T FastExp(T x) noexcept {
+    return ExpSeries(x, T{0}, MathTraits<T>::EXP);
+}
+
+// exp(x) - 1 without cancellation near zero, for |x| <= 2 TANH_LIMIT
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T FastExpM1(T x) noexcept {
+    using Traits = MathTraits<T>;
+    typename Traits::Bits k{};
+    const T r{ReduceExp(x, k)};
+    // exp(r) - 1 = r + r^2 (1/2 + r/6 + ...)
+    constexpr std::size_t ORDER{std::size(Traits::EXP) - 2};
+    T tail{Traits::EXP[0]};
+    PPP_UNROLL(16)
+    for (std::size_t i{1}; i < ORDER; i++) {
+        tail = (tail * r) + Traits::EXP[i];
+    }
+    const T small{r + (r * r * tail)};
+    const T scale{Pow2<T>(k)};
+    return k == 0 ? small : (scale * small) + (scale - T{1});
+}
+
+/*
+ * x = 2^k (1 + f) with 1 + f in [sqrt(1/2), sqrt(2)), and the pieces of
+ *
+ *     log1p(f) = f - hfsq + s (hfsq + series),  s = f / (2 + f)
+ *
+ * kept apart so that Pow can recover the bits lost rounding their sum.
+ */
+template <VectorMath T>
+struct LogParts {
+    T k;
+    T f;
+    T s;
+    T hfsq;
+    T series;
+};
+
+template <VectorMath T, std::size_t N>
+PPP_ALWAYS_INLINE inline LogParts<T> SplitLog(T x,
+                                              const T (&series)[N]) noexcept {
+    using Traits = MathTraits<T>;
+    using Bits = typename Traits::Bits;
+    constexpr Bits SQRT_HALF{std::bit_cast<Bits>(T{0.70710678118654752440})};
+    constexpr Bits MANTISSA_MASK{(Bits{1} << Traits::MANTISSA) - 1};
+    constexpr T SUBNORMAL_SCALE{T(Bits{1} << Traits::MANTISSA)};
+
+    const bool subnormal{x < std::numeric_limits<T>::min()};
+    const T normal{subnormal ? x * SUBNORMAL_SCALE : x};
+    const Bits offset{std::bit_cast<Bits>(normal) - SQRT_HALF};
+    const Bits exponent{(offset >> Traits::MANTISSA) -
+                        (subnormal ? Traits::MANTISSA : 0)};
+    const T f{std::bit_cast<T>((offset & MANTISSA_MASK) + SQRT_HALF) - T{1}};
+    const T s{f / (T{2} + f)};
+    const T z{s * s};
+    // k goes through ROUND: AVX2 has no int64 to double conversion
+    return {std::bit_cast<T>(exponent + std::bit_cast<Bits>(Traits::ROUND)) -
+                Traits::ROUND,
+            f, s, T{0.5} * f * f, z * Horner(z, series)};
+}
+
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T FastLog(T x) noexcept {
+    using Traits = MathTraits<T>;
+    using Limits = std::numeric_limits<T>;
+    const LogParts<T> parts{SplitLog(x, Traits::LOG)};
+    const T tail{parts.s * (parts.hfsq + parts.series)};
+    const T result{(parts.k * Traits::LN2_HI) +
+                   ((parts.f - parts.hfsq) +
+                    (tail + (parts.k * Traits::LN2_LO)))};
+    return !(x >= T{0})              ? Limits::quiet_NaN()
+           : x == T{0}               ? -Limits::infinity()
+           : x == Limits::infinity() ? x
+                                     : result;
+}
+
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T FastTanh(T x) noexcept {
+    const T magnitude{std::abs(x)};
+    const T grown{FastExpM1(T{2} * std::min(magnitude,
+                                            MathTraits<T>::TANH_LIMIT))};
+    const T result{magnitude > MathTraits<T>::TANH_LIMIT
+                       ? T{1}
+                       : grown / (grown + T{2})};
+    return std::copysign(result, x);
+}
+
+// Both halves divide by 1 + exp(-|x|), so neither tail cancels
+template <VectorMath T>
+PPP_ALWAYS_INLINE inline T FastSigmoid(T x) noexcept {
+    const T decay{FastExp(-std::abs(x))};
+    const T result{T{1} / (T{1} + decay)};
+    return x >= T{0} ? result : decay * result;
+}
+
+// exp(y log(x)) for finite x > 0 and finite y; anything else is left to
+// std::pow by the caller
+PPP_ALWAYS_INLINE inline double FastPow(double x, double y) noexcept {
+    using Traits = MathTraits<double>;
+    const auto [k, f, s, hfsq, series]{SplitLog(x, Traits::LOG)};
+
+    // What rounding f / (2 + f), f * f / 2 and the tail products dropped
+    const double divisor{2.0 + f};
+    const double s_low{
+        (std::fma(-s, divisor, f) - (s * ((2.0 - divisor) + f))) / divisor};
+    const double hfsq_low{std::fma(0.5 * f, f, -hfsq)};
+    const double sum{hfsq + series};
+    const double sum_low{((hfsq - sum) + series) + hfsq_low};
+    const double tail{s * sum};
+    // d(tail) / ds, taking series as (2/3) s^2
+    const double tail_low{std::fma(s, sum, -tail) + (s * sum_low) +
+                          (s_low * (hfsq + (3.0 * series)))};
+
+    // log(x) as the unevaluated sum log + low. Each partial sum is larger
+    // than what it absorbs, so Fast2Sum recovers its rounding error exactly.
+    const double leading{f - hfsq};
+    const double exponent{k * Traits::LN2_HI};
+    const double head{exponent + leading};
+    const double high{head + tail};
+    const double rest{((exponent - head) + leading) + ((head - high) + tail) +
+                      (((f - leading) - hfsq) - hfsq_low) + tail_low +
+                      (k * Traits::LN2_LO)};
+    const double log{high + rest};
+    const double low{(high - log) + rest};
+
+    const double product{y * log};
+    return ExpSeries(product, std::fma(y, log, -product) + (y * low),
+                     Traits::EXP);
+}
+
+// pow for float operands, widened: float accuracy series evaluated in double
+// leave an error near 2^-30, well under half a float ULP
+PPP_ALWAYS_INLINE inline double WidePow(double x, double y) noexcept {
+    using Traits = MathTraits<double>;
+    const auto [k, f, s, hfsq, series]{
+        SplitLog(x, MathTraits<float>::WIDE_LOG)};
+    const double log{(k * Traits::LN2_HI) +
+                     ((f - hfsq) + ((s * (hfsq + series)) +
+                                    (k * Traits::LN2_LO)))};
+    return ExpSeries(y * log, 0.0, MathTraits<float>::WIDE_EXP);
+}
+
+template <Transcendental T>
+T ExactMath(MathOp op, const T &x, const T &y) {
+    switch (op) {
+        case MathOp::Exp:
+            return std::exp(x);
+        case MathOp::Log:
+            return std::log(x);
+        case MathOp::Sqrt:
+            return std::sqrt(x);
+        case MathOp::Tanh:
+            return std::tanh(x);
+        case MathOp::Sigmoid:
+            return T{1} / (T{1} + std::exp(-x));
+        case MathOp::Pow:
+            return std::pow(x, y);
+    }
+    return x;
+}
+
+#ifdef PPP_SIMD_X86
+// std::sqrt does not vectorize while it may have to set errno
+template <VectorMath T>
+PPP_TARGET_AVX2 void SqrtAvx2(const T *input, T *output, std::size_t count) {
+    std::size_t i{0};
+    if constexpr (std::same_as<T, float>) {
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(output + i,
+                             _mm256_sqrt_ps(_mm256_loadu_ps(input + i)));
+        }
+    } else {
+        for (; i + 4 <= count; i += 4) {
+            _mm256_storeu_pd(output + i,
+                             _mm256_sqrt_pd(_mm256_loadu_pd(input + i)));
+        }
+    }
+    for (; i < count; i++) {
+        output[i] = std::sqrt(input[i]);
+    }
+}
+
+template <VectorMath T>
+PPP_TARGET_AVX512 void SqrtAvx512(const T *input, T *output,
+                                  std::size_t count) {
+    // The full-mask maskz forms give the builtin a zeroed pass-through
+    // register; _mm512_sqrt_* passes an undefined one, which GCC flags
+    std::size_t i{0};
+    if constexpr (std::same_as<T, float>) {
+        constexpr __mmask16 all{0xFFFF};
+        for (; i + 16 <= count; i += 16) {
+            _mm512_storeu_ps(output + i, _mm512_maskz_sqrt_ps(
+                                             all, _mm512_loadu_ps(input + i)));
+        }
+    } else {
+        constexpr __mmask8 all{0xFF};
+        for (; i + 8 <= count; i += 8) {
+            _mm512_storeu_pd(output + i, _mm512_maskz_sqrt_pd(
+                                             all, _mm512_loadu_pd(input + i)));
+        }
+    }
+    for (; i < count; i++) {
+        output[i] = std::sqrt(input[i]);
+    }
+}
+#endif  // PPP_SIMD_X86
+
+// Runs body compiled for AVX-512 or AVX2; false if neither is available
+template <class Body>
+bool RunVectorized([[maybe_unused]] const Body &body) {
+#ifdef PPP_SIMD_X86
+    if (HasAvx512()) {
+        RunAvx512(body);
+        return true;
+    } else if (HasAvx2()) {
+        RunAvx2(body);
+        return true;
+    }
+#endif  // PPP_SIMD_X86
+    return false;
+}
+
+template <VectorMath T>
+bool FastMath(MathOp op, const T *x, const T *y, std::size_t y_step,
+              T *output, std::size_t count) {
+#ifdef PPP_SIMD_X86
+    if (op == MathOp::Sqrt) {
+        if (HasAvx512()) {
+            SqrtAvx512(x, output, count);
+            return true;
+        } else if (HasAvx2()) {
+            SqrtAvx2(x, output, count);
+            return true;
+        }
+        return false;
+    }
+#endif  // PPP_SIMD_X86
+
+    const auto sweep{[&](const auto &kernel) PPP_ALWAYS_INLINE {
+        return RunVectorized([&]() PPP_ALWAYS_INLINE {
+            for (std::size_t i{0}; i < count; i++) {
+                output[i] = kernel(x[i]);
+            }
+        });
+    }};
+
+    switch (op) {
+        case MathOp::Exp:
+            return sweep([](T value) PPP_ALWAYS_INLINE {
+                return FastExp(value);
+            });
+        case MathOp::Log:
+            return sweep([](T value) PPP_ALWAYS_INLINE {
+                return FastLog(value);
+            });
+        case MathOp::Tanh:
+            return sweep([](T value) PPP_ALWAYS_INLINE {
+                return FastTanh(value);
+            });
+        case MathOp::Sigmoid:
+            return sweep([](T value) PPP_ALWAYS_INLINE {
+                return FastSigmoid(value);
+            });
+        case MathOp::Pow:
+            break;
+        default:
+            return false;
+    }
+
+    // Zero, negative or non-finite bases and non-finite exponents are left
+    // to std::pow afterwards. Bitwise ors keep the test free of branches.
+    const auto unusual{[](T base, T exponent) PPP_ALWAYS_INLINE {
+        constexpr T INFINITE{std::numeric_limits<T>::infinity()};
+        return static_cast<std::size_t>(!(base > T{0}) | !(base < INFINITE) |
+                                        !(std::abs(exponent) < INFINITE));
+    }};
+    std::size_t unusual_count{0};
+    const auto pow_sweep{[&](const auto &exponent) PPP_ALWAYS_INLINE {
+        return RunVectorized([&]() PPP_ALWAYS_INLINE {
+            std::size_t found{0};
+            if constexpr (std::same_as<T, float>) {
+                // Mixing float and double in one loop defeats if-conversion,
+                // so the operands are widened through scratch first
+                double bases[POW_CHUNK];
+                double exponents[POW_CHUNK];
+                for (std::size_t first{0}; first < count; first += POW_CHUNK) {
+                    const std::size_t length{
+                        std::min(POW_CHUNK, count - first)};
+                    for (std::size_t i{0}; i < length; i++) {
+                        bases[i] = x[first + i];
+                        exponents[i] = exponent(first + i);
+                        found += unusual(x[first + i], exponent(first + i));
+                    }
+                    for (std::size_t i{0}; i < length; i++) {
+                        bases[i] = WidePow(bases[i], exponents[i]);
+                    }
+                    for (std::size_t i{0}; i < length; i++) {
+                        output[first + i] = static_cast<float>(bases[i]);
+                    }
+                }
+            } else {
+                for (std::size_t i{0}; i < count; i++) {
+                    output[i] = FastPow(x[i], exponent(i));
+                    found += unusual(x[i], exponent(i));
+                }
+            }
+            unusual_count = found;
+        });
+    }};
+
+    const bool vectorized{
+        y_step == 0
+            ? pow_sweep([value = *y](std::size_t) PPP_ALWAYS_INLINE {
+                  return value;
+              })
+            : pow_sweep([y](std::size_t i) PPP_ALWAYS_INLINE { return y[i]; })};
+    for (std::size_t i{0}; vectorized && unusual_count != 0 && i < count;
+         i++) {
+        if (unusual(x[i], y[i * y_step])) {
+            output[i] = std::pow(x[i], y[i * y_step]);
+        }
+    }
+    return vectorized;
+}
+
+/**
+ * @brief output[i] = op(x[i], y[i * y_step]) for i in [0, count), in blocks
+ *        spread over up to threads threads
+ *
+ * y is only read for MathOp::Pow, with a y_step of 1, or of 0 to broadcast
+ * *y. output must not overlap x or y.
+ */
+template <Transcendental T>
+void ElementwiseMath(MathOp op, const T *x, const T *y, std::size_t y_step,
+                     T *output, std::size_t count, std::size_t threads,
+                     MathPrecision precision) {
+    const std::size_t blocks{(count + MATH_BLOCK - 1) / MATH_BLOCK};
+    ParallelFor(blocks, std::min(threads, blocks), [&](std::size_t block) {
+        const std::size_t first{block * MATH_BLOCK};
+        const std::size_t length{std::min(MATH_BLOCK, count - first)};
+        const T *exponents{y == nullptr ? nullptr : y + (first * y_step)};
+        if constexpr (VectorMath<T>) {
+            if (precision == MathPrecision::Fast &&
+                FastMath(op, x + first, exponents, y_step, output + first,
+                         length)) {
+                return;
+            }
+        }
+        for (std::size_t i{0}; i < length; i++) {
+            output[first + i] =
+                ExactMath(op, x[first + i],
+                          exponents == nullptr ? T{} : exponents[i * y_step]);
+        }
+    });
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_MATH_HPP_
@@ -22,6 +22,7 @@
 #define PPP_PPP_MATRIX_HPP_
 
 #include <algorithm>
+#include <array>
 #include <cfloat>
 #include <cmath>
 #include <complex>
@@ -29,177 +30,1271 @@
 #include <cstddef>
 #include <cstdint>
 #include <execution>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
-#include <mutex>
+#include <numeric>
 #include <optional>
 #include <ostream>
-#include <ranges>
 #include <span>
 #include <string_view>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "Allocator.hpp"
+#include "Buffer.hpp"
 #include "Column.hpp"
+#include "Convolution.hpp"
+#include "Decomposition.hpp"
+#include "Gemm.hpp"
+#include "Math.hpp"
+#include "Reduce.hpp"
+#include "ThreadPool.hpp"
+#include "Transpose.hpp"
+#include "Triangular.hpp"
+#include "Tuning.hpp"
+#include "View.hpp"
 
 namespace ppp {
 constexpr std::uint8_t padding{5};
 
+// Below this many elements the cost of spinning up the parallel backend
+// outweighs the arithmetic, so whole-matrix sweeps stay on one thread
+constexpr std::size_t PARALLEL_THRESHOLD{1 << 15};
+
+/**
+ * @brief Benchmarks candidate tile sizes for multiply, transpose and the
+ *        reductions on this CPU, uses the fastest from now on and writes
+ *        them to the tuning cache
+ *
+ * Takes a few seconds, on one thread. Later processes on the same kind of
+ * CPU read the sizes from the cache instead; see SetTuningCachePath. Returns
+ * whether the cache was written.
+ */
+inline bool Tune() {
+    const std::array<std::pair<detail::TunedKernel, detail::TunedValues>, 5>
+        tuned{{{detail::TunedKernel::GemmFloat,
+                detail::TuneGemmBlocking<float>()},
+               {detail::TunedKernel::GemmDouble,
+                detail::TuneGemmBlocking<double>()},
+               {detail::TunedKernel::Transpose, detail::TuneTransposeTile()},
+               {detail::TunedKernel::Reduce, detail::TuneReduceChunk()},
+               {detail::TunedKernel::Convolution,
+                detail::TuneConvolution()}}};
+    return detail::SaveTunedValues(tuned);
+}
+
+enum class Layout : std::uint8_t {
+    RowMajor,
+    ColumnMajor,
+};
+
 template <BasicEntry T>
 class Matrix {
  public:
+    // Copy-on-write once shared, drawn from CurrentResource() when created
+    using Buffer = SharedBuffer<T>;
+
     ~Matrix() = default;
 
+    // Deep copy; Share() is the O(1) copy-on-write alternative
+    Matrix(const Matrix<T> &to_copy)
+        : height_{to_copy.height_},
+          width_{to_copy.width_},
+          layout_{to_copy.layout_},
+          row_stride_{to_copy.row_stride_},
+          column_stride_{to_copy.column_stride_},
+          data_{to_copy.data_.Clone()},
+          headers_{to_copy.headers_} {}
+
+    Matrix<T> &operator=(const Matrix<T> &to_copy) {
+        if (this != &to_copy) {
+            *this = Matrix<T>{to_copy};
+        }
+        return *this;
+    }
+
+    // Steals the buffer and leaves to_move as an empty 0x0 matrix
     Matrix(Matrix<T> &&to_move) noexcept
-        : data_mutex_{},
-          data_{to_move.data_},
-          headers_{to_move.headers_},
-          height_{to_move.height_},
-          width_{to_move.width_} {}
+        : height_{std::exchange(to_move.height_, 0)},
+          width_{std::exchange(to_move.width_, 0)},
+          layout_{to_move.layout_},
+          row_stride_{std::exchange(to_move.row_stride_, 0)},
+          column_stride_{std::exchange(to_move.column_stride_, 1)},
+          data_{std::move(to_move.data_)},
+          headers_{std::exchange(to_move.headers_, std::nullopt)} {}
 
+    Matrix<T> &operator=(Matrix<T> &&to_move) noexcept {
+        if (this != &to_move) {
+            height_ = std::exchange(to_move.height_, 0);
+            width_ = std::exchange(to_move.width_, 0);
+            layout_ = to_move.layout_;
+            row_stride_ = std::exchange(to_move.row_stride_, 0);
+            column_stride_ = std::exchange(to_move.column_stride_, 1);
+            data_ = std::move(to_move.data_);
+            headers_ = std::exchange(to_move.headers_, std::nullopt);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief O(1) copy that shares this matrix's entries until either side
+     *        writes, at which point the writer copies them
+     *
+     * Pointers and mutable views taken from either matrix before the share
+     * still see both; take them afterwards.
+     */
+    Matrix<T> Share() const noexcept {
+        Matrix<T> shared{};
+        shared.height_ = height_;
+        shared.width_ = width_;
+        shared.layout_ = layout_;
+        shared.row_stride_ = row_stride_;
+        shared.column_stride_ = column_stride_;
+        shared.data_ = data_;
+        shared.headers_ = headers_;
+        return shared;
+    }
+
+    // Whether a Share() of this matrix still refers to the same entries
+    bool Shared() const noexcept { return data_.References() > 1; }
+
+    /**
+     * @brief Determinant, read off a pivoted LU factorization
+     *
+     * Integer matrices are factored in double precision and rounded.
+     */
     std::optional<T> Det() const {
         if (height_ != width_) {
             return std::nullopt;
+        } else if constexpr (std::is_integral_v<T>) {
+            Matrix<double> real{Matrix<double>::New(height_, width_).value()};
+            for (std::size_t row{0}; row < height_; row++) {
+                for (std::size_t column{0}; column < width_; column++) {
+                    real.Data()[(row * width_) + column] =
+                        static_cast<double>(data_[Offset(row, column)]);
+                }
+            }
+            return static_cast<T>(std::llround(real.Det().value()));
         } else {
-            std::optional<std::pair<Matrix<T>>> lu_pair{LU()};
-            if (!lu_pair.has_value()) {
-                return std::nullopt;
-            } else {
-                const Matrix<T> &upper{lu_pair.value().second};
-                T det{0};
-                for (std::size_t row{0}; row < height_; row++) {
-                    det *= upper.data_[row][row];
+            Matrix<T> lu{ToLayout(Layout::RowMajor)};
+            std::vector<std::size_t> pivots(height_);
+            detail::LuFactor<T>(height_, lu.Strided(), pivots.data(),
+                                GetThreadCount());
+
+            T det{1};
+            for (std::size_t row{0}; row < height_; row++) {
+                det *= lu.data_[lu.Offset(row, row)];
+                if (pivots[row] != row) {
+                    det = -det;
                 }
-                return det;
             }
+            return det;
+        }
+    }
+
+    /**
+     * @brief Blocked LU factorization with partial pivoting, P * A = L * U
+     *
+     * @return The compact factorization (L strictly below the diagonal with an
+     *         implied unit diagonal, U on and above it) and the permutation:
+     *         row i of P * A is row permutation[i] of A. std::nullopt if the
+     *         matrix is not square. Singular matrices still factor, with a
+     *         zero somewhere on the diagonal of U. Integer matrices would
+     *         factor with truncating division, so they are rejected; convert
+     *         them to a floating point Matrix first, as Det() does.
+     */
+    std::optional<std::pair<Matrix<T>, std::vector<std::size_t>>> FactorLU()
+        const &
+        requires(!std::is_integral_v<T>)
+    {
+        if (height_ != width_) {
+            return std::nullopt;
+        } else {
+            return FactorInPlace(ToLayout(Layout::RowMajor));
+        }
+    }
+
+    // Factors a temporary in its own buffer instead of copying it first
+    std::optional<std::pair<Matrix<T>, std::vector<std::size_t>>> FactorLU()
+        &&
+        requires(!std::is_integral_v<T>)
+    {
+        if (height_ != width_) {
+            return std::nullopt;
+        } else {
+            return FactorInPlace(std::move(*this));
+        }
+    }
+
+    /**
+     * @brief Solves A * X = rhs for every column of rhs
+     *
+     * @return std::nullopt if A is not square, rhs has the wrong height or A
+     *         is singular
+     */
+    std::optional<Matrix<T>> Solve(const Matrix<T> &rhs) const
+        requires(!std::is_integral_v<T>)
+    {
+        if (height_ != width_ || rhs.height_ != height_) {
+            return std::nullopt;
+        }
+
+        Matrix<T> lu{ToLayout(Layout::RowMajor)};
+        std::vector<std::size_t> pivots(height_);
+        const std::size_t threads{GetThreadCount()};
+        if (!detail::LuFactor<T>(height_, lu.Strided(), pivots.data(),
+                                 threads)) {
+            return std::nullopt;
+        }
+
+        Matrix<T> solution{rhs.ToLayout(Layout::RowMajor)};
+        solution.headers_ = std::nullopt;
+        for (std::size_t row{0}; row < height_; row++) {
+            if (pivots[row] != row) {
+                detail::SwapRows(solution.width_, solution.Strided(), row,
+                                 pivots[row]);
+            }
+        }
+        const detail::StridedMatrix<const T> factors{
+            lu.data_.data(), lu.row_stride_, lu.column_stride_};
+        detail::Trsm<T>(height_, solution.width_, Triangle::Lower,
+                        Diagonal::Unit, factors, solution.Strided(), threads);
+        detail::Trsm<T>(height_, solution.width_, Triangle::Upper,
+                        Diagonal::NonUnit, factors, solution.Strided(),
+                        threads);
+        return std::make_optional<Matrix<T>>(std::move(solution));
+    }
+
+    /**
+     * @brief Matrix inverse, or std::nullopt if the matrix is singular or not
+     *        square
+     */
+    std::optional<Matrix<T>> Inverse() const
+        requires(!std::is_integral_v<T>)
+    {
+        Matrix<T> identity{height_, height_, Layout::RowMajor};
+        for (std::size_t row{0}; row < height_; row++) {
+            identity.data_[identity.Offset(row, row)] = T(1);
         }
+        return Solve(identity);
     }
 
+    // Unpivoted Doolittle factorization into separate L and U matrices. Prefer
+    // FactorLU(), which pivots and is blocked.
     std::optional<std::pair<Matrix<T>, Matrix<T>>> LU() const {
         if (height_ != width_) {
             return std::nullopt;
         } else {
-            std::vector<std::vector<T>> lower_data{
-                height_, std::vector<T>(width_, static_cast<T>(0))};
-            std::vector<std::vector<T>> upper_data{data_};
+            Matrix<T> lower{height_, width_, Layout::RowMajor};
+            Matrix<T> upper{ToLayout(Layout::RowMajor)};
 
             for (std::size_t row{0}; row < height_; row++) {
-                lower_data[row][row] = static_cast<T>(1);
+                lower.data_[row * width_ + row] = static_cast<T>(1);
             }
 
-            for (std::size_t column{0}; column < width_ - 1; column++) {
+            for (std::size_t column{0}; column + 1 < width_; column++) {
+                const T *pivot_row{upper.data_.data() + (column * width_)};
                 for (std::size_t row{column + 1}; row < height_; row++) {
-                    T multiplier =
-                        upper_data[row][column] / upper_data[column][column];
-                    lower_data[row][column] = multiplier;
-
-                    auto it{std::ranges::views::zip(upper_data[column],
-                                                    upper_data[row])};
-                    std::transform(std::execution::seq, it.begin(), it.end(),
-                                   upper_data[row].begin(),
-                                   [multiplier](const std::pair<T, T> vals) {
-                                       return (vals.first * multiplier * -1) +
-                                              vals.second;
-                                   });
+                    T *current_row{upper.data_.data() + (row * width_)};
+                    const T multiplier{current_row[column] /
+                                       pivot_row[column]};
+                    lower.data_[row * width_ + column] = multiplier;
+
+                    current_row[column] = static_cast<T>(0);
+                    for (std::size_t entry{column + 1}; entry < width_;
+                         entry++) {
+                        current_row[entry] -= multiplier * pivot_row[entry];
+                    }
+                }
+            }
+
+            return std::make_pair<Matrix<T>, Matrix<T>>(std::move(lower),
+                                                        std::move(upper));
+        }
+    }
+
+    /**
+     * @brief Solves T * X = rhs, where T is the triangle of this square
+     *        matrix selected by triangle; the other triangle is never read
+     *
+     * With Diagonal::Unit the diagonal is taken to be ones, so the unit lower
+     * factor of LU() can be passed as is. Blocked, with the off-diagonal work
+     * done by GEMM and the right hand sides split across threads.
+     *
+     * @return std::nullopt if the matrix is not square, rhs has the wrong
+     *         height or a non-unit diagonal holds a zero
+     */
+    std::optional<Matrix<T>> SolveTriangular(
+        const Matrix<T> &rhs, Triangle triangle,
+        Diagonal diagonal = Diagonal::NonUnit) const
+        requires(!std::is_integral_v<T>)
+    {
+        if (!TriangularConformable(rhs.height_) ||
+            (diagonal == Diagonal::NonUnit && !FullDiagonal())) {
+            return std::nullopt;
+        }
+        Matrix<T> solution{rhs.ToLayout(Layout::RowMajor)};
+        solution.headers_ = std::nullopt;
+        detail::Trsm<T>(height_, solution.width_, triangle, diagonal,
+                        Strided(), solution.Strided(), GetThreadCount());
+        return std::make_optional<Matrix<T>>(std::move(solution));
+    }
+
+    // SolveTriangular for a single right hand side
+    std::optional<Column<T>> SolveTriangular(
+        const Column<T> &rhs, Triangle triangle,
+        Diagonal diagonal = Diagonal::NonUnit) const
+        requires(!std::is_integral_v<T>)
+    {
+        if (!TriangularConformable(rhs.Size()) ||
+            (diagonal == Diagonal::NonUnit && !FullDiagonal())) {
+            return std::nullopt;
+        }
+        typename Column<T>::Buffer solution(rhs.Data(),
+                                            rhs.Data() + rhs.Size());
+        detail::Trsm<T>(height_, 1, triangle, diagonal, Strided(),
+                        {solution.data(), 1, height_}, GetThreadCount());
+        return std::make_optional<Column<T>>(std::move(solution), "solution");
+    }
+
+    /**
+     * @brief T * rhs, where T is the triangle of this square matrix selected
+     *        by triangle, without reading or multiplying by the other one
+     *
+     * @return std::nullopt if the matrix is not square or rhs has the wrong
+     *         height
+     */
+    std::optional<Matrix<T>> MultiplyTriangular(
+        const Matrix<T> &rhs, Triangle triangle,
+        Diagonal diagonal = Diagonal::NonUnit) const {
+        if (!TriangularConformable(rhs.height_)) {
+            return std::nullopt;
+        }
+        Matrix<T> product{height_, rhs.width_};
+        detail::Trmm<T>(height_, rhs.width_, triangle, diagonal, Strided(),
+                        rhs.Strided(), product.Strided(), GetThreadCount());
+        return std::make_optional<Matrix<T>>(std::move(product));
+    }
+
+    // MultiplyTriangular for a single right hand side
+    std::optional<Column<T>> MultiplyTriangular(
+        const Column<T> &rhs, Triangle triangle,
+        Diagonal diagonal = Diagonal::NonUnit) const {
+        if (!TriangularConformable(rhs.Size())) {
+            return std::nullopt;
+        }
+        typename Column<T>::Buffer product(rhs.Size());
+        detail::Trmm<T>(height_, 1, triangle, diagonal, Strided(),
+                        {rhs.Data(), 1, height_}, {product.data(), 1, height_},
+                        GetThreadCount());
+        return std::make_optional<Column<T>>(std::move(product), "product");
+    }
+
+    template <class... Args>
+    static std::optional<Matrix<T>> New(Args... args) noexcept {
+        return Matrix<T>::FactoryHelper(std::forward<Args>(args)...);
+    }
+
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    SetHeaders(const std::span<std::string_view> headers) {
+        if (std::ranges::size(headers) != width_) {
+            return std::nullopt;
+        } else {
+            std::vector<std::string_view> tmp_headers{};
+            tmp_headers.reserve(width_);
+            for (const std::string_view header : headers) {
+                tmp_headers.emplace_back(header);
+            }
+            headers_ = std::move(tmp_headers);
+            return 0;
+        }
+    }
+
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr std::size_t Size() const noexcept { return data_.size(); }
+    constexpr Layout GetLayout() const noexcept { return layout_; }
+
+    // Distance, in elements, between vertically/horizontally adjacent entries
+    constexpr std::size_t RowStride() const noexcept { return row_stride_; }
+    constexpr std::size_t ColumnStride() const noexcept {
+        return column_stride_;
+    }
+
+    // The non-const accessors copy a shared buffer first, so they may throw
+    // std::bad_alloc
+    constexpr const T *Data() const noexcept { return data_.data(); }
+    constexpr T *Data() { return data_.data(); }
+
+    std::optional<T> At(std::size_t row, std::size_t column) const noexcept {
+        if (row >= height_ || column >= width_) {
+            return std::nullopt;
+        } else {
+            return data_[Offset(row, column)];
+        }
+    }
+
+    Matrix<T> ToLayout(Layout layout) const noexcept {
+        Matrix<T> result{height_, width_, layout};
+        if (layout == layout_) {
+            std::copy(data_.cbegin(), data_.cend(), result.data_.begin());
+        } else {
+            detail::CopyStrided<T>(height_, width_, View().Strided(),
+                                   result.Strided(), SweepThreads());
+        }
+        result.headers_ = headers_;
+        return result;
+    }
+
+    MatrixView<const T> View() const noexcept {
+        return {data_.data(), height_, width_, row_stride_, column_stride_};
+    }
+
+    MatrixView<T> View() {
+        return {data_.data(), height_, width_, row_stride_, column_stride_};
+    }
+
+    // Zero-copy sub-matrices; see MatrixView::Block and MatrixView::Slice
+    std::optional<MatrixView<const T>> Block(
+        std::size_t row, std::size_t column, std::size_t height,
+        std::size_t width) const noexcept {
+        return View().Block(row, column, height, width);
+    }
+
+    std::optional<MatrixView<T>> Block(std::size_t row, std::size_t column,
+                                       std::size_t height,
+                                       std::size_t width) {
+        return View().Block(row, column, height, width);
+    }
+
+    std::optional<MatrixView<const T>> Slice(
+        std::size_t first_row, std::size_t last_row, std::size_t row_step,
+        std::size_t first_column, std::size_t last_column,
+        std::size_t column_step) const noexcept {
+        return View().Slice(first_row, last_row, row_step, first_column,
+                            last_column, column_step);
+    }
+
+    std::optional<MatrixView<T>> Slice(std::size_t first_row,
+                                       std::size_t last_row,
+                                       std::size_t row_step,
+                                       std::size_t first_column,
+                                       std::size_t last_column,
+                                       std::size_t column_step) {
+        return View().Slice(first_row, last_row, row_step, first_column,
+                            last_column, column_step);
+    }
+
+    // Lazy transpose: the same entries with the strides swapped, usable
+    // anywhere a view is accepted (including operator*) without copying
+    MatrixView<const T> Transposed() const noexcept {
+        return View().Transposed();
+    }
+
+    /**
+     * @brief Materialized transpose, in the same layout as this matrix
+     */
+    Matrix<T> Transpose() const noexcept {
+        Matrix<T> result{width_, height_, layout_};
+        detail::CopyStrided<T>(width_, height_, Transposed().Strided(),
+                               result.Strided(), SweepThreads());
+        return result;
+    }
+
+    /**
+     * @brief Transposes a square matrix without allocating, unless its
+     *        buffer is shared
+     *
+     * @return std::nullopt, leaving the matrix untouched, if it is not square
+     */
+    std::optional<std::uint8_t> TransposeInPlace() {
+        if (height_ != width_) {
+            return std::nullopt;
+        } else {
+            // Transposing the buffer is the same operation in either layout
+            detail::TransposeSquareInPlace(
+                height_, data_.data(),
+                layout_ == Layout::RowMajor ? row_stride_ : column_stride_,
+                SweepThreads());
+            headers_ = std::nullopt;
+            return 0;
+        }
+    }
+
+    /* ********************************************************************** */
+    /*                               Reductions                               */
+    /* ********************************************************************** */
+
+    // Each reduction gives one entry per row for Axis::Row, one per column
+    // for Axis::Column and a single entry for Axis::All. Slices stored
+    // contiguously are reduced in vector-wide chains; the others are swept
+    // line by line into a vector of accumulators, so memory is always read
+    // in order.
+
+    Column<T> Sum(Axis axis) const {
+        return Column<T>{
+            SumOver(axis, [](const T &entry, std::size_t) PPP_ALWAYS_INLINE {
+                return entry;
+            }),
+            "sum"};
+    }
+
+    // std::nullopt when there is nothing to average
+    std::optional<Column<T>> Mean(Axis axis) const {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(MeanOver(axis), "mean");
+        }
+    }
+
+    // Smallest entry; std::nullopt when there is nothing to compare
+    std::optional<Column<T>> Min(Axis axis) const
+        requires std::totally_ordered<T>
+    {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(
+                ExtremumOver<false>(axis).first, "min");
+        }
+    }
+
+    std::optional<Column<T>> Max(Axis axis) const
+        requires std::totally_ordered<T>
+    {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(
+                ExtremumOver<true>(axis).first, "max");
+        }
+    }
+
+    /**
+     * @brief Where the smallest entry is: its column for Axis::Row, its row
+     *        for Axis::Column and its row-major position for Axis::All
+     *
+     * Ties go to the first occurrence along the slice; for Axis::All that is
+     * the first in storage order.
+     */
+    std::optional<Column<std::int64_t>> ArgMin(Axis axis) const
+        requires std::totally_ordered<T>
+    {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<std::int64_t>>(
+                Indices(ExtremumOver<false>(axis).second), "argmin");
+        }
+    }
+
+    std::optional<Column<std::int64_t>> ArgMax(Axis axis) const
+        requires std::totally_ordered<T>
+    {
+        if (ReducedCount(axis) == 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<std::int64_t>>(
+                Indices(ExtremumOver<true>(axis).second), "argmax");
+        }
+    }
+
+    /**
+     * @brief Variance, sum((x - mean)^2) / (n - ddof), from two passes so
+     *        large offsets do not cancel
+     *
+     * @return std::nullopt unless more than ddof entries are reduced
+     */
+    std::optional<Column<T>> Variance(Axis axis, std::size_t ddof = 0) const
+        requires std::floating_point<T>
+    {
+        if (ReducedCount(axis) <= ddof) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<Column<T>>(VarianceOver(axis, ddof),
+                                                 "variance");
+        }
+    }
+
+    std::optional<Column<T>> StdDev(Axis axis, std::size_t ddof = 0) const
+        requires std::floating_point<T>
+    {
+        if (ReducedCount(axis) <= ddof) {
+            return std::nullopt;
+        } else {
+            std::vector<T> deviations{VarianceOver(axis, ddof)};
+            for (T &deviation : deviations) {
+                deviation = std::sqrt(deviation);
+            }
+            return std::make_optional<Column<T>>(deviations, "std");
+        }
+    }
+
+    /* ********************************************************************** */
+    /*                            Element-wise Math                           */
+    /* ********************************************************************** */
+
+    // Each function maps every entry into a matrix of the same shape and
+    // layout. MathPrecision lists how far the Fast kernels can be off.
+
+    Matrix<T> Exp(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return MathOver(detail::MathOp::Exp, nullptr, 0, precision);
+    }
+
+    Matrix<T> Log(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return MathOver(detail::MathOp::Log, nullptr, 0, precision);
+    }
+
+    Matrix<T> Sqrt(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return MathOver(detail::MathOp::Sqrt, nullptr, 0, precision);
+    }
+
+    Matrix<T> Tanh(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return MathOver(detail::MathOp::Tanh, nullptr, 0, precision);
+    }
+
+    // 1 / (1 + exp(-x))
+    Matrix<T> Sigmoid(MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return MathOver(detail::MathOp::Sigmoid, nullptr, 0, precision);
+    }
+
+    Matrix<T> Pow(const T &exponent,
+                  MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        return MathOver(detail::MathOp::Pow, &exponent, 0, precision);
+    }
+
+    // Raises each entry to the matching entry of exponents; std::nullopt
+    // unless the shapes agree
+    std::optional<Matrix<T>> Pow(
+        const Matrix<T> &exponents,
+        MathPrecision precision = MathPrecision::Fast) const
+        requires Transcendental<T>
+    {
+        if (exponents.height_ != height_ || exponents.width_ != width_) {
+            return std::nullopt;
+        } else if (exponents.layout_ != layout_) {
+            return Pow(exponents.ToLayout(layout_), precision);
+        } else {
+            return MathOver(detail::MathOp::Pow, exponents.data_.data(), 1,
+                            precision);
+        }
+    }
+
+    /* ********************************************************************** */
+    /*                               Filtering                                */
+    /* ********************************************************************** */
+
+    /**
+     * @brief Two dimensional cross-correlation: output(i, j) is the sum of
+     *        kernel(u, v) * (*this)(i * stride + u - top, j * stride + v -
+     *        left) over the kernel, entries outside the matrix read as zero
+     *
+     * padding decides the output size and the top and left offsets; see
+     * Padding. Kernels are applied directly, except large strided ones,
+     * which run as a GEMM over unrolled patches with the crossover tuned
+     * like the GEMM blocks.
+     *
+     * @return std::nullopt if the matrix or kernel is empty, stride is 0, or
+     *         a Padding::Valid kernel is larger than the matrix
+     */
+    std::optional<Matrix<T>> Correlate2D(const Matrix<T> &kernel,
+                                         Padding padding = Padding::Valid,
+                                         std::size_t stride = 1) const {
+        return Filter2D(kernel, padding, stride, false);
+    }
+
+    // Correlate2D with the kernel turned by 180 degrees
+    std::optional<Matrix<T>> Convolve2D(const Matrix<T> &kernel,
+                                        Padding padding = Padding::Valid,
+                                        std::size_t stride = 1) const {
+        return Filter2D(kernel, padding, stride, true);
+    }
+
+    /* ********************************************************************** */
+    /*                          Compound Assignment                           */
+    /* ********************************************************************** */
+
+    // rhs may be a 1xw row, hx1 column or 1x1 stretched over this matrix, but
+    // can never grow it. Returns std::nullopt and leaves the matrix untouched
+    // when the shapes do not fit.
+    std::optional<std::uint8_t> operator+=(const Matrix<T> &rhs) {
+        return *this += rhs.View();
+    }
+
+    std::optional<std::uint8_t> operator-=(const Matrix<T> &rhs) {
+        return *this -= rhs.View();
+    }
+
+    std::optional<std::uint8_t> operator+=(MatrixView<const T> rhs) {
+        return ApplyInPlace(
+            rhs, [](const T &left, const T &right) { return left + right; });
+    }
+
+    std::optional<std::uint8_t> operator-=(MatrixView<const T> rhs) {
+        return ApplyInPlace(
+            rhs, [](const T &left, const T &right) { return left - right; });
+    }
+
+    // Matrix product; the result needs a new buffer unless rhs is square
+    std::optional<std::uint8_t> operator*=(const Matrix<T> &rhs) noexcept {
+        std::optional<Matrix<T>> product{*this * rhs};
+        if (!product.has_value()) {
+            return std::nullopt;
+        } else {
+            if (product.value().width_ != width_) {
+                headers_ = std::nullopt;
+            }
+            height_ = product.value().height_;
+            width_ = product.value().width_;
+            layout_ = product.value().layout_;
+            row_stride_ = product.value().row_stride_;
+            column_stride_ = product.value().column_stride_;
+            data_ = std::move(product.value().data_);
+            return 0;
+        }
+    }
+
+    template <SimpleNumber U>
+    Matrix<T> &operator+=(U rhs) {
+        const T scalar{static_cast<T>(rhs)};
+        return MapInPlace([scalar](const T &entry) { return entry + scalar; });
+    }
+
+    template <SimpleNumber U>
+    Matrix<T> &operator-=(U rhs) {
+        const T scalar{static_cast<T>(rhs)};
+        return MapInPlace([scalar](const T &entry) { return entry - scalar; });
+    }
+
+    template <SimpleNumber U>
+    Matrix<T> &operator*=(U rhs) {
+        const T scalar{static_cast<T>(rhs)};
+        return MapInPlace([scalar](const T &entry) { return entry * scalar; });
+    }
+
+    template <SimpleNumber U>
+    Matrix<T> &operator/=(U rhs) {
+        const T scalar{static_cast<T>(rhs)};
+        return MapInPlace([scalar](const T &entry) { return entry / scalar; });
+    }
+
+    template <BasicEntry V>
+    friend inline std::ostream &operator<<(std::ostream &stream,
+                                           const Matrix<V> &matrix) noexcept;
+
+    template <BasicEntry V>
+    friend inline std::ostream &operator<<(std::ostream &stream,
+                                           Matrix<V> &&matrix) noexcept;
+    template <BasicEntry V>
+    friend inline std::optional<Matrix<V>> operator+(
+        const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept;
+
+    template <BasicEntry V>
+    friend inline std::optional<Matrix<V>> operator-(
+        const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator-(const Matrix<V> &lhs,
+                                                     U rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
+                                                     U rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator*(const Matrix<V> &lhs,
+                                                     U rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator/(const Matrix<V> &lhs,
+                                                     U rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator-(
+        U lhs, const Matrix<V> &rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator/(
+        U lhs, const Matrix<V> &rhs) noexcept;
+
+    template <BasicEntry V, class Op>
+    friend inline std::optional<Matrix<V>> Broadcast(const Matrix<V> &lhs,
+                                                     const Matrix<V> &rhs,
+                                                     Op op) noexcept;
+
+    template <BasicEntry V, class Op>
+    friend inline std::optional<Matrix<V>> Broadcast(MatrixView<const V> lhs,
+                                                     MatrixView<const V> rhs,
+                                                     Op op) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator-(U lhs,
+                                                     Matrix<V> &&rhs) noexcept;
+
+    template <BasicEntry V, SimpleNumber U>
+    friend inline std::optional<Matrix<V>> operator/(U lhs,
+                                                     Matrix<V> &&rhs) noexcept;
+
+    template <BasicEntry V, class Op>
+    friend inline std::optional<Matrix<V>> Broadcast(Matrix<V> &&lhs,
+                                                     const Matrix<V> &rhs,
+                                                     Op op) noexcept;
+
+    template <BasicEntry V, class Op>
+    friend inline std::optional<Matrix<V>> Broadcast(const Matrix<V> &lhs,
+                                                     Matrix<V> &&rhs,
+                                                     Op op) noexcept;
+
+    template <BasicEntry V>
+    friend inline bool operator==(const Matrix<V> &lhs,
+                                  const Matrix<V> &rhs) noexcept;
+
+ private:
+    Matrix() noexcept
+        : height_{0},
+          width_{0},
+          layout_{Layout::RowMajor},
+          row_stride_{0},
+          column_stride_{1},
+          data_{},
+          headers_{std::nullopt} {}
+
+    Matrix(std::size_t rows, std::size_t columns,
+           Layout layout = Layout::RowMajor) noexcept
+        : height_{rows},
+          width_{columns},
+          layout_{layout},
+          row_stride_{layout == Layout::RowMajor ? columns : 1},
+          column_stride_{layout == Layout::RowMajor ? 1 : rows},
+          data_(rows * columns, static_cast<T>(0)),
+          headers_{std::nullopt} {}
+
+    explicit Matrix(const std::vector<std::vector<T>> &data) noexcept
+        : Matrix(data.size(), data[0].size()) {
+        T *destination{data_.data()};
+        for (const std::vector<T> &row : data) {
+            destination = std::copy(row.cbegin(), row.cend(), destination);
+        }
+    }
+
+    template <SimpleNumber U>
+    Matrix(std::size_t rows, std::size_t columns, U value) noexcept
+        : height_{rows},
+          width_{columns},
+          layout_{Layout::RowMajor},
+          row_stride_{columns},
+          column_stride_{1},
+          data_(rows * columns, static_cast<T>(value)),
+          headers_{std::nullopt} {}
+
+    static std::pair<Matrix<T>, std::vector<std::size_t>> FactorInPlace(
+        Matrix<T> &&matrix) noexcept {
+        Matrix<T> lu{std::move(matrix)};
+        lu.headers_ = std::nullopt;
+        std::vector<std::size_t> pivots(lu.height_);
+        detail::LuFactor<T>(lu.height_, lu.Strided(), pivots.data(),
+                            GetThreadCount());
+
+        // Replay the row swaps to turn LAPACK style pivots into a permutation
+        std::vector<std::size_t> permutation(lu.height_);
+        std::iota(permutation.begin(), permutation.end(), std::size_t{0});
+        for (std::size_t row{0}; row < lu.height_; row++) {
+            std::swap(permutation[row], permutation[pivots[row]]);
+        }
+        return std::make_pair(std::move(lu), std::move(permutation));
+    }
+
+    detail::StridedMatrix<T> Strided() {
+        return {data_.data(), row_stride_, column_stride_};
+    }
+
+    detail::StridedMatrix<const T> Strided() const noexcept {
+        return {data_.data(), row_stride_, column_stride_};
+    }
+
+    bool TriangularConformable(std::size_t rhs_height) const noexcept {
+        return height_ == width_ && rhs_height == height_;
+    }
+
+    bool FullDiagonal() const noexcept {
+        for (std::size_t row{0}; row < height_; row++) {
+            if (data_[Offset(row, row)] == T(0)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t SweepThreads() const noexcept {
+        return data_.size() < PARALLEL_THRESHOLD ? 1 : GetThreadCount();
+    }
+
+    Matrix<T> MathOver(detail::MathOp op, const T *exponents,
+                       std::size_t exponent_step,
+                       MathPrecision precision) const {
+        Matrix<T> result{height_, width_, layout_};
+        detail::ElementwiseMath(op, data_.data(), exponents, exponent_step,
+                                result.data_.data(), data_.size(),
+                                GetThreadCount(), precision);
+        return result;
+    }
+
+    std::optional<Matrix<T>> Filter2D(const Matrix<T> &kernel,
+                                      Padding padding, std::size_t stride,
+                                      bool flip) const {
+        const std::optional<detail::FilterShape> shape{detail::FilterShapeFor(
+            height_, width_, kernel.height_, kernel.width_, padding, stride)};
+        if (!shape.has_value()) {
+            return std::nullopt;
+        }
+        const std::size_t taps{kernel.data_.size()};
+        std::vector<T> weights(taps);
+        for (std::size_t u{0}; u < kernel.height_; u++) {
+            for (std::size_t v{0}; v < kernel.width_; v++) {
+                const std::size_t index{(u * kernel.width_) + v};
+                weights[flip ? taps - 1 - index : index] =
+                    kernel.data_[(u * kernel.row_stride_) +
+                                 (v * kernel.column_stride_)];
+            }
+        }
+        Matrix<T> result{shape->rows.outputs, shape->columns.outputs};
+        detail::Correlate2D<T>(
+            {data_.data(), row_stride_, column_stride_}, height_, width_,
+            weights.data(), kernel.height_, kernel.width_, shape.value(),
+            stride, result.data_.data(), GetThreadCount(),
+            detail::DirectConvolutionTaps(stride));
+        return result;
+    }
+
+    // Entries that feed each result of a reduction over axis
+    std::size_t ReducedCount(Axis axis) const noexcept {
+        return axis == Axis::Row      ? width_
+               : axis == Axis::Column ? height_
+                                      : data_.size();
+    }
+
+    // How a reduction over axis maps onto the buffer: lines of length
+    // entries, stride apart, each either reduced on its own (along) or
+    // folded position by position into one vector of results (across)
+    struct ReduceShape {
+        std::size_t lines;
+        std::size_t length;
+        std::size_t stride;
+        bool along;
+    };
+
+    ReduceShape Reduction(Axis axis) const noexcept {
+        const bool row_major{layout_ == Layout::RowMajor};
+        if (axis == Axis::All) {
+            return {1, data_.size(), 0, true};
+        } else {
+            return {row_major ? height_ : width_,
+                    row_major ? width_ : height_,
+                    row_major ? row_stride_ : column_stride_,
+                    (axis == Axis::Row) == row_major};
+        }
+    }
+
+    // Sum of map(entry, result index) for each result of a reduction
+    template <class Map>
+    std::vector<T> SumOver(Axis axis, const Map &map) const {
+        const ReduceShape shape{Reduction(axis)};
+        if (shape.along) {
+            return detail::SumAlong(data_.data(), shape.lines, shape.length,
+                                    shape.stride, SweepThreads(), map);
+        } else {
+            return detail::SumAcross(data_.data(), shape.lines, shape.length,
+                                     shape.stride, SweepThreads(), map,
+                                     detail::ReduceChunk());
+        }
+    }
+
+    std::vector<T> MeanOver(Axis axis) const {
+        std::vector<T> means{
+            SumOver(axis, [](const T &entry, std::size_t) PPP_ALWAYS_INLINE {
+                return entry;
+            })};
+        const T count{static_cast<T>(ReducedCount(axis))};
+        for (T &mean : means) {
+            mean /= count;
+        }
+        return means;
+    }
+
+    std::vector<T> VarianceOver(Axis axis, std::size_t ddof) const {
+        const std::vector<T> means{MeanOver(axis)};
+        const T *center{means.data()};
+        std::vector<T> variances{SumOver(
+            axis, [center](const T &entry, std::size_t result)
+                      PPP_ALWAYS_INLINE {
+                          const T deviation{entry - center[result]};
+                          return deviation * deviation;
+                      })};
+        const T count{static_cast<T>(ReducedCount(axis) - ddof)};
+        for (T &variance : variances) {
+            variance /= count;
+        }
+        return variances;
+    }
+
+    // Extremum of each result's entries and its index, as ArgMin describes
+    template <bool Greatest>
+    std::pair<std::vector<T>, std::vector<std::size_t>> ExtremumOver(
+        Axis axis) const {
+        const ReduceShape shape{Reduction(axis)};
+        if (!shape.along) {
+            return detail::ExtremumAcross<Greatest>(
+                data_.data(), shape.lines, shape.length, shape.stride,
+                SweepThreads(), detail::ReduceChunk());
+        }
+
+        const std::vector<std::pair<T, std::size_t>> extrema{
+            detail::ExtremumAlong<Greatest>(data_.data(), shape.lines,
+                                            shape.length, shape.stride,
+                                            SweepThreads())};
+        std::pair<std::vector<T>, std::vector<std::size_t>> result{};
+        result.first.reserve(extrema.size());
+        result.second.reserve(extrema.size());
+        for (const auto &[value, index] : extrema) {
+            result.first.push_back(value);
+            // Buffer positions of a column-major matrix are column by column
+            result.second.push_back(
+                axis == Axis::All && layout_ == Layout::ColumnMajor
+                    ? ((index % height_) * width_) + (index / height_)
+                    : index);
+        }
+        return result;
+    }
+
+    static std::vector<std::int64_t> Indices(
+        const std::vector<std::size_t> &positions) {
+        return {positions.cbegin(), positions.cend()};
+    }
+
+    constexpr std::size_t Offset(std::size_t row,
+                                 std::size_t column) const noexcept {
+        return (row * row_stride_) + (column * column_stride_);
+    }
+
+    // Applies op to every pair of entries at the same (row, column). When both
+    // operands share a layout this is one linear sweep over the buffers.
+    template <class Op>
+    static Matrix<T> ElementWise(const Matrix<T> &lhs, const Matrix<T> &rhs,
+                                 Op op) noexcept {
+        Matrix<T> result{lhs.height_, lhs.width_, lhs.layout_};
+
+        if (lhs.layout_ == rhs.layout_) {
+            if (result.data_.size() < PARALLEL_THRESHOLD) {
+                std::transform(std::execution::unseq, lhs.data_.cbegin(),
+                               lhs.data_.cend(), rhs.data_.cbegin(),
+                               result.data_.begin(), op);
+            } else {
+                std::transform(std::execution::par_unseq, lhs.data_.cbegin(),
+                               lhs.data_.cend(), rhs.data_.cbegin(),
+                               result.data_.begin(), op);
+            }
+        } else {
+            T *destination{result.data_.data()};
+            for (std::size_t row{0}; row < lhs.height_; row++) {
+                for (std::size_t column{0}; column < lhs.width_; column++) {
+                    const std::size_t offset{lhs.Offset(row, column)};
+                    destination[offset] = op(
+                        lhs.data_[offset], rhs.data_[rhs.Offset(row, column)]);
                 }
             }
+        }
+
+        return result;
+    }
+
+    // Applies op to every entry as one linear sweep over the buffer
+    template <class Op>
+    static Matrix<T> Map(const Matrix<T> &matrix, Op op) noexcept {
+        Matrix<T> result{matrix.height_, matrix.width_, matrix.layout_};
+        if (result.data_.size() < PARALLEL_THRESHOLD) {
+            std::transform(std::execution::unseq, matrix.data_.cbegin(),
+                           matrix.data_.cend(), result.data_.begin(), op);
+        } else {
+            std::transform(std::execution::par_unseq, matrix.data_.cbegin(),
+                           matrix.data_.cend(), result.data_.begin(), op);
+        }
+        return result;
+    }
 
-            return std::make_pair<Matrix<T>, Matrix<T>>(Matrix<T>{lower_data},
-                                                        Matrix<T>{upper_data});
+    template <class Op>
+    Matrix<T> &MapInPlace(Op op) {
+        T *entries{data_.data()};
+        if (data_.size() < PARALLEL_THRESHOLD) {
+            std::transform(std::execution::unseq, entries,
+                           entries + data_.size(), entries, op);
+        } else {
+            std::transform(std::execution::par_unseq, entries,
+                           entries + data_.size(), entries, op);
         }
+        return *this;
     }
 
-    template <class... Args>
-    static std::optional<Matrix<T>> New(Args... args) noexcept {
-        return Matrix<T>::FactoryHelper(std::forward<Args>(args)...);
+    // True when rhs broadcasts to exactly this matrix's shape
+    bool Absorbs(MatrixView<const T> rhs) const noexcept {
+        return height_ != 0 && rhs.Height() != 0 &&
+               (rhs.Height() == height_ || rhs.Height() == 1) &&
+               (rhs.Width() == width_ || rhs.Width() == 1);
     }
 
-    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
-    SetHeaders(const std::span<std::string_view> headers) {
-        if (std::ranges::size(headers) != data_[0].size()) {
-            return std::nullopt;
-        } else {
-            std::vector<std::string_view> tmp_headers{};
-            tmp_headers.reserve(data_[0].size());
-            for (const std::string_view header : headers) {
-                tmp_headers.emplace_back(header);
-            }
-            headers_ = std::move(tmp_headers);
+    bool Overlaps(MatrixView<const T> view) const noexcept {
+        return !data_.empty() && view.Size() != 0 &&
+               std::less_equal<const T *>{}(data_.data(), view.Data()) &&
+               std::less<const T *>{}(view.Data(),
+                                      data_.data() + data_.size());
+    }
+
+    // this[r, c] = op(this[r, c], rhs[r, c]), or op(rhs[r, c], this[r, c]) when
+    // reversed, with rhs broadcast over this matrix
+    template <class Op>
+    std::optional<std::uint8_t> ApplyInPlace(MatrixView<const T> rhs, Op op,
+                                             bool reversed = false) {
+        if (height_ == 0 && rhs.Height() == 0) {
             return 0;
+        } else if (!Absorbs(rhs)) {
+            return std::nullopt;
+        } else if (Overlaps(rhs)) {
+            // A view into this buffer could be overwritten before it is read
+            const Matrix<T> copy{FactoryHelper(rhs).value()};
+            return ApplyInPlace(copy.View(), op, reversed);
         }
-    }
 
-    template <BasicEntry V>
-    friend inline std::ostream &operator<<(std::ostream &stream,
-                                           const Matrix<V> &matrix) noexcept;
+        const auto apply{[&op, reversed](const T &mine, const T &other) {
+            return reversed ? op(other, mine) : op(mine, other);
+        }};
 
-    template <BasicEntry V>
-    friend inline std::ostream &operator<<(std::ostream &stream,
-                                           Matrix<V> &&matrix) noexcept;
-    template <BasicEntry V>
-    friend inline std::optional<Matrix<V>> operator+(
-        const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept;
+        // Same shape and strides means rhs is packed exactly like this buffer
+        if (rhs.Height() == height_ && rhs.Width() == width_ &&
+            rhs.RowStride() == row_stride_ &&
+            rhs.ColumnStride() == column_stride_) {
+            T *entries{data_.data()};
+            if (data_.size() < PARALLEL_THRESHOLD) {
+                std::transform(std::execution::unseq, entries,
+                               entries + data_.size(), rhs.Data(), entries,
+                               apply);
+            } else {
+                std::transform(std::execution::par_unseq, entries,
+                               entries + data_.size(), rhs.Data(), entries,
+                               apply);
+            }
+            return 0;
+        }
 
-    template <BasicEntry V>
-    friend inline std::optional<Matrix<V>> operator-(
-        const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept;
+        const std::size_t rhs_row_stride{rhs.Height() == 1 ? 0
+                                                           : rhs.RowStride()};
+        const std::size_t rhs_column_stride{
+            rhs.Width() == 1 ? 0 : rhs.ColumnStride()};
+        const std::size_t threads{
+            data_.size() < PARALLEL_THRESHOLD ? 1 : GetThreadCount()};
+        // Detach once here; a shared buffer must not be copied per worker
+        T *entries{data_.data()};
+        ParallelFor(height_, threads, [&](std::size_t row) {
+            T *destination{entries + (row * row_stride_)};
+            const T *source{rhs.Data() + (row * rhs_row_stride)};
+            for (std::size_t column{0}; column < width_; column++) {
+                T &entry{destination[column * column_stride_]};
+                entry = apply(entry, source[column * rhs_column_stride]);
+            }
+        });
+        return 0;
+    }
 
-    template <BasicEntry V, SimpleNumber U>
-    friend inline std::optional<Matrix<V>> operator-(const Matrix<V> &lhs,
-                                                     U rhs) noexcept;
+    // numpy rules: a dimension of 1 is stretched to match the other operand
+    static bool Broadcastable(MatrixView<const T> lhs,
+                              MatrixView<const T> rhs) noexcept {
+        const auto compatible{[](std::size_t left, std::size_t right) {
+            return left == right || left == 1 || right == 1;
+        }};
+        return lhs.Height() != 0 && rhs.Height() != 0 &&
+               compatible(lhs.Height(), rhs.Height()) &&
+               compatible(lhs.Width(), rhs.Width());
+    }
 
-    template <BasicEntry V, SimpleNumber U>
-    friend inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
-                                                     U rhs) noexcept;
+    template <class Op>
+    static Matrix<T> BroadcastElementWise(MatrixView<const T> lhs,
+                                          MatrixView<const T> rhs,
+                                          Op op) noexcept {
+        const std::size_t height{std::max(lhs.Height(), rhs.Height())};
+        const std::size_t width{std::max(lhs.Width(), rhs.Width())};
+        Matrix<T> result{height, width, Layout::RowMajor};
 
-    template <BasicEntry V>
-    friend inline bool operator==(const Matrix<V> &lhs,
-                                  const Matrix<V> &rhs) noexcept;
+        // A zero stride pins a stretched operand to its only row or column
+        const std::size_t lhs_row_stride{lhs.Height() == 1 ? 0
+                                                           : lhs.RowStride()};
+        const std::size_t lhs_column_stride{
+            lhs.Width() == 1 ? 0 : lhs.ColumnStride()};
+        const std::size_t rhs_row_stride{rhs.Height() == 1 ? 0
+                                                           : rhs.RowStride()};
+        const std::size_t rhs_column_stride{
+            rhs.Width() == 1 ? 0 : rhs.ColumnStride()};
 
-    template <BasicEntry V>
-    friend inline std::optional<Matrix<V>> operator*(
-        const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept;
+        const std::size_t threads{result.data_.size() < PARALLEL_THRESHOLD
+                                      ? 1
+                                      : GetThreadCount()};
+        T *entries{result.data_.data()};
+        ParallelFor(height, threads, [&](std::size_t row) {
+            const T *left{lhs.Data() + (row * lhs_row_stride)};
+            const T *right{rhs.Data() + (row * rhs_row_stride)};
+            T *destination{entries + (row * width)};
 
- private:
-    Matrix() noexcept
-        : data_mutex_{},
-          data_{},
-          headers_{std::nullopt},
-          height_{0},
-          width_{0} {}
-
-    Matrix(std::size_t rows, std::size_t columns) noexcept
-        : data_mutex_{},
-          data_{std::vector<std::vector<T>>(rows,
-                                            std::vector<T>(columns, T(0.0)))},
-          headers_{std::nullopt},
-          height_{rows},
-          width_{columns} {}
-
-    explicit Matrix(std::vector<std::vector<T>> &&data) noexcept
-        : data_mutex_{},
-          data_{data},
-          headers_{std::nullopt},
-          height_{data.size()},
-          width_{data[0].size()} {}
+            if (lhs_column_stride == 1 && rhs_column_stride == 1) {
+                for (std::size_t column{0}; column < width; column++) {
+                    destination[column] = op(left[column], right[column]);
+                }
+            } else if (lhs_column_stride == 1 && rhs_column_stride == 0) {
+                const T scalar{right[0]};
+                for (std::size_t column{0}; column < width; column++) {
+                    destination[column] = op(left[column], scalar);
+                }
+            } else if (lhs_column_stride == 0 && rhs_column_stride == 1) {
+                const T scalar{left[0]};
+                for (std::size_t column{0}; column < width; column++) {
+                    destination[column] = op(scalar, right[column]);
+                }
+            } else {
+                for (std::size_t column{0}; column < width; column++) {
+                    destination[column] =
+                        op(left[column * lhs_column_stride],
+                           right[column * rhs_column_stride]);
+                }
+            }
+        });
 
-    explicit Matrix(const std::vector<std::vector<T>> &data) noexcept
-        : data_mutex_{},
-          data_{data},
-          headers_{std::nullopt},
-          height_{data.size()},
-          width_{data[0].size()} {}
+        return result;
+    }
 
-    template <SimpleNumber U>
-    Matrix(std::size_t rows, std::size_t columns, U value) noexcept
-        : data_mutex_{},
-          data_{std::vector<std::vector<U>>(rows,
-                                            std::vector<U>(columns, value))},
-          headers_{std::nullopt},
-          height_{rows},
-          width_{columns} {}
+    static bool AlmostEqual(const T &left, const T &right) noexcept {
+        if constexpr (std::is_floating_point_v<T>) {
+            const T m = std::min(std::fabs(left), std::fabs(right));
+            const int exp = m < std::numeric_limits<T>::min()
+                                ? std::numeric_limits<T>::min_exponent - 1
+                                : std::ilogb(m);
+            return !(std::fabs(left) - std::fabs(right) >
+                     std::ldexp(std::numeric_limits<T>::epsilon(), exp));
+        } else {
+            return left == right;
+        }
+    }
 
     static std::optional<Matrix<T>> FactoryHelper() noexcept {
         return std::make_optional<Matrix<T>>(Matrix<T>{});
@@ -207,28 +1302,25 @@ class Matrix {
 
     static std::optional<Matrix<T>> FactoryHelper(
         std::size_t rows, std::size_t columns) noexcept {
+        return FactoryHelper(rows, columns, Layout::RowMajor);
+    }
+
+    static std::optional<Matrix<T>> FactoryHelper(std::size_t rows,
+                                                  std::size_t columns,
+                                                  Layout layout) noexcept {
         // Prevent matrices that don't make physical sense!
         if (rows == 0 && columns != 0) {
             return std::nullopt;
         } else {
-            return std::make_optional<Matrix<T>>(Matrix<T>{rows, columns});
+            return std::make_optional<Matrix<T>>(
+                Matrix<T>{rows, columns, layout});
         }
     }
 
     static std::optional<Matrix<T>> FactoryHelper(
         std::vector<std::vector<T>> &&data) noexcept {
-        if (data.size() == 0) {
-            return std::make_optional<Matrix<T>>(Matrix<T>{});
-        } else {
-            std::size_t width{data[0].size()};
-            for (const std::vector<T> &row : data) {
-                if (row.size() != width) {
-                    return std::nullopt;
-                }
-            }
-
-            return std::make_optional<Matrix<T>>(Matrix<T>{std::move(data)});
-        }
+        return FactoryHelper(static_cast<const std::vector<std::vector<T>> &>(
+            data));
     }
 
     static std::optional<Matrix<T>> FactoryHelper(
@@ -260,11 +1352,32 @@ class Matrix {
         }
     }
 
+    // Materializes a view, e.g. Matrix<T>::New(matrix.Transposed())
+    static std::optional<Matrix<T>> FactoryHelper(
+        MatrixView<const T> view) noexcept {
+        if (view.Height() == 0) {
+            return std::make_optional<Matrix<T>>(Matrix<T>{});
+        } else {
+            std::optional<Matrix<T>> result{
+                FactoryHelper(view.Height(), view.Width())};
+            detail::CopyStrided<T>(view.Height(), view.Width(),
+                                   view.Strided(), result.value().Strided(),
+                                   result.value().SweepThreads());
+            return result;
+        }
+    }
+
+    static std::optional<Matrix<T>> FactoryHelper(MatrixView<T> view) noexcept {
+        return FactoryHelper(MatrixView<const T>{view});
+    }
+
  private:
-    std::mutex data_mutex_;
     std::size_t height_;
     std::size_t width_;
-    std::vector<std::vector<T>> data_;
+    Layout layout_;
+    std::size_t row_stride_;
+    std::size_t column_stride_;
+    Buffer data_;
     std::optional<std::vector<std::string_view>> headers_;
     static constexpr std::size_t MAX_COLUMN_WIDTH{15};
 };  // class Matrix
@@ -309,9 +1422,10 @@ inline std::ostream &operator<<(std::ostream &stream,
     }
     stream << std::endl;
 
-    for (const std::vector<V> &row : matrix.data_) {
-        for (const V &element : row) {
-            stream << std::setw(Matrix<V>::MAX_COLUMN_WIDTH) << element << "|";
+    for (std::size_t row{0}; row < matrix.height_; row++) {
+        for (std::size_t column{0}; column < matrix.width_; column++) {
+            stream << std::setw(Matrix<V>::MAX_COLUMN_WIDTH)
+                   << matrix.data_[matrix.Offset(row, column)] << "|";
         }
         stream << std::endl;
     }
@@ -319,129 +1433,490 @@ inline std::ostream &operator<<(std::ostream &stream,
     return stream;
 }
 
-template <BasicEntry V>
-inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
-                                          const Matrix<V> &rhs) noexcept {
-    if ((lhs.height_ != rhs.height_) || (lhs.width_ != rhs.width_)) {
+/**
+ * @brief Applies op entry by entry, stretching any dimension of size 1 to
+ *        match the other operand (numpy style broadcasting)
+ *
+ * @return std::nullopt if the shapes can not be broadcast together
+ */
+template <BasicEntry V, class Op>
+inline std::optional<Matrix<V>> Broadcast(const Matrix<V> &lhs,
+                                          const Matrix<V> &rhs,
+                                          Op op) noexcept {
+    if ((lhs.height_ == rhs.height_) && (lhs.width_ == rhs.width_)) {
+        return std::make_optional<Matrix<V>>(
+            Matrix<V>::ElementWise(lhs, rhs, op));
+    } else if (!Matrix<V>::Broadcastable(lhs.View(), rhs.View())) {
+        return std::nullopt;
+    } else {
+        return std::make_optional<Matrix<V>>(
+            Matrix<V>::BroadcastElementWise(lhs.View(), rhs.View(), op));
+    }
+}
+
+// Views can be strided any which way, so they always take the row by row
+// kernel, which is still a contiguous sweep for row-major blocks
+template <BasicEntry V, class Op>
+inline std::optional<Matrix<V>> Broadcast(MatrixView<const V> lhs,
+                                          MatrixView<const V> rhs,
+                                          Op op) noexcept {
+    if (lhs.Height() == 0 && rhs.Height() == 0) {
+        return Matrix<V>::New();
+    } else if (!Matrix<V>::Broadcastable(lhs, rhs)) {
         return std::nullopt;
     } else {
-        std::vector<std::vector<V>> new_data{lhs.height_,
-                                             std::vector<V>(lhs.width_)};
+        return std::make_optional<Matrix<V>>(
+            Matrix<V>::BroadcastElementWise(lhs, rhs, op));
+    }
+}
+
+// The rvalue overloads write the result into the temporary's buffer whenever
+// it already has the broadcast shape, so chained arithmetic allocates once
+
+template <BasicEntry V, class Op>
+inline std::optional<Matrix<V>> Broadcast(Matrix<V> &&lhs,
+                                          const Matrix<V> &rhs,
+                                          Op op) noexcept {
+    if (!lhs.Absorbs(rhs.View())) {
+        return Broadcast(static_cast<const Matrix<V> &>(lhs), rhs, op);
+    } else {
+        lhs.ApplyInPlace(rhs.View(), op);
+        return std::make_optional<Matrix<V>>(std::move(lhs));
+    }
+}
 
-        std::transform(std::execution::par_unseq, lhs.data_.begin(),
-                       lhs.data_.end(), rhs.data_.begin(), new_data.begin(),
-                       [](const std::vector<V> &left_row,
-                          const std::vector<V> &right_row) {
-                           std::vector<V> row(left_row.size());
-                           std::transform(left_row.begin(), left_row.end(),
-                                          right_row.begin(), row.begin(),
-                                          [](const V &left, const V &right) {
-                                              return left + right;
-                                          });
-                           return row;
-                       });
+template <BasicEntry V, class Op>
+inline std::optional<Matrix<V>> Broadcast(const Matrix<V> &lhs,
+                                          Matrix<V> &&rhs, Op op) noexcept {
+    if (!rhs.Absorbs(lhs.View())) {
+        return Broadcast(lhs, static_cast<const Matrix<V> &>(rhs), op);
+    } else {
+        rhs.ApplyInPlace(lhs.View(), op, true);
+        return std::make_optional<Matrix<V>>(std::move(rhs));
+    }
+}
 
-        return std::make_optional<Matrix<V>>(Matrix<V>{new_data});
+template <BasicEntry V, class Op>
+inline std::optional<Matrix<V>> Broadcast(Matrix<V> &&lhs, Matrix<V> &&rhs,
+                                          Op op) noexcept {
+    if (lhs.Height() >= rhs.Height() && lhs.Width() >= rhs.Width()) {
+        return Broadcast(std::move(lhs), static_cast<const Matrix<V> &>(rhs),
+                         op);
+    } else {
+        return Broadcast(static_cast<const Matrix<V> &>(lhs), std::move(rhs),
+                         op);
     }
 }
 
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    return Broadcast(lhs, rhs, [](const V &left, const V &right) {
+        return left + right;
+    });
+}
+
 template <BasicEntry V>
 inline std::optional<Matrix<V>> operator-(const Matrix<V> &lhs,
                                           const Matrix<V> &rhs) noexcept {
-    if ((lhs.height_ != rhs.height_) || (lhs.width_ != rhs.width_)) {
-        return std::nullopt;
-    } else {
-        std::vector<std::vector<V>> new_data{lhs.height_,
-                                             std::vector<V>(lhs.width_)};
+    return Broadcast(lhs, rhs, [](const V &left, const V &right) {
+        return left - right;
+    });
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator+(Matrix<V> &&lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    return Broadcast(std::move(lhs), rhs, [](const V &left, const V &right) {
+        return left + right;
+    });
+}
 
-        std::transform(std::execution::par_unseq, lhs.data_.begin(),
-                       lhs.data_.end(), rhs.data_.begin(), new_data.begin(),
-                       [](const std::vector<V> &left_row,
-                          const std::vector<V> &right_row) {
-                           std::vector<V> row(left_row.size());
-                           std::transform(left_row.begin(), left_row.end(),
-                                          right_row.begin(), row.begin(),
-                                          [](const V &left, const V &right) {
-                                              return left - right;
-                                          });
-                           return row;
-                       });
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator-(Matrix<V> &&lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    return Broadcast(std::move(lhs), rhs, [](const V &left, const V &right) {
+        return left - right;
+    });
+}
 
-        return std::make_optional<Matrix<V>>(Matrix<V>{new_data});
-    }
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
+                                          Matrix<V> &&rhs) noexcept {
+    return Broadcast(lhs, std::move(rhs), [](const V &left, const V &right) {
+        return left + right;
+    });
 }
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator-(const Matrix<V> &lhs,
+                                          Matrix<V> &&rhs) noexcept {
+    return Broadcast(lhs, std::move(rhs), [](const V &left, const V &right) {
+        return left - right;
+    });
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator+(Matrix<V> &&lhs,
+                                          Matrix<V> &&rhs) noexcept {
+    return Broadcast(std::move(lhs), std::move(rhs),
+                     [](const V &left, const V &right) {
+                         return left + right;
+                     });
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator-(Matrix<V> &&lhs,
+                                          Matrix<V> &&rhs) noexcept {
+    return Broadcast(std::move(lhs), std::move(rhs),
+                     [](const V &left, const V &right) {
+                         return left - right;
+                     });
+}
+
+// Entry-wise (Hadamard) product; operator* is the matrix product
+template <BasicEntry V>
+inline std::optional<Matrix<V>> MultiplyElements(
+    const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept {
+    return Broadcast(lhs, rhs, [](const V &left, const V &right) {
+        return left * right;
+    });
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> DivideElements(const Matrix<V> &lhs,
+                                               const Matrix<V> &rhs) noexcept {
+    return Broadcast(lhs, rhs, [](const V &left, const V &right) {
+        return left / right;
+    });
+}
+
 template <BasicEntry V, SimpleNumber U>
 inline std::optional<Matrix<V>> operator-(const Matrix<V> &lhs,
                                           U rhs) noexcept {
-    const std::size_t height{lhs.height_};
-    const std::size_t width{lhs.width_};
+    const V scalar{static_cast<V>(rhs)};
+    return std::make_optional<Matrix<V>>(Matrix<V>::Map(
+        lhs, [scalar](const V &entry) { return entry - scalar; }));
+}
 
-    const std::optional<Matrix<V>> right{Matrix<V>::New(height, width, rhs)};
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
+                                          U rhs) noexcept {
+    const V scalar{static_cast<V>(rhs)};
+    return std::make_optional<Matrix<V>>(Matrix<V>::Map(
+        lhs, [scalar](const V &entry) { return entry + scalar; }));
+}
 
-    if (right.has_value()) {
-        return lhs - right.value();
-    } else {
-        return std::nullopt;
-    }
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator*(const Matrix<V> &lhs,
+                                          U rhs) noexcept {
+    const V scalar{static_cast<V>(rhs)};
+    return std::make_optional<Matrix<V>>(Matrix<V>::Map(
+        lhs, [scalar](const V &entry) { return entry * scalar; }));
 }
 
 template <BasicEntry V, SimpleNumber U>
-inline std::optional<Matrix<V>> operator+(const Matrix<V> &lhs,
+inline std::optional<Matrix<V>> operator/(const Matrix<V> &lhs,
                                           U rhs) noexcept {
-    const std::size_t height{lhs.height_};
-    const std::size_t width{lhs.width_};
+    const V scalar{static_cast<V>(rhs)};
+    return std::make_optional<Matrix<V>>(Matrix<V>::Map(
+        lhs, [scalar](const V &entry) { return entry / scalar; }));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator+(U lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    return rhs + lhs;
+}
 
-    const std::optional<Matrix<V>> right{Matrix<V>::New(height, width, rhs)};
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator-(U lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    const V scalar{static_cast<V>(lhs)};
+    return std::make_optional<Matrix<V>>(Matrix<V>::Map(
+        rhs, [scalar](const V &entry) { return scalar - entry; }));
+}
 
-    if (right.has_value()) {
-        return lhs + right.value();
-    } else {
-        return std::nullopt;
-    }
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator*(U lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    return rhs * lhs;
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator/(U lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    const V scalar{static_cast<V>(lhs)};
+    return std::make_optional<Matrix<V>>(Matrix<V>::Map(
+        rhs, [scalar](const V &entry) { return scalar / entry; }));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator+(Matrix<V> &&lhs, U rhs) noexcept {
+    lhs += rhs;
+    return std::make_optional<Matrix<V>>(std::move(lhs));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator-(Matrix<V> &&lhs, U rhs) noexcept {
+    lhs -= rhs;
+    return std::make_optional<Matrix<V>>(std::move(lhs));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator*(Matrix<V> &&lhs, U rhs) noexcept {
+    lhs *= rhs;
+    return std::make_optional<Matrix<V>>(std::move(lhs));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator/(Matrix<V> &&lhs, U rhs) noexcept {
+    lhs /= rhs;
+    return std::make_optional<Matrix<V>>(std::move(lhs));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator+(U lhs, Matrix<V> &&rhs) noexcept {
+    return std::move(rhs) + lhs;
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator-(U lhs, Matrix<V> &&rhs) noexcept {
+    const V scalar{static_cast<V>(lhs)};
+    rhs.MapInPlace([scalar](const V &entry) { return scalar - entry; });
+    return std::make_optional<Matrix<V>>(std::move(rhs));
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator*(U lhs, Matrix<V> &&rhs) noexcept {
+    return std::move(rhs) * lhs;
+}
+
+template <BasicEntry V, SimpleNumber U>
+inline std::optional<Matrix<V>> operator/(U lhs, Matrix<V> &&rhs) noexcept {
+    const V scalar{static_cast<V>(lhs)};
+    rhs.MapInPlace([scalar](const V &entry) { return scalar / entry; });
+    return std::make_optional<Matrix<V>>(std::move(rhs));
 }
 
 template <BasicEntry V>
 inline bool operator==(const Matrix<V> &lhs, const Matrix<V> &rhs) noexcept {
     if ((lhs.height_ != rhs.height_) || (lhs.width_ != rhs.width_)) {
         return false;
+    } else if (lhs.layout_ == rhs.layout_) {
+        return std::equal(lhs.data_.cbegin(), lhs.data_.cend(),
+                          rhs.data_.cbegin(), Matrix<V>::AlmostEqual);
+    } else {
+        for (std::size_t row{0}; row < lhs.height_; row++) {
+            for (std::size_t column{0}; column < lhs.width_; column++) {
+                if (!Matrix<V>::AlmostEqual(
+                        lhs.data_[lhs.Offset(row, column)],
+                        rhs.data_[rhs.Offset(row, column)])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Matrix product computed on up to threads threads
+ *
+ * Either operand may be a view, such as Transposed(), which the packing step
+ * reads through its strides without a copy.
+ */
+template <BasicEntry V>
+inline std::optional<Matrix<V>> Multiply(MatrixView<const V> lhs,
+                                         MatrixView<const V> rhs,
+                                         std::size_t threads) noexcept {
+    if (lhs.Width() != rhs.Height()) {
+        return std::nullopt;
+    } else if (lhs.Height() == 0 || rhs.Width() == 0) {
+        return Matrix<V>::New();
     } else {
-        auto zip_it{std::views::zip(lhs.data_, rhs.data_)};
-        return !(
-            std::ranges::find_if(
-                zip_it,
-                [](std::pair<std::span<const V>, std::span<const V>> rows) {
-                    auto inner_zip_it{std::views::zip(rows.first, rows.second)};
-                    return std::ranges::find_if(
-                               inner_zip_it,
-                               [](std::pair<const V, const V> vals) {
-                                   if (std::is_floating_point_v<V>) {
-                                       const V m =
-                                           std::min(std::fabs(vals.first),
-                                                    std::fabs(vals.second));
-                                       const int exp =
-                                           m < std::numeric_limits<V>::min()
-                                               ? std::numeric_limits<
-                                                     V>::min_exponent -
-                                                     1
-                                               : std::ilogb(m);
-                                       return std::fabs(vals.first) -
-                                                  std::fabs(vals.second) >
-                                              std::ldexp(std::numeric_limits<
-                                                             V>::epsilon(),
-                                                         exp);
-                                   } else {
-                                       return vals.first != vals.second;
-                                   }
-                               }) != std::ranges::end(inner_zip_it);
-                }) != std::ranges::end(zip_it));
+        std::optional<Matrix<V>> product{
+            Matrix<V>::New(lhs.Height(), rhs.Width())};
+        if (product.has_value()) {
+            detail::ParallelGemm<V>(lhs.Height(), rhs.Width(), lhs.Width(),
+                                    V(1), lhs.Strided(), rhs.Strided(), V(0),
+                                    product.value().View().Strided(), threads);
+        }
+        return product;
     }
 }
 
+template <BasicEntry V>
+inline std::optional<Matrix<V>> Multiply(const Matrix<V> &lhs,
+                                         const Matrix<V> &rhs,
+                                         std::size_t threads) noexcept {
+    return Multiply(lhs.View(), rhs.View(), threads);
+}
+
 template <BasicEntry V>
 inline std::optional<Matrix<V>> operator*(const Matrix<V> &lhs,
                                           const Matrix<V> &rhs) noexcept {
-    /* TODO: implement */
-    return std::nullopt;
+    return Multiply(lhs.View(), rhs.View(), GetThreadCount());
+}
+
+/* ************************************************************************** */
+/*                              View Operands                                 */
+/* ************************************************************************** */
+
+namespace detail {
+
+template <class T>
+struct IsMatrixView : std::false_type {};
+
+template <class T>
+struct IsMatrixView<MatrixView<T>> : std::true_type {};
+
+template <BasicEntry V>
+constexpr MatrixView<const V> AsView(const Matrix<V> &matrix) noexcept {
+    return matrix.View();
+}
+
+template <class V>
+constexpr MatrixView<const std::remove_const_t<V>> AsView(
+    MatrixView<V> view) noexcept {
+    return view;
+}
+
+// At least one side is a view and the other a view or Matrix of the same
+// entry type, so Matrix op Matrix keeps its own overloads
+template <class L, class R>
+concept ViewOperands =
+    (IsMatrixView<L>::value || IsMatrixView<R>::value) &&
+    requires(const L &lhs, const R &rhs) {
+        { AsView(lhs) } -> std::same_as<decltype(AsView(rhs))>;
+    };
+
+template <class T, class Op>
+std::optional<Matrix<std::remove_const_t<T>>> MapView(MatrixView<T> view,
+                                                      Op op) noexcept {
+    using V = std::remove_const_t<T>;
+    if (view.Height() == 0) {
+        return Matrix<V>::New();
+    }
+
+    std::optional<Matrix<V>> result{
+        Matrix<V>::New(view.Height(), view.Width())};
+    V *destination{result.value().Data()};
+    const std::size_t width{view.Width()};
+    const std::size_t threads{
+        view.Size() < PARALLEL_THRESHOLD ? 1 : GetThreadCount()};
+    ParallelFor(view.Height(), threads, [&](std::size_t row) {
+        for (std::size_t column{0}; column < width; column++) {
+            destination[(row * width) + column] = op(view(row, column));
+        }
+    });
+    return result;
+}
+
+}  // namespace detail
+
+// Any mix of views and matrices, with the same broadcasting rules and results
+// as the Matrix overloads. Views are read in place, never copied.
+
+template <class L, class R>
+    requires detail::ViewOperands<L, R>
+inline auto operator+(const L &lhs, const R &rhs) noexcept {
+    return Broadcast(detail::AsView(lhs), detail::AsView(rhs),
+                     [](const auto &left, const auto &right) {
+                         return left + right;
+                     });
+}
+
+template <class L, class R>
+    requires detail::ViewOperands<L, R>
+inline auto operator-(const L &lhs, const R &rhs) noexcept {
+    return Broadcast(detail::AsView(lhs), detail::AsView(rhs),
+                     [](const auto &left, const auto &right) {
+                         return left - right;
+                     });
+}
+
+template <class L, class R>
+    requires detail::ViewOperands<L, R>
+inline auto MultiplyElements(const L &lhs, const R &rhs) noexcept {
+    return Broadcast(detail::AsView(lhs), detail::AsView(rhs),
+                     [](const auto &left, const auto &right) {
+                         return left * right;
+                     });
+}
+
+template <class L, class R>
+    requires detail::ViewOperands<L, R>
+inline auto DivideElements(const L &lhs, const R &rhs) noexcept {
+    return Broadcast(detail::AsView(lhs), detail::AsView(rhs),
+                     [](const auto &left, const auto &right) {
+                         return left / right;
+                     });
+}
+
+template <class L, class R>
+    requires detail::ViewOperands<L, R>
+inline auto operator*(const L &lhs, const R &rhs) noexcept {
+    return Multiply(detail::AsView(lhs), detail::AsView(rhs),
+                    GetThreadCount());
+}
+
+template <class T, SimpleNumber U>
+inline auto operator+(MatrixView<T> lhs, U rhs) noexcept {
+    const std::remove_const_t<T> scalar{
+        static_cast<std::remove_const_t<T>>(rhs)};
+    return detail::MapView(
+        lhs, [scalar](const auto &entry) { return entry + scalar; });
+}
+
+template <class T, SimpleNumber U>
+inline auto operator-(MatrixView<T> lhs, U rhs) noexcept {
+    const std::remove_const_t<T> scalar{
+        static_cast<std::remove_const_t<T>>(rhs)};
+    return detail::MapView(
+        lhs, [scalar](const auto &entry) { return entry - scalar; });
+}
+
+template <class T, SimpleNumber U>
+inline auto operator*(MatrixView<T> lhs, U rhs) noexcept {
+    const std::remove_const_t<T> scalar{
+        static_cast<std::remove_const_t<T>>(rhs)};
+    return detail::MapView(
+        lhs, [scalar](const auto &entry) { return entry * scalar; });
+}
+
+template <class T, SimpleNumber U>
+inline auto operator/(MatrixView<T> lhs, U rhs) noexcept {
+    const std::remove_const_t<T> scalar{
+        static_cast<std::remove_const_t<T>>(rhs)};
+    return detail::MapView(
+        lhs, [scalar](const auto &entry) { return entry / scalar; });
+}
+
+template <class T, SimpleNumber U>
+inline auto operator+(U lhs, MatrixView<T> rhs) noexcept {
+    return rhs + lhs;
+}
+
+template <class T, SimpleNumber U>
+inline auto operator-(U lhs, MatrixView<T> rhs) noexcept {
+    const std::remove_const_t<T> scalar{
+        static_cast<std::remove_const_t<T>>(lhs)};
+    return detail::MapView(
+        rhs, [scalar](const auto &entry) { return scalar - entry; });
+}
+
+template <class T, SimpleNumber U>
+inline auto operator*(U lhs, MatrixView<T> rhs) noexcept {
+    return rhs * lhs;
+}
+
+template <class T, SimpleNumber U>
+inline auto operator/(U lhs, MatrixView<T> rhs) noexcept {
+    const std::remove_const_t<T> scalar{
+        static_cast<std::remove_const_t<T>>(lhs)};
+    return detail::MapView(
+        rhs, [scalar](const auto &entry) { return scalar / entry; });
 }
 
 }  // namespace ppp
@@ -0,0 +1,205 @@
+/*
+ *  Numa.hpp
+ *  NUMA aware placement of Matrix and Column buffers
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_NUMA_HPP_
+#define PPP_PPP_NUMA_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(PPP_HAVE_LIBNUMA)
+#include <numa.h>
+#endif
+
+#include "Allocator.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+enum class NumaPolicy : std::uint8_t {
+    // Pages land on the node of whichever thread writes them first
+    Local,
+    // Pages are spread round robin over every node
+    Interleave,
+    // Pages are first touched by the thread pool in the same contiguous
+    // ranges ParallelFor hands its slots, so with SetThreadPinning(true) each
+    // range lives on the node of the worker that later sweeps it
+    Partitioned,
+};
+
+// Smaller buffers go upstream; placing them is not worth a mapping
+constexpr std::size_t NUMA_MIN_BYTES{1 << 21};
+
+// Pages first touched per ParallelFor index under NumaPolicy::Partitioned
+constexpr std::size_t NUMA_TOUCH_PAGES{64};
+
+/**
+ * @brief NUMA nodes the allocator can place memory on; 1 on single node
+ *        machines and whenever libnuma is unavailable
+ */
+inline std::size_t NumaNodeCount() noexcept { return detail::NodeCount(); }
+
+namespace detail {
+
+inline std::size_t PageSize() noexcept {
+#if defined(__linux__)
+    static const std::size_t page{
+        static_cast<std::size_t>(std::max(1L, sysconf(_SC_PAGESIZE)))};
+    return page;
+#else
+    return 4096;
+#endif
+}
+
+inline void InterleavePages(void *pointer, std::size_t bytes) noexcept {
+#if defined(PPP_HAVE_LIBNUMA)
+    if (NodeCount() > 1) {
+        numa_interleave_memory(pointer, bytes, numa_all_nodes_ptr);
+    }
+#else
+    (void)pointer;
+    (void)bytes;
+#endif
+}
+
+// Writes one byte of every page, split over the pool like a linear sweep
+inline void PartitionPages(void *pointer, std::size_t bytes,
+                           std::size_t threads) {
+    volatile std::byte *base{static_cast<std::byte *>(pointer)};
+    const std::size_t page{PageSize()};
+    const std::size_t pages{(bytes + page - 1) / page};
+    const std::size_t chunks{(pages + NUMA_TOUCH_PAGES - 1) /
+                             NUMA_TOUCH_PAGES};
+    ParallelFor(chunks, threads, [&](std::size_t chunk) {
+        const std::size_t first{chunk * NUMA_TOUCH_PAGES};
+        const std::size_t last{std::min(pages, first + NUMA_TOUCH_PAGES)};
+        for (std::size_t index{first}; index < last; index++) {
+            base[index * page] = std::byte{0};
+        }
+    });
+}
+
+}  // namespace detail
+
+/*
+ * Memory resource that places large buffers by a NumaPolicy. Buffers of at
+ * least NUMA_MIN_BYTES are mapped straight from the kernel, so no page has
+ * been touched before the policy decides where it goes; smaller ones come
+ * from upstream unchanged. Install it with ScopedResource to place every
+ * Matrix and Column created on this thread:
+ *
+ *     ppp::ScopedResource numa{
+ *         &ppp::SharedNumaResource(ppp::NumaPolicy::Interleave)};
+ *
+ * Without libnuma, or on one node, Interleave is a plain mapping, and
+ * Partitioned still first touches in parallel.
+ */
+class NumaResource : public std::pmr::memory_resource {
+ public:
+    explicit NumaResource(
+        NumaPolicy policy,
+        std::pmr::memory_resource *upstream =
+            std::pmr::new_delete_resource()) noexcept
+        : policy_{policy}, upstream_{upstream} {}
+
+    NumaResource(const NumaResource &) = delete;
+    NumaResource &operator=(const NumaResource &) = delete;
+
+    NumaPolicy Policy() const noexcept { return policy_; }
+
+ private:
+    bool Mapped(std::size_t bytes, std::size_t alignment) const noexcept {
+#if defined(__linux__)
+        return policy_ != NumaPolicy::Local && bytes >= NUMA_MIN_BYTES &&
+               alignment <= detail::PageSize();
+#else
+        (void)bytes;
+        (void)alignment;
+        return false;
+#endif
+    }
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!Mapped(bytes, alignment)) {
+            return upstream_->allocate(bytes, alignment);
+        }
+#if defined(__linux__)
+        void *pointer{mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+        if (pointer == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (policy_ == NumaPolicy::Interleave) {
+            detail::InterleavePages(pointer, bytes);
+        } else {
+            detail::PartitionPages(pointer, bytes, GetThreadCount());
+        }
+        return pointer;
+#else
+        return nullptr;
+#endif
+    }
+
+    void do_deallocate(void *pointer, std::size_t bytes,
+                       std::size_t alignment) override {
+        if (!Mapped(bytes, alignment)) {
+            upstream_->deallocate(pointer, bytes, alignment);
+            return;
+        }
+#if defined(__linux__)
+        munmap(pointer, bytes);
+#endif
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    NumaPolicy policy_;
+    std::pmr::memory_resource *upstream_;
+};  // class NumaResource
+
+// Process-wide resource for policy, shared like SharedPool()
+inline NumaResource &SharedNumaResource(NumaPolicy policy) noexcept {
+    static NumaResource local{NumaPolicy::Local};
+    static NumaResource interleave{NumaPolicy::Interleave};
+    static NumaResource partitioned{NumaPolicy::Partitioned};
+    switch (policy) {
+        case NumaPolicy::Interleave:
+            return interleave;
+        case NumaPolicy::Partitioned:
+            return partitioned;
+        default:
+            return local;
+    }
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_NUMA_HPP_
@@ -0,0 +1,561 @@
+/*
+ *  Quantized.hpp
+ *  8 bit quantized matrices and their int32 accumulating product
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_QUANTIZED_HPP_
+#define PPP_PPP_QUANTIZED_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+#include "Reduce.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+template <class I>
+concept QuantizedEntry =
+    std::same_as<I, std::int8_t> || std::same_as<I, std::uint8_t>;
+
+/*
+ * A quantized matrix stores q = round(x / scale) + zero_point, with one scale
+ * and zero point per row, per column or for the whole matrix. int8 is
+ * symmetric (zero point 0, scale max|x| / 127); uint8 is affine over
+ * [min(x, 0), max(x, 0)], so zero is always exact.
+ *
+ * The product runs on unsigned x signed bytes, which is what the x86 dot
+ * product instructions take: AVX512-VNNI and AVX-VNNI vpdpbusd add four
+ * u8 * s8 products into each int32 lane. Without VNNI, bytes are widened to
+ * int16 and multiplied with vpmaddwd, since vpmaddubsw saturates its int16
+ * pair sums (2 * 255 * 128 does not fit). An int8 left operand is shifted
+ * to unsigned by adding 128 while packing, and every left zero point is
+ * taken out after the fact with the column sums of the right operand:
+ * sum((a - za) * b) = sum(a * b) - za * sum(b). So only the right operand
+ * has to be int8 and symmetric. Each product is at most 255 * 128 in
+ * magnitude, so int32 accumulation is exact up to depth 65793.
+ */
+template <QuantizedEntry I>
+class QuantizedMatrix {
+ public:
+    /**
+     * @return std::nullopt if source has a non-finite entry
+     */
+    static std::optional<QuantizedMatrix<I>> New(const Matrix<float> &source,
+                                                 Axis axis = Axis::Row) {
+        const std::size_t height{source.Height()};
+        const std::size_t width{source.Width()};
+        const std::size_t slices{axis == Axis::Row      ? height
+                                 : axis == Axis::Column ? width
+                                                        : 1};
+        const float *entries{source.Data()};
+        const std::size_t row_stride{source.RowStride()};
+        const std::size_t column_stride{source.ColumnStride()};
+        const auto slice = [axis](std::size_t row, std::size_t column) {
+            return axis == Axis::Row ? row : axis == Axis::Column ? column : 0;
+        };
+
+        std::vector<float> lowest(slices, 0.0f);
+        std::vector<float> highest(slices, 0.0f);
+        for (std::size_t row{0}; row < height; row++) {
+            for (std::size_t column{0}; column < width; column++) {
+                const float entry{
+                    entries[(row * row_stride) + (column * column_stride)]};
+                if (!std::isfinite(entry)) {
+                    return std::nullopt;
+                }
+                const std::size_t index{slice(row, column)};
+                lowest[index] = std::min(lowest[index], entry);
+                highest[index] = std::max(highest[index], entry);
+            }
+        }
+
+        QuantizedMatrix<I> quantized{height, width, axis, slices};
+        for (std::size_t index{0}; index < slices; index++) {
+            float range{};
+            if constexpr (std::same_as<I, std::int8_t>) {
+                range = std::max(-lowest[index], highest[index]) / 127.0f;
+            } else {
+                range = (highest[index] - lowest[index]) / 255.0f;
+            }
+            const float scale{range > 0.0f ? range : 1.0f};
+            quantized.scales_[index] = scale;
+            if constexpr (std::same_as<I, std::uint8_t>) {
+                quantized.zero_points_[index] = static_cast<std::int32_t>(
+                    std::clamp(std::nearbyint(-lowest[index] / scale), 0.0f,
+                               255.0f));
+            }
+        }
+
+        constexpr float low{std::same_as<I, std::int8_t> ? -127.0f : 0.0f};
+        constexpr float high{std::same_as<I, std::int8_t> ? 127.0f : 255.0f};
+        for (std::size_t row{0}; row < height; row++) {
+            for (std::size_t column{0}; column < width; column++) {
+                const std::size_t index{slice(row, column)};
+                const float entry{
+                    entries[(row * row_stride) + (column * column_stride)]};
+                const float level{
+                    std::nearbyint(entry / quantized.scales_[index]) +
+                    static_cast<float>(quantized.zero_points_[index])};
+                quantized.data_[(row * width) + column] =
+                    static_cast<I>(std::clamp(level, low, high));
+            }
+        }
+        return std::make_optional<QuantizedMatrix<I>>(std::move(quantized));
+    }
+
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr Axis GetAxis() const noexcept { return axis_; }
+
+    // Row-major, Height() x Width()
+    const I *Data() const noexcept { return data_.data(); }
+
+    // One entry per row, per column or a single one, following GetAxis()
+    const std::vector<float> &Scales() const noexcept { return scales_; }
+    const std::vector<std::int32_t> &ZeroPoints() const noexcept {
+        return zero_points_;
+    }
+
+    float Scale(std::size_t row, std::size_t column) const noexcept {
+        return scales_[Slice(row, column)];
+    }
+    std::int32_t ZeroPoint(std::size_t row, std::size_t column) const noexcept {
+        return zero_points_[Slice(row, column)];
+    }
+
+    Matrix<float> Dequantize() const {
+        Matrix<float> result{Matrix<float>::New(height_, width_).value()};
+        float *entries{result.Data()};
+        for (std::size_t row{0}; row < height_; row++) {
+            for (std::size_t column{0}; column < width_; column++) {
+                const std::size_t index{Slice(row, column)};
+                entries[(row * width_) + column] =
+                    scales_[index] *
+                    static_cast<float>(
+                        static_cast<std::int32_t>(
+                            data_[(row * width_) + column]) -
+                        zero_points_[index]);
+            }
+        }
+        return result;
+    }
+
+ private:
+    QuantizedMatrix(std::size_t height, std::size_t width, Axis axis,
+                    std::size_t slices)
+        : height_{height},
+          width_{width},
+          axis_{axis},
+          data_(height * width),
+          scales_(slices, 1.0f),
+          zero_points_(slices, 0) {}
+
+    std::size_t Slice(std::size_t row, std::size_t column) const noexcept {
+        return axis_ == Axis::Row ? row : axis_ == Axis::Column ? column : 0;
+    }
+
+    std::size_t height_;
+    std::size_t width_;
+    Axis axis_;
+    std::vector<I, AlignedAllocator<I>> data_;
+    std::vector<float> scales_;
+    std::vector<std::int32_t> zero_points_;
+};  // class QuantizedMatrix
+
+namespace detail {
+
+using Int8Buffer = std::vector<std::int8_t, AlignedAllocator<std::int8_t>>;
+using UInt8Buffer = std::vector<std::uint8_t, AlignedAllocator<std::uint8_t>>;
+
+// Rows of the left operand one task handles; a multiple of every kernel's mr
+constexpr std::size_t INT8_ROW_TILE{96};
+
+/*
+ * A micro-kernel computes an mr x nr int32 tile over groups of four depth
+ * steps. The left operand is groups * 4 bytes per row at a_stride, the
+ * right one is packed per group as nr columns of four consecutive bytes.
+ */
+using Int8KernelFunction = void (*)(std::size_t groups, const std::uint8_t *a,
+                                    std::size_t a_stride, const std::int8_t *b,
+                                    std::int32_t *ab) noexcept;
+
+struct Int8Kernel {
+    std::size_t mr;
+    std::size_t nr;
+    Int8KernelFunction compute;
+};
+
+template <std::size_t MR, std::size_t NR>
+void ScalarInt8Kernel(std::size_t groups, const std::uint8_t *a,
+                      std::size_t a_stride, const std::int8_t *b,
+                      std::int32_t *ab) noexcept {
+    std::int32_t c[MR][NR]{};
+    for (std::size_t group{0}; group < groups; group++) {
+        for (std::size_t i{0}; i < MR; i++) {
+            const std::uint8_t *row{a + (i * a_stride) + (4 * group)};
+            for (std::size_t j{0}; j < NR; j++) {
+                const std::int8_t *column{b + (4 * j)};
+                c[i][j] += (static_cast<std::int32_t>(row[0]) * column[0]) +
+                           (static_cast<std::int32_t>(row[1]) * column[1]) +
+                           (static_cast<std::int32_t>(row[2]) * column[2]) +
+                           (static_cast<std::int32_t>(row[3]) * column[3]);
+            }
+        }
+        b += 4 * NR;
+    }
+    for (std::size_t i{0}; i < MR; i++) {
+        for (std::size_t j{0}; j < NR; j++) {
+            ab[(i * NR) + j] = c[i][j];
+        }
+    }
+}
+
+#ifdef PPP_SIMD_X86
+inline std::int32_t LoadGroup(const std::uint8_t *bytes) noexcept {
+    std::int32_t group;
+    std::memcpy(&group, bytes, sizeof(group));
+    return group;
+}
+
+PPP_TARGET_AVX512_VNNI inline void Avx512VnniInt8Kernel(
+    std::size_t groups, const std::uint8_t *a, std::size_t a_stride,
+    const std::int8_t *b, std::int32_t *ab) noexcept {
+    constexpr std::size_t MR{8};
+    __m512i c[MR][2];
+    PPP_UNROLL(8)
+    for (std::size_t i{0}; i < MR; i++) {
+        c[i][0] = _mm512_setzero_si512();
+        c[i][1] = _mm512_setzero_si512();
+    }
+    for (std::size_t group{0}; group < groups; group++) {
+        const __m512i b0{_mm512_load_si512(b)};
+        const __m512i b1{_mm512_load_si512(b + 64)};
+        PPP_UNROLL(8)
+        for (std::size_t i{0}; i < MR; i++) {
+            const __m512i broadcast{_mm512_set1_epi32(
+                LoadGroup(a + (i * a_stride) + (4 * group)))};
+            c[i][0] = _mm512_dpbusd_epi32(c[i][0], broadcast, b0);
+            c[i][1] = _mm512_dpbusd_epi32(c[i][1], broadcast, b1);
+        }
+        b += 128;
+    }
+    PPP_UNROLL(8)
+    for (std::size_t i{0}; i < MR; i++) {
+        _mm512_storeu_si512(ab + (32 * i), c[i][0]);
+        _mm512_storeu_si512(ab + (32 * i) + 16, c[i][1]);
+    }
+}
+
+PPP_TARGET_AVX_VNNI inline void AvxVnniInt8Kernel(
+    std::size_t groups, const std::uint8_t *a, std::size_t a_stride,
+    const std::int8_t *b, std::int32_t *ab) noexcept {
+    constexpr std::size_t MR{6};
+    __m256i c[MR][2];
+    PPP_UNROLL(6)
+    for (std::size_t i{0}; i < MR; i++) {
+        c[i][0] = _mm256_setzero_si256();
+        c[i][1] = _mm256_setzero_si256();
+    }
+    for (std::size_t group{0}; group < groups; group++) {
+        const __m256i b0{
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(b))};
+        const __m256i b1{
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(b + 32))};
+        PPP_UNROLL(6)
+        for (std::size_t i{0}; i < MR; i++) {
+            const __m256i broadcast{_mm256_set1_epi32(
+                LoadGroup(a + (i * a_stride) + (4 * group)))};
+            c[i][0] = _mm256_dpbusd_avx_epi32(c[i][0], broadcast, b0);
+            c[i][1] = _mm256_dpbusd_avx_epi32(c[i][1], broadcast, b1);
+        }
+        b += 64;
+    }
+    PPP_UNROLL(6)
+    for (std::size_t i{0}; i < MR; i++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ab + (16 * i)),
+                            c[i][0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ab + (16 * i) + 8),
+                            c[i][1]);
+    }
+}
+
+/*
+ * Each group of 8 columns is widened to two registers of int16, columns
+ * 0-3 and 4-7, and vpmaddwd against the four left bytes repeated leaves two
+ * partial sums per column. The pairs are folded once, after the loop.
+ */
+PPP_TARGET_AVX2 inline void Avx2Int8Kernel(std::size_t groups,
+                                           const std::uint8_t *a,
+                                           std::size_t a_stride,
+                                           const std::int8_t *b,
+                                           std::int32_t *ab) noexcept {
+    constexpr std::size_t MR{4};
+    __m256i c[MR][2];
+    PPP_UNROLL(4)
+    for (std::size_t i{0}; i < MR; i++) {
+        c[i][0] = _mm256_setzero_si256();
+        c[i][1] = _mm256_setzero_si256();
+    }
+    for (std::size_t group{0}; group < groups; group++) {
+        const __m256i bytes{
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(b))};
+        const __m256i b0{
+            _mm256_cvtepi8_epi16(_mm256_castsi256_si128(bytes))};
+        const __m256i b1{
+            _mm256_cvtepi8_epi16(_mm256_extracti128_si256(bytes, 1))};
+        PPP_UNROLL(4)
+        for (std::size_t i{0}; i < MR; i++) {
+            const __m256i broadcast{_mm256_cvtepu8_epi16(
+                _mm_set1_epi32(LoadGroup(a + (i * a_stride) + (4 * group))))};
+            c[i][0] =
+                _mm256_add_epi32(c[i][0], _mm256_madd_epi16(broadcast, b0));
+            c[i][1] =
+                _mm256_add_epi32(c[i][1], _mm256_madd_epi16(broadcast, b1));
+        }
+        b += 32;
+    }
+    PPP_UNROLL(4)
+    for (std::size_t i{0}; i < MR; i++) {
+        // [0 1 4 5 | 2 3 6 7] after the fold
+        const __m256i folded{_mm256_hadd_epi32(c[i][0], c[i][1])};
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(ab + (8 * i)),
+            _mm256_permute4x64_epi64(folded, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+}
+#endif
+
+inline Int8Kernel ScalarInt8() noexcept {
+    return {4, 8, &ScalarInt8Kernel<4, 8>};
+}
+
+inline Int8Kernel SelectInt8Kernel() noexcept {
+#ifdef PPP_SIMD_X86
+    if (HasAvx512Vnni()) {
+        return {8, 32, &Avx512VnniInt8Kernel};
+    } else if (HasAvxVnni()) {
+        return {6, 16, &AvxVnniInt8Kernel};
+    } else if (HasAvx2()) {
+        return {4, 8, &Avx2Int8Kernel};
+    }
+#endif
+    return ScalarInt8();
+}
+
+/**
+ * @brief Packs the k x n row-major right operand into panels of nr columns,
+ *        each group of four depth steps stored column by column
+ */
+inline Int8Buffer PackInt8Right(std::size_t k, std::size_t n,
+                                const std::int8_t *b, std::size_t nr) {
+    const std::size_t groups{RoundUp(k, 4) / 4};
+    const std::size_t panels{RoundUp(n, nr) / nr};
+    Int8Buffer packed(panels * groups * nr * 4, 0);
+    for (std::size_t panel{0}; panel < panels; panel++) {
+        const std::size_t columns{std::min(nr, n - (panel * nr))};
+        std::int8_t *destination{packed.data() + (panel * groups * nr * 4)};
+        for (std::size_t depth{0}; depth < k; depth++) {
+            const std::int8_t *source{b + (depth * n) + (panel * nr)};
+            std::int8_t *group{destination + ((depth / 4) * nr * 4) +
+                               (depth % 4)};
+            for (std::size_t column{0}; column < columns; column++) {
+                group[4 * column] = source[column];
+            }
+        }
+    }
+    return packed;
+}
+
+/**
+ * @brief Copies the m x k row-major left operand to unsigned bytes, rows
+ *        padded to a multiple of mr and depth to a multiple of four
+ *
+ * Signed entries are shifted up by 128.
+ */
+template <QuantizedEntry I>
+UInt8Buffer PackInt8Left(std::size_t m, std::size_t k, const I *a,
+                         std::size_t mr) {
+    const std::size_t depth{RoundUp(k, 4)};
+    UInt8Buffer packed(RoundUp(m, mr) * depth, 0);
+    for (std::size_t row{0}; row < m; row++) {
+        const I *source{a + (row * k)};
+        std::uint8_t *destination{packed.data() + (row * depth)};
+        for (std::size_t column{0}; column < k; column++) {
+            if constexpr (std::same_as<I, std::int8_t>) {
+                destination[column] =
+                    static_cast<std::uint8_t>(source[column] ^ 0x80);
+            } else {
+                destination[column] = source[column];
+            }
+        }
+    }
+    return packed;
+}
+
+/**
+ * @brief Runs kernel over an m x n product of packed operands, handing
+ *        each row segment of a finished tile to
+ *        store(row, column, count, values)
+ */
+template <class Store>
+void Int8Gemm(std::size_t m, std::size_t n, std::size_t k,
+              const std::uint8_t *a, const std::int8_t *b,
+              const Int8Kernel &kernel, const Store &store,
+              std::size_t threads) {
+    const std::size_t groups{RoundUp(k, 4) / 4};
+    const std::size_t a_stride{4 * groups};
+    const std::size_t panels{RoundUp(n, kernel.nr) / kernel.nr};
+    const std::size_t tiles{RoundUp(m, INT8_ROW_TILE) / INT8_ROW_TILE};
+    if (m * n * k <= 64 * 64 * 64) {
+        threads = 1;
+    }
+    ParallelFor(tiles, threads, [&](std::size_t tile) {
+        std::vector<std::int32_t> ab(kernel.mr * kernel.nr);
+        const std::size_t first{tile * INT8_ROW_TILE};
+        const std::size_t last{std::min(m, first + INT8_ROW_TILE)};
+        for (std::size_t panel{0}; panel < panels; panel++) {
+            const std::int8_t *packed{b + (panel * groups * kernel.nr * 4)};
+            const std::size_t column{panel * kernel.nr};
+            const std::size_t columns{std::min(kernel.nr, n - column)};
+            for (std::size_t row{first}; row < last; row += kernel.mr) {
+                kernel.compute(groups, a + (row * a_stride), a_stride, packed,
+                               ab.data());
+                const std::size_t rows{std::min(kernel.mr, last - row)};
+                for (std::size_t i{0}; i < rows; i++) {
+                    store(row + i, column, columns,
+                          ab.data() + (i * kernel.nr));
+                }
+            }
+        }
+    });
+}
+
+// Runs the product with the left zero points taken out, as documented above
+template <QuantizedEntry I, class Store>
+void QuantizedProduct(const QuantizedMatrix<I> &lhs,
+                      const QuantizedMatrix<std::int8_t> &rhs,
+                      const Int8Kernel &kernel, const Store &store) {
+    const std::size_t m{lhs.Height()};
+    const std::size_t k{lhs.Width()};
+    const std::size_t n{rhs.Width()};
+    const UInt8Buffer a{PackInt8Left(m, k, lhs.Data(), kernel.mr)};
+    const Int8Buffer b{PackInt8Right(k, n, rhs.Data(), kernel.nr)};
+
+    std::vector<std::int32_t> column_sums(n, 0);
+    for (std::size_t depth{0}; depth < k; depth++) {
+        const std::int8_t *row{rhs.Data() + (depth * n)};
+        for (std::size_t column{0}; column < n; column++) {
+            column_sums[column] += row[column];
+        }
+    }
+    const std::int32_t shift{std::same_as<I, std::int8_t> ? 128 : 0};
+
+    Int8Gemm(
+        m, n, k, a.data(), b.data(), kernel,
+        [&](std::size_t row, std::size_t column, std::size_t count,
+            std::int32_t *values) {
+            const std::int32_t zero_point{lhs.ZeroPoint(row, 0) + shift};
+            for (std::size_t j{0}; j < count; j++) {
+                values[j] -= zero_point * column_sums[column + j];
+            }
+            store(row, column, count, values);
+        },
+        GetThreadCount());
+}
+
+template <QuantizedEntry I>
+bool QuantizedConformable(const QuantizedMatrix<I> &lhs,
+                          const QuantizedMatrix<std::int8_t> &rhs) noexcept {
+    return lhs.Width() == rhs.Height() && lhs.GetAxis() != Axis::Column &&
+           rhs.GetAxis() != Axis::Row;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Exact sum((lhs - zero point) * rhs) over the shared dimension, in
+ *        quantized units
+ *
+ * @return std::nullopt if the inner dimensions differ, or a scale or zero
+ *         point varies along the shared dimension (lhs quantized per column
+ *         or rhs per row)
+ */
+template <QuantizedEntry I>
+std::optional<Matrix<std::int32_t>> IntegerProduct(
+    const QuantizedMatrix<I> &lhs, const QuantizedMatrix<std::int8_t> &rhs) {
+    if (!detail::QuantizedConformable(lhs, rhs)) {
+        return std::nullopt;
+    }
+    const std::size_t n{rhs.Width()};
+    Matrix<std::int32_t> result{
+        Matrix<std::int32_t>::New(lhs.Height(), n).value()};
+    std::int32_t *entries{result.Data()};
+    detail::QuantizedProduct(
+        lhs, rhs, detail::SelectInt8Kernel(),
+        [entries, n](std::size_t row, std::size_t column, std::size_t count,
+                     const std::int32_t *values) {
+            std::copy_n(values, count, entries + (row * n) + column);
+        });
+    return std::make_optional<Matrix<std::int32_t>>(std::move(result));
+}
+
+/**
+ * @brief Approximate float product of two quantized matrices, each int32
+ *        sum scaled by its row's and column's scales
+ *
+ * @return std::nullopt under the same conditions as IntegerProduct
+ */
+template <QuantizedEntry I>
+std::optional<Matrix<float>> operator*(
+    const QuantizedMatrix<I> &lhs, const QuantizedMatrix<std::int8_t> &rhs) {
+    if (!detail::QuantizedConformable(lhs, rhs)) {
+        return std::nullopt;
+    }
+    const std::size_t n{rhs.Width()};
+    Matrix<float> result{Matrix<float>::New(lhs.Height(), n).value()};
+    float *entries{result.Data()};
+    detail::QuantizedProduct(
+        lhs, rhs, detail::SelectInt8Kernel(),
+        [&lhs, &rhs, entries, n](std::size_t row, std::size_t column,
+                                 std::size_t count,
+                                 const std::int32_t *values) {
+            const float scale{lhs.Scale(row, 0)};
+            float *destination{entries + (row * n) + column};
+            for (std::size_t j{0}; j < count; j++) {
+                destination[j] = scale * rhs.Scale(0, column + j) *
+                                 static_cast<float>(values[j]);
+            }
+        });
+    return std::make_optional<Matrix<float>>(std::move(result));
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_QUANTIZED_HPP_
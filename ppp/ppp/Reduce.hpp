@@ -0,0 +1,445 @@
+/*
+ *  Reduce.hpp
+ *  Vectorized sum and extremum reductions along and across strided lines
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_REDUCE_HPP_
+#define PPP_PPP_REDUCE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Tuning.hpp"
+
+namespace ppp {
+
+// What a Matrix reduction collapses: Row gives one entry per row, Column one
+// entry per column and All a single entry for the whole matrix
+enum class Axis : std::uint8_t {
+    Row,
+    Column,
+    All,
+};
+
+namespace detail {
+
+// A line longer than this is split across tasks when there are too few
+// lines to keep every thread busy
+constexpr std::size_t REDUCE_SEGMENT{1 << 14};
+
+// Accumulators per run sweep when reducing across lines, sized to stay in L1;
+// the default until the chunk is tuned
+constexpr std::size_t REDUCE_CHUNK{2048};
+
+// Independent partial results per run: two cache lines of T, enough chains
+// to hide the add latency at every vector width
+template <class T>
+consteval std::size_t ReduceLanes() noexcept {
+    return std::max<std::size_t>(1, (2 * BUFFER_ALIGNMENT) / sizeof(T));
+}
+
+template <class Body>
+void RunPortable(const Body &body) {
+    body();
+}
+
+#ifdef PPP_SIMD_X86
+template <class Body>
+PPP_TARGET_AVX2 void RunAvx2(const Body &body) {
+    body();
+}
+
+template <class Body>
+PPP_TARGET_AVX512 void RunAvx512(const Body &body) {
+    body();
+}
+#endif  // PPP_SIMD_X86
+
+/**
+ * @brief Runs body compiled for the widest ISA available
+ *
+ * The body, and everything it calls, has to be PPP_ALWAYS_INLINE so that it
+ * is inlined into, and vectorized for, the chosen clone.
+ */
+template <class Body>
+void RunWidest(const Body &body) {
+#ifdef PPP_SIMD_X86
+    if (HasAvx512()) {
+        RunAvx512(body);
+        return;
+    } else if (HasAvx2()) {
+        RunAvx2(body);
+        return;
+    }
+#endif  // PPP_SIMD_X86
+    RunPortable(body);
+}
+
+template <bool Greatest, class T>
+PPP_ALWAYS_INLINE constexpr bool Better(const T &candidate,
+                                        const T &best) noexcept {
+    if constexpr (Greatest) {
+        return best < candidate;
+    } else {
+        return candidate < best;
+    }
+}
+
+// Sum of map(entry) over a contiguous run
+template <class T, class Map>
+PPP_ALWAYS_INLINE inline T SumRun(const T *run, std::size_t length,
+                                  const Map &map) noexcept {
+    constexpr std::size_t lanes{ReduceLanes<T>()};
+    T partial[lanes];
+    for (std::size_t lane{0}; lane < lanes; lane++) {
+        partial[lane] = T(0);
+    }
+    std::size_t entry{0};
+    for (; entry + lanes <= length; entry += lanes) {
+        for (std::size_t lane{0}; lane < lanes; lane++) {
+            partial[lane] += map(run[entry + lane]);
+        }
+    }
+    T sum{0};
+    for (; entry < length; entry++) {
+        sum += map(run[entry]);
+    }
+    for (std::size_t lane{0}; lane < lanes; lane++) {
+        sum += partial[lane];
+    }
+    return sum;
+}
+
+// Replaces best[j] by line[j] for j in [first, last) wherever it is better,
+// recording index as where the new best came from
+template <bool Greatest, class T>
+PPP_ALWAYS_INLINE inline void ImproveRun(T *best, std::size_t *where,
+                                         const T *line, std::size_t first,
+                                         std::size_t last,
+                                         std::size_t index) noexcept {
+    for (std::size_t entry{first}; entry < last; entry++) {
+        const T value{line[entry]};
+        const bool better{Better<Greatest>(value, best[entry])};
+        best[entry] = better ? value : best[entry];
+        where[entry] = better ? index : where[entry];
+    }
+}
+
+// Smallest (largest if Greatest) entry of a non-empty contiguous run
+template <bool Greatest, class T>
+PPP_ALWAYS_INLINE inline T ExtremeValue(const T *run,
+                                        std::size_t length) noexcept {
+    constexpr std::size_t lanes{ReduceLanes<T>()};
+    T extreme{run[0]};
+    std::size_t entry{1};
+    if (length >= 2 * lanes) {
+        T best[lanes];
+        for (std::size_t lane{0}; lane < lanes; lane++) {
+            best[lane] = run[lane];
+        }
+        for (entry = lanes; entry + lanes <= length; entry += lanes) {
+            // Kept as a loop, which vectorizes, rather than unrolled into
+            // selects, which do not
+            PPP_UNROLL(1)
+            for (std::size_t lane{0}; lane < lanes; lane++) {
+                const T value{run[entry + lane]};
+                best[lane] =
+                    Better<Greatest>(value, best[lane]) ? value : best[lane];
+            }
+        }
+        extreme = best[0];
+        for (std::size_t lane{1}; lane < lanes; lane++) {
+            extreme =
+                Better<Greatest>(best[lane], extreme) ? best[lane] : extreme;
+        }
+    }
+    for (; entry < length; entry++) {
+        extreme = Better<Greatest>(run[entry], extreme) ? run[entry] : extreme;
+    }
+    return extreme;
+}
+
+/**
+ * @brief Extremum of a non-empty contiguous run and its first position
+ *
+ * Each L1-sized chunk is reduced to a value with vector compares, and only
+ * a chunk that improves on the best so far is searched again, while still
+ * cached, for the position. Entries that do not compare, such as NaN, give
+ * unspecified results.
+ */
+template <bool Greatest, class T>
+PPP_ALWAYS_INLINE inline std::pair<T, std::size_t> ExtremumRun(
+    const T *run, std::size_t length) noexcept {
+    std::pair<T, std::size_t> extremum{run[0], 0};
+    for (std::size_t start{0}; start < length; start += REDUCE_CHUNK) {
+        const std::size_t count{std::min(REDUCE_CHUNK, length - start)};
+        const T value{ExtremeValue<Greatest>(run + start, count)};
+        if (start == 0 || Better<Greatest>(value, extremum.first)) {
+            const T *found{std::find_if(
+                run + start, run + start + count, [&value](const T &entry) {
+                    return !Better<Greatest>(value, entry) &&
+                           !Better<Greatest>(entry, value);
+                })};
+            extremum = {value, static_cast<std::size_t>(found - run)};
+        }
+    }
+    return extremum;
+}
+
+// sums[j] += map(line[j], j) for j in [first, last)
+template <class T, class Map>
+PPP_ALWAYS_INLINE inline void AccumulateRun(T *sums, const T *line,
+                                            std::size_t first,
+                                            std::size_t last,
+                                            const Map &map) noexcept {
+    for (std::size_t entry{first}; entry < last; entry++) {
+        sums[entry] += map(line[entry], entry);
+    }
+}
+
+// Splits count work items into contiguous blocks, a few per thread
+template <class Block>
+void ForEachItemBlock(std::size_t count, std::size_t threads,
+                      const Block &block) {
+    const std::size_t blocks{threads <= 1 ? 1 : std::min(count, threads * 4)};
+    ParallelFor(blocks, threads, [&block, count, blocks](std::size_t task) {
+        block((task * count) / blocks, ((task + 1) * count) / blocks);
+    });
+}
+
+/**
+ * @brief Sum of map(entry, line) along each of lines contiguous runs of
+ *        length entries, stride apart, split across threads
+ */
+template <class T, class Map>
+std::vector<T> SumAlong(const T *data, std::size_t lines, std::size_t length,
+                        std::size_t stride, std::size_t threads,
+                        const Map &map) {
+    const std::size_t segments{
+        lines >= threads || length == 0
+            ? 1
+            : (length + REDUCE_SEGMENT - 1) / REDUCE_SEGMENT};
+    const std::size_t segment_length{segments == 1 ? length : REDUCE_SEGMENT};
+
+    std::vector<T> partials(lines * segments, T(0));
+    ForEachItemBlock(lines * segments, threads,
+                     [&](std::size_t first, std::size_t last) {
+        RunWidest([&]() PPP_ALWAYS_INLINE {
+            for (std::size_t item{first}; item < last; item++) {
+                const std::size_t line{item / segments};
+                const std::size_t start{(item % segments) * segment_length};
+                partials[item] = SumRun(
+                    data + (line * stride) + start,
+                    std::min(segment_length, length - start),
+                    [&map, line](const T &entry) PPP_ALWAYS_INLINE {
+                        return map(entry, line);
+                    });
+            }
+        });
+    });
+
+    if (segments == 1) {
+        return partials;
+    }
+    std::vector<T> sums(lines, T(0));
+    for (std::size_t item{0}; item < partials.size(); item++) {
+        sums[item / segments] += partials[item];
+    }
+    return sums;
+}
+
+/**
+ * @brief Sum of map(entry, j) over lines runs for every position j in
+ *        [0, length), sweeping the runs chunk positions at a time so the
+ *        sums stay cached, with blocks of runs split across threads
+ */
+template <class T, class Map>
+std::vector<T> SumAcross(const T *data, std::size_t lines, std::size_t length,
+                         std::size_t stride, std::size_t threads,
+                         const Map &map, std::size_t chunk) {
+    const std::size_t parts{std::max<std::size_t>(
+        1, std::min(lines, threads))};
+    const std::size_t chunks{(length + chunk - 1) / chunk};
+
+    std::vector<T> partials(parts * length, T(0));
+    ForEachItemBlock(parts * chunks, threads,
+                     [&](std::size_t first, std::size_t last) {
+        RunWidest([&]() PPP_ALWAYS_INLINE {
+            for (std::size_t item{first}; item < last; item++) {
+                const std::size_t part{item / chunks};
+                const std::size_t begin{(item % chunks) * chunk};
+                const std::size_t end{std::min(length, begin + chunk)};
+                T *sums{partials.data() + (part * length)};
+                for (std::size_t line{(part * lines) / parts};
+                     line < ((part + 1) * lines) / parts; line++) {
+                    AccumulateRun(sums, data + (line * stride), begin, end,
+                                  map);
+                }
+            }
+        });
+    });
+
+    for (std::size_t part{1}; part < parts; part++) {
+        for (std::size_t entry{0}; entry < length; entry++) {
+            partials[entry] += partials[(part * length) + entry];
+        }
+    }
+    partials.resize(length);
+    return partials;
+}
+
+/**
+ * @brief Extremum of each of lines non-empty contiguous runs, stride apart,
+ *        and its position within the run
+ */
+template <bool Greatest, class T>
+std::vector<std::pair<T, std::size_t>> ExtremumAlong(const T *data,
+                                                     std::size_t lines,
+                                                     std::size_t length,
+                                                     std::size_t stride,
+                                                     std::size_t threads) {
+    const std::size_t segments{
+        lines >= threads ? 1 : (length + REDUCE_SEGMENT - 1) / REDUCE_SEGMENT};
+    const std::size_t segment_length{segments == 1 ? length : REDUCE_SEGMENT};
+
+    std::vector<std::pair<T, std::size_t>> partials(lines * segments,
+                                                    {T(0), 0});
+    ForEachItemBlock(lines * segments, threads,
+                     [&](std::size_t first, std::size_t last) {
+        RunWidest([&]() PPP_ALWAYS_INLINE {
+            for (std::size_t item{first}; item < last; item++) {
+                const std::size_t start{(item % segments) * segment_length};
+                partials[item] = ExtremumRun<Greatest>(
+                    data + ((item / segments) * stride) + start,
+                    std::min(segment_length, length - start));
+                partials[item].second += start;
+            }
+        });
+    });
+
+    if (segments == 1) {
+        return partials;
+    }
+    std::vector<std::pair<T, std::size_t>> extrema(lines);
+    for (std::size_t line{0}; line < lines; line++) {
+        extrema[line] = partials[line * segments];
+        for (std::size_t segment{1}; segment < segments; segment++) {
+            const std::pair<T, std::size_t> &candidate{
+                partials[(line * segments) + segment]};
+            if (Better<Greatest>(candidate.first, extrema[line].first)) {
+                extrema[line] = candidate;
+            }
+        }
+    }
+    return extrema;
+}
+
+/**
+ * @brief Extremum over lines (at least one) runs for every position in
+ *        [0, length), and the index of the run it came from, sweeping chunk
+ *        positions at a time
+ */
+template <bool Greatest, class T>
+std::pair<std::vector<T>, std::vector<std::size_t>> ExtremumAcross(
+    const T *data, std::size_t lines, std::size_t length, std::size_t stride,
+    std::size_t threads, std::size_t chunk) {
+    const std::size_t parts{std::min(lines, std::max<std::size_t>(threads, 1))};
+    const std::size_t chunks{(length + chunk - 1) / chunk};
+
+    std::vector<T> best(parts * length, T(0));
+    std::vector<std::size_t> where(parts * length, 0);
+    ForEachItemBlock(parts * chunks, threads,
+                     [&](std::size_t first, std::size_t last) {
+        RunWidest([&]() PPP_ALWAYS_INLINE {
+            for (std::size_t item{first}; item < last; item++) {
+                const std::size_t part{item / chunks};
+                const std::size_t begin{(item % chunks) * chunk};
+                const std::size_t end{std::min(length, begin + chunk)};
+                const std::size_t first_line{(part * lines) / parts};
+                T *values{best.data() + (part * length)};
+                std::size_t *indices{where.data() + (part * length)};
+                std::copy(data + (first_line * stride) + begin,
+                          data + (first_line * stride) + end, values + begin);
+                std::fill(indices + begin, indices + end, first_line);
+                for (std::size_t line{first_line + 1};
+                     line < ((part + 1) * lines) / parts; line++) {
+                    ImproveRun<Greatest>(values, indices,
+                                         data + (line * stride), begin, end,
+                                         line);
+                }
+            }
+        });
+    });
+
+    // Later parts hold later lines, so only a strictly better entry wins
+    for (std::size_t part{1}; part < parts; part++) {
+        for (std::size_t entry{0}; entry < length; entry++) {
+            const std::size_t offset{(part * length) + entry};
+            if (Better<Greatest>(best[offset], best[entry])) {
+                best[entry] = best[offset];
+                where[entry] = where[offset];
+            }
+        }
+    }
+    best.resize(length);
+    where.resize(length);
+    return {std::move(best), std::move(where)};
+}
+
+// Times a single threaded column sum of a 64 x 16384 double matrix for
+// power of two chunks from 512 to 8192
+inline TunedValues TuneReduceChunk() {
+    constexpr std::size_t lines{64};
+    constexpr std::size_t length{1 << 14};
+    constexpr std::array<std::size_t, 5> candidates{512, 1024, 2048, 4096,
+                                                    8192};
+    std::vector<double, AlignedAllocator<double>> data(lines * length);
+    for (std::size_t entry{0}; entry < data.size(); entry++) {
+        data[entry] = static_cast<double>(entry % 9);
+    }
+    return {FastestCandidate<std::size_t>(
+                candidates,
+                [&](std::size_t chunk) {
+                    SumAcross(data.data(), lines, length, length, 1,
+                              [](const double &entry, std::size_t)
+                                  PPP_ALWAYS_INLINE { return entry; },
+                              chunk);
+                }),
+            0, 0};
+}
+
+// Tuned chunk, else REDUCE_CHUNK; cached values outside [64, 1 << 16] are
+// ignored
+inline std::size_t ReduceChunk() {
+    const std::size_t chunk{TunedValuesOr(TunedKernel::Reduce,
+                                          {REDUCE_CHUNK, 0, 0},
+                                          &TuneReduceChunk)[0]};
+    return chunk >= 64 && chunk <= (1 << 16) ? chunk : REDUCE_CHUNK;
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_REDUCE_HPP_
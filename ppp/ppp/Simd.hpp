@@ -0,0 +1,166 @@
+/*
+ *  Simd.hpp
+ *  Runtime CPU feature detection and helpers for ISA specific kernels
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_SIMD_HPP_
+#define PPP_PPP_SIMD_HPP_
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PPP_X86_64 1
+#endif
+
+// Kernels for wider ISAs are compiled into every build and chosen at runtime,
+// so the library does not need to be built with -march flags. GCC and Clang
+// need a per-function target attribute for that; MSVC accepts the intrinsics
+// anywhere.
+#if defined(PPP_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define PPP_SIMD_X86 1
+#define PPP_TARGET(features) __attribute__((target(features)))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(PPP_X86_64) && defined(_MSC_VER)
+#define PPP_SIMD_X86 1
+#define PPP_TARGET(features)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define PPP_TARGET(features)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PPP_PRAGMA(directive) _Pragma(#directive)
+#define PPP_UNROLL(count) PPP_PRAGMA(GCC unroll count)
+// Lets a generic kernel body be inlined into, and vectorized with, each
+// PPP_TARGET clone that calls it
+#define PPP_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define PPP_UNROLL(count)
+#define PPP_ALWAYS_INLINE
+#endif
+
+#define PPP_TARGET_AVX2 PPP_TARGET("avx2,fma")
+#define PPP_TARGET_AVX512 PPP_TARGET("avx512f,avx512dq,avx512bw,avx512vl,fma")
+#define PPP_TARGET_AVX512_VNNI PPP_TARGET("avx512f,avx512bw,avx512vnni")
+#define PPP_TARGET_AVX_VNNI PPP_TARGET("avx2,avxvnni")
+
+namespace ppp {
+namespace detail {
+
+struct CpuFeatures {
+    bool avx2;
+    bool fma;
+    bool avx512f;
+    bool avx512bw;
+    bool avx512dq;
+    bool avx512vl;
+    bool avx512vnni;
+    bool avx_vnni;
+};
+
+#ifdef PPP_SIMD_X86
+inline void Cpuid(std::uint32_t leaf, std::uint32_t subleaf,
+                  std::uint32_t (&registers)[4]) noexcept {
+#ifdef _MSC_VER
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i{0}; i < 4; i++) {
+        registers[i] = static_cast<std::uint32_t>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2],
+                  registers[3]);
+#endif
+}
+
+inline std::uint64_t ReadXcr0() noexcept {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    std::uint32_t eax{};
+    std::uint32_t edx{};
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif  // PPP_SIMD_X86
+
+inline CpuFeatures DetectCpuFeatures() noexcept {
+    CpuFeatures features{};
+#ifdef PPP_SIMD_X86
+    std::uint32_t registers[4]{};
+    Cpuid(0, 0, registers);
+    const std::uint32_t max_leaf{registers[0]};
+
+    Cpuid(1, 0, registers);
+    const bool osxsave{(registers[2] & (1u << 27)) != 0};
+    const bool fma{(registers[2] & (1u << 12)) != 0};
+    if (!osxsave || max_leaf < 7) {
+        return features;
+    }
+
+    // The OS has to save the wider registers on context switch too
+    const std::uint64_t xcr0{ReadXcr0()};
+    const bool ymm_state{(xcr0 & 0x6) == 0x6};
+    const bool zmm_state{(xcr0 & 0xE6) == 0xE6};
+
+    Cpuid(7, 0, registers);
+    features.avx2 = ymm_state && (registers[1] & (1u << 5)) != 0;
+    features.fma = ymm_state && fma;
+    features.avx512f = zmm_state && (registers[1] & (1u << 16)) != 0;
+    features.avx512bw = features.avx512f && (registers[1] & (1u << 30)) != 0;
+    features.avx512dq = features.avx512f && (registers[1] & (1u << 17)) != 0;
+    features.avx512vl = features.avx512f && (registers[1] & (1u << 31)) != 0;
+    features.avx512vnni =
+        features.avx512f && (registers[2] & (1u << 11)) != 0;
+
+    Cpuid(7, 1, registers);
+    features.avx_vnni = ymm_state && (registers[0] & (1u << 4)) != 0;
+#endif
+    return features;
+}
+
+inline const CpuFeatures &GetCpuFeatures() noexcept {
+    static const CpuFeatures features{DetectCpuFeatures()};
+    return features;
+}
+
+inline bool HasAvx2() noexcept {
+    return GetCpuFeatures().avx2 && GetCpuFeatures().fma;
+}
+
+inline bool HasAvx512() noexcept {
+    const CpuFeatures &features{GetCpuFeatures()};
+    return features.avx512f && features.avx512bw && features.avx512dq &&
+           features.avx512vl && features.fma;
+}
+
+inline bool HasAvx512Vnni() noexcept {
+    return HasAvx512() && GetCpuFeatures().avx512vnni;
+}
+
+inline bool HasAvxVnni() noexcept {
+    return HasAvx2() && GetCpuFeatures().avx_vnni;
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_SIMD_HPP_
@@ -0,0 +1,501 @@
+/*
+ *  Sparse.hpp
+ *  Compressed sparse row and column matrices
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_SPARSE_HPP_
+#define PPP_PPP_SPARSE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Column.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+#include "View.hpp"
+
+namespace ppp {
+
+// One stored entry in coordinate (COO) form
+template <BasicEntry T>
+struct Triplet {
+    std::size_t row;
+    std::size_t column;
+    T value;
+};
+
+/*
+ * Only the stored entries are kept, compressed along the major dimension:
+ * Layout::RowMajor is CSR and Layout::ColumnMajor is CSC. Entries of major
+ * line i are indices/values [offsets[i], offsets[i + 1]), sorted by minor
+ * index. CSR is the layout to multiply with, since every output row is then
+ * owned by a single task; CSC is there for column access and for the
+ * transposed product.
+ */
+template <BasicEntry T>
+class SparseMatrix {
+ public:
+    ~SparseMatrix() = default;
+    SparseMatrix(const SparseMatrix<T> &) = default;
+    SparseMatrix(SparseMatrix<T> &&) noexcept = default;
+    SparseMatrix<T> &operator=(const SparseMatrix<T> &) = default;
+    SparseMatrix<T> &operator=(SparseMatrix<T> &&) noexcept = default;
+
+    // Forwards by reference, since the dense sources can not be copied
+    template <class... Args>
+    [[nodiscard("You Must Check Success")]]
+    static std::optional<SparseMatrix<T>> New(Args &&...args) noexcept {
+        return SparseMatrix<T>::FactoryHelper(std::forward<Args>(args)...);
+    }
+
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr std::size_t NonZeros() const noexcept { return values_.size(); }
+    constexpr Layout GetLayout() const noexcept { return layout_; }
+
+    std::span<const std::size_t> Offsets() const noexcept { return offsets_; }
+    std::span<const std::size_t> Indices() const noexcept { return indices_; }
+    std::span<const T> Values() const noexcept { return values_; }
+
+    // Entries that are not stored read as zero
+    std::optional<T> At(std::size_t row, std::size_t column) const noexcept {
+        if (row >= height_ || column >= width_) {
+            return std::nullopt;
+        }
+
+        const bool csr{layout_ == Layout::RowMajor};
+        const std::size_t major{csr ? row : column};
+        const std::size_t minor{csr ? column : row};
+        const auto first{indices_.cbegin() + offsets_[major]};
+        const auto last{indices_.cbegin() + offsets_[major + 1]};
+        const auto found{std::lower_bound(first, last, minor)};
+        if (found == last || *found != minor) {
+            return T(0);
+        } else {
+            return values_[found - indices_.cbegin()];
+        }
+    }
+
+    Matrix<T> ToDense(Layout layout = Layout::RowMajor) const noexcept {
+        Matrix<T> dense{Matrix<T>::New(height_, width_, layout).value()};
+        const MatrixView<T> output{dense.View()};
+        const bool csr{layout_ == Layout::RowMajor};
+        ParallelFor(Major(), Threads(), [&](std::size_t major) {
+            for (std::size_t entry{offsets_[major]};
+                 entry < offsets_[major + 1]; entry++) {
+                const std::size_t minor{indices_[entry]};
+                (csr ? output(major, minor) : output(minor, major)) =
+                    values_[entry];
+            }
+        });
+        return dense;
+    }
+
+    // Recompresses along the other dimension, turning CSR into CSC or back
+    SparseMatrix<T> ToLayout(Layout layout) const noexcept {
+        if (layout == layout_) {
+            return *this;
+        }
+
+        SparseMatrix<T> result{height_, width_, layout};
+        for (const std::size_t minor : indices_) {
+            result.offsets_[minor + 1]++;
+        }
+        std::inclusive_scan(result.offsets_.cbegin(), result.offsets_.cend(),
+                            result.offsets_.begin());
+        result.indices_.resize(values_.size());
+        result.values_.resize(values_.size());
+
+        // Walking the old major lines in order keeps every new line sorted
+        std::vector<std::size_t> next(result.offsets_.cbegin(),
+                                      result.offsets_.cend() - 1);
+        for (std::size_t major{0}; major < Major(); major++) {
+            for (std::size_t entry{offsets_[major]};
+                 entry < offsets_[major + 1]; entry++) {
+                const std::size_t slot{next[indices_[entry]]++};
+                result.indices_[slot] = major;
+                result.values_[slot] = values_[entry];
+            }
+        }
+        return result;
+    }
+
+    template <BasicEntry V>
+    friend inline std::optional<Column<V>> Multiply(
+        const SparseMatrix<V> &lhs, const Column<V> &rhs,
+        std::size_t threads) noexcept;
+
+    template <BasicEntry V>
+    friend inline std::optional<Matrix<V>> Multiply(
+        const SparseMatrix<V> &lhs, MatrixView<const V> rhs,
+        std::size_t threads) noexcept;
+
+ private:
+    SparseMatrix(std::size_t height, std::size_t width, Layout layout) noexcept
+        : height_{height},
+          width_{width},
+          layout_{layout},
+          offsets_((layout == Layout::RowMajor ? height : width) + 1, 0),
+          indices_{},
+          values_{} {}
+
+    constexpr std::size_t Major() const noexcept {
+        return layout_ == Layout::RowMajor ? height_ : width_;
+    }
+
+    std::size_t Threads() const noexcept {
+        return values_.size() < PARALLEL_THRESHOLD ? 1 : GetThreadCount();
+    }
+
+    // Splits the major lines into at most count ranges holding about the same
+    // number of stored entries, so one dense row can not stall a whole task
+    std::vector<std::size_t> Partition(std::size_t count) const noexcept {
+        std::vector<std::size_t> bounds{0};
+        for (std::size_t part{1}; part < count; part++) {
+            const std::size_t target{(values_.size() * part) / count};
+            const std::size_t bound{static_cast<std::size_t>(
+                std::lower_bound(offsets_.cbegin(), offsets_.cend() - 1,
+                                 target) -
+                offsets_.cbegin())};
+            if (bound > bounds.back()) {
+                bounds.push_back(bound);
+            }
+        }
+        bounds.push_back(Major());
+        return bounds;
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper() noexcept {
+        return FactoryHelper(0, 0, Layout::RowMajor);
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        std::size_t rows, std::size_t columns) noexcept {
+        return FactoryHelper(rows, columns, Layout::RowMajor);
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        std::size_t rows, std::size_t columns, Layout layout) noexcept {
+        if (rows == 0 && columns != 0) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<SparseMatrix<T>>(
+                SparseMatrix<T>{rows, columns, layout});
+        }
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        std::size_t rows, std::size_t columns,
+        std::vector<Triplet<T>> triplets) noexcept {
+        return FactoryHelper(rows, columns, std::move(triplets),
+                             Layout::RowMajor);
+    }
+
+    /**
+     * @brief Builds from coordinate triplets in any order; repeated
+     *        coordinates are summed
+     *
+     * @return std::nullopt if any coordinate lies outside rows x columns
+     */
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        std::size_t rows, std::size_t columns,
+        std::vector<Triplet<T>> triplets, Layout layout) noexcept {
+        std::optional<SparseMatrix<T>> result{
+            FactoryHelper(rows, columns, layout)};
+        if (!result.has_value() ||
+            std::any_of(triplets.cbegin(), triplets.cend(),
+                        [rows, columns](const Triplet<T> &triplet) {
+                            return triplet.row >= rows ||
+                                   triplet.column >= columns;
+                        })) {
+            return std::nullopt;
+        }
+
+        const bool csr{layout == Layout::RowMajor};
+        const auto order{[csr](const Triplet<T> &left,
+                               const Triplet<T> &right) {
+            return csr ? std::pair{left.row, left.column} <
+                             std::pair{right.row, right.column}
+                       : std::pair{left.column, left.row} <
+                             std::pair{right.column, right.row};
+        }};
+        if (triplets.size() < PARALLEL_THRESHOLD) {
+            std::sort(triplets.begin(), triplets.end(), order);
+        } else {
+            std::sort(std::execution::par_unseq, triplets.begin(),
+                      triplets.end(), order);
+        }
+
+        SparseMatrix<T> &matrix{result.value()};
+        matrix.indices_.reserve(triplets.size());
+        matrix.values_.reserve(triplets.size());
+        for (std::size_t i{0}; i < triplets.size(); i++) {
+            const std::size_t major{csr ? triplets[i].row
+                                        : triplets[i].column};
+            const std::size_t minor{csr ? triplets[i].column
+                                        : triplets[i].row};
+            if (i > 0 && triplets[i - 1].row == triplets[i].row &&
+                triplets[i - 1].column == triplets[i].column) {
+                matrix.values_.back() += triplets[i].value;
+            } else {
+                matrix.indices_.push_back(minor);
+                matrix.values_.push_back(triplets[i].value);
+                matrix.offsets_[major + 1]++;
+            }
+        }
+        std::inclusive_scan(matrix.offsets_.cbegin(), matrix.offsets_.cend(),
+                            matrix.offsets_.begin());
+        return result;
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        const Matrix<T> &dense) noexcept {
+        return FactoryHelper(dense.View(), Layout::RowMajor);
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        const Matrix<T> &dense, Layout layout) noexcept {
+        return FactoryHelper(dense.View(), layout);
+    }
+
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        MatrixView<const T> dense) noexcept {
+        return FactoryHelper(dense, Layout::RowMajor);
+    }
+
+    // Keeps the nonzero entries of a dense matrix or view
+    static std::optional<SparseMatrix<T>> FactoryHelper(
+        MatrixView<const T> dense, Layout layout) noexcept {
+        std::optional<SparseMatrix<T>> result{
+            FactoryHelper(dense.Height(), dense.Width(), layout)};
+        if (!result.has_value()) {
+            return std::nullopt;
+        }
+
+        SparseMatrix<T> &matrix{result.value()};
+        const bool csr{layout == Layout::RowMajor};
+        const std::size_t majors{matrix.Major()};
+        const std::size_t minors{csr ? dense.Width() : dense.Height()};
+        const auto entry{[&dense, csr](std::size_t major, std::size_t minor) {
+            return csr ? dense(major, minor) : dense(minor, major);
+        }};
+        const std::size_t threads{
+            dense.Size() < PARALLEL_THRESHOLD ? 1 : GetThreadCount()};
+
+        // Count each line, then fill every line at its own offset in parallel
+        ParallelFor(majors, threads, [&](std::size_t major) {
+            std::size_t count{0};
+            for (std::size_t minor{0}; minor < minors; minor++) {
+                count += entry(major, minor) != T(0) ? 1 : 0;
+            }
+            matrix.offsets_[major + 1] = count;
+        });
+        std::inclusive_scan(matrix.offsets_.cbegin(), matrix.offsets_.cend(),
+                            matrix.offsets_.begin());
+        matrix.indices_.resize(matrix.offsets_.back());
+        matrix.values_.resize(matrix.offsets_.back());
+        ParallelFor(majors, threads, [&](std::size_t major) {
+            std::size_t slot{matrix.offsets_[major]};
+            for (std::size_t minor{0}; minor < minors; minor++) {
+                const T value{entry(major, minor)};
+                if (value != T(0)) {
+                    matrix.indices_[slot] = minor;
+                    matrix.values_[slot] = value;
+                    slot++;
+                }
+            }
+        });
+        return result;
+    }
+
+    std::size_t height_;
+    std::size_t width_;
+    Layout layout_;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> indices_;
+    std::vector<T> values_;
+};  // class SparseMatrix
+
+/**
+ * @brief Sparse matrix times dense vector (SpMV)
+ *
+ * CSR rows are split across threads by stored entry count. CSC scatters into
+ * one partial result per task, which are summed at the end.
+ *
+ * @return std::nullopt if rhs does not have Width() entries
+ */
+template <BasicEntry V>
+inline std::optional<Column<V>> Multiply(const SparseMatrix<V> &lhs,
+                                         const Column<V> &rhs,
+                                         std::size_t threads) noexcept {
+    if (rhs.Size() != lhs.width_) {
+        return std::nullopt;
+    }
+
+    typename Column<V>::Buffer product(lhs.height_, V(0));
+    const V *x{rhs.Data()};
+    const std::size_t tasks{lhs.NonZeros() < PARALLEL_THRESHOLD
+                                ? 1
+                                : std::max<std::size_t>(threads, 1)};
+    const std::vector<std::size_t> bounds{lhs.Partition(tasks)};
+    const std::size_t parts{bounds.size() - 1};
+
+    if (lhs.layout_ == Layout::RowMajor) {
+        ParallelFor(parts, tasks, [&](std::size_t part) {
+            for (std::size_t row{bounds[part]}; row < bounds[part + 1];
+                 row++) {
+                V sum{0};
+                for (std::size_t entry{lhs.offsets_[row]};
+                     entry < lhs.offsets_[row + 1]; entry++) {
+                    sum += lhs.values_[entry] * x[lhs.indices_[entry]];
+                }
+                product[row] = sum;
+            }
+        });
+    } else {
+        std::vector<std::vector<V>> partials(parts);
+        ParallelFor(parts, tasks, [&](std::size_t part) {
+            std::vector<V> &y{partials[part]};
+            y.assign(lhs.height_, V(0));
+            for (std::size_t column{bounds[part]}; column < bounds[part + 1];
+                 column++) {
+                const V scale{x[column]};
+                for (std::size_t entry{lhs.offsets_[column]};
+                     entry < lhs.offsets_[column + 1]; entry++) {
+                    y[lhs.indices_[entry]] += lhs.values_[entry] * scale;
+                }
+            }
+        });
+        for (const std::vector<V> &y : partials) {
+            std::transform(y.cbegin(), y.cend(), product.cbegin(),
+                           product.begin(), std::plus<V>());
+        }
+    }
+
+    return std::make_optional<Column<V>>(std::move(product), "");
+}
+
+/**
+ * @brief Sparse matrix times dense matrix (SpMM), into a row-major result
+ *
+ * Every stored entry a(i, k) adds a(i, k) times row k of rhs to row i of the
+ * result. CSR splits the result by rows, so no two tasks ever write the same
+ * entry. CSC is recompressed to CSR once when it would run in parallel.
+ *
+ * @return std::nullopt if rhs does not have Width() rows
+ */
+template <BasicEntry V>
+inline std::optional<Matrix<V>> Multiply(const SparseMatrix<V> &lhs,
+                                         MatrixView<const V> rhs,
+                                         std::size_t threads) noexcept {
+    if (rhs.Height() != lhs.width_) {
+        return std::nullopt;
+    } else if (lhs.height_ == 0 || rhs.Width() == 0) {
+        return Matrix<V>::New();
+    }
+
+    const std::size_t width{rhs.Width()};
+    const std::size_t tasks{
+        lhs.NonZeros() * width < PARALLEL_THRESHOLD
+            ? 1
+            : std::max<std::size_t>(threads, 1)};
+    if (lhs.layout_ == Layout::ColumnMajor && tasks > 1) {
+        // CSC columns scatter into every row, so split the rows of CSR
+        return Multiply(lhs.ToLayout(Layout::RowMajor), rhs, threads);
+    }
+
+    std::optional<Matrix<V>> product{Matrix<V>::New(lhs.height_, width)};
+    V *output{product.value().Data()};
+    const bool unit{rhs.ColumnStride() == 1};
+
+    // result[row][first, last) += value * rhs[inner][first, last)
+    const auto accumulate{[&](std::size_t row, std::size_t inner, V value,
+                              std::size_t first, std::size_t last) {
+        V *destination{output + (row * width)};
+        if (unit) {
+            const V *source{&rhs(inner, 0)};
+            for (std::size_t column{first}; column < last; column++) {
+                destination[column] += value * source[column];
+            }
+        } else {
+            for (std::size_t column{first}; column < last; column++) {
+                destination[column] += value * rhs(inner, column);
+            }
+        }
+    }};
+
+    if (lhs.layout_ == Layout::RowMajor) {
+        const std::vector<std::size_t> bounds{lhs.Partition(tasks)};
+        ParallelFor(bounds.size() - 1, tasks, [&](std::size_t part) {
+            for (std::size_t row{bounds[part]}; row < bounds[part + 1];
+                 row++) {
+                for (std::size_t entry{lhs.offsets_[row]};
+                     entry < lhs.offsets_[row + 1]; entry++) {
+                    accumulate(row, lhs.indices_[entry], lhs.values_[entry],
+                               0, width);
+                }
+            }
+        });
+    } else {
+        for (std::size_t column{0}; column < lhs.width_; column++) {
+            for (std::size_t entry{lhs.offsets_[column]};
+                 entry < lhs.offsets_[column + 1]; entry++) {
+                accumulate(lhs.indices_[entry], column, lhs.values_[entry], 0,
+                           width);
+            }
+        }
+    }
+
+    return product;
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> Multiply(const SparseMatrix<V> &lhs,
+                                         const Matrix<V> &rhs,
+                                         std::size_t threads) noexcept {
+    return Multiply(lhs, rhs.View(), threads);
+}
+
+template <BasicEntry V>
+inline std::optional<Column<V>> operator*(const SparseMatrix<V> &lhs,
+                                          const Column<V> &rhs) noexcept {
+    return Multiply(lhs, rhs, GetThreadCount());
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator*(const SparseMatrix<V> &lhs,
+                                          const Matrix<V> &rhs) noexcept {
+    return Multiply(lhs, rhs.View(), GetThreadCount());
+}
+
+template <BasicEntry V>
+inline std::optional<Matrix<V>> operator*(const SparseMatrix<V> &lhs,
+                                          MatrixView<const V> rhs) noexcept {
+    return Multiply(lhs, rhs, GetThreadCount());
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_SPARSE_HPP_
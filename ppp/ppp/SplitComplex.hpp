@@ -0,0 +1,480 @@
+/*
+ *  SplitComplex.hpp
+ *  Complex columns and matrices stored as separate real and imaginary planes
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_SPLITCOMPLEX_HPP_
+#define PPP_PPP_SPLITCOMPLEX_HPP_
+
+#include <algorithm>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Column.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+#include "Reduce.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+/*
+ * Interleaved std::complex storage puts the real and imaginary parts of an
+ * entry next to each other, so a vectorized multiply spends shuffles pairing
+ * them up. Split storage keeps all real parts in one plane and all
+ * imaginary parts in another: a complex multiply becomes four real
+ * multiplies and two adds on whole registers, and a complex GEMM becomes
+ * four real GEMMs on the packed real kernels,
+ *
+ *     Re(C) = Re(A) Re(B) - Im(A) Im(B),  Im(C) = Re(A) Im(B) + Im(A) Re(B).
+ *
+ * The split types convert to and from Column<std::complex<T>> and
+ * Matrix<std::complex<T>>, so data can be moved into them for a hot loop
+ * and back out for everything else.
+ */
+template <class T>
+concept SplitEntry = std::same_as<T, float> || std::same_as<T, double>;
+
+namespace detail {
+
+// Entries per parallel task for the element-wise kernels
+constexpr std::size_t SPLIT_BLOCK{1 << 14};
+
+template <class T>
+using Plane = std::vector<T, AlignedAllocator<T>>;
+
+enum class SplitOp : std::uint8_t {
+    Add,
+    Subtract,
+    Multiply,
+    MultiplyAccumulate,
+};
+
+/**
+ * @brief c = op(a, b) entry by entry over count split complex entries,
+ *        in blocks spread over up to threads threads
+ */
+template <SplitEntry T>
+void SplitElementwise(SplitOp op, std::size_t count, const T *a_real,
+                      const T *a_imag, const T *b_real, const T *b_imag,
+                      T *c_real, T *c_imag, std::size_t threads) {
+    const std::size_t blocks{(count + SPLIT_BLOCK - 1) / SPLIT_BLOCK};
+    ParallelFor(blocks, std::min(threads, blocks), [&](std::size_t block) {
+        const std::size_t first{block * SPLIT_BLOCK};
+        const std::size_t last{std::min(count, first + SPLIT_BLOCK)};
+        RunWidest([&]() PPP_ALWAYS_INLINE {
+            switch (op) {
+                case SplitOp::Add:
+                    for (std::size_t i{first}; i < last; i++) {
+                        c_real[i] = a_real[i] + b_real[i];
+                        c_imag[i] = a_imag[i] + b_imag[i];
+                    }
+                    break;
+                case SplitOp::Subtract:
+                    for (std::size_t i{first}; i < last; i++) {
+                        c_real[i] = a_real[i] - b_real[i];
+                        c_imag[i] = a_imag[i] - b_imag[i];
+                    }
+                    break;
+                case SplitOp::Multiply:
+                    for (std::size_t i{first}; i < last; i++) {
+                        const T real{(a_real[i] * b_real[i]) -
+                                     (a_imag[i] * b_imag[i])};
+                        const T imag{(a_real[i] * b_imag[i]) +
+                                     (a_imag[i] * b_real[i])};
+                        c_real[i] = real;
+                        c_imag[i] = imag;
+                    }
+                    break;
+                case SplitOp::MultiplyAccumulate:
+                    for (std::size_t i{first}; i < last; i++) {
+                        const T real{(a_real[i] * b_real[i]) -
+                                     (a_imag[i] * b_imag[i])};
+                        const T imag{(a_real[i] * b_imag[i]) +
+                                     (a_imag[i] * b_real[i])};
+                        c_real[i] += real;
+                        c_imag[i] += imag;
+                    }
+                    break;
+            }
+        });
+    });
+}
+
+/**
+ * @brief sum(conj(a) * b) over count split complex entries
+ *
+ * Partial sums are kept in ReduceLanes() independent lanes per part, as in
+ * the real reductions, so the loop vectorizes without reassociating.
+ */
+template <SplitEntry T>
+std::complex<T> SplitConjugateDot(std::size_t count, const T *a_real,
+                                  const T *a_imag, const T *b_real,
+                                  const T *b_imag) {
+    T real{0};
+    T imag{0};
+    RunWidest([&]() PPP_ALWAYS_INLINE {
+        constexpr std::size_t lanes{ReduceLanes<T>()};
+        T real_lanes[lanes];
+        T imag_lanes[lanes];
+        for (std::size_t lane{0}; lane < lanes; lane++) {
+            real_lanes[lane] = T(0);
+            imag_lanes[lane] = T(0);
+        }
+        std::size_t entry{0};
+        for (; entry + lanes <= count; entry += lanes) {
+            for (std::size_t lane{0}; lane < lanes; lane++) {
+                const std::size_t i{entry + lane};
+                real_lanes[lane] +=
+                    (a_real[i] * b_real[i]) + (a_imag[i] * b_imag[i]);
+                imag_lanes[lane] +=
+                    (a_real[i] * b_imag[i]) - (a_imag[i] * b_real[i]);
+            }
+        }
+        for (; entry < count; entry++) {
+            real += (a_real[entry] * b_real[entry]) +
+                    (a_imag[entry] * b_imag[entry]);
+            imag += (a_real[entry] * b_imag[entry]) -
+                    (a_imag[entry] * b_real[entry]);
+        }
+        for (std::size_t lane{0}; lane < lanes; lane++) {
+            real += real_lanes[lane];
+            imag += imag_lanes[lane];
+        }
+    });
+    return {real, imag};
+}
+
+/**
+ * @brief C = A * B + beta * C for row-major split planes, A m x k and B
+ *        k x n, as four real products
+ *
+ * When beta is zero C is never read.
+ */
+template <SplitEntry T>
+void SplitGemm(std::size_t m, std::size_t n, std::size_t k, const T *a_real,
+               const T *a_imag, const T *b_real, const T *b_imag, T beta,
+               T *c_real, T *c_imag, std::size_t threads) noexcept {
+    const StridedMatrix<const T> ar{a_real, k, 1};
+    const StridedMatrix<const T> ai{a_imag, k, 1};
+    const StridedMatrix<const T> br{b_real, n, 1};
+    const StridedMatrix<const T> bi{b_imag, n, 1};
+    const StridedMatrix<T> cr{c_real, n, 1};
+    const StridedMatrix<T> ci{c_imag, n, 1};
+    ParallelGemm<T>(m, n, k, T(1), ar, br, beta, cr, threads);
+    ParallelGemm<T>(m, n, k, T(-1), ai, bi, T(1), cr, threads);
+    ParallelGemm<T>(m, n, k, T(1), ar, bi, beta, ci, threads);
+    ParallelGemm<T>(m, n, k, T(1), ai, br, T(1), ci, threads);
+}
+
+}  // namespace detail
+
+template <SplitEntry T>
+class SplitComplexColumn {
+ public:
+    static SplitComplexColumn<T> New(std::size_t size) {
+        return SplitComplexColumn<T>{size};
+    }
+
+    static SplitComplexColumn<T> New(const Column<std::complex<T>> &column) {
+        SplitComplexColumn<T> split{column.Size()};
+        const std::complex<T> *entries{column.Data()};
+        for (std::size_t i{0}; i < split.Size(); i++) {
+            split.real_[i] = entries[i].real();
+            split.imag_[i] = entries[i].imag();
+        }
+        return split;
+    }
+
+    std::size_t Size() const noexcept { return real_.size(); }
+
+    const T *Real() const noexcept { return real_.data(); }
+    T *Real() noexcept { return real_.data(); }
+    const T *Imag() const noexcept { return imag_.data(); }
+    T *Imag() noexcept { return imag_.data(); }
+
+    std::optional<std::complex<T>> At(std::size_t index) const noexcept {
+        if (index >= Size()) {
+            return std::nullopt;
+        } else {
+            return std::complex<T>{real_[index], imag_[index]};
+        }
+    }
+
+    Column<std::complex<T>> Interleaved(std::string_view key = "") const {
+        typename Column<std::complex<T>>::Buffer entries(Size());
+        for (std::size_t i{0}; i < Size(); i++) {
+            entries[i] = {real_[i], imag_[i]};
+        }
+        return Column<std::complex<T>>{std::move(entries), key};
+    }
+
+    /**
+     * @brief sum(conj(this) * rhs)
+     *
+     * @return std::nullopt if the sizes differ
+     */
+    std::optional<std::complex<T>> ConjugateDot(
+        const SplitComplexColumn<T> &rhs) const {
+        if (rhs.Size() != Size()) {
+            return std::nullopt;
+        } else {
+            return detail::SplitConjugateDot(Size(), Real(), Imag(),
+                                             rhs.Real(), rhs.Imag());
+        }
+    }
+
+    // this += lhs * rhs entry by entry
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    MultiplyAccumulate(const SplitComplexColumn<T> &lhs,
+                       const SplitComplexColumn<T> &rhs) {
+        if (lhs.Size() != Size() || rhs.Size() != Size()) {
+            return std::nullopt;
+        } else {
+            detail::SplitElementwise(detail::SplitOp::MultiplyAccumulate,
+                                     Size(), lhs.Real(), lhs.Imag(),
+                                     rhs.Real(), rhs.Imag(), Real(), Imag(),
+                                     GetThreadCount());
+            return 0;
+        }
+    }
+
+ private:
+    explicit SplitComplexColumn(std::size_t size) : real_(size), imag_(size) {}
+
+    detail::Plane<T> real_;
+    detail::Plane<T> imag_;
+};  // class SplitComplexColumn
+
+template <SplitEntry T>
+class SplitComplexMatrix {
+ public:
+    static SplitComplexMatrix<T> New(std::size_t rows, std::size_t columns) {
+        return SplitComplexMatrix<T>{rows, columns};
+    }
+
+    static SplitComplexMatrix<T> New(const Matrix<std::complex<T>> &matrix) {
+        return New(matrix.View());
+    }
+
+    // Reads the view through its strides, e.g. New(matrix.Transposed())
+    static SplitComplexMatrix<T> New(MatrixView<const std::complex<T>> view) {
+        SplitComplexMatrix<T> split{view.Height(), view.Width()};
+        for (std::size_t row{0}; row < split.height_; row++) {
+            for (std::size_t column{0}; column < split.width_; column++) {
+                const std::complex<T> entry{
+                    view.Data()[(row * view.RowStride()) +
+                                (column * view.ColumnStride())]};
+                split.real_[(row * split.width_) + column] = entry.real();
+                split.imag_[(row * split.width_) + column] = entry.imag();
+            }
+        }
+        return split;
+    }
+
+    std::size_t Height() const noexcept { return height_; }
+    std::size_t Width() const noexcept { return width_; }
+
+    // Row-major planes, Height() x Width()
+    const T *Real() const noexcept { return real_.data(); }
+    T *Real() noexcept { return real_.data(); }
+    const T *Imag() const noexcept { return imag_.data(); }
+    T *Imag() noexcept { return imag_.data(); }
+
+    std::optional<std::complex<T>> At(std::size_t row,
+                                      std::size_t column) const noexcept {
+        if (row >= height_ || column >= width_) {
+            return std::nullopt;
+        } else {
+            const std::size_t index{(row * width_) + column};
+            return std::complex<T>{real_[index], imag_[index]};
+        }
+    }
+
+    Matrix<std::complex<T>> Interleaved() const {
+        Matrix<std::complex<T>> matrix{
+            Matrix<std::complex<T>>::New(height_, width_).value()};
+        std::complex<T> *entries{matrix.Data()};
+        for (std::size_t i{0}; i < real_.size(); i++) {
+            entries[i] = {real_[i], imag_[i]};
+        }
+        return matrix;
+    }
+
+    // this += lhs * rhs, a matrix product accumulated in place
+    [[nodiscard("You Must Check Success")]] std::optional<std::uint8_t>
+    MultiplyAccumulate(const SplitComplexMatrix<T> &lhs,
+                       const SplitComplexMatrix<T> &rhs) {
+        if (lhs.width_ != rhs.height_ || lhs.height_ != height_ ||
+            rhs.width_ != width_) {
+            return std::nullopt;
+        } else if (&lhs == this || &rhs == this) {
+            // The products read the operands while writing this
+            const SplitComplexMatrix<T> operand{*this};
+            return MultiplyAccumulate(&lhs == this ? operand : lhs,
+                                      &rhs == this ? operand : rhs);
+        } else {
+            detail::SplitGemm(height_, width_, lhs.width_, lhs.Real(),
+                              lhs.Imag(), rhs.Real(), rhs.Imag(), T(1),
+                              Real(), Imag(), GetThreadCount());
+            return 0;
+        }
+    }
+
+ private:
+    SplitComplexMatrix(std::size_t rows, std::size_t columns)
+        : height_{rows},
+          width_{columns},
+          real_(rows * columns),
+          imag_(rows * columns) {}
+
+    std::size_t height_;
+    std::size_t width_;
+    detail::Plane<T> real_;
+    detail::Plane<T> imag_;
+};  // class SplitComplexMatrix
+
+namespace detail {
+
+/**
+ * @brief Entry by entry op(lhs, rhs)
+ *
+ * @return std::nullopt if the sizes differ
+ */
+template <SplitEntry T>
+std::optional<SplitComplexColumn<T>> SplitApply(
+    SplitOp op, const SplitComplexColumn<T> &lhs,
+    const SplitComplexColumn<T> &rhs) {
+    if (lhs.Size() != rhs.Size()) {
+        return std::nullopt;
+    }
+    SplitComplexColumn<T> result{SplitComplexColumn<T>::New(lhs.Size())};
+    SplitElementwise(op, lhs.Size(), lhs.Real(), lhs.Imag(), rhs.Real(),
+                     rhs.Imag(), result.Real(), result.Imag(),
+                     GetThreadCount());
+    return std::make_optional<SplitComplexColumn<T>>(std::move(result));
+}
+
+/**
+ * @brief Entry by entry op(lhs, rhs)
+ *
+ * @return std::nullopt if the shapes differ
+ */
+template <SplitEntry T>
+std::optional<SplitComplexMatrix<T>> SplitApply(
+    SplitOp op, const SplitComplexMatrix<T> &lhs,
+    const SplitComplexMatrix<T> &rhs) {
+    if (lhs.Height() != rhs.Height() || lhs.Width() != rhs.Width()) {
+        return std::nullopt;
+    }
+    SplitComplexMatrix<T> result{
+        SplitComplexMatrix<T>::New(lhs.Height(), lhs.Width())};
+    SplitElementwise(op, lhs.Height() * lhs.Width(), lhs.Real(), lhs.Imag(),
+                     rhs.Real(), rhs.Imag(), result.Real(), result.Imag(),
+                     GetThreadCount());
+    return std::make_optional<SplitComplexMatrix<T>>(std::move(result));
+}
+
+}  // namespace detail
+
+template <SplitEntry T>
+std::optional<SplitComplexColumn<T>> operator+(
+    const SplitComplexColumn<T> &lhs, const SplitComplexColumn<T> &rhs) {
+    return detail::SplitApply(detail::SplitOp::Add, lhs, rhs);
+}
+
+template <SplitEntry T>
+std::optional<SplitComplexColumn<T>> operator-(
+    const SplitComplexColumn<T> &lhs, const SplitComplexColumn<T> &rhs) {
+    return detail::SplitApply(detail::SplitOp::Subtract, lhs, rhs);
+}
+
+// Entry by entry product
+template <SplitEntry T>
+std::optional<SplitComplexColumn<T>> Multiply(
+    const SplitComplexColumn<T> &lhs, const SplitComplexColumn<T> &rhs) {
+    return detail::SplitApply(detail::SplitOp::Multiply, lhs, rhs);
+}
+
+template <SplitEntry T>
+std::optional<SplitComplexMatrix<T>> operator+(
+    const SplitComplexMatrix<T> &lhs, const SplitComplexMatrix<T> &rhs) {
+    return detail::SplitApply(detail::SplitOp::Add, lhs, rhs);
+}
+
+template <SplitEntry T>
+std::optional<SplitComplexMatrix<T>> operator-(
+    const SplitComplexMatrix<T> &lhs, const SplitComplexMatrix<T> &rhs) {
+    return detail::SplitApply(detail::SplitOp::Subtract, lhs, rhs);
+}
+
+// Entry by entry product
+template <SplitEntry T>
+std::optional<SplitComplexMatrix<T>> Multiply(
+    const SplitComplexMatrix<T> &lhs, const SplitComplexMatrix<T> &rhs) {
+    return detail::SplitApply(detail::SplitOp::Multiply, lhs, rhs);
+}
+
+/**
+ * @brief Matrix product
+ *
+ * @return std::nullopt if the inner dimensions differ
+ */
+template <SplitEntry T>
+std::optional<SplitComplexMatrix<T>> operator*(
+    const SplitComplexMatrix<T> &lhs, const SplitComplexMatrix<T> &rhs) {
+    if (lhs.Width() != rhs.Height()) {
+        return std::nullopt;
+    }
+    SplitComplexMatrix<T> product{
+        SplitComplexMatrix<T>::New(lhs.Height(), rhs.Width())};
+    detail::SplitGemm(lhs.Height(), rhs.Width(), lhs.Width(), lhs.Real(),
+                      lhs.Imag(), rhs.Real(), rhs.Imag(), T(0),
+                      product.Real(), product.Imag(), GetThreadCount());
+    return std::make_optional<SplitComplexMatrix<T>>(std::move(product));
+}
+
+/**
+ * @brief Matrix times column
+ *
+ * @return std::nullopt if the matrix width is not the column size
+ */
+template <SplitEntry T>
+std::optional<SplitComplexColumn<T>> operator*(
+    const SplitComplexMatrix<T> &lhs, const SplitComplexColumn<T> &rhs) {
+    if (lhs.Width() != rhs.Size()) {
+        return std::nullopt;
+    }
+    SplitComplexColumn<T> product{SplitComplexColumn<T>::New(lhs.Height())};
+    detail::SplitGemm(lhs.Height(), 1, lhs.Width(), lhs.Real(), lhs.Imag(),
+                      rhs.Real(), rhs.Imag(), T(0), product.Real(),
+                      product.Imag(), GetThreadCount());
+    return std::make_optional<SplitComplexColumn<T>>(std::move(product));
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_SPLITCOMPLEX_HPP_
@@ -0,0 +1,695 @@
+/*
+ *  Svd.hpp
+ *  Randomized truncated SVD and PCA of tall ppp::Matrix inputs
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_SVD_HPP_
+#define PPP_PPP_SVD_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Allocator.hpp"
+#include "Decomposition.hpp"
+#include "Factorization.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+#include "Triangular.hpp"
+
+namespace ppp {
+
+/*
+ * The top k singular triplets of an m x n matrix A come from a sketch of its
+ * range (Halko, Martinsson and Tropp): Y = A * Omega for an n x l Gaussian
+ * Omega, l = k + oversampling, has nearly the same leading left singular
+ * subspace as A. With Q an orthonormal basis of Y, A ~ Q * (Q^T * A), and
+ * the small l x n matrix Q^T * A is decomposed directly. Everything costs
+ * O(m * n * l), in GEMMs and blocked Householder QR.
+ *
+ * A matrix in memory is read twice, for Y and then Q^T * A, plus twice per
+ * power iteration. SVDSketch instead reads rows block by block, once: next
+ * to Y it keeps a co-range sketch W = Psi * A for a random sign matrix Psi
+ * with 2l + 1 rows, and recovers Q^T * A afterwards as the least squares
+ * solution X of (Psi * Q) * X = W (Tropp, Yurtsever, Udell and Cevher).
+ * Psi is regenerated from its seed rather than stored.
+ */
+
+struct SVDOptions {
+    // Sketch columns beyond the rank; a few extra make the captured range
+    // nearly as good as the best rank k one
+    std::size_t oversampling{10};
+    // Extra passes with A * A^T over an in-memory matrix, which sharpen a
+    // slowly decaying spectrum. Ignored by SVDSketch.
+    std::size_t power_iterations{0};
+    std::uint64_t seed{0};
+};
+
+template <BasicEntry T>
+    requires std::floating_point<T>
+class TruncatedSVD;
+
+template <BasicEntry T>
+    requires std::floating_point<T>
+class PCA;
+
+namespace detail {
+
+// Rows of Psi regenerated at a time when forming Psi * Q
+constexpr std::size_t SKETCH_BLOCK{4096};
+
+template <class T>
+using SketchBuffer = std::vector<T, AlignedAllocator<T>>;
+
+constexpr std::uint64_t MixBits(std::uint64_t bits) noexcept {
+    bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+    return bits ^ (bits >> 31);
+}
+
+// Counter based, so any entry of a random matrix can be regenerated alone
+template <class T>
+T RandomNormal(std::uint64_t seed, std::uint64_t index) noexcept {
+    const std::uint64_t first{
+        MixBits(seed + ((2 * index + 1) * 0x9E3779B97F4A7C15ULL))};
+    const std::uint64_t second{MixBits(first + 0x9E3779B97F4A7C15ULL)};
+    // Box-Muller with uniforms in (0, 1] and [0, 1)
+    const double radius{std::sqrt(
+        -2.0 * std::log(static_cast<double>((first >> 11) + 1) * 0x1.0p-53))};
+    const double angle{2.0 * std::numbers::pi *
+                       static_cast<double>(second >> 11) * 0x1.0p-53};
+    return static_cast<T>(radius * std::cos(angle));
+}
+
+// rows x columns row-major Gaussian matrix
+template <class T>
+SketchBuffer<T> GaussianMatrix(std::size_t rows, std::size_t columns,
+                               std::uint64_t seed) {
+    SketchBuffer<T> matrix(rows * columns);
+    for (std::size_t entry{0}; entry < matrix.size(); entry++) {
+        matrix[entry] = RandomNormal<T>(seed, entry);
+    }
+    return matrix;
+}
+
+/**
+ * @brief Columns [first, first + count) of the corange x infinity random
+ *        sign matrix Psi, as a corange x count row-major block
+ */
+template <class T>
+void RandomSigns(std::uint64_t seed, std::size_t corange, std::size_t first,
+                 std::size_t count, T *block) noexcept {
+    const std::size_t words{(corange + 63) / 64};
+    for (std::size_t column{0}; column < count; column++) {
+        const std::uint64_t base{(first + column) * words};
+        for (std::size_t word{0}; word < words; word++) {
+            const std::uint64_t bits{
+                MixBits(seed ^ ((base + word) * 0x9E3779B97F4A7C15ULL))};
+            const std::size_t end{std::min(corange, (word + 1) * 64)};
+            for (std::size_t row{word * 64}; row < end; row++) {
+                block[(row * count) + column] =
+                    ((bits >> (row % 64)) & 1) != 0 ? T(1) : T(-1);
+            }
+        }
+    }
+}
+
+// Orthonormal basis of the columns of a rows x columns row-major matrix,
+// rows >= columns, by Householder QR
+template <class T>
+SketchBuffer<T> Orthonormalize(std::size_t rows, std::size_t columns,
+                               SketchBuffer<T> &&matrix,
+                               std::size_t threads) noexcept {
+    std::vector<T> tau(columns, T(0));
+    QrFactor<T>(rows, columns, {matrix.data(), columns, 1}, tau.data(),
+                threads);
+    SketchBuffer<T> q(rows * columns);
+    QrFormQ<T>(rows, columns, {matrix.data(), columns, 1}, tau.data(),
+               {q.data(), columns, 1}, threads);
+    return q;
+}
+
+template <class T>
+struct SvdParts {
+    Matrix<T> u;
+    std::vector<T> singular_values;
+    Matrix<T> vt;
+};
+
+/**
+ * @brief Rank k SVD of Q * X, for an m x l orthonormal Q and an l x n X,
+ *        all row-major, with k <= l <= n
+ *
+ * X = W * diag(sigma) * Z^T by one-sided Jacobi on X^T, whose columns are
+ * the rows of X; then U = Q * W.
+ */
+template <class T>
+SvdParts<T> SvdFromRange(std::size_t m, std::size_t n, std::size_t l,
+                         std::size_t k, const T *q, const T *x,
+                         std::size_t threads) {
+    SketchBuffer<T> columns(x, x + (l * n));
+    SketchBuffer<T> rotations(l * l);
+    JacobiSvd(n, l, columns.data(), rotations.data());
+
+    std::vector<T> norms(l, T(0));
+    for (std::size_t column{0}; column < l; column++) {
+        const T *entries{columns.data() + (column * n)};
+        norms[column] = std::sqrt(
+            std::inner_product(entries, entries + n, entries, T(0)));
+    }
+    std::vector<std::size_t> order(l);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&norms](std::size_t left, std::size_t right) {
+                         return norms[left] > norms[right];
+                     });
+
+    SvdParts<T> parts{Matrix<T>::New(m, k).value(), std::vector<T>(k),
+                      Matrix<T>::New(k, n).value()};
+    SketchBuffer<T> left(l * k);
+    T *vt{parts.vt.Data()};
+    for (std::size_t rank{0}; rank < k; rank++) {
+        const std::size_t column{order[rank]};
+        const T sigma{norms[column]};
+        parts.singular_values[rank] = sigma;
+        const T scale{sigma > T(0) ? T(1) / sigma : T(0)};
+        for (std::size_t entry{0}; entry < n; entry++) {
+            vt[(rank * n) + entry] = columns[(column * n) + entry] * scale;
+        }
+        for (std::size_t row{0}; row < l; row++) {
+            left[(row * k) + rank] = rotations[(column * l) + row];
+        }
+    }
+    ParallelGemm<T>(m, k, l, T(1), {q, l, 1}, {left.data(), k, 1}, T(0),
+                    {parts.u.Data(), k, 1}, threads);
+    return parts;
+}
+
+/**
+ * @brief output = (A - 1 * mean^T) * rhs for an m x n A and an n x l
+ *        row-major rhs, or A * rhs when mean is null
+ */
+template <class T>
+void CenteredProduct(std::size_t m, std::size_t n, std::size_t l,
+                     StridedMatrix<const T> a, const T *mean, const T *rhs,
+                     T *output, std::size_t threads) noexcept {
+    ParallelGemm<T>(m, l, n, T(1), a, {rhs, l, 1}, T(0), {output, l, 1},
+                    threads);
+    if (mean != nullptr) {
+        std::vector<T> shift(l, T(0));
+        for (std::size_t row{0}; row < n; row++) {
+            for (std::size_t column{0}; column < l; column++) {
+                shift[column] += mean[row] * rhs[(row * l) + column];
+            }
+        }
+        for (std::size_t row{0}; row < m; row++) {
+            for (std::size_t column{0}; column < l; column++) {
+                output[(row * l) + column] -= shift[column];
+            }
+        }
+    }
+}
+
+/**
+ * @brief output = lhs^T * (A - 1 * mean^T), l x n, for an m x l row-major
+ *        lhs, or lhs^T * A when mean is null
+ */
+template <class T>
+void CenteredTransposedProduct(std::size_t m, std::size_t n, std::size_t l,
+                               StridedMatrix<const T> a, const T *mean,
+                               const T *lhs, T *output,
+                               std::size_t threads) noexcept {
+    ParallelGemm<T>(l, n, m, T(1), {lhs, 1, l}, a, T(0), {output, n, 1},
+                    threads);
+    if (mean != nullptr) {
+        std::vector<T> sums(l, T(0));
+        for (std::size_t row{0}; row < m; row++) {
+            for (std::size_t column{0}; column < l; column++) {
+                sums[column] += lhs[(row * l) + column];
+            }
+        }
+        for (std::size_t row{0}; row < l; row++) {
+            for (std::size_t column{0}; column < n; column++) {
+                output[(row * n) + column] -= sums[row] * mean[column];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Rank k SVD of A - 1 * mean^T (A when mean is null) by subspace
+ *        iteration on an in-memory A
+ */
+template <class T>
+SvdParts<T> SubspaceSvd(const Matrix<T> &matrix, const T *mean,
+                        std::size_t k, const SVDOptions &options) {
+    const std::size_t m{matrix.Height()};
+    const std::size_t n{matrix.Width()};
+    const std::size_t l{std::min({k + options.oversampling, m, n})};
+    const std::size_t threads{GetThreadCount()};
+    const StridedMatrix<const T> a{Strided(matrix)};
+
+    const SketchBuffer<T> omega{GaussianMatrix<T>(n, l, options.seed)};
+    SketchBuffer<T> range(m * l);
+    CenteredProduct(m, n, l, a, mean, omega.data(), range.data(), threads);
+    SketchBuffer<T> q{Orthonormalize(m, l, std::move(range), threads)};
+
+    SketchBuffer<T> projected(l * n);
+    for (std::size_t pass{0}; pass < options.power_iterations; pass++) {
+        // Z = orth(A^T * Q), then Q = orth(A * Z)
+        CenteredTransposedProduct(m, n, l, a, mean, q.data(),
+                                  projected.data(), threads);
+        SketchBuffer<T> co_range(n * l);
+        for (std::size_t row{0}; row < l; row++) {
+            for (std::size_t column{0}; column < n; column++) {
+                co_range[(column * l) + row] = projected[(row * n) + column];
+            }
+        }
+        co_range = Orthonormalize(n, l, std::move(co_range), threads);
+        range.resize(m * l);
+        CenteredProduct(m, n, l, a, mean, co_range.data(), range.data(),
+                        threads);
+        q = Orthonormalize(m, l, std::move(range), threads);
+    }
+
+    CenteredTransposedProduct(m, n, l, a, mean, q.data(), projected.data(),
+                              threads);
+    return SvdFromRange(m, n, l, k, q.data(), projected.data(), threads);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Single pass sketch of a tall matrix that arrives in blocks of rows,
+ *        from which its truncated SVD or principal components are recovered
+ *
+ * Holds O((m + n) * (rank + oversampling)) numbers, never the matrix. Each
+ * Update() costs two GEMMs against the block.
+ */
+template <BasicEntry T>
+    requires std::floating_point<T>
+class SVDSketch {
+ public:
+    /**
+     * @return std::nullopt if rank is 0 or larger than width
+     */
+    static std::optional<SVDSketch<T>> New(std::size_t width,
+                                           std::size_t rank,
+                                           SVDOptions options = {}) noexcept {
+        if (rank == 0 || rank > width) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<SVDSketch<T>>(
+                SVDSketch<T>{width, rank, options});
+        }
+    }
+
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr std::size_t Rank() const noexcept { return rank_; }
+
+    /**
+     * @brief Appends the rows of block to the sketched matrix
+     *
+     * @return false, leaving the sketch unchanged, if block has the wrong
+     *         width
+     */
+    bool Update(const Matrix<T> &block) noexcept {
+        if (block.Width() != width_) {
+            return false;
+        }
+        const std::size_t rows{block.Height()};
+        const std::size_t threads{GetThreadCount()};
+        const detail::StridedMatrix<const T> a{detail::Strided(block)};
+
+        range_.resize((height_ + rows) * sketch_);
+        detail::ParallelGemm<T>(rows, sketch_, width_, T(1), a,
+                                {omega_.data(), sketch_, 1}, T(0),
+                                {range_.data() + (height_ * sketch_),
+                                 sketch_, 1},
+                                threads);
+
+        const std::size_t chunk{std::min(rows, detail::SKETCH_BLOCK)};
+        detail::SketchBuffer<T> signs(corange_ * chunk);
+        for (std::size_t first{0}; first < rows; first += chunk) {
+            const std::size_t count{std::min(chunk, rows - first)};
+            detail::RandomSigns(sign_seed_, corange_, height_ + first, count,
+                                signs.data());
+            detail::ParallelGemm<T>(
+                corange_, width_, count, T(1), {signs.data(), count, 1},
+                {&a(first, 0), a.row_stride, a.column_stride}, T(1),
+                {co_range_.data(), width_, 1}, threads);
+            for (std::size_t row{0}; row < corange_; row++) {
+                for (std::size_t column{0}; column < count; column++) {
+                    sign_sums_[row] += signs[(row * count) + column];
+                }
+            }
+        }
+
+        // Two passes over the block for its own mean and M2, then Chan's
+        // update merges them, so a large mean never cancels
+        std::vector<T> block_mean(width_, T(0));
+        std::vector<T> block_m2(width_, T(0));
+        for (std::size_t row{0}; row < rows; row++) {
+            for (std::size_t column{0}; column < width_; column++) {
+                block_mean[column] += a(row, column);
+            }
+        }
+        for (T &entry : block_mean) {
+            entry /= static_cast<T>(std::max<std::size_t>(rows, 1));
+        }
+        for (std::size_t row{0}; row < rows; row++) {
+            for (std::size_t column{0}; column < width_; column++) {
+                const T deviation{a(row, column) - block_mean[column]};
+                block_m2[column] += deviation * deviation;
+            }
+        }
+        if (rows != 0) {
+            const T before{static_cast<T>(height_)};
+            const T added{static_cast<T>(rows)};
+            const T total{before + added};
+            for (std::size_t column{0}; column < width_; column++) {
+                const T delta{block_mean[column] - means_[column]};
+                means_[column] += delta * (added / total);
+                m2_[column] += block_m2[column] +
+                               (delta * delta * (before * added / total));
+            }
+        }
+        height_ += rows;
+        return true;
+    }
+
+ private:
+    friend class TruncatedSVD<T>;
+    friend class PCA<T>;
+
+    SVDSketch(std::size_t width, std::size_t rank,
+              const SVDOptions &options) noexcept
+        : width_{width},
+          rank_{rank},
+          sketch_{std::min(width, rank + options.oversampling)},
+          corange_{(2 * sketch_) + 1},
+          sign_seed_{detail::MixBits(options.seed ^ 0x5851F42D4C957F2DULL)},
+          omega_{detail::GaussianMatrix<T>(width, sketch_, options.seed)},
+          co_range_(corange_ * width, T(0)),
+          sign_sums_(corange_, T(0)),
+          means_(width, T(0)),
+          m2_(width, T(0)) {}
+
+    std::vector<T> Mean() const { return means_; }
+
+    // Sum of the column variances, with one degree of freedom removed
+    T TotalVariance() const {
+        T centered{0};
+        for (const T m2 : m2_) {
+            centered += m2;
+        }
+        return centered / static_cast<T>(height_ - 1);
+    }
+
+    /**
+     * @brief Rank() SVD of the sketched matrix, with its column means
+     *        removed when mean is given
+     *
+     * The range sketch is cut to the row count when there are fewer rows
+     * than sketch columns, which keeps the rest of it Gaussian.
+     */
+    std::optional<detail::SvdParts<T>> Decompose(const T *mean) const {
+        const std::size_t m{height_};
+        if (m < rank_) {
+            return std::nullopt;
+        }
+        const std::size_t l{std::min(sketch_, m)};
+        const std::size_t threads{GetThreadCount()};
+
+        // Y - 1 * (mean^T * Omega) and W - (Psi * 1) * mean^T
+        std::vector<T> shift(l, T(0));
+        detail::SketchBuffer<T> co_range{co_range_};
+        if (mean != nullptr) {
+            for (std::size_t row{0}; row < width_; row++) {
+                for (std::size_t column{0}; column < l; column++) {
+                    shift[column] += mean[row] * omega_[(row * sketch_) +
+                                                        column];
+                }
+            }
+            for (std::size_t row{0}; row < corange_; row++) {
+                for (std::size_t column{0}; column < width_; column++) {
+                    co_range[(row * width_) + column] -=
+                        sign_sums_[row] * mean[column];
+                }
+            }
+        }
+        detail::SketchBuffer<T> range(m * l);
+        for (std::size_t row{0}; row < m; row++) {
+            for (std::size_t column{0}; column < l; column++) {
+                range[(row * l) + column] =
+                    range_[(row * sketch_) + column] - shift[column];
+            }
+        }
+        const detail::SketchBuffer<T> q{
+            detail::Orthonormalize(m, l, std::move(range), threads)};
+
+        // Psi * Q, regenerating Psi a block of columns at a time
+        detail::SketchBuffer<T> projected_signs(corange_ * l, T(0));
+        const std::size_t chunk{std::min(m, detail::SKETCH_BLOCK)};
+        detail::SketchBuffer<T> signs(corange_ * chunk);
+        for (std::size_t first{0}; first < m; first += chunk) {
+            const std::size_t count{std::min(chunk, m - first)};
+            detail::RandomSigns(sign_seed_, corange_, first, count,
+                                signs.data());
+            detail::ParallelGemm<T>(corange_, l, count, T(1),
+                                    {signs.data(), count, 1},
+                                    {q.data() + (first * l), l, 1}, T(1),
+                                    {projected_signs.data(), l, 1}, threads);
+        }
+
+        // Q^T * A ~ X minimizing ||(Psi * Q) * X - W||, through QR of Psi * Q
+        std::vector<T> tau(l, T(0));
+        detail::QrFactor<T>(corange_, l, {projected_signs.data(), l, 1},
+                            tau.data(), threads);
+        detail::QrApplyTransposed<T>(corange_, l,
+                                     {projected_signs.data(), l, 1},
+                                     tau.data(), width_,
+                                     {co_range.data(), width_, 1}, threads);
+        for (std::size_t row{0}; row < l; row++) {
+            if (projected_signs[(row * l) + row] == T(0)) {
+                return std::nullopt;
+            }
+        }
+        detail::Trsm<T>(l, width_, Triangle::Upper, Diagonal::NonUnit,
+                        {projected_signs.data(), l, 1},
+                        {co_range.data(), width_, 1}, threads);
+        return detail::SvdFromRange(m, width_, l, rank_, q.data(),
+                                    co_range.data(), threads);
+    }
+
+    std::size_t width_;
+    std::size_t rank_;
+    std::size_t sketch_;
+    std::size_t corange_;
+    std::uint64_t sign_seed_;
+    std::size_t height_{0};
+    // Omega (width x sketch), Y = A * Omega (height x sketch) and
+    // W = Psi * A (corange x width), all row-major
+    detail::SketchBuffer<T> omega_;
+    detail::SketchBuffer<T> range_{};
+    detail::SketchBuffer<T> co_range_;
+    // Psi * 1, and the running mean and sum of squared deviations of each
+    // column of A over its height_ rows
+    std::vector<T> sign_sums_;
+    std::vector<T> means_;
+    std::vector<T> m2_;
+};  // class SVDSketch
+
+/**
+ * @brief A ~ U * diag(singular values) * Vt for the leading singular triplets
+ *        of an m x n A: U is m x rank, Vt is rank x n
+ *
+ * Singular values are in decreasing order.
+ */
+template <BasicEntry T>
+    requires std::floating_point<T>
+class TruncatedSVD {
+ public:
+    /**
+     * @return std::nullopt if rank is 0 or larger than either dimension
+     */
+    static std::optional<TruncatedSVD<T>> New(const Matrix<T> &matrix,
+                                              std::size_t rank,
+                                              SVDOptions options = {}) {
+        if (rank == 0 || rank > std::min(matrix.Height(), matrix.Width())) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<TruncatedSVD<T>>(TruncatedSVD<T>{
+                detail::SubspaceSvd<T>(matrix, nullptr, rank, options)});
+        }
+    }
+
+    /**
+     * @return std::nullopt if the sketch has seen fewer rows than its rank
+     */
+    static std::optional<TruncatedSVD<T>> New(const SVDSketch<T> &sketch) {
+        std::optional<detail::SvdParts<T>> parts{sketch.Decompose(nullptr)};
+        if (!parts.has_value()) {
+            return std::nullopt;
+        } else {
+            return std::make_optional<TruncatedSVD<T>>(
+                TruncatedSVD<T>{std::move(parts.value())});
+        }
+    }
+
+    std::size_t Rank() const noexcept { return singular_values_.size(); }
+
+    const Matrix<T> &U() const noexcept { return u_; }
+    const std::vector<T> &SingularValues() const noexcept {
+        return singular_values_;
+    }
+    const Matrix<T> &Vt() const noexcept { return vt_; }
+
+ private:
+    explicit TruncatedSVD(detail::SvdParts<T> &&parts) noexcept
+        : u_{std::move(parts.u)},
+          singular_values_{std::move(parts.singular_values)},
+          vt_{std::move(parts.vt)} {}
+
+    Matrix<T> u_;
+    std::vector<T> singular_values_;
+    Matrix<T> vt_;
+};  // class TruncatedSVD
+
+/**
+ * @brief Leading principal components of the rows of an m x n data matrix,
+ *        each row one observation
+ *
+ * The components are the right singular vectors of the data with its
+ * column means removed; the centering is folded into the products, so the
+ * centered matrix is never formed.
+ */
+template <BasicEntry T>
+    requires std::floating_point<T>
+class PCA {
+ public:
+    /**
+     * @return std::nullopt if components is 0 or larger than the width, or
+     *         there are fewer than two rows or fewer rows than components
+     */
+    static std::optional<PCA<T>> New(const Matrix<T> &data,
+                                     std::size_t components,
+                                     SVDOptions options = {}) {
+        if (components == 0 || components > data.Width() ||
+            data.Height() < std::max<std::size_t>(2, components)) {
+            return std::nullopt;
+        }
+        const Column<T> means{data.Mean(Axis::Column).value()};
+        const Column<T> variances{data.Variance(Axis::Column, 1).value()};
+        std::vector<T> mean(means.Data(), means.Data() + means.Size());
+        const T total{std::accumulate(
+            variances.Data(), variances.Data() + variances.Size(), T(0))};
+        detail::SvdParts<T> parts{
+            detail::SubspaceSvd<T>(data, mean.data(), components, options)};
+        return std::make_optional<PCA<T>>(PCA<T>{
+            std::move(parts), std::move(mean), total, data.Height()});
+    }
+
+    /**
+     * @return std::nullopt if the sketch has seen fewer than two rows or
+     *         fewer rows than its rank
+     */
+    static std::optional<PCA<T>> New(const SVDSketch<T> &sketch) {
+        if (sketch.Height() < 2) {
+            return std::nullopt;
+        }
+        std::vector<T> mean{sketch.Mean()};
+        std::optional<detail::SvdParts<T>> parts{
+            sketch.Decompose(mean.data())};
+        if (!parts.has_value()) {
+            return std::nullopt;
+        }
+        return std::make_optional<PCA<T>>(
+            PCA<T>{std::move(parts.value()), std::move(mean),
+                   sketch.TotalVariance(), sketch.Height()});
+    }
+
+    std::size_t Components() const noexcept { return variance_.size(); }
+
+    // One principal axis per row, components x width
+    const Matrix<T> &Axes() const noexcept { return axes_; }
+    const std::vector<T> &Mean() const noexcept { return mean_; }
+
+    // Variance of the data along each axis, in decreasing order
+    const std::vector<T> &ExplainedVariance() const noexcept {
+        return variance_;
+    }
+    // The same, as fractions of the data's total variance
+    const std::vector<T> &ExplainedVarianceRatio() const noexcept {
+        return ratio_;
+    }
+
+    /**
+     * @brief Coordinates of each row of data along the axes, rows x
+     *        components
+     *
+     * @return std::nullopt if data has the wrong width
+     */
+    std::optional<Matrix<T>> Transform(const Matrix<T> &data) const {
+        if (data.Width() != mean_.size()) {
+            return std::nullopt;
+        }
+        Matrix<T> scores{
+            Matrix<T>::New(data.Height(), Components()).value()};
+        detail::SketchBuffer<T> axes(mean_.size() * Components());
+        for (std::size_t row{0}; row < Components(); row++) {
+            for (std::size_t column{0}; column < mean_.size(); column++) {
+                axes[(column * Components()) + row] =
+                    axes_.Data()[(row * mean_.size()) + column];
+            }
+        }
+        detail::CenteredProduct<T>(data.Height(), data.Width(), Components(),
+                                   detail::Strided(data), mean_.data(),
+                                   axes.data(), scores.Data(),
+                                   GetThreadCount());
+        return std::make_optional<Matrix<T>>(std::move(scores));
+    }
+
+ private:
+    PCA(detail::SvdParts<T> &&parts, std::vector<T> &&mean, T total,
+        std::size_t rows) noexcept
+        : axes_{std::move(parts.vt)}, mean_{std::move(mean)} {
+        for (const T sigma : parts.singular_values) {
+            variance_.push_back((sigma * sigma) / static_cast<T>(rows - 1));
+            ratio_.push_back(total > T(0) ? variance_.back() / total : T(0));
+        }
+    }
+
+    Matrix<T> axes_;
+    std::vector<T> mean_;
+    std::vector<T> variance_{};
+    std::vector<T> ratio_{};
+};  // class PCA
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_SVD_HPP_
@@ -0,0 +1,402 @@
+/*
+ *  ThreadPool.hpp
+ *  Work stealing thread pool shared by the parallel ppp kernels
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_THREADPOOL_HPP_
+#define PPP_PPP_THREADPOOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(PPP_HAVE_LIBNUMA)
+#include <numa.h>
+#endif
+
+namespace ppp {
+namespace detail {
+
+// Whether libnuma was linked in and the kernel supports NUMA
+inline bool NumaUsable() noexcept {
+#if defined(PPP_HAVE_LIBNUMA)
+    static const bool usable{numa_available() >= 0};
+    return usable;
+#else
+    return false;
+#endif
+}
+
+inline std::size_t NodeCount() noexcept {
+#if defined(PPP_HAVE_LIBNUMA)
+    if (NumaUsable()) {
+        return static_cast<std::size_t>(
+            std::max(1, numa_num_configured_nodes()));
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief The CPUs this process may run on, grouped by node so that
+ *        neighbouring pool slots, which ParallelFor hands neighbouring
+ *        ranges, share a node
+ */
+inline const std::vector<int> &PlacementCpus() {
+    static const std::vector<int> cpus{[]() {
+        std::vector<int> allowed{};
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu{0}; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) {
+                    allowed.push_back(cpu);
+                }
+            }
+        }
+#endif
+#if defined(PPP_HAVE_LIBNUMA)
+        if (NumaUsable()) {
+            std::ranges::stable_sort(allowed, {}, [](int cpu) {
+                return numa_node_of_cpu(cpu);
+            });
+        }
+#endif
+        return allowed;
+    }()};
+    return cpus;
+}
+
+// Binds the calling thread to the CPU of pool slot slot; a no-op off Linux
+inline void PinCurrentThread(std::size_t slot) noexcept {
+#if defined(__linux__)
+    const std::vector<int> &cpus{PlacementCpus()};
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[slot % cpus.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)slot;
+#endif
+}
+
+}  // namespace detail
+
+/*
+ * A ParallelFor call splits its index space into contiguous runs, one per
+ * participating thread. Each participant drains its own deque from the front
+ * and, once empty, steals single indices from the back of the others. The
+ * calling thread always participates, so a pool of N workers runs N + 1 wide.
+ *
+ * A pinned pool binds worker slot s to the s-th CPU of PlacementCpus(), so a
+ * slot keeps sweeping the same range of a buffer from the same node. The
+ * calling thread, slot 0, is left where it is.
+ */
+class ThreadPool {
+ public:
+    explicit ThreadPool(std::size_t workers, bool pinned = false)
+        : queues_(workers + 1), pinned_{pinned} {
+        if (pinned_) {
+            (void)detail::PlacementCpus();
+        }
+        workers_.reserve(workers);
+        for (std::size_t slot{1}; slot <= workers; slot++) {
+            workers_.emplace_back([this, slot](std::stop_token stop) {
+                if (pinned_) {
+                    detail::PinCurrentThread(slot);
+                }
+                WorkerLoop(stop, slot);
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        for (std::jthread &worker : workers_) {
+            worker.request_stop();
+        }
+        {
+            std::lock_guard<std::mutex> lock{wake_mutex_};
+            generation_++;
+        }
+        wake_.notify_all();
+
+        // Join here: the members the workers wait on are declared after
+        // workers_, so they would be gone before an implicit join
+        for (std::jthread &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t Concurrency() const noexcept { return workers_.size() + 1; }
+
+    bool Pinned() const noexcept { return pinned_; }
+
+    /**
+     * @brief Runs task(i) for every i in [0, count) on up to threads threads
+     *        and returns once all of them have finished
+     *
+     * Calls made from inside a task, or while another thread owns the pool,
+     * run serially on the calling thread instead of deadlocking.
+     */
+    void ParallelFor(std::size_t count, std::size_t threads,
+                     const std::function<void(std::size_t)> &task) {
+        const std::size_t participants{
+            std::min({threads, Concurrency(), count})};
+        std::unique_lock<std::mutex> submit{submit_mutex_, std::try_to_lock};
+
+        if (participants <= 1 || InsideTask() || !submit.owns_lock()) {
+            for (std::size_t index{0}; index < count; index++) {
+                task(index);
+            }
+            return;
+        }
+
+        for (std::size_t slot{0}; slot < participants; slot++) {
+            const std::size_t begin{(count * slot) / participants};
+            const std::size_t end{(count * (slot + 1)) / participants};
+            std::lock_guard<std::mutex> lock{queues_[slot].mutex};
+            for (std::size_t index{begin}; index < end; index++) {
+                queues_[slot].tasks.push_back(index);
+            }
+        }
+
+        task_ = &task;
+        remaining_.store(count, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock{wake_mutex_};
+            participants_ = participants;
+            generation_++;
+        }
+        wake_.notify_all();
+
+        RunTasks(0, participants);
+
+        std::unique_lock<std::mutex> lock{done_mutex_};
+        done_.wait(lock, [this]() {
+            return remaining_.load(std::memory_order_acquire) == 0 &&
+                   active_.load(std::memory_order_acquire) == 0;
+        });
+        task_ = nullptr;
+    }
+
+ private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    static bool &InsideTask() noexcept {
+        static thread_local bool inside_task{false};
+        return inside_task;
+    }
+
+    std::optional<std::size_t> PopOwn(std::size_t slot) {
+        std::lock_guard<std::mutex> lock{queues_[slot].mutex};
+        if (queues_[slot].tasks.empty()) {
+            return std::nullopt;
+        }
+        const std::size_t index{queues_[slot].tasks.front()};
+        queues_[slot].tasks.pop_front();
+        return index;
+    }
+
+    std::optional<std::size_t> Steal(std::size_t thief,
+                                     std::size_t participants) {
+        for (std::size_t offset{1}; offset < participants; offset++) {
+            WorkQueue &victim{queues_[(thief + offset) % participants]};
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (!victim.tasks.empty()) {
+                const std::size_t index{victim.tasks.back()};
+                victim.tasks.pop_back();
+                return index;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void RunTasks(std::size_t slot, std::size_t participants) {
+        InsideTask() = true;
+        while (remaining_.load(std::memory_order_acquire) != 0) {
+            std::optional<std::size_t> index{PopOwn(slot)};
+            if (!index.has_value()) {
+                index = Steal(slot, participants);
+            }
+            if (!index.has_value()) {
+                break;
+            }
+            (*task_)(index.value());
+            remaining_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        InsideTask() = false;
+    }
+
+    void WorkerLoop(std::stop_token stop, std::size_t slot) {
+        std::uint64_t seen{0};
+        while (true) {
+            std::size_t participants{};
+            {
+                std::unique_lock<std::mutex> lock{wake_mutex_};
+                wake_.wait(lock, [this, &seen, &stop]() {
+                    return generation_ != seen || stop.stop_requested();
+                });
+                if (stop.stop_requested()) {
+                    return;
+                }
+                seen = generation_;
+                participants = participants_;
+                if (slot >= participants) {
+                    continue;
+                }
+                active_.fetch_add(1, std::memory_order_acq_rel);
+            }
+
+            RunTasks(slot, participants);
+
+            {
+                std::lock_guard<std::mutex> lock{done_mutex_};
+                active_.fetch_sub(1, std::memory_order_acq_rel);
+            }
+            done_.notify_all();
+        }
+    }
+
+    std::vector<WorkQueue> queues_;
+    bool pinned_;
+    std::vector<std::jthread> workers_;
+
+    std::mutex submit_mutex_;
+    const std::function<void(std::size_t)> *task_{nullptr};
+    std::atomic<std::size_t> remaining_{0};
+    std::atomic<std::size_t> active_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::uint64_t generation_{0};
+    std::size_t participants_{0};
+
+    std::mutex done_mutex_;
+    std::condition_variable done_;
+};  // class ThreadPool
+
+namespace detail {
+
+inline std::size_t HardwareThreads() noexcept {
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+inline std::atomic<std::size_t> &ThreadCountSetting() noexcept {
+    static std::atomic<std::size_t> threads{HardwareThreads()};
+    return threads;
+}
+
+inline std::atomic<bool> &PinningSetting() noexcept {
+    static std::atomic<bool> pinned{false};
+    return pinned;
+}
+
+struct GlobalPoolState {
+    std::mutex mutex;
+    std::shared_ptr<ThreadPool> pool;
+};
+
+inline GlobalPoolState &GlobalPool() noexcept {
+    static GlobalPoolState state{};
+    return state;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Sets how many threads the parallel kernels use when a call does not
+ *        ask for a specific count. 0 restores the hardware default.
+ */
+inline void SetThreadCount(std::size_t threads) noexcept {
+    detail::ThreadCountSetting().store(
+        threads == 0 ? detail::HardwareThreads() : threads);
+}
+
+inline std::size_t GetThreadCount() noexcept {
+    return detail::ThreadCountSetting().load();
+}
+
+/**
+ * @brief Pins the shared pool's workers to CPUs, grouped by NUMA node, or
+ *        lets them float again. Takes effect on the next parallel call.
+ */
+inline void SetThreadPinning(bool pinned) noexcept {
+    detail::PinningSetting().store(pinned);
+}
+
+inline bool GetThreadPinning() noexcept {
+    return detail::PinningSetting().load();
+}
+
+/**
+ * @brief The process wide pool, grown on demand to hold at least threads
+ *        participants, and rebuilt when the pinning setting changes
+ */
+inline std::shared_ptr<ThreadPool> GetThreadPool(std::size_t threads) {
+    detail::GlobalPoolState &state{detail::GlobalPool()};
+    std::lock_guard<std::mutex> lock{state.mutex};
+    const bool pinned{GetThreadPinning()};
+    if (!state.pool || state.pool->Concurrency() < threads ||
+        state.pool->Pinned() != pinned) {
+        state.pool = std::make_shared<ThreadPool>(
+            std::max(threads, detail::HardwareThreads()) - 1, pinned);
+    }
+    return state.pool;
+}
+
+/**
+ * @brief Runs task(i) for i in [0, count) on the shared pool
+ */
+inline void ParallelFor(std::size_t count, std::size_t threads,
+                        const std::function<void(std::size_t)> &task) {
+    if (threads <= 1 || count <= 1) {
+        for (std::size_t index{0}; index < count; index++) {
+            task(index);
+        }
+    } else {
+        GetThreadPool(threads)->ParallelFor(count, threads, task);
+    }
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_THREADPOOL_HPP_
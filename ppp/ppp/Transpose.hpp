@@ -0,0 +1,308 @@
+/*
+ *  Transpose.hpp
+ *  Tiled transpose and strided copy kernels used by ppp::Matrix
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_TRANSPOSE_HPP_
+#define PPP_PPP_TRANSPOSE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Tuning.hpp"
+
+namespace ppp {
+namespace detail {
+
+/*
+ * A transpose reads one operand along rows and writes the other along
+ * columns, so one side always strides through memory. Working in
+ * TRANSPOSE_TILE square tiles keeps both sides of a tile in L1, and inside a
+ * tile 8x8 (4 byte) or 4x4 (8 byte) blocks are transposed in registers with
+ * AVX2 shuffles. Any trivially copyable type of those sizes goes through the
+ * same shuffles, since they only move bits. TRANSPOSE_TILE is the default
+ * until the tile is tuned.
+ */
+constexpr std::size_t TRANSPOSE_TILE{64};
+
+#ifdef PPP_SIMD_X86
+PPP_TARGET_AVX2 inline void Transpose8x8(
+    const float *source, std::size_t source_stride, float *destination,
+    std::size_t destination_stride) noexcept {
+    __m256 r0{_mm256_loadu_ps(source)};
+    __m256 r1{_mm256_loadu_ps(source + source_stride)};
+    __m256 r2{_mm256_loadu_ps(source + (2 * source_stride))};
+    __m256 r3{_mm256_loadu_ps(source + (3 * source_stride))};
+    __m256 r4{_mm256_loadu_ps(source + (4 * source_stride))};
+    __m256 r5{_mm256_loadu_ps(source + (5 * source_stride))};
+    __m256 r6{_mm256_loadu_ps(source + (6 * source_stride))};
+    __m256 r7{_mm256_loadu_ps(source + (7 * source_stride))};
+
+    const __m256 t0{_mm256_unpacklo_ps(r0, r1)};
+    const __m256 t1{_mm256_unpackhi_ps(r0, r1)};
+    const __m256 t2{_mm256_unpacklo_ps(r2, r3)};
+    const __m256 t3{_mm256_unpackhi_ps(r2, r3)};
+    const __m256 t4{_mm256_unpacklo_ps(r4, r5)};
+    const __m256 t5{_mm256_unpackhi_ps(r4, r5)};
+    const __m256 t6{_mm256_unpacklo_ps(r6, r7)};
+    const __m256 t7{_mm256_unpackhi_ps(r6, r7)};
+
+    const __m256 s0{_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0))};
+    const __m256 s1{_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2))};
+    const __m256 s2{_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0))};
+    const __m256 s3{_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))};
+    const __m256 s4{_mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0))};
+    const __m256 s5{_mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2))};
+    const __m256 s6{_mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0))};
+    const __m256 s7{_mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2))};
+
+    r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+
+    _mm256_storeu_ps(destination, r0);
+    _mm256_storeu_ps(destination + destination_stride, r1);
+    _mm256_storeu_ps(destination + (2 * destination_stride), r2);
+    _mm256_storeu_ps(destination + (3 * destination_stride), r3);
+    _mm256_storeu_ps(destination + (4 * destination_stride), r4);
+    _mm256_storeu_ps(destination + (5 * destination_stride), r5);
+    _mm256_storeu_ps(destination + (6 * destination_stride), r6);
+    _mm256_storeu_ps(destination + (7 * destination_stride), r7);
+}
+
+PPP_TARGET_AVX2 inline void Transpose4x4(
+    const double *source, std::size_t source_stride, double *destination,
+    std::size_t destination_stride) noexcept {
+    const __m256d r0{_mm256_loadu_pd(source)};
+    const __m256d r1{_mm256_loadu_pd(source + source_stride)};
+    const __m256d r2{_mm256_loadu_pd(source + (2 * source_stride))};
+    const __m256d r3{_mm256_loadu_pd(source + (3 * source_stride))};
+
+    const __m256d t0{_mm256_unpacklo_pd(r0, r1)};
+    const __m256d t1{_mm256_unpackhi_pd(r0, r1)};
+    const __m256d t2{_mm256_unpacklo_pd(r2, r3)};
+    const __m256d t3{_mm256_unpackhi_pd(r2, r3)};
+
+    _mm256_storeu_pd(destination, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(destination + destination_stride,
+                     _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(destination + (2 * destination_stride),
+                     _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(destination + (3 * destination_stride),
+                     _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+#endif  // PPP_SIMD_X86
+
+/**
+ * @brief destination[c][r] = source[r][c] for one tile
+ */
+template <class T>
+void TransposeTile(std::size_t rows, std::size_t columns, const T *source,
+                   std::size_t source_stride, T *destination,
+                   std::size_t destination_stride, bool simd) noexcept {
+    std::size_t row_end{0};
+    std::size_t column_end{0};
+
+#ifdef PPP_SIMD_X86
+    if constexpr (std::is_trivially_copyable_v<T> &&
+                  (sizeof(T) == sizeof(float) || sizeof(T) == sizeof(double))) {
+        using Lane = std::conditional_t<sizeof(T) == sizeof(float), float,
+                                        double>;
+        constexpr std::size_t block{sizeof(T) == sizeof(float) ? 8 : 4};
+        if (simd) {
+            row_end = rows - (rows % block);
+            column_end = columns - (columns % block);
+            for (std::size_t row{0}; row < row_end; row += block) {
+                for (std::size_t column{0}; column < column_end;
+                     column += block) {
+                    const Lane *from{reinterpret_cast<const Lane *>(
+                        source + (row * source_stride) + column)};
+                    Lane *to{reinterpret_cast<Lane *>(
+                        destination + (column * destination_stride) + row)};
+                    if constexpr (block == 8) {
+                        Transpose8x8(from, source_stride, to,
+                                     destination_stride);
+                    } else {
+                        Transpose4x4(from, source_stride, to,
+                                     destination_stride);
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    // Ragged right edge of the SIMD blocks, then the ragged bottom rows
+    for (std::size_t row{0}; row < row_end; row++) {
+        for (std::size_t column{column_end}; column < columns; column++) {
+            destination[(column * destination_stride) + row] =
+                source[(row * source_stride) + column];
+        }
+    }
+    for (std::size_t row{row_end}; row < rows; row++) {
+        for (std::size_t column{0}; column < columns; column++) {
+            destination[(column * destination_stride) + row] =
+                source[(row * source_stride) + column];
+        }
+    }
+}
+
+/**
+ * @brief destination[c][r] = source[r][c] for a rows x columns source, both
+ *        sides with unit column stride, in tile x tile steps
+ */
+template <class T>
+void TransposeCopy(std::size_t rows, std::size_t columns, const T *source,
+                   std::size_t source_stride, T *destination,
+                   std::size_t destination_stride, std::size_t threads,
+                   std::size_t tile) noexcept {
+    const bool simd{HasAvx2()};
+    const std::size_t row_tiles{(rows + tile - 1) / tile};
+    ParallelFor(row_tiles, threads, [&](std::size_t tile_row) {
+        const std::size_t row{tile_row * tile};
+        const std::size_t tile_rows{std::min(tile, rows - row)};
+        for (std::size_t column{0}; column < columns; column += tile) {
+            TransposeTile(tile_rows, std::min(tile, columns - column),
+                          source + (row * source_stride) + column,
+                          source_stride,
+                          destination + (column * destination_stride) + row,
+                          destination_stride, simd);
+        }
+    });
+}
+
+// Times a single threaded out-of-place transpose of a 1024 x 1024 float
+// matrix for power of two tiles from 16 to 256
+inline TunedValues TuneTransposeTile() {
+    constexpr std::size_t size{1024};
+    constexpr std::array<std::size_t, 5> candidates{16, 32, 64, 128, 256};
+    std::vector<float, AlignedAllocator<float>> source(size * size);
+    std::vector<float, AlignedAllocator<float>> destination(size * size);
+    for (std::size_t entry{0}; entry < source.size(); entry++) {
+        source[entry] = static_cast<float>(entry);
+    }
+    return {FastestCandidate<std::size_t>(
+                candidates,
+                [&](std::size_t tile) {
+                    TransposeCopy(size, size, source.data(), size,
+                                  destination.data(), size, 1, tile);
+                }),
+            0, 0};
+}
+
+// Tuned tile edge, else TRANSPOSE_TILE; cached values outside [8, 1024] are
+// ignored
+inline std::size_t TransposeTileSize() {
+    const std::size_t tile{TunedValuesOr(TunedKernel::Transpose,
+                                         {TRANSPOSE_TILE, 0, 0},
+                                         &TuneTransposeTile)[0]};
+    return tile >= 8 && tile <= 1024 ? tile : TRANSPOSE_TILE;
+}
+
+/**
+ * @brief output(r, c) = input(r, c) for any pair of strided matrices
+ *
+ * When one side is row-major and the other column-major this is a transpose
+ * in memory, so it goes through the tiled kernel; matching layouts are
+ * copied line by line.
+ */
+template <class T>
+void CopyStrided(std::size_t rows, std::size_t columns,
+                 StridedMatrix<const T> input, StridedMatrix<T> output,
+                 std::size_t threads) noexcept {
+    if (rows == 0 || columns == 0) {
+        return;
+    } else if (input.column_stride == 1 && output.column_stride == 1) {
+        ParallelFor(rows, threads, [&](std::size_t row) {
+            std::copy_n(&input(row, 0), columns, &output(row, 0));
+        });
+    } else if (input.row_stride == 1 && output.row_stride == 1) {
+        ParallelFor(columns, threads, [&](std::size_t column) {
+            std::copy_n(&input(0, column), rows, &output(0, column));
+        });
+    } else if (input.row_stride == 1 && output.column_stride == 1) {
+        TransposeCopy(columns, rows, input.data, input.column_stride,
+                      output.data, output.row_stride, threads,
+                      TransposeTileSize());
+    } else if (input.column_stride == 1 && output.row_stride == 1) {
+        TransposeCopy(rows, columns, input.data, input.row_stride,
+                      output.data, output.column_stride, threads,
+                      TransposeTileSize());
+    } else {
+        ParallelFor(rows, threads, [&](std::size_t row) {
+            for (std::size_t column{0}; column < columns; column++) {
+                output(row, column) = input(row, column);
+            }
+        });
+    }
+}
+
+/**
+ * @brief Transposes an n x n matrix with unit column stride in place
+ *
+ * Tiles (i, j) and (j, i) are swapped through a scratch tile, so each pair
+ * is read and written once.
+ */
+template <class T>
+void TransposeSquareInPlace(std::size_t n, T *data, std::size_t stride,
+                            std::size_t threads) noexcept {
+    const bool simd{HasAvx2()};
+    const std::size_t tile{TransposeTileSize()};
+    const std::size_t tiles{(n + tile - 1) / tile};
+    ParallelFor(tiles, threads, [&](std::size_t tile_row) {
+        std::vector<T> scratch(tile * tile);
+        const std::size_t row{tile_row * tile};
+        const std::size_t rows{std::min(tile, n - row)};
+        for (std::size_t tile_column{tile_row}; tile_column < tiles;
+             tile_column++) {
+            const std::size_t column{tile_column * tile};
+            const std::size_t columns{std::min(tile, n - column)};
+            T *upper{data + (row * stride) + column};
+            T *lower{data + (column * stride) + row};
+
+            // scratch = upper^T, upper = lower^T, lower = scratch
+            TransposeTile(rows, columns, upper, stride, scratch.data(), tile,
+                          simd);
+            if (tile_column != tile_row) {
+                TransposeTile(columns, rows, lower, stride, upper, stride,
+                              simd);
+            }
+            for (std::size_t r{0}; r < columns; r++) {
+                std::copy_n(scratch.data() + (r * tile), rows,
+                            lower + (r * stride));
+            }
+        }
+    });
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_TRANSPOSE_HPP_
@@ -0,0 +1,413 @@
+/*
+ *  Triangular.hpp
+ *  Blocked triangular solves used by the factorizations
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_TRIANGULAR_HPP_
+#define PPP_PPP_TRIANGULAR_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace ppp {
+
+enum class Triangle : std::uint8_t {
+    Lower,
+    Upper,
+};
+
+enum class Diagonal : std::uint8_t {
+    NonUnit,
+    // The diagonal is taken to be all ones and never read
+    Unit,
+};
+
+namespace detail {
+
+// Rows of the triangle solved per diagonal block; everything off the diagonal
+// block is applied with GEMM
+constexpr std::size_t TRSM_BLOCK{128};
+
+// Right hand side columns handled per task
+constexpr std::size_t SOLVE_CHUNK{256};
+
+/**
+ * @brief Runs task(first, last) over [0, columns) in SOLVE_CHUNK wide pieces
+ */
+template <class Task>
+void ForColumnChunks(std::size_t columns, std::size_t threads,
+                     const Task &task) {
+    const std::size_t chunks{(columns + SOLVE_CHUNK - 1) / SOLVE_CHUNK};
+    ParallelFor(chunks, threads, [&](std::size_t chunk) {
+        const std::size_t first{chunk * SOLVE_CHUNK};
+        task(first, std::min(columns, first + SOLVE_CHUNK));
+    });
+}
+
+/**
+ * @brief Substitution on the columns [first, last) of b for an n x n
+ *        triangle a
+ *
+ * Row-major right hand sides are updated a row at a time (axpy), column-major
+ * ones and single columns a column at a time (dot products), so the inner
+ * loop is contiguous.
+ */
+template <class T>
+void TrsmUnblocked(std::size_t n, Triangle triangle, Diagonal diagonal,
+                   StridedMatrix<const T> a, std::size_t first,
+                   std::size_t last, StridedMatrix<T> b) noexcept {
+    const bool lower{triangle == Triangle::Lower};
+    const bool unit{diagonal == Diagonal::Unit};
+
+    if ((b.row_stride == 1 && b.column_stride != 1) || last - first == 1) {
+        for (std::size_t column{first}; column < last; column++) {
+            for (std::size_t step{0}; step < n; step++) {
+                const std::size_t row{lower ? step : n - 1 - step};
+                const std::size_t begin{lower ? 0 : row + 1};
+                const std::size_t end{lower ? row : n};
+                T sum{b(row, column)};
+                for (std::size_t inner{begin}; inner < end; inner++) {
+                    sum -= a(row, inner) * b(inner, column);
+                }
+                b(row, column) = unit ? sum : sum / a(row, row);
+            }
+        }
+        return;
+    }
+
+    for (std::size_t step{0}; step < n; step++) {
+        const std::size_t row{lower ? step : n - 1 - step};
+        const std::size_t begin{lower ? 0 : row + 1};
+        const std::size_t end{lower ? row : n};
+        for (std::size_t inner{begin}; inner < end; inner++) {
+            const T multiplier{a(row, inner)};
+            for (std::size_t column{first}; column < last; column++) {
+                b(row, column) -= multiplier * b(inner, column);
+            }
+        }
+        if (!unit) {
+            const T pivot{a(row, row)};
+            for (std::size_t column{first}; column < last; column++) {
+                b(row, column) /= pivot;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Overwrites the n x columns matrix b with A^-1 * b, for the triangle
+ *        of the n x n matrix a selected by triangle
+ *
+ * The triangle is walked in TRSM_BLOCK sized diagonal blocks. Each block is
+ * solved by substitution, split across threads by right hand side column,
+ * and its contribution to the remaining rows is subtracted with one parallel
+ * GEMM, so with many right hand sides the solve runs at GEMM speed. Passing
+ * a with its strides swapped solves with the transpose.
+ */
+template <class T>
+void Trsm(std::size_t n, std::size_t columns, Triangle triangle,
+          Diagonal diagonal, StridedMatrix<const T> a, StridedMatrix<T> b,
+          std::size_t threads) noexcept {
+    if (n == 0 || columns == 0) {
+        return;
+    } else if (columns == 1) {
+        // A lone right hand side has nothing for GEMM to reuse, and one pass
+        // of dot products reads the triangle once without packing it
+        TrsmUnblocked(n, triangle, diagonal, a, 0, 1, b);
+        return;
+    }
+
+    const std::size_t blocks{(n + TRSM_BLOCK - 1) / TRSM_BLOCK};
+    for (std::size_t step{0}; step < blocks; step++) {
+        const std::size_t block{
+            triangle == Triangle::Lower ? step : blocks - 1 - step};
+        const std::size_t begin{block * TRSM_BLOCK};
+        const std::size_t end{std::min(n, begin + TRSM_BLOCK)};
+
+        const StridedMatrix<const T> diagonal_block{
+            &a(begin, begin), a.row_stride, a.column_stride};
+        const StridedMatrix<T> solved{&b(begin, 0), b.row_stride,
+                                      b.column_stride};
+        ForColumnChunks(columns, threads,
+                        [&](std::size_t first, std::size_t last) {
+                            TrsmUnblocked(end - begin, triangle, diagonal,
+                                          diagonal_block, first, last, solved);
+                        });
+
+        const StridedMatrix<const T> solved_rows{&b(begin, 0), b.row_stride,
+                                                 b.column_stride};
+        if (triangle == Triangle::Lower && end < n) {
+            ParallelGemm<T>(n - end, columns, end - begin, T(-1),
+                            {&a(end, begin), a.row_stride, a.column_stride},
+                            solved_rows, T(1),
+                            {&b(end, 0), b.row_stride, b.column_stride},
+                            threads);
+        } else if (triangle == Triangle::Upper && begin > 0) {
+            ParallelGemm<T>(begin, columns, end - begin, T(-1),
+                            {&a(0, begin), a.row_stride, a.column_stride},
+                            solved_rows, T(1), b, threads);
+        }
+    }
+}
+
+/**
+ * @brief Overwrites the columns [first, last) of b with A * b for an n x n
+ *        triangle a
+ *
+ * Rows are produced in the order that leaves the rows they still read
+ * untouched: bottom up for a lower triangle, top down for an upper one.
+ */
+template <class T>
+void TrmmUnblocked(std::size_t n, Triangle triangle, Diagonal diagonal,
+                   StridedMatrix<const T> a, std::size_t first,
+                   std::size_t last, StridedMatrix<T> b) noexcept {
+    const bool lower{triangle == Triangle::Lower};
+    const bool unit{diagonal == Diagonal::Unit};
+
+    if ((b.row_stride == 1 && b.column_stride != 1) || last - first == 1) {
+        for (std::size_t column{first}; column < last; column++) {
+            for (std::size_t step{0}; step < n; step++) {
+                const std::size_t row{lower ? n - 1 - step : step};
+                const std::size_t begin{lower ? 0 : row + 1};
+                const std::size_t end{lower ? row : n};
+                T sum{unit ? b(row, column) : a(row, row) * b(row, column)};
+                for (std::size_t inner{begin}; inner < end; inner++) {
+                    sum += a(row, inner) * b(inner, column);
+                }
+                b(row, column) = sum;
+            }
+        }
+        return;
+    }
+
+    for (std::size_t step{0}; step < n; step++) {
+        const std::size_t row{lower ? n - 1 - step : step};
+        const std::size_t begin{lower ? 0 : row + 1};
+        const std::size_t end{lower ? row : n};
+        if (!unit) {
+            const T pivot{a(row, row)};
+            for (std::size_t column{first}; column < last; column++) {
+                b(row, column) *= pivot;
+            }
+        }
+        for (std::size_t inner{begin}; inner < end; inner++) {
+            const T multiplier{a(row, inner)};
+            for (std::size_t column{first}; column < last; column++) {
+                b(row, column) += multiplier * b(inner, column);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Packs rows [0, rows) and columns [0, depth) of a block of the
+ *        triangle whose top left entry is a(first_row, first_column), like
+ *        PackA, with the entries outside the triangle packed as zeros
+ */
+template <class T>
+void PackTriangle(std::size_t rows, std::size_t depth, std::size_t first_row,
+                  std::size_t first_column, bool lower, bool unit,
+                  StridedMatrix<const T> a, std::size_t mr,
+                  T *packed) noexcept {
+    const bool inside{lower ? first_column + depth <= first_row
+                            : first_column >= first_row + rows};
+    if (inside) {
+        PackA(rows, depth,
+              StridedMatrix<const T>{&a(first_row, first_column),
+                                     a.row_stride, a.column_stride},
+              mr, packed);
+        return;
+    }
+
+    for (std::size_t panel{0}; panel < rows; panel += mr) {
+        const std::size_t height{std::min(mr, rows - panel)};
+        for (std::size_t i{0}; i < mr; i++) {
+            const std::size_t row{first_row + panel + i};
+            for (std::size_t p{0}; p < depth; p++) {
+                const std::size_t column{first_column + p};
+                T entry{0};
+                if (i >= height) {
+                } else if (column == row) {
+                    entry = unit ? T(1) : a(row, row);
+                } else if (lower ? column < row : column > row) {
+                    entry = a(row, column);
+                }
+                packed[(p * mr) + i] = entry;
+            }
+        }
+        packed += mr * depth;
+    }
+}
+
+/**
+ * @brief Computes the [row_begin, row_end) x [column_begin, column_end) tile
+ *        of C = A * B for the triangle of the n x n matrix a
+ *
+ * GemmTile's loops, except that depth slices a row block never reaches are
+ * skipped and each micro kernel call is trimmed to the depth its rows reach,
+ * so only the mr x mr corners on the diagonal multiply zeros.
+ */
+template <class T>
+void TrmmTile(std::size_t row_begin, std::size_t row_end,
+              std::size_t column_begin, std::size_t column_end, std::size_t n,
+              bool lower, bool unit, StridedMatrix<const T> a,
+              StridedMatrix<const T> b, StridedMatrix<T> c,
+              const GemmKernel<T> &kernel,
+              const GemmBlocking<T> &blocking) noexcept {
+    const std::size_t mr{kernel.mr};
+    const std::size_t nr{kernel.nr};
+    const std::size_t mc{std::max(mr, blocking.mc / mr * mr)};
+    const std::size_t kc{std::max<std::size_t>(1, blocking.kc)};
+    const std::size_t nc{std::max(nr, blocking.nc / nr * nr)};
+
+    T *packed_a{GemmWorkspace<T>(0, mc * kc)};
+    T *packed_b{GemmWorkspace<T>(1, nc * kc)};
+    alignas(BUFFER_ALIGNMENT) T ab[MAX_MICRO_TILE];
+
+    for (std::size_t jc{column_begin}; jc < column_end; jc += nc) {
+        const std::size_t nc_current{std::min(nc, column_end - jc)};
+
+        for (std::size_t pc{0}; pc < n; pc += kc) {
+            const std::size_t kc_current{std::min(kc, n - pc)};
+
+            // Rows of a lower triangle reach depth pc from row pc on; rows of
+            // an upper one stop reaching it after row pc + kc_current
+            const std::size_t first_row{lower ? std::max(row_begin, pc)
+                                              : row_begin};
+            const std::size_t last_row{
+                lower ? row_end : std::min(row_end, pc + kc_current)};
+            if (first_row >= last_row) {
+                continue;
+            }
+
+            PackB(kc_current, nc_current,
+                  StridedMatrix<const T>{&b(pc, jc), b.row_stride,
+                                         b.column_stride},
+                  nr, packed_b);
+
+            // Micro tiles stay aligned to row_begin for every slice, so the
+            // first slice to reach a tile writes all of its rows
+            for (std::size_t ic{first_row}; ic < last_row; ic += mc) {
+                const std::size_t mc_current{std::min(mc, row_end - ic)};
+                PackTriangle(std::min(mc_current, last_row - ic), kc_current,
+                             ic, pc, lower, unit, a, mr, packed_a);
+
+                for (std::size_t jr{0}; jr < nc_current; jr += nr) {
+                    const std::size_t width{std::min(nr, nc_current - jr)};
+                    const T *panel_b{packed_b + (jr * kc_current)};
+
+                    for (std::size_t ir{0};
+                         ir < mc_current && ic + ir < last_row; ir += mr) {
+                        const std::size_t height{std::min(mr, mc_current - ir)};
+                        const std::size_t row{ic + ir};
+
+                        // Depth [skip, skip + depth) of the slice holds every
+                        // nonzero of these rows. The first slice a row reaches
+                        // overwrites C; later ones accumulate.
+                        const std::size_t skip{lower || row <= pc ? 0
+                                                                  : row - pc};
+                        const std::size_t depth{
+                            lower ? std::min(kc_current, row + height - pc)
+                                  : kc_current - skip};
+                        const bool first{lower ? pc == 0
+                                               : pc == (row / kc) * kc};
+                        kernel.compute(depth,
+                                       packed_a + (ir * kc_current) +
+                                           (skip * mr),
+                                       panel_b + (skip * nr), ab);
+
+                        UpdateTile(height, width, T(1), ab, nr,
+                                   first ? T(0) : T(1),
+                                   StridedMatrix<T>{&c(row, jc + jr),
+                                                    c.row_stride,
+                                                    c.column_stride});
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief c = A * b for the n x columns matrix b, where A is the triangle of
+ *        the n x n matrix a selected by triangle; c must not overlap b
+ *
+ * Runs GEMM's packing and micro kernels over tiles of c split across
+ * threads like ParallelGemm, skipping the blocks of A outside the triangle,
+ * so the product costs about half a GEMM of the same size.
+ */
+template <class T>
+void Trmm(std::size_t n, std::size_t columns, Triangle triangle,
+          Diagonal diagonal, StridedMatrix<const T> a, StridedMatrix<const T> b,
+          StridedMatrix<T> c, std::size_t threads) noexcept {
+    if (n == 0 || columns == 0) {
+        return;
+    } else if (columns == 1) {
+        // A lone right hand side has nothing for GEMM to reuse, and one pass
+        // of dot products reads the triangle once without packing it
+        for (std::size_t row{0}; row < n; row++) {
+            c(row, 0) = b(row, 0);
+        }
+        TrmmUnblocked(n, triangle, diagonal, a, 0, 1, c);
+        return;
+    }
+
+    const bool lower{triangle == Triangle::Lower};
+    const bool unit{diagonal == Diagonal::Unit};
+    const GemmKernel<T> &kernel{SelectGemmKernel<T>()};
+    const GemmBlocking<T> blocking{GetGemmBlocking<T>()};
+    if (threads <= 1) {
+        TrmmTile(0, n, 0, columns, n, lower, unit, a, b, c, kernel, blocking);
+        return;
+    }
+
+    const std::size_t mr{kernel.mr};
+    const std::size_t nr{kernel.nr};
+    std::size_t tile_m{RoundUp(std::min(n, blocking.mc), mr)};
+    std::size_t tile_n{RoundUp(std::min(columns, blocking.nc), nr)};
+    const std::size_t wanted_tiles{4 * threads};
+    while (((n + tile_m - 1) / tile_m) * ((columns + tile_n - 1) / tile_n) <
+           wanted_tiles) {
+        if (tile_m > mr && (tile_m >= tile_n || tile_n <= nr)) {
+            tile_m = RoundUp(tile_m / 2, mr);
+        } else if (tile_n > nr) {
+            tile_n = RoundUp(tile_n / 2, nr);
+        } else {
+            break;
+        }
+    }
+
+    const std::size_t row_tiles{(n + tile_m - 1) / tile_m};
+    const std::size_t column_tiles{(columns + tile_n - 1) / tile_n};
+    ParallelFor(row_tiles * column_tiles, threads, [&](std::size_t tile) {
+        const std::size_t row_begin{(tile / column_tiles) * tile_m};
+        const std::size_t column_begin{(tile % column_tiles) * tile_n};
+        TrmmTile(row_begin, std::min(n, row_begin + tile_m), column_begin,
+                 std::min(columns, column_begin + tile_n), n, lower, unit, a,
+                 b, c, kernel, blocking);
+    });
+}
+
+}  // namespace detail
+}  // namespace ppp
+
+#endif  // PPP_PPP_TRIANGULAR_HPP_
@@ -0,0 +1,478 @@
+/*
+ *  Tuning.hpp
+ *  Autotuned kernel tile sizes and the on-disk cache that persists them
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_TUNING_HPP_
+#define PPP_PPP_TUNING_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "Simd.hpp"
+
+namespace ppp {
+namespace detail {
+
+/*
+ * The best blocking for a kernel depends on the cache hierarchy, so tile
+ * sizes are measured rather than derived. Each tuned kernel has a group of up
+ * to TUNED_VALUES sizes; 0 in the first slot means "not tuned", and the
+ * kernel falls back to its built-in defaults.
+ *
+ * Winners are cached in a text file, one line per CPU and kernel:
+ *
+ *   <cpu signature> TAB <kernel> TAB <value> <value> <value>
+ *
+ * The signature is the CPU brand string, its cache sizes and its widest
+ * vector ISA, so one file can be shared by a fleet of mixed machines. The
+ * file is read the first time any tuned kernel runs; a missing entry is
+ * benchmarked then, when autotuning is on, or by an explicit ppp::Tune().
+ */
+
+enum class TunedKernel : std::uint8_t {
+    GemmFloat,
+    GemmDouble,
+    Transpose,
+    Reduce,
+    Convolution,
+};
+
+constexpr std::size_t TUNED_KERNELS{5};
+constexpr std::size_t TUNED_VALUES{3};
+constexpr std::array<std::string_view, TUNED_KERNELS> TUNED_KERNEL_NAMES{
+    "gemm-float", "gemm-double", "transpose", "reduce", "convolution"};
+
+using TunedValues = std::array<std::size_t, TUNED_VALUES>;
+
+struct CpuCaches {
+    std::size_t l1d;
+    std::size_t l2;
+    std::size_t l3;
+};
+
+inline CpuCaches DetectCpuCaches() noexcept {
+    CpuCaches caches{};
+#ifdef PPP_SIMD_X86
+    std::uint32_t registers[4]{};
+    Cpuid(0, 0, registers);
+    const std::uint32_t max_leaf{registers[0]};
+    char vendor[13]{};
+    std::memcpy(vendor, &registers[1], 4);
+    std::memcpy(vendor + 4, &registers[3], 4);
+    std::memcpy(vendor + 8, &registers[2], 4);
+    Cpuid(0x80000000, 0, registers);
+    const std::uint32_t max_extended{registers[0]};
+
+    // Intel describes its caches in leaf 4, AMD in 0x8000001D, same layout
+    std::uint32_t leaf{0};
+    if (std::string_view{vendor} == "GenuineIntel" && max_leaf >= 4) {
+        leaf = 4;
+    } else if (std::string_view{vendor} == "AuthenticAMD" &&
+               max_extended >= 0x8000001D) {
+        leaf = 0x8000001D;
+    }
+    for (std::uint32_t index{0}; leaf != 0 && index < 16; index++) {
+        Cpuid(leaf, index, registers);
+        const std::uint32_t type{registers[0] & 0x1F};
+        if (type == 0) {
+            break;
+        }
+        const std::size_t size{
+            static_cast<std::size_t>((registers[1] >> 22) + 1) *
+            (((registers[1] >> 12) & 0x3FF) + 1) *
+            ((registers[1] & 0xFFF) + 1) * (std::size_t{registers[2]} + 1)};
+        const std::uint32_t level{(registers[0] >> 5) & 0x7};
+        if (level == 1 && type != 2) {
+            caches.l1d = size;
+        } else if (level == 2) {
+            caches.l2 = size;
+        } else if (level == 3) {
+            caches.l3 = size;
+        }
+    }
+#endif
+    return caches;
+}
+
+inline const CpuCaches &GetCpuCaches() noexcept {
+    static const CpuCaches caches{DetectCpuCaches()};
+    return caches;
+}
+
+// Brand string, cache sizes and widest vector ISA, free of tabs and newlines
+inline std::string DetectCpuSignature() {
+    std::string brand{};
+#ifdef PPP_SIMD_X86
+    std::uint32_t registers[4]{};
+    Cpuid(0x80000000, 0, registers);
+    if (registers[0] >= 0x80000004) {
+        for (std::uint32_t leaf{0x80000002}; leaf <= 0x80000004; leaf++) {
+            Cpuid(leaf, 0, registers);
+            brand.append(reinterpret_cast<const char *>(registers),
+                         sizeof(registers));
+        }
+    }
+#endif
+    std::string signature{};
+    for (const char character : brand) {
+        if (character == '\0') {
+            break;
+        }
+        const bool space{character == ' ' || character == '\t' ||
+                         character == '\n' || character == '\r'};
+        if (!space) {
+            signature.push_back(character);
+        } else if (!signature.empty() && signature.back() != ' ') {
+            signature.push_back(' ');
+        }
+    }
+    while (!signature.empty() && signature.back() == ' ') {
+        signature.pop_back();
+    }
+    if (signature.empty()) {
+        signature = "unknown";
+    }
+
+    const CpuCaches &caches{GetCpuCaches()};
+    signature += ";L1d=" + std::to_string(caches.l1d) +
+                 ";L2=" + std::to_string(caches.l2) +
+                 ";L3=" + std::to_string(caches.l3);
+    signature += HasAvx512() ? ";avx512" : HasAvx2() ? ";avx2" : ";scalar";
+    return signature;
+}
+
+inline const std::string &CpuSignature() {
+    static const std::string signature{DetectCpuSignature()};
+    return signature;
+}
+
+// PPP_TUNING_CACHE, else the per-user cache directory
+inline std::filesystem::path DefaultTuningCachePath() {
+    if (const char *path{std::getenv("PPP_TUNING_CACHE")}) {
+        return path;
+    }
+    for (const auto &[variable, suffix] :
+         {std::pair{"XDG_CACHE_HOME", "ppp"}, std::pair{"HOME", ".cache/ppp"},
+          std::pair{"LOCALAPPDATA", "ppp"}}) {
+        const char *root{std::getenv(variable)};
+        if (root != nullptr && *root != '\0') {
+            return std::filesystem::path{root} / suffix / "tuning";
+        }
+    }
+    return {};
+}
+
+struct TuningState {
+    std::mutex mutex;
+    std::atomic<bool> loaded{false};
+    std::atomic<bool> autotune{false};
+    std::filesystem::path path;
+    std::array<std::array<std::atomic<std::size_t>, TUNED_VALUES>,
+               TUNED_KERNELS>
+        values{};
+};
+
+inline TuningState &GetTuningState() {
+    static TuningState state{};
+    static std::once_flag initialized{};
+    std::call_once(initialized, [] {
+        state.path = DefaultTuningCachePath();
+        const char *autotune{std::getenv("PPP_AUTOTUNE")};
+        state.autotune.store(autotune != nullptr &&
+                             std::string_view{autotune} != "0" &&
+                             *autotune != '\0');
+    });
+    return state;
+}
+
+inline void StoreTunedValues(TuningState &state, TunedKernel kernel,
+                             const TunedValues &values) noexcept {
+    auto &slots{state.values[static_cast<std::size_t>(kernel)]};
+    for (std::size_t value{1}; value < TUNED_VALUES; value++) {
+        slots[value].store(values[value], std::memory_order_relaxed);
+    }
+    // The first slot doubles as the "tuned" flag, so it is published last
+    slots[0].store(values[0], std::memory_order_release);
+}
+
+inline TunedValues LoadTunedValues(const TuningState &state,
+                                   TunedKernel kernel) noexcept {
+    const auto &slots{state.values[static_cast<std::size_t>(kernel)]};
+    TunedValues values{};
+    values[0] = slots[0].load(std::memory_order_acquire);
+    for (std::size_t value{1}; value < TUNED_VALUES; value++) {
+        values[value] = slots[value].load(std::memory_order_relaxed);
+    }
+    return values;
+}
+
+// Reads this CPU's lines from the cache file, which the caller has locked
+inline bool ReadTuningCache(TuningState &state) {
+    for (std::size_t kernel{0}; kernel < TUNED_KERNELS; kernel++) {
+        StoreTunedValues(state, static_cast<TunedKernel>(kernel), {});
+    }
+    std::ifstream file{state.path};
+    bool found{false};
+    std::string line{};
+    while (std::getline(file, line)) {
+        const std::size_t first_tab{line.find('\t')};
+        const std::size_t second_tab{line.find('\t', first_tab + 1)};
+        if (second_tab == std::string::npos ||
+            std::string_view{line}.substr(0, first_tab) != CpuSignature()) {
+            continue;
+        }
+        const std::string_view name{
+            std::string_view{line}.substr(first_tab + 1,
+                                          second_tab - first_tab - 1)};
+        const auto *kernel{std::find(TUNED_KERNEL_NAMES.begin(),
+                                     TUNED_KERNEL_NAMES.end(), name)};
+        TunedValues values{};
+        std::istringstream stream{line.substr(second_tab + 1)};
+        for (std::size_t &value : values) {
+            stream >> value;
+        }
+        if (kernel != TUNED_KERNEL_NAMES.end() && stream && values[0] != 0) {
+            StoreTunedValues(
+                state,
+                static_cast<TunedKernel>(kernel - TUNED_KERNEL_NAMES.begin()),
+                values);
+            found = true;
+        }
+    }
+    state.loaded.store(true, std::memory_order_release);
+    return found;
+}
+
+/**
+ * @brief Rewrites the cache file with this CPU's current values, keeping the
+ *        lines of every other CPU; the caller holds the state lock
+ *
+ * The new contents are written beside the file and renamed over it, so a
+ * concurrent reader sees either the old or the new file.
+ */
+inline bool WriteTuningCache(const TuningState &state) {
+    if (state.path.empty()) {
+        return false;
+    }
+    std::vector<std::string> kept{};
+    {
+        std::ifstream file{state.path};
+        std::string line{};
+        while (std::getline(file, line)) {
+            const std::size_t tab{line.find('\t')};
+            if (tab != std::string::npos &&
+                std::string_view{line}.substr(0, tab) != CpuSignature()) {
+                kept.push_back(std::move(line));
+            }
+        }
+    }
+
+    std::error_code error{};
+    if (state.path.has_parent_path()) {
+        std::filesystem::create_directories(state.path.parent_path(), error);
+    }
+    std::filesystem::path temporary{state.path};
+    temporary += ".tmp" + std::to_string(std::chrono::steady_clock::now()
+                                             .time_since_epoch()
+                                             .count());
+    {
+        std::ofstream file{temporary, std::ios::trunc};
+        for (const std::string &line : kept) {
+            file << line << '\n';
+        }
+        for (std::size_t kernel{0}; kernel < TUNED_KERNELS; kernel++) {
+            const TunedValues values{
+                LoadTunedValues(state, static_cast<TunedKernel>(kernel))};
+            if (values[0] == 0) {
+                continue;
+            }
+            file << CpuSignature() << '\t' << TUNED_KERNEL_NAMES[kernel]
+                 << '\t' << values[0];
+            for (std::size_t value{1}; value < TUNED_VALUES; value++) {
+                file << ' ' << values[value];
+            }
+            file << '\n';
+        }
+        if (!file.flush()) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, state.path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+inline TuningState &LoadedTuningState() {
+    TuningState &state{GetTuningState()};
+    if (!state.loaded.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock{state.mutex};
+        if (!state.loaded.load(std::memory_order_relaxed)) {
+            ReadTuningCache(state);
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief The tuned sizes of kernel, else fallback; with autotuning on, the
+ *        first call without cached sizes runs tune() and persists its result
+ *
+ * tune() runs under the tuning lock, so it must time its candidates through
+ * entry points that take the sizes explicitly.
+ */
+template <class Tune>
+TunedValues TunedValuesOr(TunedKernel kernel, const TunedValues &fallback,
+                          const Tune &tune) {
+    TuningState &state{LoadedTuningState()};
+    TunedValues values{LoadTunedValues(state, kernel)};
+    if (values[0] != 0) {
+        return values;
+    } else if (!state.autotune.load(std::memory_order_relaxed)) {
+        return fallback;
+    }
+
+    std::lock_guard<std::mutex> lock{state.mutex};
+    values = LoadTunedValues(state, kernel);
+    if (values[0] == 0) {
+        values = tune();
+        StoreTunedValues(state, kernel, values);
+        WriteTuningCache(state);
+    }
+    return values;
+}
+
+// Stores freshly measured sizes and persists them; see ppp::Tune
+inline bool SaveTunedValues(
+    std::span<const std::pair<TunedKernel, TunedValues>> tuned) {
+    TuningState &state{LoadedTuningState()};
+    std::lock_guard<std::mutex> lock{state.mutex};
+    for (const auto &[kernel, values] : tuned) {
+        StoreTunedValues(state, kernel, values);
+    }
+    return WriteTuningCache(state);
+}
+
+// Shortest of a few timed runs, in seconds
+template <class Run>
+double BestTime(const Run &run, std::size_t repeats = 5) {
+    double best{std::numeric_limits<double>::infinity()};
+    for (std::size_t repeat{0}; repeat < repeats; repeat++) {
+        const auto start{std::chrono::steady_clock::now()};
+        run();
+        const std::chrono::duration<double> elapsed{
+            std::chrono::steady_clock::now() - start};
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// The candidate whose run(candidate) is quickest, after one warm-up run
+template <class Candidate, class Run>
+Candidate FastestCandidate(std::span<const Candidate> candidates,
+                           const Run &run) {
+    run(candidates.front());
+    Candidate fastest{candidates.front()};
+    double fastest_time{std::numeric_limits<double>::infinity()};
+    for (const Candidate &candidate : candidates) {
+        const double time{BestTime([&] { run(candidate); })};
+        if (time < fastest_time) {
+            fastest = candidate;
+            fastest_time = time;
+        }
+    }
+    return fastest;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Turns benchmarking on first use on or off. With it on, the first
+ *        multiply, transpose or reduction on a CPU with no cached tile sizes
+ *        tunes them and writes them to the cache.
+ *
+ * Defaults to off, or on when the PPP_AUTOTUNE environment variable is set to
+ * anything but 0.
+ */
+inline void SetAutotune(bool enabled) {
+    detail::GetTuningState().autotune.store(enabled);
+}
+
+inline bool GetAutotune() {
+    return detail::GetTuningState().autotune.load();
+}
+
+/**
+ * @brief Points the tuning cache at path, or back at the default when path
+ *        is empty, and reloads this CPU's sizes from it
+ *
+ * The default is PPP_TUNING_CACHE when set, else ppp/tuning under
+ * XDG_CACHE_HOME, ~/.cache or LOCALAPPDATA. Returns whether the file had
+ * sizes for this CPU.
+ */
+inline bool SetTuningCachePath(const std::filesystem::path &path) {
+    detail::TuningState &state{detail::GetTuningState()};
+    std::lock_guard<std::mutex> lock{state.mutex};
+    state.path = path.empty() ? detail::DefaultTuningCachePath() : path;
+    return detail::ReadTuningCache(state);
+}
+
+inline std::filesystem::path GetTuningCachePath() {
+    detail::TuningState &state{detail::GetTuningState()};
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return state.path;
+}
+
+/**
+ * @brief Forgets the tuned sizes in memory, so kernels use their defaults
+ *        until the cache is read again by SetTuningCachePath
+ */
+inline void ResetTuning() {
+    detail::TuningState &state{detail::GetTuningState()};
+    std::lock_guard<std::mutex> lock{state.mutex};
+    for (std::size_t kernel{0}; kernel < detail::TUNED_KERNELS; kernel++) {
+        detail::StoreTunedValues(state,
+                                 static_cast<detail::TunedKernel>(kernel), {});
+    }
+    state.loaded.store(true, std::memory_order_release);
+}
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_TUNING_HPP_
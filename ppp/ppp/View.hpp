@@ -0,0 +1,184 @@
+/*
+ *  View.hpp
+ *  Non-owning strided views into ppp::Matrix storage
+ *
+ *  Copyright (C) 2024 Sebastian Pineda (spineda.wpi.alum@gmail.com)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License Version 3.0 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License and GNU Lesser General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PPP_PPP_VIEW_HPP_
+#define PPP_PPP_VIEW_HPP_
+
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <version>
+
+#if defined(__cpp_lib_mdspan)
+#include <array>
+#include <mdspan>
+#endif
+
+#include "Gemm.hpp"
+
+namespace ppp {
+
+/*
+ * A MatrixView is a pointer plus a shape and two strides, the same model as a
+ * rank 2 std::mdspan with layout_stride, which it converts to and from when
+ * the standard library has one. It never owns or copies its entries, so the
+ * matrix it was taken from has to outlive it. Rows, columns, blocks, strided
+ * slices and the transpose are all just a new pointer and strides.
+ */
+template <class T>
+class MatrixView {
+ public:
+    using value_type = std::remove_cv_t<T>;
+
+    constexpr MatrixView(T *data, std::size_t height, std::size_t width,
+                         std::size_t row_stride,
+                         std::size_t column_stride) noexcept
+        : data_{data},
+          height_{height},
+          width_{width},
+          row_stride_{row_stride},
+          column_stride_{column_stride} {}
+
+    // A mutable view can always be used where a read-only one is expected
+    template <class U>
+        requires std::same_as<const U, T>
+    constexpr MatrixView(const MatrixView<U> &view) noexcept
+        : MatrixView(view.Data(), view.Height(), view.Width(),
+                     view.RowStride(), view.ColumnStride()) {}
+
+    constexpr std::size_t Height() const noexcept { return height_; }
+    constexpr std::size_t Width() const noexcept { return width_; }
+    constexpr std::size_t Size() const noexcept { return height_ * width_; }
+    constexpr std::size_t RowStride() const noexcept { return row_stride_; }
+    constexpr std::size_t ColumnStride() const noexcept {
+        return column_stride_;
+    }
+    constexpr T *Data() const noexcept { return data_; }
+
+    // Unchecked access, for kernels
+    constexpr T &operator()(std::size_t row,
+                            std::size_t column) const noexcept {
+        return data_[(row * row_stride_) + (column * column_stride_)];
+    }
+
+    std::optional<value_type> At(std::size_t row,
+                                 std::size_t column) const noexcept {
+        if (row >= height_ || column >= width_) {
+            return std::nullopt;
+        } else {
+            return (*this)(row, column);
+        }
+    }
+
+#if defined(__cpp_lib_mdspan)
+    using mdspan_type = std::mdspan<T, std::dextents<std::size_t, 2>,
+                                    std::layout_stride>;
+
+    constexpr explicit MatrixView(const mdspan_type &span) noexcept
+        : MatrixView(span.data_handle(), span.extent(0), span.extent(1),
+                     span.stride(0), span.stride(1)) {}
+
+    constexpr mdspan_type ToMdspan() const noexcept {
+        return mdspan_type{
+            data_, typename mdspan_type::mapping_type{
+                       std::dextents<std::size_t, 2>{height_, width_},
+                       std::array<std::size_t, 2>{row_stride_,
+                                                  column_stride_}}};
+    }
+#endif
+
+    /**
+     * @brief The height x width block whose top left entry is (row, column)
+     *
+     * @return std::nullopt if the block does not fit inside this view
+     */
+    constexpr std::optional<MatrixView<T>> Block(
+        std::size_t row, std::size_t column, std::size_t height,
+        std::size_t width) const noexcept {
+        if (row > height_ || height > height_ - row || column > width_ ||
+            width > width_ - column) {
+            return std::nullopt;
+        } else if (height == 0 || width == 0) {
+            return MatrixView<T>{data_, height, width, row_stride_,
+                                 column_stride_};
+        } else {
+            return MatrixView<T>{&(*this)(row, column), height, width,
+                                 row_stride_, column_stride_};
+        }
+    }
+
+    constexpr std::optional<MatrixView<T>> Row(
+        std::size_t row) const noexcept {
+        return Block(row, 0, 1, width_);
+    }
+
+    constexpr std::optional<MatrixView<T>> Column(
+        std::size_t column) const noexcept {
+        return Block(0, column, height_, 1);
+    }
+
+    /**
+     * @brief Every row_step-th row of [first_row, last_row) crossed with every
+     *        column_step-th column of [first_column, last_column)
+     *
+     * @return std::nullopt for a zero step or a range outside this view
+     */
+    constexpr std::optional<MatrixView<T>> Slice(
+        std::size_t first_row, std::size_t last_row, std::size_t row_step,
+        std::size_t first_column, std::size_t last_column,
+        std::size_t column_step) const noexcept {
+        if (row_step == 0 || column_step == 0 || first_row > last_row ||
+            last_row > height_ || first_column > last_column ||
+            last_column > width_) {
+            return std::nullopt;
+        }
+
+        const std::size_t height{(last_row - first_row + row_step - 1) /
+                                 row_step};
+        const std::size_t width{
+            (last_column - first_column + column_step - 1) / column_step};
+        return MatrixView<T>{
+            height == 0 || width == 0 ? data_
+                                      : &(*this)(first_row, first_column),
+            height, width, row_stride_ * row_step,
+            column_stride_ * column_step};
+    }
+
+    constexpr MatrixView<T> Transposed() const noexcept {
+        return MatrixView<T>{data_, width_, height_, column_stride_,
+                             row_stride_};
+    }
+
+    constexpr detail::StridedMatrix<T> Strided() const noexcept {
+        return {data_, row_stride_, column_stride_};
+    }
+
+ private:
+    T *data_;
+    std::size_t height_;
+    std::size_t width_;
+    std::size_t row_stride_;
+    std::size_t column_stride_;
+};  // class MatrixView
+
+}  // namespace ppp
+
+#endif  // PPP_PPP_VIEW_HPP_
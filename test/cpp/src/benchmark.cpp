@@ -1,13 +1,36 @@
 #include "include/benchmark.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
 #include <optional>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "ppp/Allocator.hpp"
+#include "ppp/Batch.hpp"
+#include "ppp/Expression.hpp"
+#include "ppp/Factorization.hpp"
+#include "ppp/FixedMatrix.hpp"
+#include "ppp/Mapped.hpp"
 #include "ppp/Matrix.hpp"
+#include "ppp/Numa.hpp"
+#include "ppp/Quantized.hpp"
+#include "ppp/Sparse.hpp"
+#include "ppp/SplitComplex.hpp"
+#include "ppp/Svd.hpp"
+#include "ppp/Tuning.hpp"
 
 namespace benchmark {
 
@@ -19,6 +42,870 @@ auto time_operation = [](const std::function<void()>& operation) {
     return duration.count();
 };
 
+template <class T>
+void BenchMarkGemm(std::size_t size, const std::string_view type_name) {
+    ppp::Matrix<T> lhs{ppp::Matrix<T>::New(size, size).value()};
+    ppp::Matrix<T> rhs{ppp::Matrix<T>::New(size, size).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = static_cast<T>(i % 17) / T(16);
+        rhs.Data()[i] = static_cast<T>(i % 13) / T(12);
+    }
+
+    const double flops{2.0 * size * size * size};
+    constexpr std::uint64_t test_iters{5};
+    std::uint64_t time = time_operation([&lhs, &rhs]() {
+                             for (std::size_t test{0}; test < test_iters;
+                                  test++) {
+                                 (void)(lhs * rhs);
+                             }
+                         }) /
+                         test_iters;
+    std::cout << "Average " << size << "x" << size << " " << type_name
+              << " multiplication: " << time << "us ("
+              << flops / static_cast<double>(time) / 1e3 << " GFLOP/s)"
+              << std::endl;
+
+    // Reference i-k-j loop over the same flat buffers, to show what the
+    // blocking and packing buys
+    std::vector<T> naive(size * size);
+    time = time_operation([&lhs, &rhs, &naive, size]() {
+        std::fill(naive.begin(), naive.end(), T(0));
+        for (std::size_t i{0}; i < size; i++) {
+            for (std::size_t p{0}; p < size; p++) {
+                const T scale{lhs.Data()[(i * size) + p]};
+                for (std::size_t j{0}; j < size; j++) {
+                    naive[(i * size) + j] +=
+                        scale * rhs.Data()[(p * size) + j];
+                }
+            }
+        }
+    });
+    std::cout << "Naive " << size << "x" << size << " " << type_name
+              << " multiplication: " << time << "us ("
+              << flops / static_cast<double>(time) / 1e3 << " GFLOP/s)"
+              << std::endl;
+}
+
+// Strong scaling: the same product on a growing number of threads
+void BenchMarkGemmScaling(std::size_t m, std::size_t k, std::size_t n) {
+    ppp::Matrix<float> lhs{ppp::Matrix<float>::New(m, k, 0.5f).value()};
+    ppp::Matrix<float> rhs{ppp::Matrix<float>::New(k, n, 0.25f).value()};
+
+    const double flops{2.0 * m * n * k};
+    std::uint64_t single_thread{0};
+    for (const std::size_t threads : {1, 2, 4, 8, 16, 32}) {
+        constexpr std::uint64_t test_iters{3};
+        const std::uint64_t time =
+            time_operation([&lhs, &rhs, threads]() {
+                for (std::size_t test{0}; test < test_iters; test++) {
+                    (void)ppp::Multiply(lhs, rhs, threads);
+                }
+            }) /
+            test_iters;
+        if (threads == 1) {
+            single_thread = time;
+        }
+        std::cout << m << "x" << k << " * " << k << "x" << n << " on "
+                  << threads << " threads: " << time << "us ("
+                  << flops / static_cast<double>(time) / 1e3
+                  << " GFLOP/s, speedup "
+                  << static_cast<double>(single_thread) /
+                         static_cast<double>(time)
+                  << "x)" << std::endl;
+    }
+}
+
+void BenchMarkLazyExpression(std::size_t size) {
+    const ppp::Matrix<float> a{ppp::Matrix<float>::New(size, size, 1).value()};
+    const ppp::Matrix<float> b{ppp::Matrix<float>::New(size, size, 2).value()};
+    const ppp::Matrix<float> c{ppp::Matrix<float>::New(size, size, 3).value()};
+
+    constexpr std::uint64_t test_iters{10};
+    std::uint64_t time = time_operation([&a, &b, &c]() {
+                             for (std::size_t test{0}; test < test_iters;
+                                  test++) {
+                                 const std::optional<ppp::Matrix<float>> sum{
+                                     a + b};
+                                 (void)(sum.value() - c);
+                             }
+                         }) /
+                         test_iters;
+    std::cout << "Eager " << size << "x" << size << " a + b - c: " << time
+              << "us" << std::endl;
+
+    time = time_operation([&a, &b, &c]() {
+               for (std::size_t test{0}; test < test_iters; test++) {
+                   (void)(ppp::Lazy(a) + b - c).Evaluate();
+               }
+           }) /
+           test_iters;
+    std::cout << "Fused " << size << "x" << size << " a + b - c: " << time
+              << "us" << std::endl;
+}
+
+void BenchMarkScalarBroadcast(std::size_t size) {
+    const ppp::Matrix<float> matrix{
+        ppp::Matrix<float>::New(size, size, 1).value()};
+
+    constexpr std::uint64_t test_iters{10};
+    // What operator+(Matrix, scalar) used to do: build a constant matrix
+    std::uint64_t time = time_operation([&matrix, size]() {
+                             for (std::size_t test{0}; test < test_iters;
+                                  test++) {
+                                 const std::optional<ppp::Matrix<float>>
+                                     constant{ppp::Matrix<float>::New(
+                                         size, size, 2.0f)};
+                                 (void)(matrix + constant.value());
+                             }
+                         }) /
+                         test_iters;
+    std::cout << "Materialized " << size << "x" << size
+              << " matrix + scalar: " << time << "us" << std::endl;
+
+    time = time_operation([&matrix]() {
+               for (std::size_t test{0}; test < test_iters; test++) {
+                   (void)(matrix + 2.0f);
+               }
+           }) /
+           test_iters;
+    std::cout << "Streaming " << size << "x" << size
+              << " matrix + scalar: " << time << "us" << std::endl;
+
+    const ppp::Matrix<float> row{ppp::Matrix<float>::New(1, size, 2).value()};
+    time = time_operation([&matrix, &row]() {
+               for (std::size_t test{0}; test < test_iters; test++) {
+                   (void)(matrix + row);
+               }
+           }) /
+           test_iters;
+    std::cout << "Broadcast " << size << "x" << size
+              << " matrix + row: " << time << "us" << std::endl;
+}
+
+void BenchMarkLU(std::size_t size) {
+    ppp::Matrix<double> matrix{ppp::Matrix<double>::New(size, size).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<double>((i * 7919) % 1009) / 1009.0;
+    }
+    for (std::size_t row{0}; row < size; row++) {
+        matrix.Data()[(row * size) + row] += 1.0;
+    }
+
+    const double flops{(2.0 / 3.0) * size * size * size};
+    std::uint64_t time =
+        time_operation([&matrix]() { (void)matrix.FactorLU(); });
+    std::cout << "Blocked LU " << size << "x" << size << ": " << time
+              << "us (" << flops / static_cast<double>(time) / 1e3
+              << " GFLOP/s)" << std::endl;
+
+    time = time_operation([&matrix]() { (void)matrix.LU(); });
+    std::cout << "Unpivoted LU " << size << "x" << size << ": " << time
+              << "us (" << flops / static_cast<double>(time) / 1e3
+              << " GFLOP/s)" << std::endl;
+}
+
+void BenchMarkFactorizationSolve(std::size_t size, std::size_t rhs_columns) {
+    ppp::Matrix<double> matrix{ppp::Matrix<double>::New(size, size).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<double>((i * 7919) % 1009) / 1009.0;
+    }
+    for (std::size_t row{0}; row < size; row++) {
+        matrix.Data()[(row * size) + row] += static_cast<double>(size);
+    }
+    ppp::Matrix<double> rhs{
+        ppp::Matrix<double>::New(size, rhs_columns, 1.0).value()};
+    ppp::Matrix<double> single{ppp::Matrix<double>::New(size, 1, 1.0).value()};
+
+    const auto lu{ppp::LUFactorization<double>::New(matrix).value()};
+    const auto cholesky{
+        ppp::CholeskyFactorization<double>::New(matrix).value()};
+    const auto qr{ppp::QRFactorization<double>::New(matrix).value()};
+
+    std::uint64_t time =
+        time_operation([&lu, &rhs]() { (void)lu.Solve(rhs); });
+    std::cout << "LU solve " << size << "x" << size << " with "
+              << rhs_columns << " right hand sides: " << time << "us"
+              << std::endl;
+
+    time = time_operation([&lu, &single, rhs_columns]() {
+        for (std::size_t column{0}; column < rhs_columns; column++) {
+            (void)lu.Solve(single);
+        }
+    });
+    std::cout << "LU solve " << size << "x" << size << " one column at a time: "
+              << time << "us" << std::endl;
+
+    time = time_operation([&cholesky, &rhs]() { (void)cholesky.Solve(rhs); });
+    std::cout << "Cholesky solve " << size << "x" << size << " with "
+              << rhs_columns << " right hand sides: " << time << "us"
+              << std::endl;
+
+    time = time_operation([&qr, &rhs]() { (void)qr.Solve(rhs); });
+    std::cout << "QR solve " << size << "x" << size << " with "
+              << rhs_columns << " right hand sides: " << time << "us"
+              << std::endl;
+}
+
+void BenchMarkTranspose(std::size_t size) {
+    ppp::Matrix<float> matrix{ppp::Matrix<float>::New(size, size).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<float>(i % 1009);
+    }
+    ppp::Matrix<float> naive{ppp::Matrix<float>::New(size, size).value()};
+
+    std::uint64_t time = time_operation([&matrix, &naive, size]() {
+        for (std::size_t row{0}; row < size; row++) {
+            for (std::size_t column{0}; column < size; column++) {
+                naive.Data()[(column * size) + row] =
+                    matrix.Data()[(row * size) + column];
+            }
+        }
+    });
+    std::cout << "Naive transpose " << size << "x" << size << ": " << time
+              << "us" << std::endl;
+
+    time = time_operation([&matrix]() { (void)matrix.Transpose(); });
+    std::cout << "Tiled transpose " << size << "x" << size << ": " << time
+              << "us" << std::endl;
+
+    time = time_operation([&matrix]() { (void)matrix.TransposeInPlace(); });
+    std::cout << "In-place transpose " << size << "x" << size << ": " << time
+              << "us" << std::endl;
+}
+
+void BenchMarkSparse(std::size_t rows, std::size_t columns,
+                     std::size_t per_row) {
+    // One-hot style rows: per_row ones at scattered columns
+    std::vector<ppp::Triplet<double>> triplets;
+    triplets.reserve(rows * per_row);
+    for (std::size_t row{0}; row < rows; row++) {
+        for (std::size_t hit{0}; hit < per_row; hit++) {
+            triplets.push_back(
+                {row, ((row * 7919) + (hit * 104729)) % columns, 1.0});
+        }
+    }
+
+    std::optional<ppp::SparseMatrix<double>> sparse{};
+    std::uint64_t time = time_operation([&]() {
+        sparse = ppp::SparseMatrix<double>::New(rows, columns, triplets);
+    });
+    std::cout << "COO to CSR " << rows << "x" << columns << " with "
+              << triplets.size() << " entries: " << time << "us" << std::endl;
+
+    const ppp::Matrix<double> dense{sparse.value().ToDense()};
+    const ppp::Column<double> x{std::vector<double>(columns, 0.5), "x"};
+    const ppp::Matrix<double> x_dense{
+        ppp::Matrix<double>::New(columns, 1, 0.5).value()};
+    const ppp::Matrix<double> block{
+        ppp::Matrix<double>::New(columns, 64, 0.5).value()};
+
+    time = time_operation([&]() { (void)(sparse.value() * x); });
+    std::cout << "SpMV: " << time << "us" << std::endl;
+    time = time_operation([&]() { (void)(dense * x_dense); });
+    std::cout << "Dense matrix-vector: " << time << "us" << std::endl;
+    time = time_operation([&]() { (void)(sparse.value() * block); });
+    std::cout << "SpMM with 64 columns: " << time << "us" << std::endl;
+    time = time_operation([&]() { (void)(dense * block); });
+    std::cout << "Dense GEMM with 64 columns: " << time << "us" << std::endl;
+    std::cout << "Storage: "
+              << (sparse.value().NonZeros() *
+                  (sizeof(double) + sizeof(std::size_t))) /
+                     1024
+              << "KiB sparse vs " << (dense.Size() * sizeof(double)) / 1024
+              << "KiB dense" << std::endl;
+}
+
+// The 10x10 addition and subtraction loops, with the result buffers drawn
+// from each memory resource in turn
+void BenchMarkAllocation(const ppp::Matrix<float>& lhs,
+                         const ppp::Matrix<float>& rhs) {
+    constexpr std::uint64_t test_iters{1'000'000};
+    const std::pair<std::string_view, std::pmr::memory_resource*>
+        resources[]{{"heap", std::pmr::new_delete_resource()},
+                    {"pool", &ppp::SharedPool()},
+                    {"arena", &ppp::ThreadArena()}};
+    for (const auto& [name, resource] : resources) {
+        const ppp::ScopedResource scope{resource};
+        std::uint64_t time = time_operation([&lhs, &rhs]() {
+            for (std::size_t test{0}; test < test_iters; test++) {
+                lhs + rhs;
+                lhs - rhs;
+            }
+        });
+        std::cout << "Average 10x10 addition and subtraction, " << name
+                  << ": " << (time * 1000) / test_iters << "ns" << std::endl;
+    }
+}
+
+void BenchMarkFixedMatrix() {
+    constexpr std::uint64_t test_iters{1'000'000};
+    ppp::FixedMatrix<float, 10, 10> lhs{1.0f};
+    const ppp::FixedMatrix<float, 10, 10> rhs{2.0f};
+    std::uint64_t time = time_operation([&lhs, &rhs]() {
+        for (std::size_t test{0}; test < test_iters; test++) {
+            lhs = lhs + rhs;
+            // Keeps the compiler from folding the loop away
+            asm volatile("" : : "g"(lhs.Data()) : "memory");
+        }
+    });
+    std::cout << "Average fixed 10x10 addition: "
+              << (time * 1000) / test_iters << "ns" << std::endl;
+
+    ppp::FixedMatrix<double, 4, 4> transform{
+        {{0, -1, 0, 1}, {1, 0, 0, 2}, {0, 0, 1, 3}, {0, 0, 0, 1}}};
+    const ppp::Matrix<double> dynamic{transform.ToMatrix()};
+    ppp::FixedMatrix<double, 4, 4> accumulated{
+        ppp::FixedMatrix<double, 4, 4>::Identity()};
+    time = time_operation([&accumulated, &transform]() {
+        for (std::size_t test{0}; test < test_iters; test++) {
+            accumulated = accumulated * transform;
+            asm volatile("" : : "g"(accumulated.Data()) : "memory");
+        }
+    });
+    std::cout << "Average fixed 4x4 product: " << (time * 1000) / test_iters
+              << "ns" << std::endl;
+
+    constexpr std::uint64_t dynamic_iters{100'000};
+    time = time_operation([&dynamic]() {
+        for (std::size_t test{0}; test < dynamic_iters; test++) {
+            (void)(dynamic * dynamic);
+        }
+    });
+    std::cout << "Average dynamic 4x4 product: "
+              << (time * 1000) / dynamic_iters << "ns" << std::endl;
+}
+
+void BenchMarkBatch(std::size_t count) {
+    ppp::MatrixBatch<float, 4, 4> batch{
+        ppp::MatrixBatch<float, 4, 4>::New(count).value()};
+    for (std::size_t index{0}; index < count; index++) {
+        ppp::FixedMatrix<float, 4, 4> matrix{
+            static_cast<float>(index % 7) / 7.0f};
+        for (std::size_t diagonal{0}; diagonal < 4; diagonal++) {
+            matrix(diagonal, diagonal) = 4.0f;
+        }
+        (void)batch.Set(index, matrix);
+    }
+
+    std::uint64_t time = time_operation([&batch]() {
+        const ppp::MatrixBatch<float, 4, 4> inverses{batch.Inverse()};
+        asm volatile("" : : "g"(inverses.Plane(0, 0)) : "memory");
+    });
+    std::cout << "Batched 4x4 inverse of " << count << ": " << time << "us"
+              << std::endl;
+
+    time = time_operation([&batch, count]() {
+        for (std::size_t index{0}; index < count; index++) {
+            const ppp::FixedMatrix<float, 4, 4> inverse{
+                batch.Get(index).value().Inverse().value()};
+            asm volatile("" : : "g"(inverse.Data()) : "memory");
+        }
+    });
+    std::cout << "One at a time 4x4 inverse of " << count << ": " << time
+              << "us" << std::endl;
+
+    time = time_operation([&batch]() {
+        const std::optional<ppp::MatrixBatch<float, 4, 4>> product{
+            batch * batch};
+        asm volatile("" : : "g"(&product) : "memory");
+    });
+    std::cout << "Batched 4x4 product of " << count << ": " << time << "us"
+              << std::endl;
+
+    time = time_operation([&batch, count]() {
+        for (std::size_t index{0}; index < count; index++) {
+            const ppp::FixedMatrix<float, 4, 4> matrix{
+                batch.Get(index).value()};
+            const ppp::FixedMatrix<float, 4, 4> product{matrix * matrix};
+            asm volatile("" : : "g"(product.Data()) : "memory");
+        }
+    });
+    std::cout << "One at a time 4x4 product of " << count << ": " << time
+              << "us" << std::endl;
+}
+
+void BenchMarkReductions(std::size_t size) {
+    ppp::Matrix<float> matrix{ppp::Matrix<float>::New(size, size).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<float>(i % 1021) / 1021.0f;
+    }
+
+    // What the ad-hoc loops look like: one column at a time, striding down
+    std::vector<float> sums(size, 0.0f);
+    std::uint64_t time = time_operation([&matrix, &sums, size]() {
+        for (std::size_t column{0}; column < size; column++) {
+            for (std::size_t row{0}; row < size; row++) {
+                sums[column] += matrix.Data()[(row * size) + column];
+            }
+        }
+    });
+    std::cout << "Naive column sums of " << size << "x" << size << ": "
+              << time << "us" << std::endl;
+
+    for (const auto& [name, axis] :
+         {std::pair<std::string_view, ppp::Axis>{"row", ppp::Axis::Row},
+          {"column", ppp::Axis::Column},
+          {"whole", ppp::Axis::All}}) {
+        time = time_operation([&matrix, axis]() {
+            const ppp::Column<float> sum{matrix.Sum(axis)};
+            asm volatile("" : : "g"(sum.Data()) : "memory");
+        });
+        std::cout << "Reduce " << name << " sums: " << time << "us";
+        time = time_operation([&matrix, axis]() {
+            const std::optional<ppp::Column<std::int64_t>> argmax{
+                matrix.ArgMax(axis)};
+            asm volatile("" : : "g"(&argmax) : "memory");
+        });
+        std::cout << ", argmax: " << time << "us";
+        time = time_operation([&matrix, axis]() {
+            const std::optional<ppp::Column<float>> variance{
+                matrix.Variance(axis)};
+            asm volatile("" : : "g"(&variance) : "memory");
+        });
+        std::cout << ", variance: " << time << "us" << std::endl;
+    }
+}
+
+void BenchMarkMath(std::size_t size) {
+    ppp::Matrix<float> matrix{ppp::Matrix<float>::New(size, size).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<float>(i % 1021) / 64.0f + 0.01f;
+    }
+
+    using Function =
+        ppp::Matrix<float> (ppp::Matrix<float>::*)(ppp::MathPrecision) const;
+    for (const auto& [name, function, libm] :
+         {std::tuple<std::string_view, Function, float (*)(float)>{
+              "exp", &ppp::Matrix<float>::Exp,
+              [](float x) { return std::exp(x); }},
+          {"log", &ppp::Matrix<float>::Log,
+           [](float x) { return std::log(x); }},
+          {"sqrt", &ppp::Matrix<float>::Sqrt,
+           [](float x) { return std::sqrt(x); }},
+          {"tanh", &ppp::Matrix<float>::Tanh,
+           [](float x) { return std::tanh(x); }},
+          {"sigmoid", &ppp::Matrix<float>::Sigmoid,
+           [](float x) { return 1.0f / (1.0f + std::exp(-x)); }}}) {
+        // Each side allocates its result
+        std::uint64_t time = time_operation([&matrix, libm]() {
+            std::vector<float> output(matrix.Size());
+            std::transform(matrix.Data(), matrix.Data() + matrix.Size(),
+                           output.begin(), libm);
+            asm volatile("" : : "g"(output.data()) : "memory");
+        });
+        std::cout << "libm " << name << ": " << time << "us";
+        time = time_operation([&matrix, function]() {
+            const ppp::Matrix<float> result{
+                (matrix.*function)(ppp::MathPrecision::Fast)};
+            asm volatile("" : : "g"(result.Data()) : "memory");
+        });
+        std::cout << ", vectorized: " << time << "us" << std::endl;
+    }
+
+    std::uint64_t time = time_operation([&matrix]() {
+        std::vector<float> output(matrix.Size());
+        std::transform(matrix.Data(), matrix.Data() + matrix.Size(),
+                       output.begin(),
+                       [](float x) { return std::pow(x, 1.7f); });
+        asm volatile("" : : "g"(output.data()) : "memory");
+    });
+    std::cout << "libm pow: " << time << "us";
+    time = time_operation([&matrix]() {
+        const ppp::Matrix<float> result{matrix.Pow(1.7f)};
+        asm volatile("" : : "g"(result.Data()) : "memory");
+    });
+    std::cout << ", vectorized: " << time << "us" << std::endl;
+}
+
+void BenchMarkTuning(std::size_t size) {
+    ppp::Matrix<double> lhs{ppp::Matrix<double>::New(size, size).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = static_cast<double>(i % 31) - 15.0;
+    }
+    const ppp::Matrix<double> rhs{lhs.Transpose()};
+
+    // Tune into a scratch cache so the user's cache is left alone
+    const std::filesystem::path cache{
+        std::filesystem::temp_directory_path() / "ppp_tuning_benchmark"};
+    ppp::SetTuningCachePath(cache);
+    ppp::ResetTuning();
+    const auto run{[&lhs, &rhs]() {
+        (void)(lhs * rhs);
+        (void)lhs.Transpose();
+        (void)lhs.Sum(ppp::Axis::Column);
+    }};
+    std::uint64_t time = time_operation(run);
+    std::cout << "Default tiles " << size << "x" << size << ": " << time
+              << "us" << std::endl;
+
+    time = time_operation([]() { (void)ppp::Tune(); });
+    std::cout << "Tune: " << time << "us" << std::endl;
+
+    time = time_operation(run);
+    std::cout << "Tuned tiles " << size << "x" << size << ": " << time
+              << "us" << std::endl;
+
+    std::filesystem::remove(cache);
+    ppp::SetTuningCachePath({});
+}
+
+void BenchMarkRandomizedSVD(std::size_t rows, std::size_t columns,
+                            std::size_t rank) {
+    ppp::Matrix<double> data{ppp::Matrix<double>::New(rows, columns).value()};
+    for (std::size_t i{0}; i < data.Size(); i++) {
+        data.Data()[i] = ppp::detail::RandomNormal<double>(1, i) *
+                         std::pow(0.95, static_cast<double>(i % columns));
+    }
+
+    // Full decomposition of the same matrix, column by column
+    std::vector<double> full(rows * columns);
+    std::vector<double> rotations(columns * columns);
+    std::uint64_t time = time_operation([&]() {
+        for (std::size_t row{0}; row < rows; row++) {
+            for (std::size_t column{0}; column < columns; column++) {
+                full[(column * rows) + row] =
+                    data.Data()[(row * columns) + column];
+            }
+        }
+        ppp::detail::JacobiSvd(rows, columns, full.data(),
+                               rotations.data());
+    });
+    std::cout << "Full Jacobi SVD " << rows << "x" << columns << ": " << time
+              << "us" << std::endl;
+
+    time = time_operation([&data, rank]() {
+        (void)ppp::TruncatedSVD<double>::New(data, rank);
+    });
+    std::cout << "Randomized SVD, rank " << rank << ": " << time << "us"
+              << std::endl;
+
+    time = time_operation([&data, rank]() {
+        (void)ppp::PCA<double>::New(data, rank,
+                                    ppp::SVDOptions{.power_iterations = 2});
+    });
+    std::cout << "PCA with 2 power iterations, " << rank
+              << " components: " << time << "us" << std::endl;
+
+    constexpr std::size_t block{4096};
+    std::vector<ppp::Matrix<double>> blocks{};
+    for (std::size_t row{0}; row < rows; row += block) {
+        blocks.push_back(
+            ppp::Matrix<double>::New(
+                data.View()
+                    .Block(row, 0, std::min(block, rows - row), columns)
+                    .value())
+                .value());
+    }
+    time = time_operation([&blocks, columns, rank]() {
+        ppp::SVDSketch<double> sketch{
+            ppp::SVDSketch<double>::New(columns, rank).value()};
+        for (const ppp::Matrix<double>& rows_block : blocks) {
+            (void)sketch.Update(rows_block);
+        }
+        (void)ppp::PCA<double>::New(sketch);
+    });
+    std::cout << "Single pass sketched PCA, " << rank
+              << " components: " << time << "us" << std::endl;
+}
+
+void BenchMarkQuantized(std::size_t size) {
+    ppp::Matrix<float> lhs{ppp::Matrix<float>::New(size, size).value()};
+    ppp::Matrix<float> rhs{ppp::Matrix<float>::New(size, size).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = ppp::detail::RandomNormal<float>(1, i);
+        rhs.Data()[i] = ppp::detail::RandomNormal<float>(2, i);
+    }
+
+    std::uint64_t time = time_operation([&lhs, &rhs]() {
+        (void)(lhs * rhs);
+    });
+    std::cout << "float GEMM " << size << "x" << size << ": " << time << "us"
+              << std::endl;
+
+    std::optional<ppp::QuantizedMatrix<std::uint8_t>> left{};
+    std::optional<ppp::QuantizedMatrix<std::int8_t>> right{};
+    time = time_operation([&]() {
+        left = ppp::QuantizedMatrix<std::uint8_t>::New(lhs);
+        right = ppp::QuantizedMatrix<std::int8_t>::New(rhs, ppp::Axis::Column);
+    });
+    std::cout << "Quantizing both operands: " << time << "us" << std::endl;
+
+    time = time_operation([&left, &right]() { (void)(*left * *right); });
+    std::cout << "uint8 x int8 GEMM, float result: " << time << "us"
+              << std::endl;
+
+    time = time_operation(
+        [&left, &right]() { (void)ppp::IntegerProduct(*left, *right); });
+    std::cout << "uint8 x int8 GEMM, int32 result: " << time << "us"
+              << std::endl;
+}
+
+void BenchMarkSplitComplex(std::size_t size, std::size_t samples) {
+    using Complex = std::complex<float>;
+    const auto random_entry = [](std::uint64_t seed, std::size_t i) {
+        return Complex{ppp::detail::RandomNormal<float>(seed, 2 * i),
+                       ppp::detail::RandomNormal<float>(seed, (2 * i) + 1)};
+    };
+
+    // Multiply-accumulate over I/Q samples
+    std::vector<Complex> signal(samples);
+    std::vector<Complex> taps(samples);
+    for (std::size_t i{0}; i < samples; i++) {
+        signal[i] = random_entry(1, i);
+        taps[i] = random_entry(2, i);
+    }
+    std::vector<Complex> accumulator(samples, Complex{0.0f, 0.0f});
+    std::uint64_t time = time_operation([&]() {
+        for (std::size_t i{0}; i < samples; i++) {
+            accumulator[i] += signal[i] * taps[i];
+        }
+    });
+    std::cout << "Interleaved multiply-accumulate, " << samples
+              << " samples: " << time << "us" << std::endl;
+
+    const ppp::SplitComplexColumn<float> split_signal{
+        ppp::SplitComplexColumn<float>::New(
+            ppp::Column<Complex>{signal, ""})};
+    const ppp::SplitComplexColumn<float> split_taps{
+        ppp::SplitComplexColumn<float>::New(ppp::Column<Complex>{taps, ""})};
+    ppp::SplitComplexColumn<float> split_accumulator{
+        ppp::SplitComplexColumn<float>::New(samples)};
+    time = time_operation([&]() {
+        (void)split_accumulator.MultiplyAccumulate(split_signal, split_taps);
+    });
+    std::cout << "Split multiply-accumulate: " << time << "us" << std::endl;
+
+    Complex interleaved_dot{};
+    time = time_operation([&]() {
+        interleaved_dot = std::transform_reduce(
+            signal.begin(), signal.end(), taps.begin(), Complex{0.0f, 0.0f},
+            std::plus<>{},
+            [](Complex x, Complex y) { return std::conj(x) * y; });
+    });
+    std::cout << "Interleaved conjugate dot: " << time << "us" << std::endl;
+    Complex split_dot{};
+    time = time_operation(
+        [&]() { split_dot = split_signal.ConjugateDot(split_taps).value(); });
+    std::cout << "Split conjugate dot: " << time << "us, relative difference "
+              << std::abs(split_dot - interleaved_dot) /
+                     std::abs(interleaved_dot)
+              << std::endl;
+
+    ppp::Matrix<Complex> lhs{ppp::Matrix<Complex>::New(size, size).value()};
+    ppp::Matrix<Complex> rhs{ppp::Matrix<Complex>::New(size, size).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = random_entry(3, i);
+        rhs.Data()[i] = random_entry(4, i);
+    }
+    time = time_operation([&lhs, &rhs]() { (void)(lhs * rhs); });
+    std::cout << "Interleaved complex GEMM " << size << "x" << size << ": "
+              << time << "us" << std::endl;
+
+    const auto split_lhs{ppp::SplitComplexMatrix<float>::New(lhs)};
+    const auto split_rhs{ppp::SplitComplexMatrix<float>::New(rhs)};
+    time = time_operation(
+        [&split_lhs, &split_rhs]() { (void)(split_lhs * split_rhs); });
+    std::cout << "Split complex GEMM: " << time << "us" << std::endl;
+}
+
+void BenchMarkConvolution(std::size_t size) {
+    ppp::Matrix<float> image{ppp::Matrix<float>::New(size, size).value()};
+    for (std::size_t i{0}; i < image.Size(); i++) {
+        image.Data()[i] = ppp::detail::RandomNormal<float>(1, i);
+    }
+    for (const std::size_t edge : {3, 7, 15, 31}) {
+        ppp::Matrix<float> kernel{
+            ppp::Matrix<float>::New(edge, edge).value()};
+        for (std::size_t i{0}; i < kernel.Size(); i++) {
+            kernel.Data()[i] = ppp::detail::RandomNormal<float>(2, i);
+        }
+
+        // The hand-rolled loop this replaces
+        const std::size_t outputs{size - edge + 1};
+        std::vector<float> naive(outputs * outputs);
+        std::uint64_t time = time_operation([&]() {
+            for (std::size_t i{0}; i < outputs; i++) {
+                for (std::size_t j{0}; j < outputs; j++) {
+                    float sum{0.0f};
+                    for (std::size_t u{0}; u < edge; u++) {
+                        for (std::size_t v{0}; v < edge; v++) {
+                            sum += kernel.Data()[(u * edge) + v] *
+                                   image.Data()[((i + u) * size) + j + v];
+                        }
+                    }
+                    naive[(i * outputs) + j] = sum;
+                }
+            }
+        });
+        std::cout << edge << "x" << edge << " kernel, naive loop: " << time
+                  << "us" << std::endl;
+
+        time = time_operation(
+            [&image, &kernel]() { (void)image.Correlate2D(kernel); });
+        std::cout << edge << "x" << edge << " kernel, Correlate2D: " << time
+                  << "us" << std::endl;
+
+        std::vector<float> output(outputs * outputs);
+        for (const std::size_t stride : {1, 2}) {
+            const ppp::detail::FilterShape shape{
+                ppp::detail::FilterShapeFor(size, size, edge, edge,
+                                            ppp::Padding::Valid, stride)
+                    .value()};
+            for (const std::size_t direct_taps :
+                 {std::numeric_limits<std::size_t>::max(), std::size_t{0}}) {
+                time = time_operation([&]() {
+                    ppp::detail::Correlate2D<float>(
+                        {image.Data(), size, 1}, size, size, kernel.Data(),
+                        edge, edge, shape, stride, output.data(),
+                        ppp::GetThreadCount(), direct_taps);
+                });
+                std::cout << edge << "x" << edge << " kernel, stride "
+                          << stride << ", "
+                          << (direct_taps == 0 ? "im2col" : "direct")
+                          << " path: " << time << "us" << std::endl;
+            }
+        }
+    }
+}
+
+void BenchMarkTriangular(std::size_t size) {
+    ppp::Matrix<double> a{ppp::Matrix<double>::New(size, size).value()};
+    for (std::size_t i{0}; i < a.Size(); i++) {
+        a.Data()[i] = ppp::detail::RandomNormal<double>(1, i) /
+                      static_cast<double>(size);
+    }
+    for (std::size_t i{0}; i < size; i++) {
+        a.Data()[(i * size) + i] += 2.0;
+    }
+    ppp::Matrix<double> rhs{ppp::Matrix<double>::New(size, size).value()};
+    for (std::size_t i{0}; i < rhs.Size(); i++) {
+        rhs.Data()[i] = ppp::detail::RandomNormal<double>(2, i);
+    }
+
+    // Forward substitution one right hand side at a time
+    ppp::Matrix<double> naive{rhs};
+    std::uint64_t time = time_operation([&]() {
+        for (std::size_t column{0}; column < size; column++) {
+            for (std::size_t row{0}; row < size; row++) {
+                double sum{naive.Data()[(row * size) + column]};
+                for (std::size_t inner{0}; inner < row; inner++) {
+                    sum -= a.Data()[(row * size) + inner] *
+                           naive.Data()[(inner * size) + column];
+                }
+                naive.Data()[(row * size) + column] =
+                    sum / a.Data()[(row * size) + row];
+            }
+        }
+    });
+    std::cout << "Naive forward substitution: " << time << "us" << std::endl;
+
+    std::optional<ppp::Matrix<double>> solved{};
+    time = time_operation([&]() {
+        solved = a.SolveTriangular(rhs, ppp::Triangle::Lower);
+    });
+    std::cout << "Blocked SolveTriangular: " << time << "us" << std::endl;
+
+    double difference{0.0};
+    for (std::size_t i{0}; i < rhs.Size(); i++) {
+        difference = std::max(
+            difference, std::fabs(solved->Data()[i] - naive.Data()[i]));
+    }
+    std::cout << "Largest difference: " << difference << std::endl;
+
+    time = time_operation([&]() {
+        (void)a.MultiplyTriangular(rhs, ppp::Triangle::Upper);
+    });
+    std::cout << "Blocked MultiplyTriangular: " << time << "us" << std::endl;
+
+    time = time_operation([&]() { (void)(a * rhs); });
+    std::cout << "Full GEMM for comparison: " << time << "us" << std::endl;
+
+    const ppp::Column<double> single{
+        std::vector<double>(rhs.Data(), rhs.Data() + size), "b"};
+    time = time_operation([&]() {
+        (void)a.SolveTriangular(single, ppp::Triangle::Lower);
+    });
+    std::cout << "Single right hand side SolveTriangular: " << time << "us"
+              << std::endl;
+}
+
+void BenchMarkNuma(std::size_t size) {
+    std::cout << "NUMA nodes: " << ppp::NumaNodeCount() << std::endl;
+    const ppp::Matrix<double> source{
+        ppp::Matrix<double>::New(size, size, 1.0).value()};
+    const std::vector<std::pair<std::string_view, ppp::NumaPolicy>> policies{
+        {"Local", ppp::NumaPolicy::Local},
+        {"Interleave", ppp::NumaPolicy::Interleave},
+        {"Partitioned", ppp::NumaPolicy::Partitioned}};
+    for (const bool pinned : {false, true}) {
+        ppp::SetThreadPinning(pinned);
+        for (const auto& [name, policy] : policies) {
+            const ppp::ScopedResource scope{
+                &ppp::SharedNumaResource(policy)};
+            std::optional<ppp::Matrix<double>> placed{};
+            std::uint64_t time = time_operation([&]() {
+                placed = ppp::Matrix<double>::New(size, size);
+            });
+            std::cout << name << (pinned ? ", pinned" : "")
+                      << " allocation: " << time << "us" << std::endl;
+
+            time = time_operation([&]() { placed.value() += source; });
+            std::cout << name << (pinned ? ", pinned" : "")
+                      << " first sweep: " << time << "us" << std::endl;
+        }
+    }
+    ppp::SetThreadPinning(false);
+}
+
+void BenchMarkMapped(std::size_t rows, std::size_t columns) {
+    const std::filesystem::path directory{
+        std::filesystem::temp_directory_path() / "ppp_mapped_benchmark"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    ppp::Matrix<double> in_memory{
+        ppp::Matrix<double>::New(rows, columns).value()};
+    for (std::size_t i{0}; i < in_memory.Size(); i++) {
+        in_memory.Data()[i] = static_cast<double>(i % 1021) - 510.0;
+    }
+    std::uint64_t time = time_operation([&]() {
+        (void)ppp::MappedMatrix<double>::Save(directory / "a", in_memory)
+            ->Flush();
+    });
+    std::cout << "Saving a " << rows << "x" << columns
+              << " matrix to a mapped file: " << time << "us" << std::endl;
+
+    const ppp::MappedMatrix<double> a{
+        ppp::MappedMatrix<double>::Open(directory / "a").value()};
+    time = time_operation(
+        [&in_memory]() { (void)in_memory.Sum(ppp::Axis::Column); });
+    std::cout << "In-memory column sums: " << time << "us" << std::endl;
+    time = time_operation([&a]() { (void)a.Sum(ppp::Axis::Column); });
+    std::cout << "Mapped column sums: " << time << "us" << std::endl;
+    time = time_operation([&a]() { (void)a.Max(ppp::Axis::Row); });
+    std::cout << "Mapped row maxima: " << time << "us" << std::endl;
+
+    time = time_operation([&in_memory]() { (void)(in_memory + in_memory); });
+    std::cout << "In-memory addition: " << time << "us" << std::endl;
+    time = time_operation(
+        [&a, &directory]() { (void)ppp::Add(a, a, directory / "sum"); });
+    std::cout << "Mapped addition into a new file: " << time << "us"
+              << std::endl;
+
+    const ppp::Matrix<double> projection{
+        ppp::Matrix<double>::New(columns, 64, 0.5).value()};
+    time = time_operation([&in_memory, &projection]() {
+        (void)(in_memory * projection);
+    });
+    std::cout << "In-memory product with a " << columns
+              << "x64 matrix: " << time << "us" << std::endl;
+    time = time_operation([&a, &projection, &directory]() {
+        (void)ppp::Multiply(a, projection.View(), directory / "product");
+    });
+    std::cout << "Mapped product into a new file: " << time << "us"
+              << std::endl;
+    std::filesystem::remove_all(directory);
+}
+
 void BenchMarkOperations() {
     std::vector<std::vector<float>> data{
         {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 0.0f},
@@ -56,6 +943,74 @@ void BenchMarkOperations() {
                }) /
                test_iters;
         std::cout << "Average 10x10 subtraction: " << time << "us" << std::endl;
+
+        std::cout << "Benchmarking allocation..." << std::endl;
+        BenchMarkAllocation(lhs.value(), rhs.value());
+
+        std::cout << "Benchmarking fixed-size matrices..." << std::endl;
+        BenchMarkFixedMatrix();
+
+        std::cout << "Benchmarking batched small matrices..." << std::endl;
+        BenchMarkBatch(1 << 16);
+
+        std::cout << "Benchmarking scalar broadcasting..." << std::endl;
+        BenchMarkScalarBroadcast(4096);
+
+        std::cout << "Benchmarking expression fusion..." << std::endl;
+        BenchMarkLazyExpression(4096);
+
+        std::cout << "Benchmarking multiplication..." << std::endl;
+        for (const std::size_t size : {256, 512, 1024}) {
+            BenchMarkGemm<float>(size, "float");
+            BenchMarkGemm<double>(size, "double");
+        }
+
+        std::cout << "Benchmarking parallel multiplication..." << std::endl;
+        BenchMarkGemmScaling(2048, 2048, 2048);
+        BenchMarkGemmScaling(65536, 256, 64);
+
+        std::cout << "Benchmarking LU factorization..." << std::endl;
+        BenchMarkLU(2048);
+
+        std::cout << "Benchmarking factorization reuse..." << std::endl;
+        BenchMarkFactorizationSolve(1024, 256);
+
+        std::cout << "Benchmarking reductions..." << std::endl;
+        BenchMarkReductions(4096);
+
+        std::cout << "Benchmarking element-wise math..." << std::endl;
+        BenchMarkMath(2048);
+
+        std::cout << "Benchmarking transpose..." << std::endl;
+        BenchMarkTranspose(4096);
+
+        std::cout << "Benchmarking sparse products..." << std::endl;
+        BenchMarkSparse(100'000, 2'000, 8);
+
+        std::cout << "Benchmarking autotuned tiles..." << std::endl;
+        BenchMarkTuning(2048);
+
+        std::cout << "Benchmarking randomized SVD..." << std::endl;
+        BenchMarkRandomizedSVD(50'000, 128, 10);
+
+        std::cout << "Benchmarking quantized products..." << std::endl;
+        BenchMarkQuantized(2048);
+
+        std::cout << "Benchmarking split complex kernels..." << std::endl;
+        BenchMarkSplitComplex(1024, 1 << 22);
+
+        std::cout << "Benchmarking 2D convolution..." << std::endl;
+        BenchMarkConvolution(2048);
+
+        std::cout << "Benchmarking triangular solve and multiply..."
+                  << std::endl;
+        BenchMarkTriangular(1024);
+
+        std::cout << "Benchmarking NUMA placement..." << std::endl;
+        BenchMarkNuma(4096);
+
+        std::cout << "Benchmarking memory-mapped matrices..." << std::endl;
+        BenchMarkMapped(16384, 4096);
     } else {
         std::cout << "Benchmarking skipped, unexpected result encountered.."
                   << std::endl;
@@ -336,6 +336,44 @@ bool TestCross(const std::unique_ptr<std::size_t>& passes,
     }
 }
 
+bool TestCompoundAssignment(const std::unique_ptr<std::size_t>& passes,
+                            const std::unique_ptr<std::size_t>& fails) {
+    std::vector<int> data{1, 5, 6};
+    std::vector<int> short_data{1, 5};
+    std::vector<int> expected_data{5, 25, 30};
+
+    ppp::Column col{data, "Key"};
+    ppp::Column short_col{short_data, "Key"};
+    ppp::Column original{data, "Key"};
+    ppp::Column expected{expected_data, "Key"};
+
+    if ((col += short_col).has_value() || col != original) {
+        FailNotification(col, "TestCompoundAssignment");
+        (*fails)++;
+        return false;
+    }
+
+    col += original;
+    col *= 3;
+    col -= original;
+    col /= 1;
+
+    // Chained temporaries reuse the buffer of the first one
+    std::optional<ppp::Column<int>> chained{
+        (2 * ppp::Column{data, "Key"} + original).value() - original};
+
+    if (col != expected || !chained.has_value() ||
+        chained.value() != ppp::Column{std::vector<int>{2, 10, 12}, "Key"}) {
+        FailNotification(col, "TestCompoundAssignment");
+        (*fails)++;
+        return false;
+    } else {
+        PassNotification(col, "TestCompoundAssignment");
+        (*passes)++;
+        return true;
+    }
+}
+
 }  // namespace
 
 bool ColumnMasterTest(const std::unique_ptr<std::size_t>& passes,
@@ -345,7 +383,7 @@ bool ColumnMasterTest(const std::unique_ptr<std::size_t>& passes,
            TestComparison(passes, fails) && TestSubtraction(passes, fails) &&
            TestDot(passes, fails) && TestAppend(passes, fails) &&
            TestScale(passes, fails) && TestNorm(passes, fails) &&
-           TestCross(passes, fails);
+           TestCross(passes, fails) && TestCompoundAssignment(passes, fails);
 }
 
 }  // namespace column_test
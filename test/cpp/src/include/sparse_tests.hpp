@@ -0,0 +1,14 @@
+#ifndef TEST_SRC_INCLUDE_SPARSE_TESTS_HPP_
+#define TEST_SRC_INCLUDE_SPARSE_TESTS_HPP_
+
+#include <cstddef>
+#include <memory>
+
+namespace sparse_test {
+
+bool SparseMasterTest(const std::unique_ptr<std::size_t>& passes,
+                      const std::unique_ptr<std::size_t>& fails);
+
+}
+
+#endif  // TEST_SRC_INCLUDE_SPARSE_TESTS_HPP_
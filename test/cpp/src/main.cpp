@@ -11,6 +11,7 @@
 
 #include "include/column_tests.hpp"
 #include "include/matrix_tests.hpp"
+#include "include/sparse_tests.hpp"
 
 bool TestCsvConstruction() {
     const char* bar = "";
@@ -23,7 +24,8 @@ int main(void) {
     std::unique_ptr<std::size_t> fails{std::make_unique<std::size_t>(0)};
 
     bool test_result{matrix_test::MatrixMasterTest(passes, fails) &&
-                     column_test::ColumnMasterTest(passes, fails)};
+                     column_test::ColumnMasterTest(passes, fails) &&
+                     sparse_test::SparseMasterTest(passes, fails)};
 
 #ifdef BENCHMARK
     std::cout << "Benchmarking matrix operations..." << std::endl;
@@ -1,15 +1,39 @@
 #include "include/matrix_tests.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <ostream>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "ppp/Allocator.hpp"
+#include "ppp/Batch.hpp"
+#include "ppp/Expression.hpp"
+#include "ppp/Factorization.hpp"
+#include "ppp/FixedMatrix.hpp"
+#include "ppp/Mapped.hpp"
 #include "ppp/Matrix.hpp"
+#include "ppp/Numa.hpp"
+#include "ppp/Quantized.hpp"
+#include "ppp/SplitComplex.hpp"
+#include "ppp/Svd.hpp"
+#include "ppp/Tuning.hpp"
 
 namespace matrix_test {
 namespace {
@@ -322,6 +346,2328 @@ bool TestLU(const std::unique_ptr<std::size_t>& passes,
     }
 }
 
+bool TestMultiplication(const std::unique_ptr<std::size_t>& passes,
+                        const std::unique_ptr<std::size_t>& fails) {
+    const ppp::Matrix<int> lhs{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{
+                                  {1, 2, 3},
+                                  {4, 5, 6},
+                              })
+            .value()};
+    const ppp::Matrix<int> rhs{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{
+                                  {7, 8},
+                                  {9, 10},
+                                  {11, 12},
+                              })
+            .value()};
+    const ppp::Matrix<int> known_product{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{
+                                  {58, 64},
+                                  {139, 154},
+                              })
+            .value()};
+
+    const std::optional<ppp::Matrix<int>> product{lhs * rhs};
+    const std::optional<ppp::Matrix<int>> bad_product{lhs * lhs};
+    if (!product.has_value() || product.value() != known_product ||
+        bad_product.has_value()) {
+        (*fails)++;
+        std::cout << "Test: TestMultiplication Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+
+    // Big enough to go through the packed kernels, with ragged edges and a
+    // column-major right hand side
+    constexpr std::size_t m{97};
+    constexpr std::size_t k{131};
+    constexpr std::size_t n{75};
+    ppp::Matrix<double> big_lhs{ppp::Matrix<double>::New(m, k).value()};
+    ppp::Matrix<double> big_rhs{
+        ppp::Matrix<double>::New(k, n, ppp::Layout::ColumnMajor).value()};
+    for (std::size_t i{0}; i < big_lhs.Size(); i++) {
+        big_lhs.Data()[i] = static_cast<double>((i * 7) % 13) - 6.0;
+    }
+    for (std::size_t i{0}; i < big_rhs.Size(); i++) {
+        big_rhs.Data()[i] = static_cast<double>((i * 5) % 11) * 0.25;
+    }
+
+    const std::optional<ppp::Matrix<double>> big_product{big_lhs * big_rhs};
+    bool matches{big_product.has_value()};
+    for (std::size_t row{0}; matches && row < m; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            double expected{0.0};
+            for (std::size_t p{0}; p < k; p++) {
+                expected += big_lhs.At(row, p).value() *
+                            big_rhs.At(p, column).value();
+            }
+            if (std::fabs(big_product.value().At(row, column).value() -
+                          expected) > 1e-9) {
+                matches = false;
+                break;
+            }
+        }
+    }
+
+    if (matches) {
+        (*passes)++;
+        std::cout << "Test: TestMultiplication Passed!" << std::endl
+                  << std::endl;
+        std::cout << product.value() << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestMultiplication Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestParallelMultiplication(const std::unique_ptr<std::size_t>& passes,
+                                const std::unique_ptr<std::size_t>& fails) {
+    // Tall-skinny and square shapes exercise both ways of splitting C
+    for (const auto &[m, k, n] :
+         {std::tuple<std::size_t, std::size_t, std::size_t>{1031, 67, 29},
+          std::tuple<std::size_t, std::size_t, std::size_t>{257, 263, 269}}) {
+        ppp::Matrix<float> lhs{ppp::Matrix<float>::New(m, k).value()};
+        ppp::Matrix<float> rhs{ppp::Matrix<float>::New(k, n).value()};
+        for (std::size_t i{0}; i < lhs.Size(); i++) {
+            lhs.Data()[i] = static_cast<float>((i * 3) % 7) - 3.0f;
+        }
+        for (std::size_t i{0}; i < rhs.Size(); i++) {
+            rhs.Data()[i] = static_cast<float>((i * 11) % 5) * 0.5f;
+        }
+
+        const std::optional<ppp::Matrix<float>> serial{
+            ppp::Multiply(lhs, rhs, 1)};
+        const std::optional<ppp::Matrix<float>> parallel{
+            ppp::Multiply(lhs, rhs, 4)};
+        if (!serial.has_value() || !parallel.has_value() ||
+            serial.value() != parallel.value()) {
+            (*fails)++;
+            std::cout << "Test: TestParallelMultiplication Failed..."
+                      << std::endl
+                      << std::endl;
+            return false;
+        }
+    }
+
+    (*passes)++;
+    std::cout << "Test: TestParallelMultiplication Passed!" << std::endl
+              << std::endl;
+    return true;
+}
+
+bool TestLazyExpression(const std::unique_ptr<std::size_t>& passes,
+                        const std::unique_ptr<std::size_t>& fails) {
+    const ppp::Matrix<double> a{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                     {3.0, 4.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> b{ppp::Matrix<double>::New(2, 2, 1.5).value()};
+    const ppp::Matrix<double> c{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {0.5, 0.5},
+                                     {1.0, 1.0},
+                                 })
+            .value()
+            .ToLayout(ppp::Layout::ColumnMajor)};
+    const ppp::Matrix<double> known{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.5, 2.5},
+                                     {1.5, 2.5},
+                                 })
+            .value()};
+    const ppp::Matrix<double> wrong_shape{
+        ppp::Matrix<double>::New(3, 2).value()};
+
+    const std::optional<ppp::Matrix<double>> fused{
+        ((ppp::Lazy(a) + b - ppp::Lazy(c) * 2.0) / 2.0 + 0.25)
+            .Evaluate()};
+    const std::optional<ppp::Matrix<double>> mismatched{
+        (ppp::Lazy(a) + b - wrong_shape).Evaluate()};
+
+    // Rows, columns and both at once broadcast like the eager operators
+    const ppp::Matrix<double> row{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {10.0, 20.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> column{row.Transpose()};
+    const std::optional<ppp::Matrix<double>> stretched{
+        (ppp::Lazy(a) + row - ppp::Lazy(column) * 2.0).Evaluate()};
+    const std::optional<ppp::Matrix<double>> outer{
+        (ppp::Lazy(column) - row).Evaluate()};
+    const bool broadcast{
+        stretched.has_value() && outer.has_value() &&
+        stretched.value() ==
+            ((a + row).value() - (column * 2.0).value()).value() &&
+        outer.value() == (column - row).value()};
+
+    if (fused.has_value() && fused.value() == known &&
+        !mismatched.has_value() && broadcast) {
+        (*passes)++;
+        std::cout << "Test: TestLazyExpression Passed!" << std::endl
+                  << std::endl;
+        std::cout << fused.value() << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestLazyExpression Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestBroadcasting(const std::unique_ptr<std::size_t>& passes,
+                      const std::unique_ptr<std::size_t>& fails) {
+    const ppp::Matrix<double> matrix{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                     {3.0, 4.0},
+                                     {5.0, 6.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> row{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {10.0, 20.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> column{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0},
+                                     {2.0},
+                                     {4.0},
+                                 })
+            .value()
+            .ToLayout(ppp::Layout::ColumnMajor)};
+    const ppp::Matrix<double> too_short{
+        ppp::Matrix<double>::New(2, 2).value()};
+
+    const ppp::Matrix<double> known_row_sum{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {11.0, 22.0},
+                                     {13.0, 24.0},
+                                     {15.0, 26.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> known_column_quotient{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                     {1.5, 2.0},
+                                     {1.25, 1.5},
+                                 })
+            .value()};
+    const ppp::Matrix<double> known_scaled{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {9.0, 8.0},
+                                     {7.0, 6.0},
+                                     {5.0, 4.0},
+                                 })
+            .value()};
+
+    const std::optional<ppp::Matrix<double>> row_sum{matrix + row};
+    const std::optional<ppp::Matrix<double>> reversed_row_sum{row + matrix};
+    const std::optional<ppp::Matrix<double>> column_quotient{
+        ppp::DivideElements(matrix, column)};
+    const std::optional<ppp::Matrix<double>> scaled{
+        10.0 - ((matrix * 2).value() / 2.0).value()};
+    const std::optional<ppp::Matrix<double>> bad{matrix + too_short};
+
+    if (row_sum.has_value() && row_sum.value() == known_row_sum &&
+        reversed_row_sum.has_value() &&
+        reversed_row_sum.value() == known_row_sum &&
+        column_quotient.has_value() &&
+        column_quotient.value() == known_column_quotient &&
+        scaled.has_value() && scaled.value() == known_scaled &&
+        !bad.has_value()) {
+        (*passes)++;
+        std::cout << "Test: TestBroadcasting Passed!" << std::endl
+                  << std::endl;
+        std::cout << row_sum.value() << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestBroadcasting Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestCompoundAssignment(const std::unique_ptr<std::size_t>& passes,
+                            const std::unique_ptr<std::size_t>& fails) {
+    ppp::Matrix<double> matrix{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                     {3.0, 4.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> row{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> wide{ppp::Matrix<double>::New(2, 3).value()};
+    const ppp::Matrix<double> known_updated{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {0.0, 1.0},
+                                     {4.0, 5.0},
+                                 })
+            .value()};
+    const ppp::Matrix<double> known_chained{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {2.0, 2.0},
+                                     {6.0, 6.0},
+                                 })
+            .value()};
+
+    // Growing the left operand in place is not allowed
+    const bool rejected{!(matrix += wide).has_value()};
+
+    matrix -= row;
+    matrix *= 4;
+    matrix /= 2.0;
+    matrix += row;
+    matrix -= 1;
+    matrix += (matrix * 0).value();
+
+    // Each step of the chain reuses the buffer of the temporary it receives
+    std::optional<ppp::Matrix<double>> start{
+        ppp::Matrix<double>::New(2, 2, 2.0)};
+    const double *buffer{start.value().Data()};
+    const std::optional<ppp::Matrix<double>> chained{
+        ((((std::move(start.value()) * 2.0).value() - 1).value() +
+          known_updated)
+             .value() -
+         row)};
+    const bool reused{chained.has_value() && chained.value().Data() == buffer};
+
+    // a *= b is the matrix product, so the shape may change
+    ppp::Matrix<double> product{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                 })
+            .value()};
+    const bool multiplied{(product *= wide).has_value() &&
+                          product.Height() == 1 && product.Width() == 3};
+
+    // A temporary on the right keeps the operands' order in the key
+    const ppp::Column<double> left{std::vector<double>{1.0, 2.0}, "a"};
+    std::ostringstream keys;
+    keys << (left + ppp::Column<double>{std::vector<double>{3.0, 4.0}, "b"})
+                .value()
+         << (left - ppp::Column<double>{std::vector<double>{3.0, 4.0}, "b"})
+                .value();
+    const bool ordered{keys.str() ==
+                       "\"a + b\" | 4 | 6 | \n\"a - b\" | -2 | -2 | \n"};
+
+    if (rejected && matrix == known_updated && reused &&
+        chained.value() == known_chained && multiplied && ordered) {
+        (*passes)++;
+        std::cout << "Test: TestCompoundAssignment Passed!" << std::endl
+                  << std::endl;
+        std::cout << matrix << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestCompoundAssignment Failed..." << std::endl
+                  << std::endl;
+        std::cout << matrix << std::endl;
+        return false;
+    }
+}
+
+template <class M>
+concept FactorableLU = requires(const M& matrix) { matrix.FactorLU(); };
+
+bool TestPivotedLU(const std::unique_ptr<std::size_t>& passes,
+                   const std::unique_ptr<std::size_t>& fails) {
+    // Truncating integer division would give wrong factors
+    static_assert(FactorableLU<ppp::Matrix<double>> &&
+                  !FactorableLU<ppp::Matrix<int>>);
+
+    const ppp::Matrix<double> small{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {0.0, 2.0, 1.0},
+                                     {1.0, 1.0, 1.0},
+                                     {2.0, 1.0, 3.0},
+                                 })
+            .value()};
+    const ppp::Matrix<int> integers{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{
+                                  {2, -3, 1},
+                                  {2, 0, -1},
+                                  {1, 4, 5},
+                              })
+            .value()};
+    const ppp::Matrix<double> singular{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {1.0, 2.0},
+                                     {2.0, 4.0},
+                                 })
+            .value()};
+
+    // Needs a row swap on the first step, which the unpivoted LU can not do
+    const bool small_ok{
+        std::fabs(small.Det().value() - -3.0) < 1e-12 &&
+        integers.Det().value() == 49 && singular.Det().value() == 0.0 &&
+        !singular.Solve(small).has_value()};
+
+    const ppp::Matrix<double> identity{
+        (small * small.Inverse().value()).value()};
+    bool inverse_ok{true};
+    for (std::size_t row{0}; row < 3; row++) {
+        for (std::size_t column{0}; column < 3; column++) {
+            const double expected{row == column ? 1.0 : 0.0};
+            inverse_ok = inverse_ok &&
+                         std::fabs(identity.At(row, column).value() -
+                                   expected) < 1e-12;
+        }
+    }
+
+    // Spans several panels, so the blocked update and row swaps across
+    // panels are exercised
+    constexpr std::size_t n{301};
+    constexpr std::size_t rhs_columns{5};
+    ppp::Matrix<double> big{ppp::Matrix<double>::New(n, n).value()};
+    for (std::size_t i{0}; i < big.Size(); i++) {
+        std::uint32_t hash{static_cast<std::uint32_t>(i) * 2654435761u};
+        hash ^= hash >> 15;
+        hash *= 2246822519u;
+        hash ^= hash >> 13;
+        big.Data()[i] = static_cast<double>(hash >> 8) / (1 << 23) - 1.0;
+    }
+    ppp::Matrix<double> expected{
+        ppp::Matrix<double>::New(n, rhs_columns).value()};
+    for (std::size_t i{0}; i < expected.Size(); i++) {
+        expected.Data()[i] = static_cast<double>(i % 7) - 3.0;
+    }
+    const ppp::Matrix<double> rhs{(big * expected).value()};
+    const std::optional<ppp::Matrix<double>> solution{big.Solve(rhs)};
+
+    bool big_ok{solution.has_value()};
+    for (std::size_t i{0}; big_ok && i < expected.Size(); i++) {
+        big_ok = std::fabs(solution.value().Data()[i] - expected.Data()[i]) <
+                 1e-8;
+    }
+
+    // P * A == L * U
+    const auto factors{big.FactorLU()};
+    big_ok = big_ok && factors.has_value();
+    if (big_ok) {
+        const ppp::Matrix<double>& lu{factors.value().first};
+        const std::vector<std::size_t>& permutation{factors.value().second};
+        for (std::size_t row{0}; big_ok && row < n; row += 37) {
+            for (std::size_t column{0}; column < n; column += 13) {
+                double product{0.0};
+                for (std::size_t p{0}; p <= std::min(row, column); p++) {
+                    const double lower{p == row ? 1.0 : lu.At(row, p).value()};
+                    product += lower * lu.At(p, column).value();
+                }
+                if (std::fabs(product -
+                              big.At(permutation[row], column).value()) >
+                    1e-10) {
+                    big_ok = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (small_ok && inverse_ok && big_ok) {
+        (*passes)++;
+        std::cout << "Test: TestPivotedLU Passed!" << std::endl << std::endl;
+        std::cout << small.Inverse().value() << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestPivotedLU Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestFactorizations(const std::unique_ptr<std::size_t>& passes,
+                        const std::unique_ptr<std::size_t>& fails) {
+    // Sizes straddle the LU, Cholesky, QR and triangular solve block sizes
+    constexpr std::size_t n{290};
+    constexpr std::size_t tall{337};
+    constexpr std::size_t rhs_columns{41};
+    const auto fill{[](ppp::Matrix<double>& matrix, std::uint32_t seed) {
+        for (std::size_t i{0}; i < matrix.Size(); i++) {
+            std::uint32_t hash{static_cast<std::uint32_t>(i + seed) *
+                               2654435761u};
+            hash ^= hash >> 15;
+            hash *= 2246822519u;
+            hash ^= hash >> 13;
+            matrix.Data()[i] = static_cast<double>(hash >> 8) / (1 << 23) - 1.0;
+        }
+    }};
+
+    ppp::Matrix<double> general{ppp::Matrix<double>::New(tall, n).value()};
+    fill(general, 1);
+    ppp::Matrix<double> expected{
+        ppp::Matrix<double>::New(n, rhs_columns, ppp::Layout::ColumnMajor)
+            .value()};
+    fill(expected, 7);
+
+    // A^T * A + I is symmetric positive definite
+    ppp::Matrix<double> general_transposed{
+        ppp::Matrix<double>::New(n, tall).value()};
+    for (std::size_t row{0}; row < tall; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            general_transposed.Data()[(column * tall) + row] =
+                general.At(row, column).value();
+        }
+    }
+    ppp::Matrix<double> spd{(general_transposed * general).value()};
+    for (std::size_t row{0}; row < n; row++) {
+        spd.Data()[(row * n) + row] += 1.0;
+    }
+
+    ppp::Matrix<double> square{ppp::Matrix<double>::New(n, n).value()};
+    fill(square, 3);
+
+    const auto close{[](const std::optional<ppp::Matrix<double>>& solution,
+                        const ppp::Matrix<double>& known) {
+        if (!solution.has_value() ||
+            solution.value().Height() != known.Height() ||
+            solution.value().Width() != known.Width()) {
+            return false;
+        }
+        for (std::size_t row{0}; row < known.Height(); row++) {
+            for (std::size_t column{0}; column < known.Width(); column++) {
+                if (std::fabs(solution.value().At(row, column).value() -
+                              known.At(row, column).value()) > 1e-7) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }};
+
+    const auto lu{ppp::LUFactorization<double>::New(square)};
+    const auto cholesky{ppp::CholeskyFactorization<double>::New(spd)};
+    const auto qr{ppp::QRFactorization<double>::New(general)};
+    const auto square_qr{ppp::QRFactorization<double>::New(square)};
+
+    const bool solved{
+        lu.has_value() && cholesky.has_value() && qr.has_value() &&
+        square_qr.has_value() &&
+        close(lu.value().Solve((square * expected).value()), expected) &&
+        close(cholesky.value().Solve((spd * expected).value()), expected) &&
+        close(qr.value().Solve((general * expected).value()), expected) &&
+        close(square_qr.value().Solve((square * expected).value()),
+              expected) &&
+        std::fabs(lu.value().Det() - square.Det().value()) <=
+            1e-9 * std::fabs(square.Det().value())};
+
+    const bool rejected{
+        !ppp::CholeskyFactorization<double>::New(square).has_value() &&
+        !ppp::QRFactorization<double>::New(general_transposed).has_value() &&
+        !ppp::LUFactorization<double>::New(general).has_value() &&
+        !lu.value().Solve(general).has_value()};
+
+    if (solved && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestFactorizations Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestFactorizations Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+template <class T>
+bool TransposeMatches(ppp::Layout layout) {
+    constexpr std::size_t rows{37};
+    constexpr std::size_t columns{53};
+    ppp::Matrix<T> matrix{
+        ppp::Matrix<T>::New(rows, columns, layout).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<T>(static_cast<int>(i % 251) - 125);
+    }
+
+    const ppp::Matrix<T> transposed{matrix.Transpose()};
+    const ppp::MatrixView<const T> view{matrix.Transposed()};
+    const ppp::Matrix<T> other_layout{matrix.ToLayout(
+        layout == ppp::Layout::RowMajor ? ppp::Layout::ColumnMajor
+                                        : ppp::Layout::RowMajor)};
+    if (transposed.Height() != columns || transposed.Width() != rows ||
+        view.Height() != columns || view.Width() != rows ||
+        other_layout != matrix || view.At(columns, 0).has_value()) {
+        return false;
+    }
+    for (std::size_t row{0}; row < rows; row++) {
+        for (std::size_t column{0}; column < columns; column++) {
+            if (transposed.At(column, row) != matrix.At(row, column) ||
+                view.At(column, row) != matrix.At(row, column)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool TestTranspose(const std::unique_ptr<std::size_t>& passes,
+                   const std::unique_ptr<std::size_t>& fails) {
+    const bool copies{
+        TransposeMatches<float>(ppp::Layout::RowMajor) &&
+        TransposeMatches<float>(ppp::Layout::ColumnMajor) &&
+        TransposeMatches<double>(ppp::Layout::RowMajor) &&
+        TransposeMatches<double>(ppp::Layout::ColumnMajor) &&
+        TransposeMatches<int>(ppp::Layout::RowMajor) &&
+        TransposeMatches<std::complex<double>>(ppp::Layout::ColumnMajor)};
+
+    // Not a multiple of the tile size, so edge tiles are swapped too
+    constexpr std::size_t n{130};
+    ppp::Matrix<double> square{ppp::Matrix<double>::New(n, n).value()};
+    for (std::size_t i{0}; i < square.Size(); i++) {
+        square.Data()[i] = static_cast<double>(i);
+    }
+    const ppp::Matrix<double> expected{square.Transpose()};
+    const bool in_place{square.TransposeInPlace().has_value() &&
+                        square == expected};
+
+    ppp::Matrix<double> wide{ppp::Matrix<double>::New(3, 5, 1.0).value()};
+    const bool rejected{!wide.TransposeInPlace().has_value() &&
+                        wide.Height() == 3 && wide.Width() == 5};
+
+    // The lazy transpose feeds GEMM without being materialized
+    ppp::Matrix<double> tall{ppp::Matrix<double>::New(n + 7, n).value()};
+    for (std::size_t i{0}; i < tall.Size(); i++) {
+        tall.Data()[i] = static_cast<double>(i % 17) - 8.0;
+    }
+    const std::optional<ppp::Matrix<double>> lazy{tall.Transposed() * tall};
+    const std::optional<ppp::Matrix<double>> eager{tall.Transpose() * tall};
+    const std::optional<ppp::Matrix<double>> materialized{
+        ppp::Matrix<double>::New(tall.Transposed())};
+    const bool views{lazy.has_value() && eager.has_value() &&
+                     lazy.value() == eager.value() &&
+                     materialized.has_value() &&
+                     materialized.value() == tall.Transpose() &&
+                     !(tall * std::as_const(tall).View()).has_value()};
+
+    if (copies && in_place && rejected && views) {
+        (*passes)++;
+        std::cout << "Test: TestTranspose Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestTranspose Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestViews(const std::unique_ptr<std::size_t>& passes,
+               const std::unique_ptr<std::size_t>& fails) {
+    ppp::Matrix<double> matrix{ppp::Matrix<double>::New(6, 8).value()};
+    for (std::size_t i{0}; i < matrix.Size(); i++) {
+        matrix.Data()[i] = static_cast<double>(i);
+    }
+    const ppp::Matrix<double>& constant{matrix};
+
+    // Entry (r, c) of the full matrix holds 8r + c
+    const ppp::MatrixView<const double> block{
+        constant.Block(1, 2, 3, 4).value()};
+    const ppp::MatrixView<const double> slice{
+        constant.Slice(1, 6, 2, 0, 8, 3).value()};
+    const bool shapes{
+        block.Height() == 3 && block.Width() == 4 &&
+        block.At(2, 3) == std::optional<double>{29.0} &&
+        slice.Height() == 3 && slice.Width() == 3 &&
+        slice.At(2, 2) == std::optional<double>{46.0} &&
+        block.Row(1).value().At(0, 1) == std::optional<double>{19.0} &&
+        block.Column(3).value().At(2, 0) == std::optional<double>{29.0} &&
+        slice.Block(1, 1, 2, 2).value().At(1, 1) ==
+            std::optional<double>{46.0} &&
+        !constant.Block(4, 0, 3, 1).has_value() &&
+        !constant.Slice(0, 7, 1, 0, 8, 1).has_value() &&
+        !constant.Slice(0, 6, 0, 0, 8, 1).has_value() &&
+        constant.Block(6, 8, 0, 0).value().Size() == 0};
+
+    // Kernels read views in place; results match the materialized blocks
+    const ppp::Matrix<double> copied{ppp::Matrix<double>::New(block).value()};
+    const ppp::Matrix<double> row{
+        ppp::Matrix<double>::New(block.Row(0).value()).value()};
+    const ppp::Matrix<double> tile{
+        ppp::Matrix<double>::New(constant.Block(0, 0, 4, 3).value())
+            .value()};
+    const bool kernels{
+        (block + row).value() == (copied + row).value() &&
+        (block - block.Row(0).value()).value() == (copied - row).value() &&
+        MultiplyElements(copied, block).value() ==
+            MultiplyElements(copied, copied).value() &&
+        (block * constant.Block(0, 0, 4, 3).value()).value() ==
+            (copied * tile).value() &&
+        (2.0 * block).value() == (copied * 2.0).value() &&
+        (1.0 - block).value() == (1.0 - copied).value() &&
+        (ppp::Lazy(block) + copied).Evaluate().value() ==
+            (copied + copied).value() &&
+        !(block + slice).has_value()};
+
+    // Writes through a mutable view land in the matrix, and a view into the
+    // matrix being updated is read before it is overwritten
+    matrix.Block(5, 0, 1, 8).value()(0, 7) = -1.0;
+    ppp::Matrix<double> centered{
+        ppp::Matrix<double>::New(4, 3, ppp::Layout::ColumnMajor).value()};
+    for (std::size_t i{0}; i < centered.Size(); i++) {
+        centered.Data()[i] = static_cast<double>(i * i);
+    }
+    const ppp::Matrix<double> first_row{
+        ppp::Matrix<double>::New(centered.View().Row(0).value()).value()};
+    const ppp::Matrix<double> expected{(centered - first_row).value()};
+    const bool in_place{
+        matrix.At(5, 7) == std::optional<double>{-1.0} &&
+        (centered -= std::as_const(centered).View().Row(0).value())
+            .has_value() &&
+        centered == expected};
+
+    if (shapes && kernels && in_place) {
+        (*passes)++;
+        std::cout << "Test: TestViews Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestViews Failed..." << std::endl << std::endl;
+        return false;
+    }
+}
+
+bool TestFixedMatrix(const std::unique_ptr<std::size_t>& passes,
+                     const std::unique_ptr<std::size_t>& fails) {
+    using Matrix3 = ppp::FixedMatrix<double, 3, 3>;
+    constexpr Matrix3 rotation{{{0.0, -1.0, 0.0}, {1.0, 0.0, 0.0}, {0, 0, 1}}};
+    constexpr ppp::FixedMatrix<double, 3, 2> points{
+        {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}}};
+
+    // Everything below is evaluated by the compiler
+    static_assert(rotation * rotation.Transpose() == Matrix3::Identity());
+    static_assert((rotation * points)(0, 1) == -4.0);
+    static_assert(rotation.Det() == 1.0);
+    static_assert(rotation.Inverse().value() == rotation.Transpose());
+    static_assert(!ppp::FixedMatrix<double, 2, 2>{{{1, 2}, {2, 4}}}
+                       .Inverse()
+                       .has_value());
+    static_assert(ppp::FixedMatrix<int, 3, 3>{{{2, 0, 1}, {1, 3, 2}, {1, 1, 2}}}
+                      .Det() == 6);
+    static_assert(ppp::FixedMatrix<int, 2, 2>{{{0, 1}, {1, 0}}}.Det() == -1);
+    static_assert((2 * points - points / 0.5)(2, 1) == 0.0);
+
+    // Interop with the dynamic Matrix goes through views
+    const ppp::Matrix<double> dynamic{points.ToMatrix()};
+    const std::optional<ppp::FixedMatrix<double, 3, 2>> round_trip{
+        ppp::FixedMatrix<double, 3, 2>::New(dynamic)};
+    const std::optional<ppp::Matrix<double>> mixed{rotation.View() * dynamic};
+    const ppp::FixedMatrix<double, 4, 4> general{{{4, 1, 2, 0.5},
+                                                  {1, 5, 0, 1},
+                                                  {2, 0, 6, 1},
+                                                  {0.5, 1, 1, 7}}};
+    const ppp::FixedMatrix<double, 4, 4> product{general *
+                                                 general.Inverse().value()};
+    bool inverted{true};
+    for (std::size_t row{0}; row < 4; row++) {
+        for (std::size_t column{0}; column < 4; column++) {
+            inverted = inverted && std::fabs(product(row, column) -
+                                             (row == column ? 1.0 : 0.0)) <
+                                       1e-12;
+        }
+    }
+
+    if (round_trip.has_value() && round_trip.value() == points &&
+        !ppp::FixedMatrix<double, 2, 3>::New(dynamic).has_value() &&
+        mixed.has_value() &&
+        mixed.value() == (rotation * points).ToMatrix() && inverted &&
+        std::fabs(general.Det() -
+                  general.ToMatrix().Det().value()) < 1e-9) {
+        (*passes)++;
+        std::cout << "Test: TestFixedMatrix Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestFixedMatrix Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+// Fills a batch with diagonally dominant, so invertible, matrices
+template <std::size_t N>
+ppp::MatrixBatch<double, N, N> DominantBatch(std::size_t count) {
+    ppp::MatrixBatch<double, N, N> batch{
+        ppp::MatrixBatch<double, N, N>::New(count).value()};
+    for (std::size_t index{0}; index < count; index++) {
+        ppp::FixedMatrix<double, N, N> matrix{};
+        for (std::size_t row{0}; row < N; row++) {
+            for (std::size_t column{0}; column < N; column++) {
+                matrix(row, column) =
+                    static_cast<double>(((index * 7) + (row * 5) + column) %
+                                        11) /
+                        11.0 +
+                    (row == column ? 2.0 * N : 0.0);
+            }
+        }
+        (void)batch.Set(index, matrix);
+    }
+    return batch;
+}
+
+template <std::size_t N>
+bool BatchMatches(std::size_t count) {
+    const ppp::MatrixBatch<double, N, N> batch{DominantBatch<N>(count)};
+    const ppp::MatrixBatch<double, N, N> other{DominantBatch<N>(count + 3)};
+    ppp::MatrixBatch<double, N, 2> rhs{
+        ppp::MatrixBatch<double, N, 2>::New(count).value()};
+    for (std::size_t index{0}; index < count; index++) {
+        ppp::FixedMatrix<double, N, 2> b{static_cast<double>(index % 5)};
+        b(0, 1) = -1.0;
+        (void)rhs.Set(index, b);
+    }
+
+    const ppp::Column<double> determinants{batch.Det()};
+    const ppp::MatrixBatch<double, N, N> inverses{batch.Inverse()};
+    const std::optional<ppp::MatrixBatch<double, N, 2>> solutions{
+        batch.Solve(rhs)};
+    const std::optional<ppp::MatrixBatch<double, N, N>> products{
+        batch * inverses};
+    if (determinants.Size() != count || !solutions.has_value() ||
+        !products.has_value() || (batch * other).has_value() ||
+        batch.Solve(ppp::MatrixBatch<double, N, 2>::New(1).value())
+            .has_value() ||
+        batch.Get(count).has_value()) {
+        return false;
+    }
+
+    const auto close{[](const auto& left, const auto& right) {
+        for (std::size_t i{0}; i < left.Size(); i++) {
+            if (std::fabs(left.Data()[i] - right.Data()[i]) > 1e-9) {
+                return false;
+            }
+        }
+        return true;
+    }};
+    for (std::size_t index{0}; index < count; index++) {
+        const ppp::FixedMatrix<double, N, N> matrix{batch.Get(index).value()};
+        const ppp::FixedMatrix<double, N, N> inverse{
+            matrix.Inverse().value()};
+        if (std::fabs(determinants.Data()[index] - matrix.Det()) > 1e-9 ||
+            !close(inverses.Get(index).value(), inverse) ||
+            !close(products.value().Get(index).value(),
+                   ppp::FixedMatrix<double, N, N>::Identity()) ||
+            !close(solutions.value().Get(index).value(),
+                   inverse * rhs.Get(index).value())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TestBatch(const std::unique_ptr<std::size_t>& passes,
+               const std::unique_ptr<std::size_t>& fails) {
+    // Counts off the block width, and one large enough to use every thread
+    ppp::MatrixBatch<int, 2, 2> integers{
+        ppp::MatrixBatch<int, 2, 2>::New(3).value()};
+    (void)integers.Set(1, ppp::FixedMatrix<int, 2, 2>{{{0, 1}, {1, 0}}});
+    (void)integers.Set(2, ppp::FixedMatrix<int, 2, 2>{{{3, 1}, {2, 4}}});
+    const ppp::Column<int> determinants{integers.Det()};
+
+    if (BatchMatches<2>(13) && BatchMatches<3>(37) &&
+        BatchMatches<4>(40'001) && determinants.Size() == 3 &&
+        determinants.Data()[0] == 0 && determinants.Data()[1] == -1 &&
+        determinants.Data()[2] == 10 &&
+        !integers.Set(3, ppp::FixedMatrix<int, 2, 2>{}).has_value()) {
+        (*passes)++;
+        std::cout << "Test: TestBatch Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestBatch Failed..." << std::endl << std::endl;
+        return false;
+    }
+}
+
+bool TestPooledAllocation(const std::unique_ptr<std::size_t>& passes,
+                          const std::unique_ptr<std::size_t>& fails) {
+    const auto aligned{[](const void* pointer) {
+        return reinterpret_cast<std::uintptr_t>(pointer) %
+                   ppp::BUFFER_ALIGNMENT ==
+               0;
+    }};
+    const ppp::Matrix<float> lhs{ppp::Matrix<float>::New(9, 7, 1.5f).value()};
+    const ppp::Matrix<float> rhs{ppp::Matrix<float>::New(9, 7, 0.5f).value()};
+    const ppp::Matrix<float> expected{(lhs + rhs).value()};
+
+    // Same-sized temporaries come back out of the pool's free list
+    ppp::PoolResource pool{};
+    const float* first{nullptr};
+    bool reused{true};
+    {
+        const ppp::ScopedResource scope{&pool};
+        for (std::size_t repeat{0}; repeat < 4; repeat++) {
+            const ppp::Matrix<float> sum{(lhs + rhs).value()};
+            first = first == nullptr ? sum.Data() : first;
+            reused = reused && sum.Data() == first && aligned(sum.Data()) &&
+                     sum == expected;
+        }
+    }
+
+    // The arena rewinds once its last temporary is gone, and buffers moved
+    // out of the scope keep the resource they were drawn from
+    ppp::ArenaResource arena{4096};
+    std::optional<ppp::Matrix<float>> kept{};
+    bool bumped{false};
+    {
+        const ppp::ScopedResource scope{&arena};
+        const ppp::Matrix<float> difference{(lhs - rhs).value()};
+        const ppp::Column<double> column{std::vector<double>(33, 2.0), "c"};
+        kept.emplace((difference + lhs).value());
+        bumped = arena.Used() >= 3 * 9 * 7 * sizeof(float) &&
+                 aligned(column.Data()) && aligned(difference.Data()) &&
+                 (column + column).value().Data()[32] == 4.0;
+    }
+    const bool held{arena.Used() != 0};
+    const bool correct{kept.has_value() &&
+                       kept.value() == ((lhs - rhs).value() + lhs).value()};
+    kept.reset();
+
+    if (reused && bumped && held && correct && arena.Used() == 0 &&
+        ppp::CurrentResource() == std::pmr::new_delete_resource() &&
+        aligned(lhs.Data())) {
+        (*passes)++;
+        std::cout << "Test: TestPooledAllocation Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestPooledAllocation Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestCopyOnWrite(const std::unique_ptr<std::size_t>& passes,
+                     const std::unique_ptr<std::size_t>& fails) {
+    const ppp::Matrix<double> original{
+        ppp::Matrix<double>::New(64, 48, 1.0).value()};
+    const double* entries{original.Data()};
+
+    // Plain copies, including by-value passing, own their entries
+    const auto read_by_value{[entries](ppp::Matrix<double> matrix) {
+        return !matrix.Shared() && std::as_const(matrix).Data() != entries;
+    }};
+    ppp::Matrix<double> deep{original};
+    deep.Data()[0] = -2.0;
+    const bool owned{!original.Shared() && read_by_value(original) &&
+                     original.At(0, 0) == std::optional<double>{1.0}};
+
+    // Share() is opt in and shares the entries until a write
+    ppp::Matrix<double> copy{original.Share()};
+    const std::optional<ppp::Matrix<double>> wrapped{original.Share()};
+    const bool shared{copy.Shared() && original.Shared() &&
+                      std::as_const(copy).Data() == entries &&
+                      wrapped.value().Data() == entries};
+
+    copy.Data()[5] = -1.0;
+    const bool detached{std::as_const(copy).Data() != entries &&
+                        original.Data() == entries &&
+                        original.At(0, 5) == std::optional<double>{1.0} &&
+                        copy.At(0, 5) == std::optional<double>{-1.0}};
+
+    // Compound assignment on a share leaves the original alone, also when
+    // the pool broadcasts it over several workers
+    ppp::Matrix<double> accumulated{original.Share()};
+    (void)(accumulated += original);
+    ppp::SetThreadCount(4);
+    ppp::Matrix<double> wide{ppp::Matrix<double>::New(256, 512, 1.0).value()};
+    const ppp::Matrix<double> wide_share{wide.Share()};
+    (void)(wide += ppp::Matrix<double>::New(1, 512, 2.0).value());
+    ppp::SetThreadCount(0);
+    const bool broadcast{
+        !wide.Shared() && !wide_share.Shared() &&
+        wide == ppp::Matrix<double>::New(256, 512, 3.0).value() &&
+        wide_share == ppp::Matrix<double>::New(256, 512, 1.0).value()};
+
+    // Moves steal the buffer in both directions
+    ppp::Matrix<double> moved{std::move(copy)};
+    ppp::Matrix<double> assigned{ppp::Matrix<double>::New().value()};
+    assigned = std::move(moved);
+
+    if (owned && shared && detached && broadcast &&
+        wrapped.value().Shared() &&
+        accumulated.At(3, 3) == std::optional<double>{2.0} &&
+        original.At(3, 3) == std::optional<double>{1.0} &&
+        copy.Size() == 0 && moved.Size() == 0 &&
+        assigned.At(0, 5) == std::optional<double>{-1.0} &&
+        !assigned.Shared()) {
+        (*passes)++;
+        std::cout << "Test: TestCopyOnWrite Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestCopyOnWrite Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+// Checks every reduction over axis against a plain loop through At()
+bool ReductionsMatch(const ppp::Matrix<double>& matrix, ppp::Axis axis) {
+    const std::size_t results{axis == ppp::Axis::Row      ? matrix.Height()
+                              : axis == ppp::Axis::Column ? matrix.Width()
+                                                          : 1};
+    const std::size_t count{axis == ppp::Axis::Row      ? matrix.Width()
+                            : axis == ppp::Axis::Column ? matrix.Height()
+                                                        : matrix.Size()};
+    const ppp::Column<double> sum{matrix.Sum(axis)};
+    const std::optional<ppp::Column<double>> mean{matrix.Mean(axis)};
+    const std::optional<ppp::Column<double>> min{matrix.Min(axis)};
+    const std::optional<ppp::Column<double>> max{matrix.Max(axis)};
+    const std::optional<ppp::Column<std::int64_t>> argmin{
+        matrix.ArgMin(axis)};
+    const std::optional<ppp::Column<std::int64_t>> argmax{
+        matrix.ArgMax(axis)};
+    const std::optional<ppp::Column<double>> variance{
+        matrix.Variance(axis, 1)};
+    const std::optional<ppp::Column<double>> deviation{matrix.StdDev(axis)};
+    if (sum.Size() != results || !mean.has_value() || !min.has_value() ||
+        !max.has_value() || !argmin.has_value() || !argmax.has_value() ||
+        !variance.has_value() || !deviation.has_value()) {
+        return false;
+    }
+
+    const auto entry{[&matrix, axis](std::size_t result, std::size_t i) {
+        return axis == ppp::Axis::Row ? matrix.At(result, i).value()
+               : axis == ppp::Axis::Column
+                   ? matrix.At(i, result).value()
+                   : matrix.At(i / matrix.Width(), i % matrix.Width())
+                         .value();
+    }};
+    const auto close{[](double left, double right) {
+        return std::fabs(left - right) <= 1e-9 * (1.0 + std::fabs(right));
+    }};
+    for (std::size_t result{0}; result < results; result++) {
+        double total{0.0};
+        std::size_t lowest{0};
+        std::size_t highest{0};
+        for (std::size_t i{0}; i < count; i++) {
+            const double value{entry(result, i)};
+            total += value;
+            lowest = value < entry(result, lowest) ? i : lowest;
+            highest = value > entry(result, highest) ? i : highest;
+        }
+        double squares{0.0};
+        for (std::size_t i{0}; i < count; i++) {
+            const double offset{entry(result, i) - (total / count)};
+            squares += offset * offset;
+        }
+        if (!close(sum.Data()[result], total) ||
+            !close(mean.value().Data()[result], total / count) ||
+            min.value().Data()[result] != entry(result, lowest) ||
+            max.value().Data()[result] != entry(result, highest) ||
+            argmin.value().Data()[result] !=
+                static_cast<std::int64_t>(lowest) ||
+            argmax.value().Data()[result] !=
+                static_cast<std::int64_t>(highest) ||
+            !close(variance.value().Data()[result],
+                   squares / (count - 1)) ||
+            !close(deviation.value().Data()[result],
+                   std::sqrt(squares / count))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TestReductions(const std::unique_ptr<std::size_t>& passes,
+                    const std::unique_ptr<std::size_t>& fails) {
+    // Distinct values, so argmin and argmax do not depend on tie-breaking
+    const auto filled{[](std::size_t rows, std::size_t columns) {
+        ppp::Matrix<double> matrix{
+            ppp::Matrix<double>::New(rows, columns).value()};
+        for (std::size_t i{0}; i < matrix.Size(); i++) {
+            matrix.Data()[i] =
+                static_cast<double>((i * 7919) % 100'003) / 97.0 - 500.0;
+        }
+        return matrix;
+    }};
+    const ppp::Matrix<double> wide{filled(180, 230)};
+    const ppp::Matrix<double> line{filled(2, 40'001)};
+    const ppp::Matrix<double> empty{ppp::Matrix<double>::New(3, 0).value()};
+
+    bool matches{true};
+    // Enough entries to take the threaded paths, and lines too few and too
+    // long not to be split into segments
+    for (const std::size_t threads : {1, 4}) {
+        ppp::SetThreadCount(threads);
+        for (const ppp::Layout layout :
+             {ppp::Layout::RowMajor, ppp::Layout::ColumnMajor}) {
+            for (const ppp::Axis axis :
+                 {ppp::Axis::Row, ppp::Axis::Column, ppp::Axis::All}) {
+                matches = matches &&
+                          ReductionsMatch(wide.ToLayout(layout), axis) &&
+                          ReductionsMatch(line.ToLayout(layout), axis);
+            }
+        }
+    }
+    ppp::SetThreadCount(0);
+
+    const ppp::Matrix<int> integers{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{{3, -1, 3},
+                                                            {0, 5, -2}})
+            .value()};
+    if (matches && !empty.Mean(ppp::Axis::Row).has_value() &&
+        !empty.ArgMax(ppp::Axis::All).has_value() &&
+        empty.Sum(ppp::Axis::Column).Size() == 0 &&
+        empty.Sum(ppp::Axis::Row).Data()[2] == 0.0 &&
+        !wide.Variance(ppp::Axis::Column, 180).has_value() &&
+        integers.Sum(ppp::Axis::Column) ==
+            ppp::Column<int>{std::vector<int>{3, 4, 1}, "sum"} &&
+        integers.ArgMax(ppp::Axis::Row).value().Data()[0] == 0 &&
+        integers.ArgMin(ppp::Axis::All).value().Data()[0] == 5 &&
+        integers.Max(ppp::Axis::All).value().Data()[0] == 5) {
+        (*passes)++;
+        std::cout << "Test: TestReductions Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestReductions Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+// Units in the last place between got and want, counting from want
+template <class T>
+double UlpDistance(T got, T want) {
+    if (std::isnan(got) || std::isnan(want)) {
+        return std::isnan(got) && std::isnan(want) ? 0.0 : INFINITY;
+    } else if (std::isinf(got) || std::isinf(want)) {
+        return got == want ? 0.0 : INFINITY;
+    }
+    const T magnitude{std::fabs(want)};
+    const T ulp{std::nextafter(magnitude, std::numeric_limits<T>::infinity()) -
+                magnitude};
+    return static_cast<double>(std::fabs(got - want) / ulp);
+}
+
+// Fast within the documented bounds of the C library, Exact identical to it
+template <class T>
+bool MathMatches(const ppp::Matrix<T>& signed_entries,
+                 const ppp::Matrix<T>& positive_entries) {
+    using Function = ppp::Matrix<T> (ppp::Matrix<T>::*)(ppp::MathPrecision)
+        const;
+    const std::tuple<Function, T (*)(T), bool, double> functions[]{
+        {&ppp::Matrix<T>::Exp, [](T x) { return std::exp(x); }, false, 1.0},
+        {&ppp::Matrix<T>::Log, [](T x) { return std::log(x); }, true, 1.5},
+        {&ppp::Matrix<T>::Sqrt, [](T x) { return std::sqrt(x); }, true, 0.5},
+        {&ppp::Matrix<T>::Tanh, [](T x) { return std::tanh(x); }, false, 3.0},
+        {&ppp::Matrix<T>::Sigmoid,
+         [](T x) { return T{1} / (T{1} + std::exp(-x)); }, false, 3.0},
+    };
+
+    for (const auto& [function, reference, positive, bound] : functions) {
+        const ppp::Matrix<T>& input{positive ? positive_entries
+                                             : signed_entries};
+        const ppp::Matrix<T> fast{(input.*function)(ppp::MathPrecision::Fast)};
+        const ppp::Matrix<T> exact{
+            (input.*function)(ppp::MathPrecision::Exact)};
+        for (std::size_t i{0}; i < input.Size(); i++) {
+            const T want{reference(input.Data()[i])};
+            // Allow a unit for the rounding of the reference itself
+            if (UlpDistance(fast.Data()[i], want) > bound + 1.0 ||
+                UlpDistance(exact.Data()[i], want) > 0.0) {
+                return false;
+            }
+        }
+    }
+
+    const ppp::Matrix<T> squares{positive_entries.Pow(T{2.5})};
+    const ppp::Matrix<T> powers{
+        positive_entries.Pow(signed_entries.ToLayout(ppp::Layout::ColumnMajor))
+            .value()};
+    for (std::size_t i{0}; i < positive_entries.Size(); i++) {
+        const T base{positive_entries.Data()[i]};
+        if (UlpDistance(squares.Data()[i], std::pow(base, T{2.5})) > 2.5 ||
+            UlpDistance(powers.Data()[i],
+                        std::pow(base, signed_entries.Data()[i])) > 2.5) {
+            return false;
+        }
+    }
+    return squares.GetLayout() == positive_entries.GetLayout();
+}
+
+bool TestMath(const std::unique_ptr<std::size_t>& passes,
+              const std::unique_ptr<std::size_t>& fails) {
+    // Several MATH_BLOCKs with a ragged tail, so the threaded path runs too
+    const auto filled{[](std::size_t rows, std::size_t columns, double low,
+                         double high) {
+        ppp::Matrix<double> matrix{
+            ppp::Matrix<double>::New(rows, columns).value()};
+        for (std::size_t i{0}; i < matrix.Size(); i++) {
+            matrix.Data()[i] =
+                low + ((high - low) * static_cast<double>((i * 7919) % 9973) /
+                       9973.0);
+        }
+        return matrix;
+    }};
+    const auto narrowed{[](const ppp::Matrix<double>& matrix) {
+        ppp::Matrix<float> single{
+            ppp::Matrix<float>::New(matrix.Height(), matrix.Width()).value()};
+        std::transform(matrix.Data(), matrix.Data() + matrix.Size(),
+                       single.Data(),
+                       [](double value) { return static_cast<float>(value); });
+        return single;
+    }};
+    const ppp::Matrix<double> signed_entries{filled(70, 131, -30.0, 30.0)};
+    const ppp::Matrix<double> positive_entries{filled(70, 131, 1e-3, 50.0)};
+
+    bool matches{true};
+    for (const std::size_t threads : {1, 4}) {
+        ppp::SetThreadCount(threads);
+        matches = matches &&
+                  MathMatches(signed_entries, positive_entries) &&
+                  MathMatches(narrowed(signed_entries),
+                              narrowed(positive_entries));
+    }
+    ppp::SetThreadCount(0);
+
+    const ppp::Matrix<double> special{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {-1.0, 0.0, 1000.0, -1000.0, NAN}})
+            .value()};
+    const ppp::Matrix<double> logs{special.Log()};
+    const ppp::Matrix<double> exps{special.Exp()};
+    const ppp::Matrix<double> bases{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {-2.0, 0.0, 1.0, INFINITY, 4.0}})
+            .value()};
+    const ppp::Matrix<double> powers{bases.Pow(3.0)};
+
+    const ppp::Matrix<std::complex<double>> complex{
+        ppp::Matrix<std::complex<double>>::New(
+            std::vector<std::vector<std::complex<double>>>{{{1.0, 2.0},
+                                                            {-0.5, 0.25}}})
+            .value()};
+    const ppp::Column<double> column{std::vector<double>{0.0, 1.0, 4.0}, "x"};
+    const ppp::Column<double> exponents{std::vector<double>{1.0, 2.0}, "y"};
+
+    if (matches && std::isnan(logs.Data()[0]) &&
+        logs.Data()[1] == -INFINITY && exps.Data()[2] == INFINITY &&
+        exps.Data()[3] == 0.0 && std::isnan(exps.Data()[4]) &&
+        powers.Data()[0] == -8.0 && powers.Data()[1] == 0.0 &&
+        powers.Data()[2] == 1.0 && powers.Data()[3] == INFINITY &&
+        powers.Data()[4] == 64.0 &&
+        !special.Pow(signed_entries).has_value() &&
+        complex.Exp().Data()[1] == std::exp(std::complex<double>{-0.5, 0.25}) &&
+        column.Sqrt() ==
+            ppp::Column<double>{std::vector<double>{0.0, 1.0, 2.0},
+                                "sqrt(x)"} &&
+        column.Exp().Data()[0] == 1.0 &&
+        !column.Pow(exponents).has_value()) {
+        (*passes)++;
+        std::cout << "Test: TestMath Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestMath Failed..." << std::endl << std::endl;
+        return false;
+    }
+}
+
+// Largest entry of |U * diag(sigma) * Vt - expected|
+double ReconstructionError(const ppp::Matrix<double>& u,
+                           const std::vector<double>& sigma,
+                           const ppp::Matrix<double>& vt,
+                           const ppp::Matrix<double>& expected) {
+    double error{0.0};
+    for (std::size_t row{0}; row < expected.Height(); row++) {
+        for (std::size_t column{0}; column < expected.Width(); column++) {
+            double entry{0.0};
+            for (std::size_t rank{0}; rank < sigma.size(); rank++) {
+                entry += u.At(row, rank).value() * sigma[rank] *
+                         vt.At(rank, column).value();
+            }
+            error = std::max(
+                error, std::fabs(entry - expected.At(row, column).value()));
+        }
+    }
+    return error;
+}
+
+bool TestRandomizedSVD(const std::unique_ptr<std::size_t>& passes,
+                       const std::unique_ptr<std::size_t>& fails) {
+    // Exactly rank 6, so a sketch of 16 columns captures the whole range
+    constexpr std::size_t m{1000};
+    constexpr std::size_t n{90};
+    constexpr std::size_t rank{6};
+    ppp::Matrix<double> left{ppp::Matrix<double>::New(m, rank).value()};
+    ppp::Matrix<double> right{ppp::Matrix<double>::New(rank, n).value()};
+    for (std::size_t i{0}; i < left.Size(); i++) {
+        left.Data()[i] = ppp::detail::RandomNormal<double>(1, i);
+    }
+    for (std::size_t i{0}; i < right.Size(); i++) {
+        right.Data()[i] = ppp::detail::RandomNormal<double>(2, i) *
+                          std::pow(0.5, static_cast<double>(i / n));
+    }
+    const ppp::Matrix<double> low_rank{(left * right).value()};
+
+    const auto svd{ppp::TruncatedSVD<double>::New(low_rank, rank)};
+    bool exact{svd.has_value() && svd->Rank() == rank &&
+               ReconstructionError(svd->U(), svd->SingularValues(),
+                                   svd->Vt(), low_rank) < 1e-9};
+    if (exact) {
+        const ppp::Matrix<double> gram{
+            (svd->U().Transposed() * svd->U()).value()};
+        for (std::size_t i{0}; i < rank; i++) {
+            for (std::size_t j{0}; j < rank; j++) {
+                exact = exact && std::fabs(gram.At(i, j).value() -
+                                           (i == j ? 1.0 : 0.0)) < 1e-12;
+            }
+            exact = exact && (i == 0 || svd->SingularValues()[i] <=
+                                            svd->SingularValues()[i - 1]);
+        }
+    }
+
+    // The same from one pass over ragged row blocks
+    auto sketch{ppp::SVDSketch<double>::New(n, rank)};
+    bool streamed{sketch.has_value()};
+    for (std::size_t row{0}; streamed && row < m; row += 97) {
+        const std::size_t rows{std::min<std::size_t>(97, m - row)};
+        streamed = sketch->Update(
+            ppp::Matrix<double>::New(
+                low_rank.View().Block(row, 0, rows, n).value())
+                .value());
+    }
+    const auto streamed_svd{
+        streamed ? ppp::TruncatedSVD<double>::New(sketch.value())
+                 : std::nullopt};
+    streamed = streamed && streamed_svd.has_value() &&
+               sketch->Height() == m &&
+               ReconstructionError(streamed_svd->U(),
+                                   streamed_svd->SingularValues(),
+                                   streamed_svd->Vt(), low_rank) < 1e-8;
+    for (std::size_t i{0}; streamed && i < rank; i++) {
+        streamed = std::fabs(streamed_svd->SingularValues()[i] -
+                             svd->SingularValues()[i]) <
+                   1e-9 * svd->SingularValues()[0];
+    }
+
+    // Full rank with a decaying spectrum: compare against a dense Jacobi SVD
+    ppp::Matrix<double> decaying{ppp::Matrix<double>::New(m, n).value()};
+    for (std::size_t i{0}; i < decaying.Size(); i++) {
+        decaying.Data()[i] = ppp::detail::RandomNormal<double>(3, i) *
+                             std::pow(0.8, static_cast<double>(i % n));
+    }
+    std::vector<double> columns(m * n);
+    std::vector<double> rotations(n * n);
+    for (std::size_t row{0}; row < m; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            columns[(column * m) + row] = decaying.At(row, column).value();
+        }
+    }
+    ppp::detail::JacobiSvd(m, n, columns.data(), rotations.data());
+    std::vector<double> reference(n);
+    for (std::size_t column{0}; column < n; column++) {
+        const auto first{columns.begin() + (column * m)};
+        reference[column] =
+            std::sqrt(std::inner_product(first, first + m, first, 0.0));
+    }
+    std::sort(reference.begin(), reference.end(), std::greater<>{});
+    const auto approximate{ppp::TruncatedSVD<double>::New(
+        decaying, 4, ppp::SVDOptions{.power_iterations = 2})};
+    bool close{approximate.has_value()};
+    for (std::size_t i{0}; close && i < 4; i++) {
+        close = std::fabs(approximate->SingularValues()[i] - reference[i]) <
+                1e-3 * reference[i];
+    }
+
+    // PCA of shifted low rank data, in memory and streamed
+    ppp::Matrix<double> data{low_rank};
+    for (std::size_t row{0}; row < m; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            data.Data()[(row * n) + column] += static_cast<double>(column);
+        }
+    }
+    const auto pca{ppp::PCA<double>::New(data, rank)};
+    auto data_sketch{ppp::SVDSketch<double>::New(n, rank)};
+    bool principal{pca.has_value() && data_sketch.has_value() &&
+                   data_sketch->Update(data)};
+    const auto streamed_pca{principal ? ppp::PCA<double>::New(*data_sketch)
+                                      : std::nullopt};
+    principal = principal && streamed_pca.has_value();
+    if (principal) {
+        const std::vector<double>& ratio{pca->ExplainedVarianceRatio()};
+        principal = std::fabs(std::accumulate(ratio.begin(), ratio.end(),
+                                              0.0) -
+                              1.0) < 1e-9 &&
+                    std::fabs(pca->Mean()[5] - 5.0 -
+                              low_rank.Mean(ppp::Axis::Column)
+                                  .value()
+                                  .Data()[5]) < 1e-9;
+        for (std::size_t i{0}; i < rank; i++) {
+            principal = principal &&
+                        std::fabs(pca->ExplainedVariance()[i] -
+                                  streamed_pca->ExplainedVariance()[i]) <
+                            1e-9 * pca->ExplainedVariance()[0];
+        }
+
+        // A mean far above the spread must not cancel the variance away
+        ppp::Matrix<double> shifted{data};
+        for (std::size_t i{0}; i < m * n; i++) {
+            shifted.Data()[i] += 1e8;
+        }
+        auto shifted_sketch{ppp::SVDSketch<double>::New(n, rank)};
+        principal = principal && shifted_sketch.has_value();
+        for (std::size_t row{0}; principal && row < m; row += 97) {
+            const std::size_t rows{std::min<std::size_t>(97, m - row)};
+            principal = shifted_sketch->Update(
+                ppp::Matrix<double>::New(
+                    shifted.View().Block(row, 0, rows, n).value())
+                    .value());
+        }
+        const auto shifted_pca{
+            principal ? ppp::PCA<double>::New(*shifted_sketch)
+                      : std::nullopt};
+        principal = principal && shifted_pca.has_value();
+        for (std::size_t i{0}; principal && i < rank; i++) {
+            principal = std::fabs(pca->ExplainedVarianceRatio()[i] -
+                                  shifted_pca->ExplainedVarianceRatio()[i]) <
+                        1e-6;
+        }
+
+        // scores * axes + mean gives the data back
+        const ppp::Matrix<double> scores{pca->Transform(data).value()};
+        const std::vector<double> ones(rank, 1.0);
+        ppp::Matrix<double> centered{data};
+        for (std::size_t row{0}; row < m; row++) {
+            for (std::size_t column{0}; column < n; column++) {
+                centered.Data()[(row * n) + column] -= pca->Mean()[column];
+            }
+        }
+        principal = principal && scores.Height() == m &&
+                    scores.Width() == rank &&
+                    ReconstructionError(scores, ones, pca->Axes(),
+                                        centered) < 1e-9;
+    }
+
+    const bool rejected{
+        !ppp::TruncatedSVD<double>::New(low_rank, 0).has_value() &&
+        !ppp::TruncatedSVD<double>::New(low_rank, n + 1).has_value() &&
+        !ppp::SVDSketch<double>::New(n, n + 1).has_value() &&
+        !ppp::SVDSketch<double>::New(n, rank)->Update(left) &&
+        !pca->Transform(left).has_value()};
+
+    if (exact && streamed && close && principal && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestRandomizedSVD Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestRandomizedSVD Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+// Lines of the tuning cache at path that start with prefix
+std::size_t CacheLines(const std::filesystem::path& path,
+                       std::string_view prefix) {
+    std::ifstream file{path};
+    std::size_t count{0};
+    std::string line{};
+    while (std::getline(file, line)) {
+        count += line.starts_with(prefix) ? 1 : 0;
+    }
+    return count;
+}
+
+bool TestTuning(const std::unique_ptr<std::size_t>& passes,
+                const std::unique_ptr<std::size_t>& fails) {
+    const std::filesystem::path directory{
+        std::filesystem::temp_directory_path() / "ppp_tuning_test"};
+    const std::filesystem::path cache{directory / "tuning"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    {
+        std::ofstream other{cache};
+        other << "Other CPU;L1d=1;L2=2;L3=3;avx2\tgemm-float\t96 256 4096\n";
+    }
+
+    ppp::Matrix<double> a{ppp::Matrix<double>::New(150, 410).value()};
+    ppp::Matrix<double> b{ppp::Matrix<double>::New(410, 170).value()};
+    for (std::size_t i{0}; i < a.Size(); i++) {
+        a.Data()[i] = static_cast<double>(i % 13) - 6.0;
+    }
+    for (std::size_t i{0}; i < b.Size(); i++) {
+        b.Data()[i] = static_cast<double>(i % 7) - 3.0;
+    }
+    const ppp::Matrix<double> expected{(a * b).value()};
+    const ppp::Matrix<double> expected_transpose{a.Transpose()};
+    const ppp::Column<double> expected_sums{a.Sum(ppp::Axis::Column)};
+
+    // Nothing cached for this CPU yet, so the defaults stay in place
+    const bool empty{!ppp::SetTuningCachePath(cache) &&
+                     ppp::GetTuningCachePath() == cache &&
+                     ppp::detail::TransposeTileSize() ==
+                         ppp::detail::TRANSPOSE_TILE};
+
+    // Tune keeps the other CPU's line and adds one per kernel for this one
+    const std::string signature{ppp::detail::CpuSignature() + "\t"};
+    const bool tuned{ppp::Tune() && CacheLines(cache, signature) == 5 &&
+                     CacheLines(cache, "Other CPU") == 1};
+    const ppp::detail::GemmBlocking<double> blocking{
+        ppp::detail::GetGemmBlocking<double>()};
+    const std::size_t tile{ppp::detail::TransposeTileSize()};
+    const std::size_t chunk{ppp::detail::ReduceChunk()};
+    const std::size_t taps{ppp::detail::DirectConvolutionTaps()};
+
+    // A later process starts from nothing and reads the same sizes back
+    ppp::ResetTuning();
+    const ppp::detail::GemmBlocking<double> fallback{
+        ppp::detail::GetGemmBlocking<double>()};
+    const ppp::detail::GemmBlocking<double> fallback_expected{
+        ppp::detail::DefaultGemmBlocking(
+            ppp::detail::SelectGemmKernel<double>())};
+    const bool reset{fallback.mc == fallback_expected.mc &&
+                     fallback.kc == fallback_expected.kc &&
+                     fallback.nc == fallback_expected.nc};
+    const bool loaded{ppp::SetTuningCachePath(cache) &&
+                      ppp::detail::GetGemmBlocking<double>().mc ==
+                          blocking.mc &&
+                      ppp::detail::GetGemmBlocking<double>().kc ==
+                          blocking.kc &&
+                      ppp::detail::TransposeTileSize() == tile &&
+                      ppp::detail::ReduceChunk() == chunk &&
+                      ppp::detail::DirectConvolutionTaps() == taps};
+
+    // Tuned sizes only change the blocking, not the results
+    const ppp::Column<double> sums{a.Sum(ppp::Axis::Column)};
+    const bool same{(a * b).value() == expected &&
+                    a.Transpose() == expected_transpose &&
+                    sums.Size() == expected_sums.Size()};
+    bool sums_close{same};
+    for (std::size_t i{0}; sums_close && i < sums.Size(); i++) {
+        sums_close =
+            std::abs(sums.Data()[i] - expected_sums.Data()[i]) <= 1e-9;
+    }
+
+    // With autotuning on, the first transpose tunes just its own tile
+    const std::filesystem::path fresh{directory / "fresh"};
+    ppp::SetAutotune(true);
+    ppp::SetTuningCachePath(fresh);
+    const bool on_first_use{a.Transpose() == expected_transpose &&
+                            CacheLines(fresh, signature) == 1 &&
+                            CacheLines(fresh, signature + "transpose") == 1};
+    ppp::SetAutotune(false);
+
+    ppp::SetTuningCachePath({});
+    ppp::ResetTuning();
+    std::filesystem::remove_all(directory);
+
+    if (empty && tuned && reset && loaded && sums_close && on_first_use) {
+        (*passes)++;
+        std::cout << "Test: TestTuning Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestTuning Failed..." << std::endl << std::endl;
+        return false;
+    }
+}
+
+
+// sum((lhs - zero point) * rhs) straight from the quantized entries
+template <class I>
+std::vector<std::int32_t> NaiveIntegerProduct(
+    const ppp::QuantizedMatrix<I>& lhs,
+    const ppp::QuantizedMatrix<std::int8_t>& rhs) {
+    const std::size_t k{lhs.Width()};
+    const std::size_t n{rhs.Width()};
+    std::vector<std::int32_t> product(lhs.Height() * n, 0);
+    for (std::size_t row{0}; row < lhs.Height(); row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            for (std::size_t depth{0}; depth < k; depth++) {
+                product[(row * n) + column] +=
+                    (static_cast<std::int32_t>(lhs.Data()[(row * k) + depth]) -
+                     lhs.ZeroPoint(row, depth)) *
+                    rhs.Data()[(depth * n) + column];
+            }
+        }
+    }
+    return product;
+}
+
+template <class I>
+bool QuantizedKernelsAgree(const ppp::QuantizedMatrix<I>& lhs,
+                           const ppp::QuantizedMatrix<std::int8_t>& rhs) {
+    const std::vector<std::int32_t> expected{NaiveIntegerProduct(lhs, rhs)};
+    const std::size_t n{rhs.Width()};
+    bool agree{true};
+    const auto check = [&](const ppp::detail::Int8Kernel& kernel) {
+        std::vector<std::int32_t> product(expected.size(), 0);
+        ppp::detail::QuantizedProduct(
+            lhs, rhs, kernel,
+            [&](std::size_t row, std::size_t column, std::size_t count,
+                const std::int32_t* values) {
+                std::copy_n(values, count,
+                            product.data() + (row * n) + column);
+            });
+        agree = agree && product == expected;
+    };
+    check(ppp::detail::ScalarInt8());
+#ifdef PPP_SIMD_X86
+    if (ppp::detail::HasAvx2()) {
+        check({4, 8, &ppp::detail::Avx2Int8Kernel});
+    }
+    if (ppp::detail::HasAvxVnni()) {
+        check({6, 16, &ppp::detail::AvxVnniInt8Kernel});
+    }
+    if (ppp::detail::HasAvx512Vnni()) {
+        check({8, 32, &ppp::detail::Avx512VnniInt8Kernel});
+    }
+#endif
+    const auto product{ppp::IntegerProduct(lhs, rhs)};
+    return agree && product.has_value() &&
+           std::equal(expected.begin(), expected.end(),
+                      product.value().Data());
+}
+
+bool TestQuantized(const std::unique_ptr<std::size_t>& passes,
+                   const std::unique_ptr<std::size_t>& fails) {
+    // Depth and width off every kernel's multiples, so all edges run
+    constexpr std::size_t m{103};
+    constexpr std::size_t k{203};
+    constexpr std::size_t n{45};
+    ppp::Matrix<float> a{ppp::Matrix<float>::New(m, k).value()};
+    ppp::Matrix<float> b{ppp::Matrix<float>::New(k, n).value()};
+    for (std::size_t i{0}; i < a.Size(); i++) {
+        a.Data()[i] = ppp::detail::RandomNormal<float>(4, i);
+    }
+    for (std::size_t i{0}; i < b.Size(); i++) {
+        b.Data()[i] = ppp::detail::RandomNormal<float>(5, i);
+    }
+    // Non-negative, like activations after a ReLU
+    ppp::Matrix<float> positive{a};
+    for (std::size_t i{0}; i < positive.Size(); i++) {
+        positive.Data()[i] = std::fabs(positive.Data()[i]) + 0.5f;
+    }
+
+    const auto signed_a{ppp::QuantizedMatrix<std::int8_t>::New(a)};
+    const auto unsigned_a{ppp::QuantizedMatrix<std::uint8_t>::New(a)};
+    const auto unsigned_positive{
+        ppp::QuantizedMatrix<std::uint8_t>::New(positive, ppp::Axis::All)};
+    const auto quantized_b{
+        ppp::QuantizedMatrix<std::int8_t>::New(b, ppp::Axis::Column)};
+    const bool exact{signed_a.has_value() && unsigned_a.has_value() &&
+                     unsigned_positive.has_value() &&
+                     quantized_b.has_value() &&
+                     QuantizedKernelsAgree(*signed_a, *quantized_b) &&
+                     QuantizedKernelsAgree(*unsigned_a, *quantized_b) &&
+                     QuantizedKernelsAgree(*unsigned_positive, *quantized_b)};
+
+    // Entries come back within half a step
+    bool round_trip{exact};
+    if (round_trip) {
+        const ppp::Matrix<float> restored{unsigned_a->Dequantize()};
+        for (std::size_t row{0}; row < m; row++) {
+            for (std::size_t column{0}; column < k; column++) {
+                round_trip = round_trip &&
+                             std::fabs(restored.At(row, column).value() -
+                                       a.At(row, column).value()) <=
+                                 0.501f * unsigned_a->Scale(row, column);
+            }
+        }
+        round_trip = round_trip && unsigned_positive->ZeroPoints()[0] == 0;
+    }
+
+    // The scaled product tracks the float one
+    bool close{exact};
+    if (close) {
+        const ppp::Matrix<float> expected{(a * b).value()};
+        const auto approximate{*signed_a * *quantized_b};
+        const auto affine{*unsigned_a * *quantized_b};
+        close = approximate.has_value() && affine.has_value();
+        for (std::size_t row{0}; close && row < m; row++) {
+            for (std::size_t column{0}; column < n; column++) {
+                const float entry{expected.At(row, column).value()};
+                close = close &&
+                        std::fabs(approximate->At(row, column).value() -
+                                  entry) < 1.0f &&
+                        std::fabs(affine->At(row, column).value() - entry) <
+                            1.0f;
+            }
+        }
+    }
+
+    // Scales that vary along the shared dimension cannot be factored out
+    ppp::Matrix<float> bad{a};
+    bad.Data()[7] = std::numeric_limits<float>::infinity();
+    const bool rejected{
+        exact &&
+        !(ppp::QuantizedMatrix<std::int8_t>::New(a, ppp::Axis::Column).value() *
+          *quantized_b)
+             .has_value() &&
+        !(*signed_a * ppp::QuantizedMatrix<std::int8_t>::New(b).value())
+             .has_value() &&
+        !ppp::IntegerProduct(*quantized_b, *quantized_b).has_value() &&
+        !ppp::QuantizedMatrix<std::int8_t>::New(bad).has_value()};
+
+    if (exact && round_trip && close && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestQuantized Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestQuantized Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+
+bool TestSplitComplex(const std::unique_ptr<std::size_t>& passes,
+                      const std::unique_ptr<std::size_t>& fails) {
+    using Complex = std::complex<float>;
+    // Odd sizes so the vector remainders run
+    constexpr std::size_t size{1001};
+    const auto random_entry = [](std::uint64_t seed, std::size_t i) {
+        return Complex{ppp::detail::RandomNormal<float>(seed, 2 * i),
+                       ppp::detail::RandomNormal<float>(seed, (2 * i) + 1)};
+    };
+    std::vector<Complex> left(size);
+    std::vector<Complex> right(size);
+    for (std::size_t i{0}; i < size; i++) {
+        left[i] = random_entry(1, i);
+        right[i] = random_entry(2, i);
+    }
+    const ppp::SplitComplexColumn<float> a{
+        ppp::SplitComplexColumn<float>::New(ppp::Column<Complex>{left, "a"})};
+    const ppp::SplitComplexColumn<float> b{
+        ppp::SplitComplexColumn<float>::New(ppp::Column<Complex>{right, ""})};
+
+    const auto sum{a + b};
+    const auto difference{a - b};
+    const auto product{ppp::Multiply(a, b)};
+    ppp::SplitComplexColumn<float> accumulated{a};
+    ppp::SplitComplexColumn<float> aliased{a};
+    bool elementwise{sum.has_value() && difference.has_value() &&
+                     product.has_value() &&
+                     accumulated.MultiplyAccumulate(a, b).has_value() &&
+                     aliased.MultiplyAccumulate(aliased, b).has_value()};
+    Complex dot{0.0f, 0.0f};
+    for (std::size_t i{0}; elementwise && i < size; i++) {
+        const Complex expected{left[i] * right[i]};
+        elementwise = std::abs(sum->At(i).value() - (left[i] + right[i])) <
+                          1e-6f &&
+                      std::abs(difference->At(i).value() -
+                               (left[i] - right[i])) < 1e-6f &&
+                      std::abs(product->At(i).value() - expected) < 1e-5f &&
+                      std::abs(accumulated.At(i).value() -
+                               (left[i] + expected)) < 1e-5f &&
+                      std::abs(aliased.At(i).value() -
+                               (left[i] + expected)) < 1e-5f;
+        dot += std::conj(left[i]) * right[i];
+    }
+    const auto split_dot{a.ConjugateDot(b)};
+    const ppp::Column<Complex> round_trip{a.Interleaved()};
+    elementwise = elementwise && split_dot.has_value() &&
+                  std::abs(split_dot.value() - dot) < 1e-3f &&
+                  std::equal(left.begin(), left.end(), round_trip.Data()) &&
+                  !a.At(size).has_value();
+
+    // Matrix products against the interleaved ones
+    constexpr std::size_t m{67};
+    constexpr std::size_t k{131};
+    constexpr std::size_t n{45};
+    ppp::Matrix<Complex> lhs{ppp::Matrix<Complex>::New(m, k).value()};
+    ppp::Matrix<Complex> rhs{ppp::Matrix<Complex>::New(k, n).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = random_entry(3, i);
+    }
+    for (std::size_t i{0}; i < rhs.Size(); i++) {
+        rhs.Data()[i] = random_entry(4, i);
+    }
+    const ppp::Matrix<Complex> expected{(lhs * rhs).value()};
+    const auto split_lhs{ppp::SplitComplexMatrix<float>::New(lhs)};
+    const auto split_rhs{ppp::SplitComplexMatrix<float>::New(rhs)};
+    const auto split_product{split_lhs * split_rhs};
+    ppp::SplitComplexMatrix<float> twice{split_product.value()};
+    bool products{split_product.has_value() &&
+                  twice.MultiplyAccumulate(split_lhs, split_rhs).has_value()};
+    for (std::size_t row{0}; products && row < m; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            const Complex entry{expected.At(row, column).value()};
+            products =
+                products &&
+                std::abs(split_product->At(row, column).value() - entry) <
+                    1e-3f &&
+                std::abs(twice.At(row, column).value() - (2.0f * entry)) <
+                    1e-3f;
+        }
+    }
+    // this as both operands, square += square * square
+    ppp::Matrix<Complex> square{ppp::Matrix<Complex>::New(n, n).value()};
+    for (std::size_t i{0}; i < square.Size(); i++) {
+        square.Data()[i] = random_entry(6, i);
+    }
+    const ppp::Matrix<Complex> squared{(square * square).value()};
+    auto split_square{ppp::SplitComplexMatrix<float>::New(square)};
+    products =
+        products &&
+        split_square.MultiplyAccumulate(split_square, split_square)
+            .has_value();
+    for (std::size_t row{0}; products && row < n; row++) {
+        for (std::size_t column{0}; column < n; column++) {
+            products = products &&
+                       std::abs(split_square.At(row, column).value() -
+                                (square.At(row, column).value() +
+                                 squared.At(row, column).value())) < 1e-3f;
+        }
+    }
+    // A transposed view goes through the strides
+    const ppp::Matrix<Complex> transposed{
+        ppp::Matrix<Complex>::New(rhs.Transposed()).value()};
+    const ppp::SplitComplexMatrix<float> split_transposed{
+        ppp::SplitComplexMatrix<float>::New(rhs.Transposed())};
+    products = products &&
+               split_transposed.Interleaved() == transposed &&
+               ppp::SplitComplexMatrix<float>::New(lhs).Interleaved() == lhs;
+
+    std::vector<Complex> vector(k);
+    for (std::size_t i{0}; i < k; i++) {
+        vector[i] = random_entry(5, i);
+    }
+    const auto matrix_vector{
+        split_lhs * ppp::SplitComplexColumn<float>::New(
+                        ppp::Column<Complex>{vector, ""})};
+    products = products && matrix_vector.has_value();
+    for (std::size_t row{0}; products && row < m; row++) {
+        Complex entry{0.0f, 0.0f};
+        for (std::size_t i{0}; i < k; i++) {
+            entry += lhs.At(row, i).value() * vector[i];
+        }
+        products = products &&
+                   std::abs(matrix_vector->At(row).value() - entry) < 1e-3f;
+    }
+
+    const bool rejected{!(a + ppp::SplitComplexColumn<float>::New(3))
+                             .has_value() &&
+                        !a.ConjugateDot(
+                              ppp::SplitComplexColumn<float>::New(3))
+                             .has_value() &&
+                        !(split_rhs * split_rhs).has_value() &&
+                        !ppp::Multiply(split_lhs, split_rhs).has_value() &&
+                        !(split_rhs * a).has_value()};
+
+    if (elementwise && products && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestSplitComplex Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestSplitComplex Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+
+// Correlation straight from the definition, with the offsets Padding gives
+ppp::Matrix<double> NaiveCorrelate(const ppp::Matrix<double>& input,
+                                   const ppp::Matrix<double>& kernel,
+                                   ppp::Padding padding, std::size_t stride) {
+    const auto extent = [padding, stride](std::size_t size,
+                                          std::size_t taps) {
+        if (padding == ppp::Padding::Valid) {
+            return std::pair<std::size_t, std::size_t>{
+                ((size - taps) / stride) + 1, 0};
+        } else if (padding == ppp::Padding::Full) {
+            return std::pair<std::size_t, std::size_t>{
+                ((size + taps - 2) / stride) + 1, taps - 1};
+        }
+        const std::size_t outputs{(size + stride - 1) / stride};
+        const std::size_t reach{((outputs - 1) * stride) + taps};
+        return std::pair<std::size_t, std::size_t>{
+            outputs, reach > size ? (reach - size) / 2 : 0};
+    };
+    const auto [rows, top] = extent(input.Height(), kernel.Height());
+    const auto [columns, left] = extent(input.Width(), kernel.Width());
+    ppp::Matrix<double> output{ppp::Matrix<double>::New(rows, columns).value()};
+    for (std::size_t i{0}; i < rows; i++) {
+        for (std::size_t j{0}; j < columns; j++) {
+            double sum{0.0};
+            for (std::size_t u{0}; u < kernel.Height(); u++) {
+                for (std::size_t v{0}; v < kernel.Width(); v++) {
+                    const std::ptrdiff_t row{
+                        static_cast<std::ptrdiff_t>((i * stride) + u) -
+                        static_cast<std::ptrdiff_t>(top)};
+                    const std::ptrdiff_t column{
+                        static_cast<std::ptrdiff_t>((j * stride) + v) -
+                        static_cast<std::ptrdiff_t>(left)};
+                    if (row >= 0 && column >= 0 &&
+                        row < static_cast<std::ptrdiff_t>(input.Height()) &&
+                        column < static_cast<std::ptrdiff_t>(input.Width())) {
+                        sum += kernel.At(u, v).value() *
+                               input
+                                   .At(static_cast<std::size_t>(row),
+                                       static_cast<std::size_t>(column))
+                                   .value();
+                    }
+                }
+            }
+            output.Data()[(i * columns) + j] = sum;
+        }
+    }
+    return output;
+}
+
+bool TestConvolution(const std::unique_ptr<std::size_t>& passes,
+                     const std::unique_ptr<std::size_t>& fails) {
+    // A 3x3 box sum over a 4x4 ramp
+    const ppp::Matrix<int> ramp{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{
+                                  {1, 2, 3, 4},
+                                  {5, 6, 7, 8},
+                                  {9, 10, 11, 12},
+                                  {13, 14, 15, 16}})
+            .value()};
+    const ppp::Matrix<int> box{
+        ppp::Matrix<int>::New(std::vector<std::vector<int>>{
+                                  {1, 1, 1}, {1, 1, 1}, {1, 1, 1}})
+            .value()};
+    const auto boxed{ramp.Correlate2D(box)};
+    const auto same{ramp.Correlate2D(box, ppp::Padding::Same)};
+    bool known{boxed.has_value() && boxed->Height() == 2 &&
+               boxed->Width() == 2 && boxed->At(0, 0).value() == 54 &&
+               boxed->At(1, 1).value() == 99 && same.has_value() &&
+               same->Height() == 4 && same->At(0, 0).value() == 14 &&
+               same->At(3, 3).value() == 54};
+
+    // Every padding and a few strides, kernels narrower and wider than the
+    // direct path unrolls, and the strides of a column-major input
+    ppp::Matrix<double> input{ppp::Matrix<double>::New(61, 83).value()};
+    for (std::size_t i{0}; i < input.Size(); i++) {
+        input.Data()[i] = ppp::detail::RandomNormal<double>(6, i);
+    }
+    const ppp::Matrix<double> column_major{
+        input.ToLayout(ppp::Layout::ColumnMajor)};
+    bool matches{true};
+    const std::vector<std::pair<std::size_t, std::size_t>> sizes{
+        {1, 1}, {3, 3}, {5, 4}, {2, 7}, {12, 3}, {9, 9}, {4, 21}, {17, 13}};
+    std::uint64_t seed{7};
+    for (const auto &[height, width] : sizes) {
+        ppp::Matrix<double> kernel{
+            ppp::Matrix<double>::New(height, width).value()};
+        for (std::size_t i{0}; i < kernel.Size(); i++) {
+            kernel.Data()[i] = ppp::detail::RandomNormal<double>(seed, i);
+        }
+        seed++;
+        for (const ppp::Padding padding :
+             {ppp::Padding::Valid, ppp::Padding::Same, ppp::Padding::Full}) {
+            for (const std::size_t stride : {1, 2, 3}) {
+                const auto result{input.Correlate2D(kernel, padding, stride)};
+                const ppp::Matrix<double> expected{
+                    NaiveCorrelate(input, kernel, padding, stride)};
+                matches = matches && result.has_value() &&
+                          result->Height() == expected.Height() &&
+                          result->Width() == expected.Width();
+                // And through the im2col path, whatever the crossover
+                std::vector<double> unrolled(expected.Size());
+                ppp::detail::Correlate2D<double>(
+                    {input.Data(), input.Width(), 1}, input.Height(),
+                    input.Width(), kernel.Data(), height, width,
+                    ppp::detail::FilterShapeFor(input.Height(), input.Width(),
+                                                height, width, padding, stride)
+                        .value(),
+                    stride, unrolled.data(), 2, 0);
+                for (std::size_t i{0}; matches && i < expected.Size(); i++) {
+                    matches = std::fabs(result->Data()[i] -
+                                        expected.Data()[i]) < 1e-10 &&
+                              std::fabs(unrolled[i] - expected.Data()[i]) <
+                                  1e-10;
+                }
+            }
+        }
+        const auto across{
+            column_major.Correlate2D(kernel, ppp::Padding::Same, 2)};
+        const ppp::Matrix<double> expected{
+            NaiveCorrelate(input, kernel, ppp::Padding::Same, 2)};
+        matches = matches && across.has_value();
+        for (std::size_t i{0}; matches && i < expected.Size(); i++) {
+            matches = std::fabs(across->Data()[i] - expected.Data()[i]) <
+                      1e-10;
+        }
+
+        // Convolution is correlation with the kernel turned around
+        ppp::Matrix<double> turned{kernel};
+        for (std::size_t i{0}; i < kernel.Size(); i++) {
+            turned.Data()[i] = kernel.Data()[kernel.Size() - 1 - i];
+        }
+        const auto convolved{input.Convolve2D(kernel, ppp::Padding::Full)};
+        const auto correlated{input.Correlate2D(turned, ppp::Padding::Full)};
+        matches = matches && convolved.has_value() &&
+                  correlated.has_value() &&
+                  convolved.value() == correlated.value();
+    }
+
+    const ppp::Matrix<double> tall{ppp::Matrix<double>::New(90, 2).value()};
+    const bool rejected{
+        !input.Correlate2D(tall).has_value() &&
+        input.Correlate2D(tall, ppp::Padding::Same).has_value() &&
+        !input.Correlate2D(tall, ppp::Padding::Same, 0).has_value() &&
+        !input.Correlate2D(ppp::Matrix<double>::New().value()).has_value()};
+
+    if (known && matches && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestConvolution Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestConvolution Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestTriangular(const std::unique_ptr<std::size_t>& passes,
+                    const std::unique_ptr<std::size_t>& fails) {
+    // Large enough for several diagonal blocks; the triangle that is not
+    // selected holds noise that must never be read
+    constexpr std::size_t n{300};
+    ppp::Matrix<double> a{ppp::Matrix<double>::New(n, n).value()};
+    for (std::size_t i{0}; i < a.Size(); i++) {
+        a.Data()[i] = ppp::detail::RandomNormal<double>(8, i) / n;
+    }
+    for (std::size_t i{0}; i < n; i++) {
+        a.Data()[(i * n) + i] += 2.0;
+    }
+    ppp::Matrix<double> rhs{ppp::Matrix<double>::New(n, 37).value()};
+    for (std::size_t i{0}; i < rhs.Size(); i++) {
+        rhs.Data()[i] = ppp::detail::RandomNormal<double>(9, i);
+    }
+    const ppp::Matrix<double> column_major{
+        a.ToLayout(ppp::Layout::ColumnMajor)};
+    std::vector<double> single_values(n);
+    for (std::size_t row{0}; row < n; row++) {
+        single_values[row] = rhs.At(row, 0).value();
+    }
+    const ppp::Column<double> single{single_values, "b"};
+    const std::vector<const ppp::Matrix<double>*> layouts{&a, &column_major};
+
+    bool matches{true};
+    const auto close{[](const double* lhs, const double* rhs,
+                        std::size_t size) {
+        for (std::size_t i{0}; i < size; i++) {
+            if (std::fabs(lhs[i] - rhs[i]) > 1e-9) {
+                return false;
+            }
+        }
+        return true;
+    }};
+    for (const ppp::Triangle triangle :
+         {ppp::Triangle::Lower, ppp::Triangle::Upper}) {
+        for (const ppp::Diagonal diagonal :
+             {ppp::Diagonal::NonUnit, ppp::Diagonal::Unit}) {
+            // The dense triangle the kernels are meant to apply
+            ppp::Matrix<double> dense{ppp::Matrix<double>::New(n, n).value()};
+            for (std::size_t row{0}; row < n; row++) {
+                for (std::size_t column{0}; column < n; column++) {
+                    const bool inside{triangle == ppp::Triangle::Lower
+                                          ? column < row
+                                          : column > row};
+                    if (row == column) {
+                        dense.Data()[(row * n) + column] =
+                            diagonal == ppp::Diagonal::Unit
+                                ? 1.0
+                                : a.Data()[(row * n) + column];
+                    } else if (inside) {
+                        dense.Data()[(row * n) + column] =
+                            a.Data()[(row * n) + column];
+                    }
+                }
+            }
+            const ppp::Matrix<double> expected{(dense * rhs).value()};
+
+            for (const ppp::Matrix<double>* operand : layouts) {
+                const auto product{
+                    operand->MultiplyTriangular(rhs, triangle, diagonal)};
+                matches = matches && product.has_value() &&
+                          close(product->Data(), expected.Data(),
+                                expected.Size());
+                const auto solved{
+                    operand->SolveTriangular(expected, triangle, diagonal)};
+                matches = matches && solved.has_value() &&
+                          close(solved->Data(), rhs.Data(), rhs.Size());
+            }
+
+            // A single right hand side agrees with the first column
+            const auto multiplied{
+                a.MultiplyTriangular(single, triangle, diagonal)};
+            matches = matches && multiplied.has_value();
+            for (std::size_t row{0}; matches && row < n; row++) {
+                matches = std::fabs(multiplied->Data()[row] -
+                                    expected.At(row, 0).value()) < 1e-9;
+            }
+            const auto recovered{
+                a.SolveTriangular(multiplied.value(), triangle, diagonal)};
+            matches = matches && recovered.has_value() &&
+                      close(recovered->Data(), single.Data(), n);
+        }
+    }
+
+    // The factors of LU() solve the system they came from
+    const auto [lower, upper]{a.LU().value()};
+    const auto forward{
+        lower.SolveTriangular(rhs, ppp::Triangle::Lower, ppp::Diagonal::Unit)};
+    const auto backward{
+        upper.SolveTriangular(forward.value(), ppp::Triangle::Upper)};
+    const auto direct{a.Solve(rhs)};
+    matches = matches && backward.has_value() && direct.has_value();
+    for (std::size_t i{0}; matches && i < rhs.Size(); i++) {
+        matches = std::fabs(backward->Data()[i] - direct->Data()[i]) < 1e-9;
+    }
+
+    ppp::Matrix<double> singular{a};
+    singular.Data()[(5 * n) + 5] = 0.0;
+    const ppp::Matrix<double> wide{ppp::Matrix<double>::New(n, n + 1).value()};
+    const bool rejected{
+        !singular.SolveTriangular(rhs, ppp::Triangle::Lower).has_value() &&
+        singular
+            .SolveTriangular(rhs, ppp::Triangle::Lower, ppp::Diagonal::Unit)
+            .has_value() &&
+        !wide.SolveTriangular(rhs, ppp::Triangle::Upper).has_value() &&
+        !wide.MultiplyTriangular(rhs, ppp::Triangle::Upper).has_value() &&
+        !a.MultiplyTriangular(wide.Transpose(), ppp::Triangle::Lower)
+             .has_value() &&
+        !a.SolveTriangular(ppp::Column<double>{std::vector<double>{1.0}, "x"},
+                           ppp::Triangle::Lower)
+             .has_value()};
+
+    if (matches && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestTriangular Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestTriangular Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestNuma(const std::unique_ptr<std::size_t>& passes,
+              const std::unique_ptr<std::size_t>& fails) {
+    const bool topology{ppp::NumaNodeCount() >= 1};
+
+    // Big buffers come from their own page aligned mapping, small ones from
+    // upstream, and both hand back usable memory under every policy
+    bool mapped{true};
+    for (const ppp::NumaPolicy policy :
+         {ppp::NumaPolicy::Local, ppp::NumaPolicy::Interleave,
+          ppp::NumaPolicy::Partitioned}) {
+        ppp::NumaResource& resource{ppp::SharedNumaResource(policy)};
+        mapped = mapped && resource.Policy() == policy;
+        for (const std::size_t bytes : {std::size_t{256}, ppp::NUMA_MIN_BYTES,
+                                        3 * ppp::NUMA_MIN_BYTES + 100}) {
+            auto* block{static_cast<unsigned char*>(
+                resource.allocate(bytes, ppp::BUFFER_ALIGNMENT))};
+            mapped = mapped && reinterpret_cast<std::uintptr_t>(block) %
+                                       ppp::BUFFER_ALIGNMENT ==
+                                   0;
+            if (policy != ppp::NumaPolicy::Local &&
+                bytes >= ppp::NUMA_MIN_BYTES) {
+                mapped = mapped &&
+                         reinterpret_cast<std::uintptr_t>(block) %
+                                 ppp::detail::PageSize() ==
+                             0 &&
+                         block[0] == 0 && block[bytes - 1] == 0;
+            }
+            block[0] = 1;
+            block[bytes - 1] = 2;
+            resource.deallocate(block, bytes, ppp::BUFFER_ALIGNMENT);
+        }
+    }
+
+    // Matrix and Column buffers placed by each policy compute the same
+    // results as ordinary ones
+    constexpr std::size_t side{768};
+    ppp::Matrix<double> lhs{ppp::Matrix<double>::New(side, side).value()};
+    ppp::Matrix<double> rhs{ppp::Matrix<double>::New(side, side).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = ppp::detail::RandomNormal<double>(10, i);
+        rhs.Data()[i] = ppp::detail::RandomNormal<double>(11, i);
+    }
+    const ppp::Matrix<double> sum{(lhs + rhs).value()};
+    const ppp::Matrix<double> product{(lhs * rhs).value()};
+    bool placed{true};
+    for (const ppp::NumaPolicy policy :
+         {ppp::NumaPolicy::Interleave, ppp::NumaPolicy::Partitioned}) {
+        const ppp::ScopedResource scope{&ppp::SharedNumaResource(policy)};
+        const ppp::Matrix<double> zeros{
+            ppp::Matrix<double>::New(side, side).value()};
+        placed = placed && std::all_of(zeros.Data(),
+                                       zeros.Data() + zeros.Size(),
+                                       [](double entry) { return entry == 0; });
+        placed = placed && (lhs + rhs).value() == sum &&
+                 (lhs * rhs).value() == product;
+        const ppp::Column<double> ones{std::vector<double>(1 << 19, 1.0),
+                                       "ones"};
+        placed = placed && ones.Sum() == static_cast<double>(1 << 19);
+    }
+
+    // Pinned workers give the same answers, and switching rebuilds the pool
+    ppp::SetThreadPinning(true);
+    const bool pinned{ppp::GetThreadPinning() &&
+                      ppp::GetThreadPool(2)->Pinned() &&
+                      ppp::Multiply(lhs, rhs, 2).value() == product};
+    ppp::SetThreadPinning(false);
+    const bool unpinned{!ppp::GetThreadPool(2)->Pinned()};
+
+    if (topology && mapped && placed && pinned && unpinned) {
+        (*passes)++;
+        std::cout << "Test: TestNuma Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestNuma Failed..." << std::endl << std::endl;
+        return false;
+    }
+}
+
+bool TestMapped(const std::unique_ptr<std::size_t>& passes,
+                const std::unique_ptr<std::size_t>& fails) {
+    const std::filesystem::path directory{
+        std::filesystem::temp_directory_path() / "ppp_mapped_test"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    // A few rows per tile, so every sweep crosses many tiles
+    ppp::SetMappedTileBytes(1 << 12);
+
+    ppp::Matrix<double> lhs{ppp::Matrix<double>::New(203, 97).value()};
+    ppp::Matrix<double> rhs{ppp::Matrix<double>::New(203, 97).value()};
+    for (std::size_t i{0}; i < lhs.Size(); i++) {
+        lhs.Data()[i] = ppp::detail::RandomNormal<double>(12, i);
+        rhs.Data()[i] = ppp::detail::RandomNormal<double>(13, i);
+    }
+    const auto close{[](const ppp::Column<double>& mapped,
+                        const ppp::Column<double>& expected) {
+        bool same{mapped.Size() == expected.Size()};
+        for (std::size_t i{0}; same && i < expected.Size(); i++) {
+            same = std::fabs(mapped.Data()[i] - expected.Data()[i]) < 1e-9;
+        }
+        return same;
+    }};
+
+    // Round trip, including from a column-major matrix
+    bool stored{
+        ppp::MappedMatrix<double>::Save(directory / "lhs", lhs).has_value() &&
+        ppp::MappedMatrix<double>::Save(
+            directory / "rhs", rhs.ToLayout(ppp::Layout::ColumnMajor))
+            .has_value()};
+    const auto left{ppp::MappedMatrix<double>::Open(directory / "lhs")};
+    const auto right{ppp::MappedMatrix<double>::Open(directory / "rhs")};
+    stored = stored && left.has_value() && right.has_value() &&
+             left->Height() == 203 && left->Width() == 97 &&
+             left->ToMatrix() == lhs && right->ToMatrix() == rhs &&
+             left->At(5, 7) == lhs.At(5, 7) && !left->At(203, 0).has_value();
+
+    bool reduced{stored};
+    for (const ppp::Axis axis :
+         {ppp::Axis::Row, ppp::Axis::Column, ppp::Axis::All}) {
+        reduced = reduced && close(left->Sum(axis), lhs.Sum(axis)) &&
+                  close(left->Mean(axis).value(), lhs.Mean(axis).value()) &&
+                  close(left->Min(axis).value(), lhs.Min(axis).value()) &&
+                  close(left->Max(axis).value(), lhs.Max(axis).value());
+    }
+
+    // Element-wise results and products go to new files
+    const auto sum{ppp::Add(*left, *right, directory / "sum")};
+    const auto difference{
+        ppp::Subtract(*left, *right, directory / "difference")};
+    const auto product{
+        ppp::Multiply(*left, rhs.Transposed(), directory / "product")};
+    const ppp::Matrix<double> expected{
+        ppp::Multiply(std::as_const(lhs).View(), rhs.Transposed(), 1)
+            .value()};
+    bool computed{stored && sum.has_value() && difference.has_value() &&
+                  product.has_value() &&
+                  sum->ToMatrix() == (lhs + rhs).value() &&
+                  difference->ToMatrix() == (lhs - rhs).value() &&
+                  product->Height() == 203 && product->Width() == 203};
+    const ppp::Matrix<double> loaded{product->ToMatrix()};
+    for (std::size_t i{0}; computed && i < expected.Size(); i++) {
+        computed = std::fabs(loaded.Data()[i] - expected.Data()[i]) < 1e-9;
+    }
+
+    // Copy-on-write changes stay in the mapping, read-write ones reach the
+    // file, and read-only maps refuse writes
+    auto scratch{ppp::MappedMatrix<double>::Open(directory / "lhs",
+                                                 ppp::MapMode::CopyOnWrite)};
+    bool modes{scratch.has_value() && (*scratch *= 2.0).has_value() &&
+               (*scratch += *right).has_value() &&
+               scratch->At(3, 4).value() ==
+                   (2.0 * lhs.At(3, 4).value()) + rhs.At(3, 4).value() &&
+               ppp::MappedMatrix<double>::Open(directory / "lhs")
+                       ->ToMatrix() == lhs};
+    {
+        auto shared{ppp::MappedMatrix<double>::Open(
+            directory / "sum", ppp::MapMode::ReadWrite)};
+        modes = modes && shared.has_value() &&
+                (*shared -= *right).has_value() &&
+                shared->Set(0, 0, 42.0).has_value() &&
+                shared->Flush().has_value();
+    }
+    ppp::Matrix<double> restored{((lhs + rhs).value() - rhs).value()};
+    restored.Data()[0] = 42.0;
+    modes = modes &&
+            ppp::MappedMatrix<double>::Open(directory / "sum")->ToMatrix() ==
+                restored;
+    auto fixed{ppp::MappedMatrix<double>::Open(directory / "lhs")};
+    modes = modes && !(*fixed *= 2.0).has_value() &&
+            !(*fixed += *right).has_value() &&
+            !fixed->Set(0, 0, 1.0).has_value() && !fixed->Flush().has_value();
+
+    // Wrong element type, missing or truncated files and shape mismatches
+    const auto narrow{ppp::MappedMatrix<double>::Create(directory / "narrow",
+                                                        203, 5)};
+    std::filesystem::copy_file(directory / "lhs", directory / "short");
+    std::filesystem::resize_file(directory / "short", 4096 + 1000);
+    const bool rejected{
+        !ppp::MappedMatrix<float>::Open(directory / "lhs").has_value() &&
+        !ppp::MappedMatrix<std::int64_t>::Open(directory / "lhs")
+             .has_value() &&
+        !ppp::MappedMatrix<double>::Open(directory / "missing").has_value() &&
+        !ppp::MappedMatrix<double>::Open(directory / "short").has_value() &&
+        narrow.has_value() &&
+        !ppp::Add(*left, *narrow, directory / "bad").has_value() &&
+        !ppp::Multiply(*left, *narrow, directory / "bad").has_value()};
+
+    ppp::SetMappedTileBytes(0);
+    std::filesystem::remove_all(directory);
+
+    if (stored && reduced && computed && modes && rejected) {
+        (*passes)++;
+        std::cout << "Test: TestMapped Passed!" << std::endl << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestMapped Failed..." << std::endl << std::endl;
+        return false;
+    }
+}
+
 }  // namespace
 
 bool MatrixMasterTest(const std::unique_ptr<std::size_t>& passes,
@@ -331,7 +2677,22 @@ bool MatrixMasterTest(const std::unique_ptr<std::size_t>& passes,
            TestInsertingHeaders(passes, fails) &&
            TestBadShapeCatching(passes, fails) && TestAddition(passes, fails) &&
            TestSubtraction(passes, fails) &&
-           TestNonMatrixSubtraction(passes, fails) && TestLU(passes, fails);
+           TestNonMatrixSubtraction(passes, fails) && TestLU(passes, fails) &&
+           TestMultiplication(passes, fails) &&
+           TestParallelMultiplication(passes, fails) &&
+           TestLazyExpression(passes, fails) &&
+           TestBroadcasting(passes, fails) &&
+           TestCompoundAssignment(passes, fails) &&
+           TestPivotedLU(passes, fails) && TestFactorizations(passes, fails) &&
+           TestTranspose(passes, fails) && TestViews(passes, fails) &&
+           TestFixedMatrix(passes, fails) && TestBatch(passes, fails) &&
+           TestPooledAllocation(passes, fails) &&
+           TestCopyOnWrite(passes, fails) && TestReductions(passes, fails) &&
+           TestMath(passes, fails) && TestTuning(passes, fails) &&
+           TestRandomizedSVD(passes, fails) && TestQuantized(passes, fails) &&
+           TestSplitComplex(passes, fails) &&
+           TestConvolution(passes, fails) && TestTriangular(passes, fails) &&
+           TestNuma(passes, fails) && TestMapped(passes, fails);
 }
 
 }  // namespace matrix_test
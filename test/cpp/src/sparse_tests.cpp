@@ -0,0 +1,204 @@
+#include "include/sparse_tests.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "ppp/Column.hpp"
+#include "ppp/Matrix.hpp"
+#include "ppp/Sparse.hpp"
+
+namespace sparse_test {
+
+namespace {
+
+// Roughly one entry in density is nonzero, with values in [-1, 1)
+ppp::Matrix<double> RandomSparse(std::size_t rows, std::size_t columns,
+                                 std::uint32_t density,
+                                 ppp::Layout layout = ppp::Layout::RowMajor) {
+    ppp::Matrix<double> dense{
+        ppp::Matrix<double>::New(rows, columns, layout).value()};
+    for (std::size_t i{0}; i < dense.Size(); i++) {
+        std::uint32_t hash{static_cast<std::uint32_t>(i) * 2654435761u};
+        hash ^= hash >> 15;
+        hash *= 2246822519u;
+        hash ^= hash >> 13;
+        if (hash % density == 0) {
+            dense.Data()[i] = static_cast<double>(hash >> 8) / (1 << 23) - 1.0;
+        }
+    }
+    return dense;
+}
+
+bool Close(const ppp::Matrix<double>& left, const ppp::Matrix<double>& right) {
+    if (left.Height() != right.Height() || left.Width() != right.Width()) {
+        return false;
+    }
+    for (std::size_t row{0}; row < left.Height(); row++) {
+        for (std::size_t column{0}; column < left.Width(); column++) {
+            if (std::fabs(left.At(row, column).value() -
+                          right.At(row, column).value()) > 1e-9) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool TestCooConstruction(const std::unique_ptr<std::size_t>& passes,
+                         const std::unique_ptr<std::size_t>& fails) {
+    // Out of order, with (2, 1) given twice
+    const std::vector<ppp::Triplet<double>> triplets{
+        {2, 1, 4.0}, {0, 3, 1.0}, {1, 0, -2.0}, {2, 1, 0.5}, {0, 0, 3.0}};
+    const std::optional<ppp::SparseMatrix<double>> csr{
+        ppp::SparseMatrix<double>::New(3, 4, triplets)};
+    const std::optional<ppp::SparseMatrix<double>> csc{
+        ppp::SparseMatrix<double>::New(3, 4, triplets,
+                                       ppp::Layout::ColumnMajor)};
+    const ppp::Matrix<double> expected{
+        ppp::Matrix<double>::New(std::vector<std::vector<double>>{
+                                     {3.0, 0.0, 0.0, 1.0},
+                                     {-2.0, 0.0, 0.0, 0.0},
+                                     {0.0, 4.5, 0.0, 0.0},
+                                 })
+            .value()};
+
+    const std::vector<ppp::Triplet<double>> outside{{3, 0, 1.0}};
+    if (csr.has_value() && csc.has_value() && csr.value().NonZeros() == 4 &&
+        csc.value().NonZeros() == 4 &&
+        csr.value().At(2, 1) == std::optional<double>{4.5} &&
+        csc.value().At(1, 0) == std::optional<double>{-2.0} &&
+        csr.value().At(1, 1) == std::optional<double>{0.0} &&
+        !csr.value().At(3, 0).has_value() &&
+        csr.value().ToDense() == expected &&
+        csc.value().ToDense(ppp::Layout::ColumnMajor) == expected &&
+        !ppp::SparseMatrix<double>::New(3, 4, outside).has_value()) {
+        (*passes)++;
+        std::cout << "Test: TestCooConstruction Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestCooConstruction Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestDenseConversion(const std::unique_ptr<std::size_t>& passes,
+                         const std::unique_ptr<std::size_t>& fails) {
+    const ppp::Matrix<double> dense{
+        RandomSparse(301, 257, 9, ppp::Layout::ColumnMajor)};
+    const ppp::SparseMatrix<double> csr{
+        ppp::SparseMatrix<double>::New(dense).value()};
+    const ppp::SparseMatrix<double> csc{
+        ppp::SparseMatrix<double>::New(dense, ppp::Layout::ColumnMajor)
+            .value()};
+    const ppp::SparseMatrix<double> converted{
+        csr.ToLayout(ppp::Layout::ColumnMajor)};
+    const ppp::SparseMatrix<double> block{
+        ppp::SparseMatrix<double>::New(dense.Block(10, 20, 30, 40).value())
+            .value()};
+
+    const auto same{[](const auto& left, const auto& right) {
+        return std::equal(left.begin(), left.end(), right.begin(),
+                          right.end());
+    }};
+    if (csr.ToDense() == dense && csc.ToDense() == dense &&
+        csr.NonZeros() == csc.NonZeros() &&
+        same(converted.Offsets(), csc.Offsets()) &&
+        same(converted.Indices(), csc.Indices()) &&
+        same(converted.Values(), csc.Values()) &&
+        converted.ToLayout(ppp::Layout::RowMajor).ToDense() == dense &&
+        block.ToDense() ==
+            ppp::Matrix<double>::New(dense.Block(10, 20, 30, 40).value())
+                .value()) {
+        (*passes)++;
+        std::cout << "Test: TestDenseConversion Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestDenseConversion Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+bool TestSparseProducts(const std::unique_ptr<std::size_t>& passes,
+                        const std::unique_ptr<std::size_t>& fails) {
+    // Enough stored entries for the products to split across threads
+    constexpr std::size_t rows{1200};
+    constexpr std::size_t inner{900};
+    const ppp::Matrix<double> dense{RandomSparse(rows, inner, 16)};
+    const ppp::SparseMatrix<double> csr{
+        ppp::SparseMatrix<double>::New(dense).value()};
+    const ppp::SparseMatrix<double> csc{
+        csr.ToLayout(ppp::Layout::ColumnMajor)};
+
+    std::vector<double> values(inner);
+    ppp::Matrix<double> vector{ppp::Matrix<double>::New(inner, 1).value()};
+    for (std::size_t i{0}; i < inner; i++) {
+        values[i] = static_cast<double>(i % 13) - 6.0;
+        vector.Data()[i] = values[i];
+    }
+    const ppp::Column<double> column{values, "x"};
+    const ppp::Matrix<double> expected_vector{(dense * vector).value()};
+
+    const auto matches{[&expected_vector](
+                           const std::optional<ppp::Column<double>>& product) {
+        if (!product.has_value() ||
+            product.value().Size() != expected_vector.Height()) {
+            return false;
+        }
+        for (std::size_t i{0}; i < expected_vector.Height(); i++) {
+            if (std::fabs(product.value().Data()[i] -
+                          expected_vector.At(i, 0).value()) > 1e-9) {
+                return false;
+            }
+        }
+        return true;
+    }};
+
+    const ppp::Matrix<double> rhs{
+        RandomSparse(inner, 37, 1, ppp::Layout::ColumnMajor)};
+    const ppp::Matrix<double> expected{(dense * rhs).value()};
+    const ppp::Column<double> short_column{std::vector<double>(3, 1.0), ""};
+
+    if (matches(csr * column) && matches(csc * column) &&
+        Close((csr * rhs).value(), expected) &&
+        Close((csc * rhs).value(), expected) &&
+        Close(ppp::Multiply(csc, rhs, 1).value(), expected) &&
+        Close(ppp::Multiply(csc, rhs, 4).value(), expected) &&
+        Close((csr * rhs.ToLayout(ppp::Layout::RowMajor)).value(),
+              expected) &&
+        Close((csr * rhs.Block(0, 5, inner, 7).value()).value(),
+              (dense * rhs.Block(0, 5, inner, 7).value()).value()) &&
+        !(csr * short_column).has_value() && !(csr * dense).has_value()) {
+        (*passes)++;
+        std::cout << "Test: TestSparseProducts Passed!" << std::endl
+                  << std::endl;
+        return true;
+    } else {
+        (*fails)++;
+        std::cout << "Test: TestSparseProducts Failed..." << std::endl
+                  << std::endl;
+        return false;
+    }
+}
+
+}  // namespace
+
+bool SparseMasterTest(const std::unique_ptr<std::size_t>& passes,
+                      const std::unique_ptr<std::size_t>& fails) {
+    return TestCooConstruction(passes, fails) &&
+           TestDenseConversion(passes, fails) &&
+           TestSparseProducts(passes, fails);
+}
+
+}  // namespace sparse_test